@@ -3,6 +3,7 @@
 
 #include "core_types.h"
 #include "esp_err.h"
+#include "freertos/FreeRTOS.h"
 
 typedef enum
 {
@@ -25,6 +26,14 @@ typedef struct
     bool heater_state;
 } heater_command_data_t;
 
+/* Reply to COMMAND_TYPE_HEATER_GET_STATUS */
+typedef struct
+{
+    bool heater_on;
+    float power_level;      // Average of the samples in the current window
+    uint8_t power_samples;
+} heater_status_t;
+
 typedef enum
 {
     COMMAND_TYPE_COORDINATOR_START_PROFILE,
@@ -33,14 +42,69 @@ typedef enum
     COMMAND_TYPE_COORDINATOR_STOP_PROFILE,
     COMMAND_TYPE_COORDINATOR_GET_STATUS_REPORT,
     COMMAND_TYPE_COORDINATOR_GET_CURRENT_PROFILE,
-    COMMAND_TYPE_UPDATE_MANUAL_TARGET
+    COMMAND_TYPE_UPDATE_MANUAL_TARGET,
+    COMMAND_TYPE_COORDINATOR_RESUME_CHECKPOINT  // Continue the run journaled before a reset
 } coordinator_command_type_t;
 
+/*
+ * The critical lane is drained first, then normal, then bulk, rescanning
+ * after every command.  Safety
+ * commands (heater clear/off, profile stop) always go to the critical lane,
+ * whatever the caller asked for; dispatching to it never blocks.  A safety
+ * command cancels the normal and bulk commands already waiting for its
+ * target that change its output, so a profile start queued before a stop
+ * never runs after it.  Status requests are never cancelled.
+ */
+typedef enum
+{
+    COMMAND_LANE_NORMAL = 0,   // Default for a zero-initialised command_t
+    COMMAND_LANE_CRITICAL,
+    COMMAND_LANE_BULK,         // Status requests and other work that may wait
+    COMMAND_LANE_COUNT
+} command_lane_t;
+
+typedef struct
+{
+    uint32_t dispatched;
+    uint32_t rejected;      // Lane full (critical only) or no payload slot
+    uint32_t coalesced;     // Superseded by a newer command before delivery
+    uint32_t cancelled;     // Dropped by a later safety command to the same target
+    uint32_t depth;         // Commands waiting now
+    uint32_t wait_max_us;   // Queue wait, dispatch to handler start
+    uint32_t wait_avg_us;
+} command_lane_stats_t;
+
+/* Where a target's commands spend their time */
+typedef struct
+{
+    uint32_t handled;
+    uint32_t wait_max_us;       // Dispatch to handler start
+    uint32_t wait_avg_us;
+    uint32_t handler_max_us;    // Handler run time
+    uint32_t handler_avg_us;
+} command_target_stats_t;
+
+/*
+ * Latest-value keys: while a command with the same target and non-zero key
+ * is still waiting, a new one replaces its payload instead of queueing
+ * again.  Only for idempotent commands whose newest value is all that
+ * matters.  A safety command to the target drops the waiting one.
+ */
+#define COMMAND_COALESCE_NONE 0
+#define COMMAND_COALESCE_HEATER_POWER 1
+
+/*
+ * commands_dispatcher_dispatch_command() copies data_size bytes of data into
+ * a dispatcher-owned slot before queueing, so data may point at a local.
+ * The handler sees the slot, which is released when the handler returns.
+ */
 typedef struct
 {
     command_target_t target;
     void* data;
     size_t data_size;
+    command_lane_t lane;
+    uint8_t coalesce_key;   // COMMAND_COALESCE_NONE delivers every command
 } command_t;
 
 
@@ -53,12 +117,60 @@ typedef struct
     int  delta_t_per_min_x10;   ///< New heating rate (x10, e.g. 15 = 1.5 °C/min)
 } coordinator_command_data_t;
 
-typedef esp_err_t (*command_handler_t)(void* handler_arg, void* command_data, size_t command_data_size);
+/*
+ * Where a handler puts its answer to a request.  NULL for commands that were
+ * dispatched without a future; data is dispatcher-owned and copied to the
+ * requester's buffer when the handler returns.
+ */
+typedef struct
+{
+    void* data;
+    size_t capacity;
+    size_t size;
+} command_reply_t;
+
+typedef esp_err_t (*command_handler_t)(void* handler_arg, void* command_data, size_t command_data_size,
+                                       command_reply_t* reply);
+
+/* Pending reply to commands_dispatcher_request(), see commands_dispatcher_wait() */
+typedef struct command_future command_future_t;
 
 esp_err_t commands_dispatcher_init(void);
 
 esp_err_t commands_dispatcher_dispatch_command(command_t* command);
 
+/**
+ * @brief Dispatch a command whose handler answers into @p reply.
+ *
+ * The returned future must be waited on exactly once, from any task.
+ * @p reply must stay valid until then; after a timeout the dispatcher
+ * drops the reply instead of writing it.
+ */
+esp_err_t commands_dispatcher_request(command_t* command, void* reply, size_t reply_size, command_future_t** future);
+
+/**
+ * @brief Block until the handler of @p future returns or @p timeout passes.
+ *
+ * Always releases the future.  Returns the handler's result, or
+ * ESP_ERR_TIMEOUT.  @p reply_len (optional) receives the reply size.
+ */
+esp_err_t commands_dispatcher_wait(command_future_t* future, TickType_t timeout, size_t* reply_len);
+
+/**
+ * @brief commands_dispatcher_request() followed by commands_dispatcher_wait().
+ */
+esp_err_t commands_dispatcher_call(command_t* command, void* reply, size_t reply_size, size_t* reply_len,
+                                   TickType_t timeout);
+
+/**
+ * @brief Copy a handler's answer into @p reply; a no-op for fire-and-forget commands.
+ */
+esp_err_t command_reply_set(command_reply_t* reply, const void* data, size_t size);
+
+esp_err_t commands_dispatcher_get_lane_stats(command_lane_t lane, command_lane_stats_t* stats);
+
+esp_err_t commands_dispatcher_get_target_stats(command_target_t target, command_target_stats_t* stats);
+
 esp_err_t register_command_handler(
     command_target_t target,
     command_handler_t handler,
@@ -8,6 +8,7 @@ static const char *TAG = "COMMANDS_DISPATCHER_HANDLERS";
 
 esp_err_t init_command_handlers(commands_dispatcher_ctx_t *ctx)
 {
+    (void)ctx;
     // Initialize default command handlers here if needed
 
     LOGGER_LOG_INFO(TAG, "Command handlers initialized");
@@ -65,7 +66,8 @@ esp_err_t register_command_handler(
         .handler_arg = handler_arg,
         .registered = true};
     LOGGER_LOG_INFO(TAG, "Registered command handler for target: %d", target);
-    return ESP_OK;
+
+    return start_command_worker(commands_dispatcher_ctx, target);
 }
 
 esp_err_t unregister_command_handler(command_target_t target)
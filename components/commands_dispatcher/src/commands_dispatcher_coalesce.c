@@ -0,0 +1,115 @@
+/**
+ * @file commands_dispatcher_coalesce.c
+ * @brief Latest-value delivery for idempotent commands.
+ *
+ * The first coalescable command for a (target, key) pair claims an entry,
+ * stores its payload there and queues a marker in its lane.  Until the
+ * marker runs, later commands with the same pair only overwrite the stored
+ * payload, so a burst of heater power updates reaches the handler as one
+ * command carrying the newest level.  The dispatcher copies the payload out
+ * and frees the entry just before calling the handler.
+ */
+
+#include <string.h>
+#include "commands_dispatcher_internal.h"
+#include "logger_component.h"
+#include "sdkconfig.h"
+
+static const char* TAG = "COMMANDS_DISPATCHER_COALESCE";
+
+/* =========================================================================
+ *  Internal API
+ * ========================================================================= */
+void init_command_coalescing(commands_dispatcher_ctx_t* ctx)
+{
+    ctx->coalesce_lock = (portMUX_TYPE)portMUX_INITIALIZER_UNLOCKED;
+    memset(ctx->coalesce_entries, 0, sizeof(ctx->coalesce_entries));
+}
+
+bool command_coalesce(commands_dispatcher_ctx_t* ctx, const command_t* command, const command_lane_t lane,
+                      command_coalesce_entry_t** marker)
+{
+    *marker = NULL;
+    if (command->data_size > sizeof(command_small_slot_t))
+    {
+        LOGGER_LOG_WARN(TAG, "Payload of %d bytes too large to coalesce, queueing as is", (int)command->data_size);
+        return false;
+    }
+
+    command_coalesce_entry_t* free_entry = NULL;
+    bool absorbed = false;
+
+    taskENTER_CRITICAL(&ctx->coalesce_lock);
+    for (int i = 0; i < CONFIG_COMMANDS_DISPATCHER_COALESCE_SLOTS; i++)
+    {
+        command_coalesce_entry_t* entry = &ctx->coalesce_entries[i];
+        if (!entry->pending)
+        {
+            free_entry = free_entry != NULL ? free_entry : entry;
+            continue;
+        }
+        if (entry->target == command->target && entry->key == command->coalesce_key)
+        {
+            memcpy(&entry->payload, command->data, command->data_size);
+            entry->payload_size = command->data_size;
+            worker_for(ctx, entry->target)->lane_stats[entry->lane].coalesced++;
+            absorbed = true;
+            break;
+        }
+    }
+    if (!absorbed && free_entry != NULL)
+    {
+        free_entry->pending = true;
+        free_entry->target = command->target;
+        free_entry->key = command->coalesce_key;
+        free_entry->lane = lane;
+        memcpy(&free_entry->payload, command->data, command->data_size);
+        free_entry->payload_size = command->data_size;
+        *marker = free_entry;
+    }
+    taskEXIT_CRITICAL(&ctx->coalesce_lock);
+
+    return absorbed;
+}
+
+void command_coalesce_cancel(commands_dispatcher_ctx_t* ctx, command_coalesce_entry_t* entry)
+{
+    taskENTER_CRITICAL(&ctx->coalesce_lock);
+    entry->pending = false;
+    taskEXIT_CRITICAL(&ctx->coalesce_lock);
+}
+
+void command_supersede_target(commands_dispatcher_ctx_t* ctx, const command_target_t target)
+{
+    taskENTER_CRITICAL(&ctx->coalesce_lock);
+    ctx->target_generation[target]++;
+    for (int i = 0; i < CONFIG_COMMANDS_DISPATCHER_COALESCE_SLOTS; i++)
+    {
+        command_coalesce_entry_t* entry = &ctx->coalesce_entries[i];
+        if (entry->pending && entry->target == target)
+        {
+            /* The marker stays queued and is cancelled by the new generation */
+            entry->pending = false;
+            worker_for(ctx, entry->target)->lane_stats[entry->lane].coalesced++;
+        }
+    }
+    taskEXIT_CRITICAL(&ctx->coalesce_lock);
+}
+
+bool command_coalesce_take(commands_dispatcher_ctx_t* ctx, command_coalesce_entry_t* entry,
+                           command_small_slot_t* payload, size_t* payload_size)
+{
+    bool taken = false;
+
+    taskENTER_CRITICAL(&ctx->coalesce_lock);
+    if (entry->pending)
+    {
+        memcpy(payload, &entry->payload, entry->payload_size);
+        *payload_size = entry->payload_size;
+        entry->pending = false;
+        taken = true;
+    }
+    taskEXIT_CRITICAL(&ctx->coalesce_lock);
+
+    return taken;
+}
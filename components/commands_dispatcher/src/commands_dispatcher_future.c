@@ -0,0 +1,241 @@
+/**
+ * @file commands_dispatcher_future.c
+ * @brief Request/response on top of the command lanes.
+ *
+ * A request takes a future from a fixed pool and travels through its lane
+ * like any other command.  The handler writes its reply into the future's
+ * scratch buffer; when it returns the dispatcher copies the reply to the
+ * requester's buffer and gives the future's own binary semaphore, so a round
+ * trip costs one switch each way and no event-bus broadcast.  The waiter's
+ * task notification value is left alone for the caller's own use.
+ *
+ * A requester that times out marks its future abandoned.  State changes and
+ * the final copy happen under future_lock, so once a wait has returned the
+ * dispatcher never touches the requester's buffer again.
+ */
+
+#include <string.h>
+#include "commands_dispatcher_internal.h"
+#include "logger_component.h"
+#include "sdkconfig.h"
+
+static const char* TAG = "COMMANDS_DISPATCHER_FUTURE";
+
+/* =========================================================================
+ *  Internal API
+ * ========================================================================= */
+esp_err_t init_command_futures(commands_dispatcher_ctx_t* ctx)
+{
+    ctx->future_lock = (portMUX_TYPE)portMUX_INITIALIZER_UNLOCKED;
+    for (int i = 0; i < CONFIG_COMMANDS_DISPATCHER_MAX_FUTURES; i++)
+    {
+        command_future_t* future = &ctx->futures[i];
+        if (future->done == NULL)
+        {
+            future->done = xSemaphoreCreateBinary();
+            if (future->done == NULL)
+            {
+                LOGGER_LOG_ERROR(TAG, "Failed to create command future semaphores");
+                return ESP_ERR_NO_MEM;
+            }
+        }
+        xSemaphoreTake(future->done, 0);
+        future->state = COMMAND_FUTURE_FREE;
+    }
+    return ESP_OK;
+}
+
+void shutdown_command_futures(commands_dispatcher_ctx_t* ctx)
+{
+    for (int i = 0; i < CONFIG_COMMANDS_DISPATCHER_MAX_FUTURES; i++)
+    {
+        if (ctx->futures[i].done != NULL)
+        {
+            vSemaphoreDelete(ctx->futures[i].done);
+            ctx->futures[i].done = NULL;
+        }
+    }
+}
+
+command_future_t* command_future_alloc(commands_dispatcher_ctx_t* ctx, void* reply, const size_t reply_size)
+{
+    command_future_t* future = NULL;
+
+    taskENTER_CRITICAL(&ctx->future_lock);
+    for (int i = 0; i < CONFIG_COMMANDS_DISPATCHER_MAX_FUTURES; i++)
+    {
+        if (ctx->futures[i].state == COMMAND_FUTURE_FREE)
+        {
+            future = &ctx->futures[i];
+            future->state = COMMAND_FUTURE_PENDING;
+            future->reply = reply;
+            future->reply_capacity = reply_size;
+            future->reply_size = 0;
+            future->result = ESP_FAIL;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&ctx->future_lock);
+
+    if (future != NULL)
+    {
+        /* A previous waiter that saw DONE before taking leaves a give behind */
+        xSemaphoreTake(future->done, 0);
+    }
+    return future;
+}
+
+void command_future_release(commands_dispatcher_ctx_t* ctx, command_future_t* future)
+{
+    taskENTER_CRITICAL(&ctx->future_lock);
+    future->state = COMMAND_FUTURE_FREE;
+    taskEXIT_CRITICAL(&ctx->future_lock);
+}
+
+void command_future_complete(commands_dispatcher_ctx_t* ctx, command_future_t* future, const esp_err_t result,
+                             const size_t reply_size)
+{
+    bool wake = false;
+
+    taskENTER_CRITICAL(&ctx->future_lock);
+    if (future->state == COMMAND_FUTURE_ABANDONED)
+    {
+        future->state = COMMAND_FUTURE_FREE;
+    }
+    else
+    {
+        const size_t size = reply_size < future->reply_capacity ? reply_size : future->reply_capacity;
+        if (future->reply != NULL && size > 0)
+        {
+            memcpy(future->reply, future->scratch, size);
+        }
+        future->reply_size = size;
+        future->result = result;
+        future->state = COMMAND_FUTURE_DONE;
+        wake = true;
+    }
+    taskEXIT_CRITICAL(&ctx->future_lock);
+
+    if (wake)
+    {
+        xSemaphoreGive(future->done);
+    }
+}
+
+/* =========================================================================
+ *  Public API
+ * ========================================================================= */
+esp_err_t commands_dispatcher_request(command_t* command, void* reply, const size_t reply_size,
+                                      command_future_t** future)
+{
+    if (commands_dispatcher_ctx == NULL || !commands_dispatcher_ctx->dispatcher_running)
+    {
+        LOGGER_LOG_ERROR(TAG, "Commands Dispatcher not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (future == NULL || (reply == NULL && reply_size > 0))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    /* A handler cannot wait for a command served by its own worker */
+    if (command != NULL && command->target < CONFIG_COMMANDS_DISPATCHER_MAX_HANDLERS &&
+        xTaskGetCurrentTaskHandle() == worker_for(commands_dispatcher_ctx, command->target)->task_handle)
+    {
+        LOGGER_LOG_ERROR(TAG, "Requests cannot be made from a command handler");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    command_future_t* pending = command_future_alloc(commands_dispatcher_ctx, reply, reply_size);
+    if (pending == NULL)
+    {
+        LOGGER_LOG_WARN(TAG, "All %d command futures in use", CONFIG_COMMANDS_DISPATCHER_MAX_FUTURES);
+        return ESP_ERR_NO_MEM;
+    }
+
+    const esp_err_t err = enqueue_command(commands_dispatcher_ctx, command, pending);
+    if (err != ESP_OK)
+    {
+        command_future_release(commands_dispatcher_ctx, pending);
+        return err;
+    }
+
+    *future = pending;
+    return ESP_OK;
+}
+
+esp_err_t commands_dispatcher_wait(command_future_t* future, const TickType_t timeout, size_t* reply_len)
+{
+    if (commands_dispatcher_ctx == NULL || future == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    commands_dispatcher_ctx_t* ctx = commands_dispatcher_ctx;
+    const TickType_t start = xTaskGetTickCount();
+    esp_err_t result = ESP_ERR_TIMEOUT;
+
+    for (;;)
+    {
+        taskENTER_CRITICAL(&ctx->future_lock);
+        const bool done = future->state == COMMAND_FUTURE_DONE;
+        const TickType_t elapsed = xTaskGetTickCount() - start;
+        if (done || elapsed >= timeout)
+        {
+            if (done)
+            {
+                result = future->result;
+                if (reply_len != NULL)
+                {
+                    *reply_len = future->reply_size;
+                }
+                future->state = COMMAND_FUTURE_FREE;
+            }
+            else
+            {
+                /* Still queued or running: the dispatcher frees it when the handler returns */
+                future->state = COMMAND_FUTURE_ABANDONED;
+            }
+            taskEXIT_CRITICAL(&ctx->future_lock);
+            break;
+        }
+        taskEXIT_CRITICAL(&ctx->future_lock);
+
+        xSemaphoreTake(future->done, timeout - elapsed);
+    }
+
+    if (result == ESP_ERR_TIMEOUT)
+    {
+        LOGGER_LOG_WARN(TAG, "Command request timed out after %lu ms",
+                        (unsigned long)pdTICKS_TO_MS(xTaskGetTickCount() - start));
+    }
+    return result;
+}
+
+esp_err_t commands_dispatcher_call(command_t* command, void* reply, const size_t reply_size, size_t* reply_len,
+                                   const TickType_t timeout)
+{
+    command_future_t* future = NULL;
+    const esp_err_t err = commands_dispatcher_request(command, reply, reply_size, &future);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    return commands_dispatcher_wait(future, timeout, reply_len);
+}
+
+esp_err_t command_reply_set(command_reply_t* reply, const void* data, const size_t size)
+{
+    if (reply == NULL)
+    {
+        return ESP_OK;
+    }
+    if (size > reply->capacity)
+    {
+        LOGGER_LOG_ERROR(TAG, "Reply of %d bytes exceeds the %d byte reply slot", (int)size, (int)reply->capacity);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    memcpy(reply->data, data, size);
+    reply->size = size;
+    return ESP_OK;
+}
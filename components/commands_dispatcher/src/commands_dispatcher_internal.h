@@ -6,6 +6,7 @@
 #include "esp_err.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
 
 typedef struct {
     command_handler_t handler;
@@ -13,23 +14,230 @@ typedef struct {
     bool registered;
 } handler_entry_t;
 
+// ----------------------------
+// Payload slab
+// ----------------------------
+typedef enum
+{
+    COMMAND_SLAB_SMALL = 0,         // Heater commands and other small payloads
+    COMMAND_SLAB_LARGE,             // coordinator_command_data_t, which embeds a whole program_draft_t
+    COMMAND_SLAB_CRITICAL_SMALL,    // Reserved for the critical lane so it never waits for a slot
+    COMMAND_SLAB_CRITICAL_LARGE,
+    COMMAND_SLAB_CLASS_COUNT,
+    COMMAND_SLAB_NONE = COMMAND_SLAB_CLASS_COUNT, // No payload
+} command_slab_class_t;
+
+typedef union
+{
+    heater_command_data_t heater;
+    uint8_t bytes[CONFIG_COMMANDS_DISPATCHER_SMALL_SLOT_SIZE];
+} command_small_slot_t;
+
+typedef union
+{
+    coordinator_command_data_t coordinator;
+    uint8_t bytes[sizeof(coordinator_command_data_t)];
+} command_large_slot_t;
+
+typedef struct
+{
+    QueueHandle_t free_slots;   // Pointers to free slots; a receive blocks while the class is exhausted
+    size_t slot_size;
+    uint16_t slot_count;
+} command_slab_t;
+
+// ----------------------------
+// Coalescing
+// ----------------------------
+typedef struct
+{
+    bool pending;               // A marker for this entry sits in a lane
+    command_target_t target;
+    uint8_t key;
+    command_lane_t lane;
+    size_t payload_size;
+    command_small_slot_t payload;   // Newest payload, copied out when the marker runs
+} command_coalesce_entry_t;
+
+// ----------------------------
+// Futures
+// ----------------------------
+typedef enum
+{
+    COMMAND_FUTURE_FREE = 0,
+    COMMAND_FUTURE_PENDING,     // Queued or running
+    COMMAND_FUTURE_DONE,        // Reply copied, requester not yet back from wait
+    COMMAND_FUTURE_ABANDONED,   // Requester timed out; the dispatcher frees it on completion
+} command_future_state_t;
+
+struct command_future
+{
+    command_future_state_t state;
+    SemaphoreHandle_t done;     // Given once the reply is in place
+    void* reply;                // Requester's buffer
+    size_t reply_capacity;
+    size_t reply_size;
+    esp_err_t result;
+    uint8_t scratch[CONFIG_COMMANDS_DISPATCHER_REPLY_SIZE]; // Handler writes here
+};
+
+/* What actually travels through the queue: the payload lives in a slab slot */
 typedef struct
 {
-    QueueHandle_t command_queue;
-    TaskHandle_t dispatcher_task_handle;
+    command_target_t target;
+    void* payload;
+    size_t payload_size;
+    command_slab_class_t slab_class;
+    command_lane_t lane;
+    int64_t enqueued_us;
+    uint32_t generation;        // Target generation at dispatch, see commands_dispatcher_ctx_t
+    bool supersedable;          // Changes the output: cancelled by a later safety command
+    command_future_t* future;   // NULL for fire-and-forget
+    command_coalesce_entry_t* coalesced; // Marker: the payload is the entry's at run time
+} queued_command_t;
+
+// ----------------------------
+// Workers
+// ----------------------------
+#if CONFIG_COMMANDS_DISPATCHER_PER_TARGET_WORKERS
+#define COMMAND_WORKER_COUNT CONFIG_COMMANDS_DISPATCHER_MAX_HANDLERS
+#else
+#define COMMAND_WORKER_COUNT 1
+#endif
+
+struct commands_dispatcher_ctx;
+
+/* A task and its lanes; one per target, or one shared by all targets */
+typedef struct
+{
+    uint8_t index;
+    QueueHandle_t lanes[COMMAND_LANE_COUNT];
+    TaskHandle_t task_handle;
+    struct commands_dispatcher_ctx* owner;
+    volatile TickType_t last_tick;  // Last pass of the worker loop, for the health heartbeat
+
+    command_lane_stats_t lane_stats[COMMAND_LANE_COUNT];
+    uint64_t lane_wait_sum_us[COMMAND_LANE_COUNT];
+} command_worker_t;
+
+typedef struct commands_dispatcher_ctx
+{
+    command_worker_t workers[COMMAND_WORKER_COUNT];
     volatile bool dispatcher_running;
+    portMUX_TYPE report_lock;       // Guards last_report_us: one worker reports per interval
+    int64_t last_report_us;
 
     handler_entry_t command_handlers[CONFIG_COMMANDS_DISPATCHER_MAX_HANDLERS];
+    command_target_stats_t target_stats[CONFIG_COMMANDS_DISPATCHER_MAX_HANDLERS];
+    uint64_t target_wait_sum_us[CONFIG_COMMANDS_DISPATCHER_MAX_HANDLERS];
+    uint64_t target_handler_sum_us[CONFIG_COMMANDS_DISPATCHER_MAX_HANDLERS];
+
+    portMUX_TYPE coalesce_lock;
+    command_coalesce_entry_t coalesce_entries[CONFIG_COMMANDS_DISPATCHER_COALESCE_SLOTS];
+
+    /* Bumped (under coalesce_lock) by every safety command; a supersedable normal
+     * or bulk command dispatched under an older generation of its target is cancelled */
+    volatile uint32_t target_generation[CONFIG_COMMANDS_DISPATCHER_MAX_HANDLERS];
+
+    portMUX_TYPE future_lock;
+    command_future_t futures[CONFIG_COMMANDS_DISPATCHER_MAX_FUTURES];
+
+    command_slab_t slabs[COMMAND_SLAB_CLASS_COUNT];
+    command_small_slot_t small_slots[CONFIG_COMMANDS_DISPATCHER_SMALL_SLOTS];
+    command_large_slot_t large_slots[CONFIG_COMMANDS_DISPATCHER_LARGE_SLOTS];
+    command_small_slot_t critical_small_slots[CONFIG_COMMANDS_DISPATCHER_CRITICAL_QUEUE_SIZE];
+    command_large_slot_t critical_large_slots[CONFIG_COMMANDS_DISPATCHER_CRITICAL_LARGE_SLOTS];
 } commands_dispatcher_ctx_t;
 
 extern commands_dispatcher_ctx_t* commands_dispatcher_ctx;
 
+static inline command_worker_t* worker_for(commands_dispatcher_ctx_t* ctx, const command_target_t target)
+{
+#if CONFIG_COMMANDS_DISPATCHER_PER_TARGET_WORKERS
+    return &ctx->workers[target];
+#else
+    (void)target;
+    return &ctx->workers[0];
+#endif
+}
+
 // ----------------------------
 // Task management
 // ----------------------------
+/**
+ * @brief Register with the health monitor, and start the shared worker unless targets get their own.
+ */
 esp_err_t init_task(commands_dispatcher_ctx_t* ctx);
+/**
+ * @brief Create the lanes and task of the worker serving @p target, if not running yet.
+ */
+esp_err_t start_command_worker(commands_dispatcher_ctx_t* ctx, command_target_t target);
+/**
+ * @brief Stop every worker and delete its lanes.
+ */
 esp_err_t shutdown_task(commands_dispatcher_ctx_t* ctx);
 
+// ----------------------------
+// Payload slab
+// ----------------------------
+esp_err_t init_command_slabs(commands_dispatcher_ctx_t* ctx);
+void shutdown_command_slabs(commands_dispatcher_ctx_t* ctx);
+/**
+ * @brief Copy a command's payload into a free slot of the smallest class that fits.
+ *
+ * Blocks while that class is exhausted, except for the critical lane, which
+ * tries its reserved slots and then the shared ones without waiting
+ * (ESP_ERR_NO_MEM).  ESP_ERR_INVALID_SIZE if no class fits.
+ */
+esp_err_t command_slab_alloc(commands_dispatcher_ctx_t* ctx, const command_t* command, command_lane_t lane,
+                             queued_command_t* queued);
+void command_slab_release(const commands_dispatcher_ctx_t* ctx, const queued_command_t* queued);
+
+// ----------------------------
+// Coalescing
+// ----------------------------
+void init_command_coalescing(commands_dispatcher_ctx_t* ctx);
+/**
+ * @brief Fold a latest-value command into the waiting one with the same target and key.
+ *
+ * Returns true when @p command was absorbed.  Otherwise, if it claimed a new
+ * entry, @p marker is set and the caller queues the marker instead of the
+ * command (and hands it back with command_coalesce_cancel() if that fails).
+ */
+bool command_coalesce(commands_dispatcher_ctx_t* ctx, const command_t* command, command_lane_t lane,
+                      command_coalesce_entry_t** marker);
+void command_coalesce_cancel(commands_dispatcher_ctx_t* ctx, command_coalesce_entry_t* entry);
+/**
+ * @brief A safety command supersedes the output commands already waiting for @p target.
+ *
+ * Drops the target's latest-value entries and starts a new target generation,
+ * so its queued supersedable normal and bulk commands are cancelled instead of
+ * running after the safety one.
+ */
+void command_supersede_target(commands_dispatcher_ctx_t* ctx, command_target_t target);
+/**
+ * @brief Copy out the newest payload of a marker; false if it was dropped meanwhile.
+ */
+bool command_coalesce_take(commands_dispatcher_ctx_t* ctx, command_coalesce_entry_t* entry,
+                           command_small_slot_t* payload, size_t* payload_size);
+
+// ----------------------------
+// Futures
+// ----------------------------
+esp_err_t init_command_futures(commands_dispatcher_ctx_t* ctx);
+void shutdown_command_futures(commands_dispatcher_ctx_t* ctx);
+command_future_t* command_future_alloc(commands_dispatcher_ctx_t* ctx, void* reply, size_t reply_size);
+void command_future_release(commands_dispatcher_ctx_t* ctx, command_future_t* future);
+/**
+ * @brief Hand the handler's result to the requester, or free an abandoned future.
+ */
+void command_future_complete(commands_dispatcher_ctx_t* ctx, command_future_t* future, esp_err_t result,
+                             size_t reply_size);
+/**
+ * @brief Queue a command, with or without a future, into its lane.
+ */
+esp_err_t enqueue_command(commands_dispatcher_ctx_t* ctx, command_t* command, command_future_t* future);
+
 // ----------------------------
 // Command Handlers
 // ----------------------------
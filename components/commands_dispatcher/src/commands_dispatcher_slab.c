@@ -0,0 +1,176 @@
+/**
+ * @file commands_dispatcher_slab.c
+ * @brief Fixed slots that hold command payloads between dispatch and handler.
+ *
+ * Dispatch copies the caller's payload into a slot so the queue never holds
+ * a pointer into the caller's stack.  Two classes: small slots for heater
+ * commands, large slots for coordinator_command_data_t.  Each class keeps
+ * its free slots in a FreeRTOS queue of pointers, so allocation is a queue
+ * receive — no malloc after init, and a dispatcher that runs out simply
+ * waits for the handler to return a slot.
+ *
+ * The critical lane has its own small and large slots and never waits:
+ * when those and the shared slots are all taken the dispatch fails.
+ */
+
+#include <string.h>
+#include "commands_dispatcher_internal.h"
+#include "logger_component.h"
+#include "sdkconfig.h"
+
+static const char* TAG = "COMMANDS_DISPATCHER_SLAB";
+
+static const char* const slab_names[COMMAND_SLAB_CLASS_COUNT] = {"small", "large", "critical small",
+                                                                  "critical large"};
+
+/* =========================================================================
+ *  Helpers
+ * ========================================================================= */
+static esp_err_t init_slab(command_slab_t* slab, uint8_t* storage, const size_t slot_size, const uint16_t slot_count)
+{
+    if (slab->free_slots == NULL)
+    {
+        slab->free_slots = xQueueCreate(slot_count, sizeof(void*));
+        if (slab->free_slots == NULL)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    xQueueReset(slab->free_slots);
+    for (uint16_t i = 0; i < slot_count; i++)
+    {
+        void* slot = storage + (size_t)i * slot_size;
+        xQueueSend(slab->free_slots, &slot, 0);
+    }
+    slab->slot_size = slot_size;
+    slab->slot_count = slot_count;
+    return ESP_OK;
+}
+
+/* Shared class that fits; its reserved critical twin is COMMAND_SLAB_CRITICAL_SMALL further on */
+static command_slab_class_t class_for_size(const commands_dispatcher_ctx_t* ctx, const size_t size)
+{
+    for (command_slab_class_t slab_class = COMMAND_SLAB_SMALL; slab_class <= COMMAND_SLAB_LARGE; slab_class++)
+    {
+        if (size <= ctx->slabs[slab_class].slot_size)
+        {
+            return slab_class;
+        }
+    }
+    return COMMAND_SLAB_CLASS_COUNT;
+}
+
+static bool try_take(const commands_dispatcher_ctx_t* ctx, const command_slab_class_t slab_class, void** slot)
+{
+    return xQueueReceive(ctx->slabs[slab_class].free_slots, slot, 0) == pdTRUE;
+}
+
+/* =========================================================================
+ *  Internal API
+ * ========================================================================= */
+esp_err_t init_command_slabs(commands_dispatcher_ctx_t* ctx)
+{
+    esp_err_t err = init_slab(&ctx->slabs[COMMAND_SLAB_SMALL], (uint8_t*)ctx->small_slots,
+                              sizeof(command_small_slot_t), CONFIG_COMMANDS_DISPATCHER_SMALL_SLOTS);
+    if (err == ESP_OK)
+    {
+        err = init_slab(&ctx->slabs[COMMAND_SLAB_LARGE], (uint8_t*)ctx->large_slots,
+                        sizeof(command_large_slot_t), CONFIG_COMMANDS_DISPATCHER_LARGE_SLOTS);
+    }
+    if (err == ESP_OK)
+    {
+        err = init_slab(&ctx->slabs[COMMAND_SLAB_CRITICAL_SMALL], (uint8_t*)ctx->critical_small_slots,
+                        sizeof(command_small_slot_t), CONFIG_COMMANDS_DISPATCHER_CRITICAL_QUEUE_SIZE);
+    }
+    if (err == ESP_OK)
+    {
+        err = init_slab(&ctx->slabs[COMMAND_SLAB_CRITICAL_LARGE], (uint8_t*)ctx->critical_large_slots,
+                        sizeof(command_large_slot_t), CONFIG_COMMANDS_DISPATCHER_CRITICAL_LARGE_SLOTS);
+    }
+    if (err != ESP_OK)
+    {
+        LOGGER_LOG_ERROR(TAG, "Failed to create command payload slabs");
+        return err;
+    }
+
+    LOGGER_LOG_INFO(TAG, "Command payload slabs: %d+%d x %d bytes, %d+%d x %d bytes (shared+critical)",
+                    CONFIG_COMMANDS_DISPATCHER_SMALL_SLOTS, CONFIG_COMMANDS_DISPATCHER_CRITICAL_QUEUE_SIZE,
+                    (int)sizeof(command_small_slot_t), CONFIG_COMMANDS_DISPATCHER_LARGE_SLOTS,
+                    CONFIG_COMMANDS_DISPATCHER_CRITICAL_LARGE_SLOTS, (int)sizeof(command_large_slot_t));
+    return ESP_OK;
+}
+
+void shutdown_command_slabs(commands_dispatcher_ctx_t* ctx)
+{
+    for (command_slab_class_t slab_class = COMMAND_SLAB_SMALL; slab_class < COMMAND_SLAB_CLASS_COUNT; slab_class++)
+    {
+        if (ctx->slabs[slab_class].free_slots != NULL)
+        {
+            vQueueDelete(ctx->slabs[slab_class].free_slots);
+            ctx->slabs[slab_class].free_slots = NULL;
+        }
+    }
+}
+
+esp_err_t command_slab_alloc(commands_dispatcher_ctx_t* ctx, const command_t* command, const command_lane_t lane,
+                             queued_command_t* queued)
+{
+    *queued = (queued_command_t){
+        .target = command->target,
+        .payload = NULL,
+        .payload_size = command->data_size,
+        .slab_class = COMMAND_SLAB_NONE,
+        .lane = lane,
+    };
+
+    if (command->data == NULL || command->data_size == 0)
+    {
+        queued->payload_size = 0;
+        return ESP_OK;
+    }
+
+    command_slab_class_t slab_class = class_for_size(ctx, command->data_size);
+    if (slab_class == COMMAND_SLAB_CLASS_COUNT)
+    {
+        LOGGER_LOG_ERROR(TAG, "Command payload of %d bytes for target %d exceeds the largest slot",
+                         (int)command->data_size, command->target);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    void* slot = NULL;
+    if (lane == COMMAND_LANE_CRITICAL)
+    {
+        const command_slab_class_t reserved = slab_class + COMMAND_SLAB_CRITICAL_SMALL;
+        if (try_take(ctx, reserved, &slot))
+        {
+            slab_class = reserved;
+        }
+        else if (!try_take(ctx, slab_class, &slot))
+        {
+            LOGGER_LOG_ERROR(TAG, "No %s command slot free for a critical command to target %d",
+                             slab_names[reserved], command->target);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    else if (!try_take(ctx, slab_class, &slot))
+    {
+        const command_slab_t* slab = &ctx->slabs[slab_class];
+        LOGGER_LOG_WARN(TAG, "All %d %s command slots in use, waiting", slab->slot_count, slab_names[slab_class]);
+        xQueueReceive(slab->free_slots, &slot, portMAX_DELAY);
+    }
+
+    memcpy(slot, command->data, command->data_size);
+    queued->payload = slot;
+    queued->slab_class = slab_class;
+    return ESP_OK;
+}
+
+void command_slab_release(const commands_dispatcher_ctx_t* ctx, const queued_command_t* queued)
+{
+    if (queued->slab_class >= COMMAND_SLAB_CLASS_COUNT || queued->payload == NULL)
+    {
+        return;
+    }
+    xQueueSend(ctx->slabs[queued->slab_class].free_slots, &queued->payload, 0);
+}
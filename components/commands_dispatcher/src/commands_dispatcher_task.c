@@ -1,5 +1,7 @@
+#include <stdio.h>
 #include "commands_dispatcher_internal.h"
 #include "core_types.h"
+#include "esp_timer.h"
 #include "logger_component.h"
 #include "sdkconfig.h"
 #include "utils.h"
@@ -23,78 +25,315 @@ static const task_config_t commands_dispatcher_task_config = {
 };
 
 
+static const UBaseType_t lane_queue_sizes[COMMAND_LANE_COUNT] = {
+    [COMMAND_LANE_NORMAL] = CONFIG_COMMANDS_DISPATCHER_QUEUE_SIZE,
+    [COMMAND_LANE_CRITICAL] = CONFIG_COMMANDS_DISPATCHER_CRITICAL_QUEUE_SIZE,
+    [COMMAND_LANE_BULK] = CONFIG_COMMANDS_DISPATCHER_BULK_QUEUE_SIZE,
+};
+
+/* Drain order: safety first, bulk only when nothing else waits */
+static const command_lane_t lane_order[COMMAND_LANE_COUNT] = {
+    COMMAND_LANE_CRITICAL,
+    COMMAND_LANE_NORMAL,
+    COMMAND_LANE_BULK,
+};
+
+#if CONFIG_COMMANDS_DISPATCHER_STATS_REPORT_MS > 0
+static const char* const lane_names[COMMAND_LANE_COUNT] = {
+    [COMMAND_LANE_NORMAL] = "normal",
+    [COMMAND_LANE_CRITICAL] = "critical",
+    [COMMAND_LANE_BULK] = "bulk",
+};
+#endif
+
+static bool next_command(const command_worker_t* worker, queued_command_t* command)
+{
+    for (int i = 0; i < COMMAND_LANE_COUNT; i++)
+    {
+        if (xQueueReceive(worker->lanes[lane_order[i]], command, 0) == pdTRUE)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void update_average(uint32_t* max_us, uint32_t* avg_us, uint64_t* sum_us, const uint32_t count,
+                           const uint32_t sample_us)
+{
+    *sum_us += sample_us;
+    *avg_us = (uint32_t)(*sum_us / count);
+    if (sample_us > *max_us)
+    {
+        *max_us = sample_us;
+    }
+}
+
+static void record_wait(command_worker_t* worker, const queued_command_t* command, const int64_t start_us)
+{
+    command_lane_stats_t* stats = &worker->lane_stats[command->lane];
+    const uint32_t wait_us = (uint32_t)(start_us - command->enqueued_us);
+
+    stats->dispatched++;
+    update_average(&stats->wait_max_us, &stats->wait_avg_us, &worker->lane_wait_sum_us[command->lane],
+                   stats->dispatched, wait_us);
+}
+
+/* Each target is served by exactly one worker, so its stats have a single writer */
+static void record_target(commands_dispatcher_ctx_t* ctx, const queued_command_t* command, const int64_t start_us,
+                          const int64_t end_us)
+{
+    command_target_stats_t* stats = &ctx->target_stats[command->target];
+
+    stats->handled++;
+    update_average(&stats->wait_max_us, &stats->wait_avg_us, &ctx->target_wait_sum_us[command->target],
+                   stats->handled, (uint32_t)(start_us - command->enqueued_us));
+    update_average(&stats->handler_max_us, &stats->handler_avg_us, &ctx->target_handler_sum_us[command->target],
+                   stats->handled, (uint32_t)(end_us - start_us));
+}
+
+/* An output command queued before a safety command to the same target; dropped unrun */
+static bool is_superseded(const commands_dispatcher_ctx_t* ctx, const queued_command_t* command)
+{
+    return command->supersedable && command->lane != COMMAND_LANE_CRITICAL &&
+        command->generation != ctx->target_generation[command->target];
+}
+
+static void run_command(command_worker_t* worker, queued_command_t* command)
+{
+    commands_dispatcher_ctx_t* ctx = worker->owner;
+    LOGGER_LOG_DEBUG(TAG, "Received command for target: %d, lane %d", command->target, command->lane);
+
+    if (is_superseded(ctx, command))
+    {
+        LOGGER_LOG_INFO(TAG, "Command to target %d in lane %d cancelled by a safety command",
+                        command->target, command->lane);
+        worker->lane_stats[command->lane].cancelled++;
+        command_slab_release(ctx, command);
+        if (command->future != NULL)
+        {
+            command_future_complete(ctx, command->future, ESP_ERR_INVALID_STATE, 0);
+        }
+        return;
+    }
+
+    /* A latest-value marker carries whatever payload is newest now */
+    command_small_slot_t coalesced_payload;
+    if (command->coalesced != NULL)
+    {
+        if (!command_coalesce_take(ctx, command->coalesced, &coalesced_payload, &command->payload_size))
+        {
+            LOGGER_LOG_DEBUG(TAG, "Coalesced command to target %d was superseded", command->target);
+            return;
+        }
+        command->payload = &coalesced_payload;
+    }
+    const int64_t start_us = esp_timer_get_time();
+    record_wait(worker, command, start_us);
+
+    command_reply_t reply = {0};
+    if (command->future != NULL)
+    {
+        reply = (command_reply_t){
+            .data = command->future->scratch,
+            .capacity = sizeof(command->future->scratch),
+        };
+    }
+
+    // Dispatch command to the appropriate handler; enqueue_command() has checked the target
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    const handler_entry_t* handler_entry = &ctx->command_handlers[command->target];
+    if (handler_entry->registered && handler_entry->handler != NULL)
+    {
+        err = handler_entry->handler(
+            handler_entry->handler_arg,
+            command->payload,
+            command->payload_size,
+            command->future != NULL ? &reply : NULL);
+        if (err != ESP_OK)
+        {
+            LOGGER_LOG_ERROR(TAG, "Command handler for target %d failed with error: %d",
+                             command->target, err);
+        }
+        record_target(ctx, command, start_us, esp_timer_get_time());
+    }
+    else
+    {
+        LOGGER_LOG_WARN(TAG, "No registered handler for command target: %d", command->target);
+    }
+
+    command_slab_release(ctx, command);
+    if (command->future != NULL)
+    {
+        command_future_complete(ctx, command->future, err, reply.size);
+    }
+}
+
+/*
+ * The component shares one health registration, so a heartbeat stands for
+ * every worker: it is only posted while each started worker has been
+ * through its loop within the timeout.  A worker stuck in a handler thus
+ * stops the heartbeats even though its siblings keep running.
+ */
+static bool all_workers_alive(const commands_dispatcher_ctx_t* ctx, const TickType_t now)
+{
+    for (int i = 0; i < COMMAND_WORKER_COUNT; i++)
+    {
+        const command_worker_t* worker = &ctx->workers[i];
+        if (worker->task_handle != NULL &&
+            now - worker->last_tick > pdMS_TO_TICKS(CONFIG_COMMANDS_DISPATCHER_HEARTBEAT_TIMEOUT_MS))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+#if CONFIG_COMMANDS_DISPATCHER_STATS_REPORT_MS > 0
+/* Claims the report for this interval; true for exactly one worker */
+static bool report_due(commands_dispatcher_ctx_t* ctx)
+{
+    const int64_t now_us = esp_timer_get_time();
+    bool due = false;
+
+    taskENTER_CRITICAL(&ctx->report_lock);
+    if (now_us - ctx->last_report_us >= (int64_t)CONFIG_COMMANDS_DISPATCHER_STATS_REPORT_MS * 1000)
+    {
+        ctx->last_report_us = now_us;
+        due = true;
+    }
+    taskEXIT_CRITICAL(&ctx->report_lock);
+
+    return due;
+}
+
+static void report_stats(void)
+{
+    for (command_lane_t lane = 0; lane < COMMAND_LANE_COUNT; lane++)
+    {
+        command_lane_stats_t stats;
+        commands_dispatcher_get_lane_stats(lane, &stats);
+        LOGGER_LOG_INFO(TAG, "Lane %s: %lu dispatched, %lu coalesced, %lu cancelled, %lu rejected, %lu waiting, "
+                        "wait avg/max %lu/%lu us",
+                        lane_names[lane], (unsigned long)stats.dispatched, (unsigned long)stats.coalesced,
+                        (unsigned long)stats.cancelled, (unsigned long)stats.rejected, (unsigned long)stats.depth,
+                        (unsigned long)stats.wait_avg_us, (unsigned long)stats.wait_max_us);
+    }
+    for (command_target_t target = 0; target < CONFIG_COMMANDS_DISPATCHER_MAX_HANDLERS; target++)
+    {
+        command_target_stats_t stats;
+        commands_dispatcher_get_target_stats(target, &stats);
+        if (stats.handled > 0)
+        {
+            LOGGER_LOG_INFO(TAG, "Target %d: %lu handled, wait avg/max %lu/%lu us, handler avg/max %lu/%lu us",
+                            target, (unsigned long)stats.handled,
+                            (unsigned long)stats.wait_avg_us, (unsigned long)stats.wait_max_us,
+                            (unsigned long)stats.handler_avg_us, (unsigned long)stats.handler_max_us);
+        }
+    }
+}
+#endif
+
 static void commands_dispatcher_task(void* args)
 {
-    LOGGER_LOG_INFO(TAG, "Commands Dispatcher task started");
+    command_worker_t* worker = (command_worker_t*)args;
+    commands_dispatcher_ctx_t* ctx = worker->owner;
+    queued_command_t received_command;
 
-    const commands_dispatcher_ctx_t* ctx = (commands_dispatcher_ctx_t*)args;
-    command_t received_command;
+    LOGGER_LOG_INFO(TAG, "Commands Dispatcher worker %d started", worker->index);
 
     while (ctx->dispatcher_running)
     {
         // Wait for a command with a finite timeout so we can send heartbeats
         // Note: if the command handlers can take a long time to execute, we may want to move the heartbeat posting inside the handler execution
         // loop or use a separate timer to ensure timely heartbeats.
-        // The only behavioral difference is that instead of sleeping indefinitely, the task wakes up every 2 seconds to say "I'm alive" 
-        // and then goes back to waiting.
-        if (xQueueReceive(ctx->command_queue, &received_command, pdMS_TO_TICKS(2000)) == pdTRUE)
+        // Every dispatch notifies the task; the lanes are then drained highest first, rescanning after each
+        // command so a stop queued behind a burst of power updates runs next.
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(2000));
+        while (ctx->dispatcher_running && next_command(worker, &received_command))
         {
-            LOGGER_LOG_DEBUG(TAG, "Received command for target: %d", received_command.target);
+            run_command(worker, &received_command);
+        }
 
-            // Dispatch command to the appropriate handler
-            if (received_command.target < CONFIG_COMMANDS_DISPATCHER_MAX_HANDLERS)
-            {
-                const handler_entry_t* handler_entry = &ctx->command_handlers[received_command.target];
-                if (handler_entry->registered && handler_entry->handler != NULL)
-                {
-                    const esp_err_t err = handler_entry->handler(
-                        handler_entry->handler_arg,
-                        received_command.data,
-                        received_command.data_size);
-                    if (err != ESP_OK)
-                    {
-                        LOGGER_LOG_ERROR(TAG, "Command handler for target %d failed with error: %d",
-                                         received_command.target, err);
-                    }
-                }
-                else
-                {
-                    LOGGER_LOG_WARN(TAG, "No registered handler for command target: %d", received_command.target);
-                }
-            }
-            else
-            {
-                LOGGER_LOG_ERROR(TAG, "Invalid command target: %d", received_command.target);
-            }
+        const TickType_t now = xTaskGetTickCount();
+        worker->last_tick = now;
+        if (all_workers_alive(ctx, now))
+        {
+            event_manager_post_health(HEALTH_MONITOR_EVENT_HEARTBEAT, &dispatcher_health_data);
         }
 
-        event_manager_post_health(HEALTH_MONITOR_EVENT_HEARTBEAT, &dispatcher_health_data);
+#if CONFIG_COMMANDS_DISPATCHER_STATS_REPORT_MS > 0
+        /* Whichever worker wakes first after the interval reports for all */
+        if (report_due(ctx))
+        {
+            report_stats();
+        }
+#endif
     }
 
-    LOGGER_LOG_INFO(TAG, "Commands Dispatcher task stopping");
+    LOGGER_LOG_INFO(TAG, "Commands Dispatcher worker %d stopping", worker->index);
+    worker->task_handle = NULL;
     vTaskDelete(NULL);
 }
 
-esp_err_t init_task(commands_dispatcher_ctx_t* ctx)
+esp_err_t start_command_worker(commands_dispatcher_ctx_t* ctx, const command_target_t target)
 {
-    if (ctx->dispatcher_task_handle)
+    command_worker_t* worker = worker_for(ctx, target);
+    if (worker->task_handle != NULL)
     {
         return ESP_OK;
     }
 
+    worker->index = (uint8_t)(worker - ctx->workers);
+    worker->owner = ctx;
+    worker->last_tick = xTaskGetTickCount();
+    for (command_lane_t lane = 0; lane < COMMAND_LANE_COUNT; lane++)
+    {
+        if (worker->lanes[lane] == NULL)
+        {
+            worker->lanes[lane] = xQueueCreate(lane_queue_sizes[lane], sizeof(queued_command_t));
+            if (worker->lanes[lane] == NULL)
+            {
+                LOGGER_LOG_ERROR(TAG, "Failed to create lane %d of commands dispatcher worker %d", lane,
+                                 worker->index);
+                return ESP_ERR_NO_MEM;
+            }
+        }
+    }
+
+#if CONFIG_COMMANDS_DISPATCHER_PER_TARGET_WORKERS
+    char task_name[configMAX_TASK_NAME_LEN];
+    snprintf(task_name, sizeof(task_name), "cmd_target_%d", target);
+#else
+    const char* task_name = commands_dispatcher_task_config.task_name;
+#endif
+
     CHECK_ERR_LOG_CALL_RET(xTaskCreate(
                                commands_dispatcher_task,
-                               commands_dispatcher_task_config.task_name,
+                               task_name,
                                commands_dispatcher_task_config.stack_size,
-                               ctx,
+                               worker,
                                commands_dispatcher_task_config.task_priority,
-                               &ctx->dispatcher_task_handle) == pdPASS
+                               &worker->task_handle) == pdPASS
                            ? ESP_OK
                            : ESP_FAIL,
-                           ctx->dispatcher_task_handle = NULL,
+                           worker->task_handle = NULL,
                            "Failed to create Commands Dispatcher task");
 
-    LOGGER_LOG_INFO(TAG, "Commands Dispatcher task initialized");
+    LOGGER_LOG_INFO(TAG, "Commands Dispatcher worker %d initialized", worker->index);
+    return ESP_OK;
+}
+
+esp_err_t init_task(commands_dispatcher_ctx_t* ctx)
+{
+    ctx->report_lock = (portMUX_TYPE)portMUX_INITIALIZER_UNLOCKED;
+    ctx->last_report_us = esp_timer_get_time();
+
+#if !CONFIG_COMMANDS_DISPATCHER_PER_TARGET_WORKERS
+    /* Per-target workers start when their handler registers */
+    CHECK_ERR_LOG_RET(start_command_worker(ctx, COMMAND_TARGET_HEATER),
+                      "Failed to start Commands Dispatcher worker");
+#endif
 
     event_manager_post_health(HEALTH_MONITOR_EVENT_REGISTER, &dispatcher_health_data);
 
@@ -103,24 +342,39 @@ esp_err_t init_task(commands_dispatcher_ctx_t* ctx)
 
 esp_err_t shutdown_task(commands_dispatcher_ctx_t* ctx)
 {
-    if (ctx->dispatcher_task_handle == NULL)
+    ctx->dispatcher_running = false;
+    for (int i = 0; i < COMMAND_WORKER_COUNT; i++)
     {
-        return ESP_OK;
+        if (ctx->workers[i].task_handle != NULL)
+        {
+            xTaskNotifyGive(ctx->workers[i].task_handle);
+        }
     }
 
-    ctx->dispatcher_running = false;
-
-    // Wait for the task to exit
+    // Wait for the workers to exit
     const TickType_t wait_ticks = pdMS_TO_TICKS(1000);
     const TickType_t start_tick = xTaskGetTickCount();
-    while (ctx->dispatcher_task_handle != NULL)
+    for (int i = 0; i < COMMAND_WORKER_COUNT; i++)
     {
-        if ((xTaskGetTickCount() - start_tick) > wait_ticks)
+        command_worker_t* worker = &ctx->workers[i];
+        while (worker->task_handle != NULL)
         {
-            LOGGER_LOG_ERROR(TAG, "Timeout waiting for Commands Dispatcher task to stop");
-            return ESP_ERR_TIMEOUT;
+            if ((xTaskGetTickCount() - start_tick) > wait_ticks)
+            {
+                LOGGER_LOG_ERROR(TAG, "Timeout waiting for Commands Dispatcher worker %d to stop", i);
+                return ESP_ERR_TIMEOUT;
+            }
+            vTaskDelay(pdMS_TO_TICKS(100));
+        }
+
+        for (command_lane_t lane = 0; lane < COMMAND_LANE_COUNT; lane++)
+        {
+            if (worker->lanes[lane] != NULL)
+            {
+                vQueueDelete(worker->lanes[lane]);
+                worker->lanes[lane] = NULL;
+            }
         }
-        vTaskDelay(pdMS_TO_TICKS(100));
     }
 
     LOGGER_LOG_INFO(TAG, "Commands Dispatcher task shutdown complete");
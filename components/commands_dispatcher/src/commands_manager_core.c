@@ -1,4 +1,5 @@
 #include "commands_dispatcher_internal.h"
+#include "esp_timer.h"
 #include "logger_component.h"
 #include "sdkconfig.h"
 
@@ -6,6 +7,48 @@ static const char* TAG = "COMMANDS_DISPATCHER";
 
 commands_dispatcher_ctx_t* commands_dispatcher_ctx = NULL;
 
+/**
+ * @brief Heater clear/off and profile stop: always critical, and they cancel
+ * the target's waiting commands.  A zero SET_POWER is an ordinary PID tick.
+ */
+static bool is_safety_command(const command_t* command)
+{
+    if (command->target == COMMAND_TARGET_HEATER && command->data_size == sizeof(heater_command_data_t))
+    {
+        const heater_command_data_t* heater = command->data;
+        return heater->type == COMMAND_TYPE_HEATER_CLEAR ||
+            (heater->type == COMMAND_TYPE_HEATER_TOGGLE && !heater->heater_state);
+    }
+    if (command->target == COMMAND_TARGET_COORDINATOR && command->data_size == sizeof(coordinator_command_data_t))
+    {
+        const coordinator_command_data_t* coordinator = command->data;
+        return coordinator->type == COMMAND_TYPE_COORDINATOR_STOP_PROFILE;
+    }
+    return false;
+}
+
+/**
+ * @brief Whether a later safety command cancels @p command while it waits.
+ *
+ * Only commands that change the output; status requests are always answered.
+ */
+static bool is_supersedable(const command_t* command)
+{
+    if (command->target == COMMAND_TARGET_HEATER && command->data_size == sizeof(heater_command_data_t))
+    {
+        const heater_command_data_t* heater = command->data;
+        return heater->type == COMMAND_TYPE_HEATER_SET_POWER || heater->type == COMMAND_TYPE_HEATER_TOGGLE ||
+            heater->type == COMMAND_TYPE_HEATER_CLEAR;
+    }
+    if (command->target == COMMAND_TARGET_COORDINATOR && command->data_size == sizeof(coordinator_command_data_t))
+    {
+        const coordinator_command_data_t* coordinator = command->data;
+        return coordinator->type != COMMAND_TYPE_COORDINATOR_GET_STATUS_REPORT &&
+            coordinator->type != COMMAND_TYPE_COORDINATOR_GET_CURRENT_PROFILE;
+    }
+    return false;
+}
+
 esp_err_t commands_dispatcher_init(void)
 {
     // Initialize any resources needed for command dispatching
@@ -27,17 +70,17 @@ esp_err_t commands_dispatcher_init(void)
         }
     }
 
-    if (commands_dispatcher_ctx->command_queue == NULL)
+    init_command_coalescing(commands_dispatcher_ctx);
+    err = init_command_futures(commands_dispatcher_ctx);
+    if (err != ESP_OK)
     {
-        commands_dispatcher_ctx->command_queue = xQueueCreate(
-            CONFIG_COMMANDS_DISPATCHER_QUEUE_SIZE,
-            sizeof(command_t));
-        if (commands_dispatcher_ctx->command_queue == NULL)
-        {
-            LOGGER_LOG_ERROR(TAG, "Failed to create commands dispatcher command queue");
-            err = ESP_FAIL;
-            goto fail;
-        }
+        goto fail;
+    }
+
+    err = init_command_slabs(commands_dispatcher_ctx);
+    if (err != ESP_OK)
+    {
+        goto fail;
     }
 
     err = init_command_handlers(commands_dispatcher_ctx);
@@ -62,6 +105,84 @@ fail:
     return err;
 }
 
+esp_err_t enqueue_command(commands_dispatcher_ctx_t* ctx, command_t* command, command_future_t* future)
+{
+    if (command == NULL || command->lane >= COMMAND_LANE_COUNT ||
+        command->target >= CONFIG_COMMANDS_DISPATCHER_MAX_HANDLERS)
+    {
+        LOGGER_LOG_ERROR(TAG, "Invalid command argument");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /* Straight into the lanes of the worker that serves the target */
+    command_worker_t* worker = worker_for(ctx, command->target);
+    if (worker->task_handle == NULL)
+    {
+        LOGGER_LOG_WARN(TAG, "No worker for command target %d, is its handler registered?", command->target);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const bool safety = is_safety_command(command);
+    const command_lane_t lane = safety ? COMMAND_LANE_CRITICAL : command->lane;
+    queued_command_t queued;
+    command_coalesce_entry_t* marker = NULL;
+
+    if (safety)
+    {
+        /* A stop must not be followed by a start that was queued before it */
+        command_supersede_target(ctx, command->target);
+    }
+    else if (lane != COMMAND_LANE_CRITICAL && command->coalesce_key != COMMAND_COALESCE_NONE && future == NULL && command->data != NULL)
+    {
+        if (command_coalesce(ctx, command, lane, &marker))
+        {
+            LOGGER_LOG_DEBUG(TAG, "Coalesced command to target %d, key %d", command->target, command->coalesce_key);
+            return ESP_OK;
+        }
+    }
+
+    if (marker != NULL)
+    {
+        queued = (queued_command_t){
+            .target = command->target,
+            .slab_class = COMMAND_SLAB_NONE,
+            .lane = lane,
+            .coalesced = marker,
+        };
+    }
+    else
+    {
+        const esp_err_t err = command_slab_alloc(ctx, command, lane, &queued);
+        if (err != ESP_OK)
+        {
+            worker->lane_stats[lane].rejected++;
+            return err;
+        }
+        queued.future = future;
+        queued.coalesced = NULL;
+    }
+
+    /* The critical lane must never stall its caller, e.g. a stop from the HMI */
+    queued.enqueued_us = esp_timer_get_time();
+    queued.generation = ctx->target_generation[command->target];
+    queued.supersedable = marker != NULL || is_supersedable(command);
+    if (xQueueSend(worker->lanes[lane], &queued, lane == COMMAND_LANE_CRITICAL ? 0 : portMAX_DELAY) != pdPASS)
+    {
+        LOGGER_LOG_ERROR(TAG, "Failed to dispatch command to lane %d, queue full", lane);
+        worker->lane_stats[lane].rejected++;
+        command_slab_release(ctx, &queued);
+        if (marker != NULL)
+        {
+            command_coalesce_cancel(ctx, marker);
+        }
+        return ESP_FAIL;
+    }
+    xTaskNotifyGive(worker->task_handle);
+
+    LOGGER_LOG_DEBUG(TAG, "Dispatched command to target %d, lane %d", command->target, lane);
+    return ESP_OK;
+}
+
 esp_err_t commands_dispatcher_dispatch_command(command_t* command)
 {
     if (commands_dispatcher_ctx == NULL || !commands_dispatcher_ctx->dispatcher_running)
@@ -70,19 +191,49 @@ esp_err_t commands_dispatcher_dispatch_command(command_t* command)
         return ESP_ERR_INVALID_STATE;
     }
 
-    if (command == NULL)
+    return enqueue_command(commands_dispatcher_ctx, command, NULL);
+}
+
+esp_err_t commands_dispatcher_get_lane_stats(const command_lane_t lane, command_lane_stats_t* stats)
+{
+    if (commands_dispatcher_ctx == NULL || lane >= COMMAND_LANE_COUNT || stats == NULL)
     {
-        LOGGER_LOG_ERROR(TAG, "Invalid command argument");
         return ESP_ERR_INVALID_ARG;
     }
 
-    if (xQueueSend(commands_dispatcher_ctx->command_queue, command, portMAX_DELAY) != pdPASS)
+    /* Sum over the workers; each keeps its own counters so only it writes them */
+    uint64_t wait_sum_us = 0;
+    *stats = (command_lane_stats_t){0};
+    for (int i = 0; i < COMMAND_WORKER_COUNT; i++)
     {
-        LOGGER_LOG_ERROR(TAG, "Failed to dispatch command to queue");
-        return ESP_FAIL;
+        const command_worker_t* worker = &commands_dispatcher_ctx->workers[i];
+        const command_lane_stats_t* lane_stats = &worker->lane_stats[lane];
+        stats->dispatched += lane_stats->dispatched;
+        stats->rejected += lane_stats->rejected;
+        stats->coalesced += lane_stats->coalesced;
+        stats->cancelled += lane_stats->cancelled;
+        if (lane_stats->wait_max_us > stats->wait_max_us)
+        {
+            stats->wait_max_us = lane_stats->wait_max_us;
+        }
+        wait_sum_us += worker->lane_wait_sum_us[lane];
+        if (worker->lanes[lane] != NULL)
+        {
+            stats->depth += (uint32_t)uxQueueMessagesWaiting(worker->lanes[lane]);
+        }
     }
+    stats->wait_avg_us = stats->dispatched > 0 ? (uint32_t)(wait_sum_us / stats->dispatched) : 0;
+    return ESP_OK;
+}
 
-    LOGGER_LOG_DEBUG(TAG, "Dispatched command to target %d", command->target);
+esp_err_t commands_dispatcher_get_target_stats(const command_target_t target, command_target_stats_t* stats)
+{
+    if (commands_dispatcher_ctx == NULL || target >= CONFIG_COMMANDS_DISPATCHER_MAX_HANDLERS || stats == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    *stats = commands_dispatcher_ctx->target_stats[target];
     return ESP_OK;
 }
 
@@ -95,13 +246,10 @@ esp_err_t commands_dispatcher_shutdown(void)
 
     esp_err_t err = ESP_OK;
 
-    if (commands_dispatcher_ctx->dispatcher_running)
+    if (shutdown_task(commands_dispatcher_ctx) != ESP_OK)
     {
-        if (shutdown_task(commands_dispatcher_ctx) != ESP_OK)
-        {
-            LOGGER_LOG_ERROR(TAG, "Failed to shutdown dispatcher task");
-            err = ESP_FAIL;
-        }
+        LOGGER_LOG_ERROR(TAG, "Failed to shutdown dispatcher task");
+        err = ESP_FAIL;
     }
 
     if (shutdown_command_handlers(commands_dispatcher_ctx) != ESP_OK)
@@ -110,11 +258,8 @@ esp_err_t commands_dispatcher_shutdown(void)
         err = ESP_FAIL;
     }
 
-    if (commands_dispatcher_ctx->command_queue)
-    {
-        vQueueDelete(commands_dispatcher_ctx->command_queue);
-        commands_dispatcher_ctx->command_queue = NULL;
-    }
+    shutdown_command_slabs(commands_dispatcher_ctx);
+    shutdown_command_futures(commands_dispatcher_ctx);
 
     free(commands_dispatcher_ctx);
     commands_dispatcher_ctx = NULL;
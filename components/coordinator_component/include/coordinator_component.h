@@ -1,8 +1,41 @@
 #pragma once
 
 #include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "coordinator_component_types.h"
+
+/* Upper bounds of the tick period jitter histogram buckets; the last bucket is open-ended */
+#define COORDINATOR_JITTER_BUCKET_LIMITS_US {100, 250, 500, 1000, 2500, 5000, 10000, 25000}
+#define COORDINATOR_JITTER_BUCKETS 9
+
+typedef struct
+{
+    uint32_t ticks;
+    uint32_t missed_ticks;          // Timer fired again before the task took the previous tick
+    uint32_t wake_latency_max_us;   // PID tick timer callback to task wake-up
+    uint32_t wake_latency_avg_us;
+    uint32_t exec_max_us;           // Duration of one control iteration
+    uint32_t exec_avg_us;
+    uint32_t dt_min_us;             // Measured interval between control iterations
+    uint32_t dt_max_us;
+    uint32_t jitter_max_us;         // |dt - CONFIG_COORDINATOR_PID_TICK_INTERVAL_MS|
+    uint32_t jitter_histogram[COORDINATOR_JITTER_BUCKETS];
+} coordinator_loop_timing_t;
 
 esp_err_t init_coordinator(void);
 
 esp_err_t stop_coordinator(void);
 
+/**
+ * @brief Current heating task state, answered by the coordinator's command handler.
+ *
+ * Must not be called from a command handler.  ESP_ERR_TIMEOUT if no reply within @p timeout.
+ */
+esp_err_t coordinator_get_status(heating_task_state_t* state, TickType_t timeout);
+
+/**
+ * @brief Control loop timing of the current (or last) heating run.
+ *
+ * ESP_ERR_INVALID_STATE while the coordinator is not initialized.
+ */
+esp_err_t coordinator_get_loop_timing(coordinator_loop_timing_t* timing);
@@ -12,6 +12,7 @@ typedef struct
     bool is_completed;
     uint32_t current_time_elapsed_ms;
     uint32_t estimated_total_duration_ms;   // Estimated total program duration (stages + cooldown)
+    uint32_t estimated_remaining_ms;        // Predicted time to completion, re-estimated every tick
     uint32_t heating_stages_duration_ms;     // Duration of heating stages only (excl. cooldown)
     bool heating_element_on;
     bool fan_on;
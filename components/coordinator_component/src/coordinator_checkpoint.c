@@ -0,0 +1,387 @@
+/**
+ * @file coordinator_checkpoint.c
+ * @brief Power-loss-safe journal of the running profile.
+ *
+ * A run journals its program once, then appends small resume records to a
+ * ring of CONFIG_COORDINATOR_CHECKPOINT_JOURNAL_SLOTS keys, one slot further
+ * each time.  NVS appends every write to its own log, so a record costs a
+ * few 32-byte entries and the page erases spread over the whole partition;
+ * the ring leaves the previous record intact when a write is cut short.
+ * On boot the newest record with a valid CRC and the journaled program's
+ * hash is the run to resume, paused if it was paused.  The resume itself is
+ * a coordinator command, so a profile start or stop dispatched meanwhile is
+ * ordered with it instead of racing it.
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "coordinator_component_internal.h"
+#include "esp_rom_crc.h"
+#include "logger_component.h"
+#include "nvs.h"
+#include "sdkconfig.h"
+#include "temperature_profile_controller.h"
+#include "utils.h"
+
+static const char* TAG = "COORDINATOR_CHECKPOINT";
+
+#define CHECKPOINT_NAMESPACE   "coord_ckpt"
+#define CHECKPOINT_PROGRAM_KEY "program"
+#define CHECKPOINT_ENABLED     (CONFIG_COORDINATOR_CHECKPOINT_INTERVAL_S > 0)
+#define CHECKPOINT_INTERVAL_MS ((uint32_t)CONFIG_COORDINATOR_CHECKPOINT_INTERVAL_S * 1000U)
+
+/* No stage has this index, so the first tick of a run always writes */
+#define CHECKPOINT_STAGE_NONE (-2)
+
+typedef struct
+{
+    program_draft_t program;
+    int32_t cooldown_rate_x10;
+} checkpoint_program_t;
+
+/* Program of the run being journaled, or the one found on boot.  Kept here
+ * rather than on a task stack: it is several hundred bytes. */
+static checkpoint_program_t s_program;
+
+/* =========================================================================
+ *  Helpers
+ * ========================================================================= */
+#if CHECKPOINT_ENABLED
+static void slot_key(const uint32_t slot, char* key, const size_t key_len)
+{
+    snprintf(key, key_len, "cp%lu", (unsigned long)slot);
+}
+
+static uint32_t program_hash(const checkpoint_program_t* program)
+{
+    return esp_rom_crc32_le(0, (const uint8_t*)program, sizeof(*program));
+}
+
+static uint32_t record_crc(const coordinator_checkpoint_t* record)
+{
+    return esp_rom_crc32_le(0, (const uint8_t*)record, offsetof(coordinator_checkpoint_t, crc));
+}
+
+static esp_err_t write_record(const coordinator_checkpoint_t* record)
+{
+    char key[8];
+    slot_key(record->sequence % CONFIG_COORDINATOR_CHECKPOINT_JOURNAL_SLOTS, key, sizeof(key));
+
+    nvs_handle_t nvs;
+    CHECK_ERR_LOG_RET(nvs_open(CHECKPOINT_NAMESPACE, NVS_READWRITE, &nvs),
+                      "Failed to open the checkpoint journal");
+    esp_err_t err = nvs_set_blob(nvs, key, record, sizeof(*record));
+    if (err == ESP_OK)
+    {
+        err = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    return err;
+}
+
+/* Append the profile controller's state; the caller has updated last_checkpoint_stage and _phase */
+static void write_checkpoint(coordinator_ctx_t* ctx)
+{
+    coordinator_checkpoint_t record;
+    memset(&record, 0, sizeof(record)); // Padding is covered by the CRC
+    if (profile_tick_get_snapshot(&record.tick) != PROFILE_CONTROLLER_ERROR_NONE)
+    {
+        return;
+    }
+    record.sequence = ctx->checkpoint_sequence + 1;
+    record.program_hash = ctx->checkpoint_program_hash;
+    record.elapsed_ms = ctx->heating_task_state.current_time_elapsed_ms;
+    record.temperature_c = ctx->current_temperature;
+    record.paused = ctx->paused;
+    record.crc = record_crc(&record);
+
+    /* A failed write is retried at the next interval, not on every tick */
+    ctx->last_checkpoint_elapsed_ms = record.elapsed_ms;
+    ctx->last_checkpoint_paused = record.paused;
+
+    const esp_err_t err = write_record(&record);
+    if (err != ESP_OK)
+    {
+        LOGGER_LOG_WARN(TAG, "Failed to write checkpoint %lu: %s", (unsigned long)record.sequence,
+                        esp_err_to_name(err));
+        return;
+    }
+    ctx->checkpoint_sequence = record.sequence;
+    LOGGER_LOG_DEBUG(TAG, "Checkpoint %lu: stage %d, phase %d, %lu ms%s", (unsigned long)record.sequence,
+                     ctx->last_checkpoint_stage, (int)ctx->last_checkpoint_phase, (unsigned long)record.elapsed_ms,
+                     record.paused ? ", paused" : "");
+}
+#endif
+
+/* =========================================================================
+ *  Internal API
+ * ========================================================================= */
+esp_err_t checkpoint_load(coordinator_ctx_t* ctx)
+{
+    ctx->resume_pending = false;
+    ctx->resume_requested = false;
+#if CHECKPOINT_ENABLED
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(CHECKPOINT_NAMESPACE, NVS_READONLY, &nvs);
+    if (err == ESP_ERR_NVS_NOT_FOUND)
+    {
+        return ESP_OK; // Nothing journaled yet
+    }
+    CHECK_ERR_LOG_RET(err, "Failed to open the checkpoint journal");
+
+    size_t len = sizeof(s_program);
+    err = nvs_get_blob(nvs, CHECKPOINT_PROGRAM_KEY, &s_program, &len);
+    if (err != ESP_OK || len != sizeof(s_program))
+    {
+        nvs_close(nvs);
+        return ESP_OK; // No run in progress
+    }
+    const uint32_t hash = program_hash(&s_program);
+
+    bool found = false;
+    for (uint32_t slot = 0; slot < CONFIG_COORDINATOR_CHECKPOINT_JOURNAL_SLOTS; slot++)
+    {
+        char key[8];
+        slot_key(slot, key, sizeof(key));
+
+        coordinator_checkpoint_t record;
+        len = sizeof(record);
+        if (nvs_get_blob(nvs, key, &record, &len) != ESP_OK || len != sizeof(record) ||
+            record.crc != record_crc(&record) || record.program_hash != hash)
+        {
+            continue;
+        }
+        if (!found || (int32_t)(record.sequence - ctx->resume.sequence) > 0)
+        {
+            ctx->resume = record;
+            found = true;
+        }
+    }
+    nvs_close(nvs);
+
+    if (!found)
+    {
+        return ESP_OK;
+    }
+
+    ctx->checkpoint_program_hash = hash;
+    ctx->checkpoint_sequence = ctx->resume.sequence;
+    ctx->resume_pending = true;
+    LOGGER_LOG_INFO(TAG, "Journaled run '%s' found: %lu s in, phase %d, %.1f C%s; resumes on a consistent reading",
+                    s_program.program.name, (unsigned long)(ctx->resume.elapsed_ms / 1000),
+                    ctx->resume.tick.phase, ctx->resume.temperature_c, ctx->resume.paused ? ", paused" : "");
+#endif
+    return ESP_OK;
+}
+
+esp_err_t checkpoint_begin(coordinator_ctx_t* ctx, const program_draft_t* program, const int cooldown_rate_x10,
+                           const bool resumed)
+{
+    ctx->resume_pending = false;
+    ctx->last_checkpoint_elapsed_ms = ctx->heating_task_state.current_time_elapsed_ms;
+    ctx->last_checkpoint_stage = CHECKPOINT_STAGE_NONE;
+    ctx->last_checkpoint_paused = ctx->paused;
+#if CHECKPOINT_ENABLED
+    if (resumed)
+    {
+        return ESP_OK; // Keep appending to the journal the run came from
+    }
+
+    memset(&s_program, 0, sizeof(s_program));
+    s_program.program = *program;
+    s_program.cooldown_rate_x10 = cooldown_rate_x10;
+    ctx->checkpoint_program_hash = program_hash(&s_program);
+
+    /* Records of an earlier run must not pair up with this program */
+    nvs_handle_t nvs;
+    CHECK_ERR_LOG_RET(nvs_open(CHECKPOINT_NAMESPACE, NVS_READWRITE, &nvs),
+                      "Failed to open the checkpoint journal");
+    esp_err_t err = nvs_erase_all(nvs);
+    if (err == ESP_OK)
+    {
+        err = nvs_set_blob(nvs, CHECKPOINT_PROGRAM_KEY, &s_program, sizeof(s_program));
+    }
+    if (err == ESP_OK)
+    {
+        err = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    CHECK_ERR_LOG_RET(err, "Failed to journal the program");
+#else
+    (void)program;
+    (void)cooldown_rate_x10;
+    (void)resumed;
+#endif
+    return ESP_OK;
+}
+
+void checkpoint_update_program(coordinator_ctx_t* ctx)
+{
+#if CHECKPOINT_ENABLED
+    checkpoint_program_t updated;
+    memset(&updated, 0, sizeof(updated));
+    memcpy(&updated.program, &ctx->run_program, sizeof(updated.program));
+    updated.cooldown_rate_x10 = ctx->run_cooldown_rate_x10;
+    const uint32_t hash = program_hash(&updated);
+    if (hash == ctx->checkpoint_program_hash)
+    {
+        return;
+    }
+
+    /* Records of the old program stop matching; a failed write keeps them valid */
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(CHECKPOINT_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err == ESP_OK)
+    {
+        err = nvs_set_blob(nvs, CHECKPOINT_PROGRAM_KEY, &updated, sizeof(updated));
+        if (err == ESP_OK)
+        {
+            err = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+    if (err != ESP_OK)
+    {
+        LOGGER_LOG_WARN(TAG, "Failed to journal the edited program: %s", esp_err_to_name(err));
+        return;
+    }
+
+    s_program = updated;
+    ctx->checkpoint_program_hash = hash;
+    /* The next checkpoint_record() writes a record for the new program at once */
+    ctx->last_checkpoint_stage = CHECKPOINT_STAGE_NONE;
+#else
+    (void)ctx;
+#endif
+}
+
+void checkpoint_record(coordinator_ctx_t* ctx, const profile_tick_result_t* tick_result)
+{
+#if CHECKPOINT_ENABLED
+    if (tick_result->profile_complete)
+    {
+        return;
+    }
+
+    const uint32_t elapsed_ms = ctx->heating_task_state.current_time_elapsed_ms;
+    const bool changed = tick_result->current_stage_index != ctx->last_checkpoint_stage ||
+                         tick_result->phase != ctx->last_checkpoint_phase ||
+                         ctx->paused != ctx->last_checkpoint_paused;
+    if (!changed && elapsed_ms - ctx->last_checkpoint_elapsed_ms < CHECKPOINT_INTERVAL_MS)
+    {
+        return;
+    }
+
+    ctx->last_checkpoint_stage = tick_result->current_stage_index;
+    ctx->last_checkpoint_phase = tick_result->phase;
+    write_checkpoint(ctx);
+#else
+    (void)ctx;
+    (void)tick_result;
+#endif
+}
+
+void checkpoint_record_pause(coordinator_ctx_t* ctx)
+{
+#if CHECKPOINT_ENABLED
+    /* Nothing journaled yet, or this pause already is */
+    if (ctx->last_checkpoint_stage == CHECKPOINT_STAGE_NONE || ctx->last_checkpoint_paused)
+    {
+        return;
+    }
+    write_checkpoint(ctx);
+#else
+    (void)ctx;
+#endif
+}
+
+void checkpoint_clear(coordinator_ctx_t* ctx)
+{
+    ctx->resume_pending = false;
+#if CHECKPOINT_ENABLED
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(CHECKPOINT_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err == ESP_OK)
+    {
+        err = nvs_erase_all(nvs);
+        if (err == ESP_OK)
+        {
+            err = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+    if (err != ESP_OK)
+    {
+        LOGGER_LOG_WARN(TAG, "Failed to clear the checkpoint journal: %s", esp_err_to_name(err));
+    }
+#endif
+}
+
+void checkpoint_request_resume(coordinator_ctx_t* ctx)
+{
+    if (!ctx->resume_pending || ctx->resume_requested)
+    {
+        return;
+    }
+    ctx->resume_requested = true;
+
+    coordinator_command_data_t request = {
+        .type = COMMAND_TYPE_COORDINATOR_RESUME_CHECKPOINT,
+    };
+    command_t command = {
+        .target = COMMAND_TARGET_COORDINATOR,
+        .data = &request,
+        .data_size = sizeof(request),
+    };
+    const esp_err_t err = commands_dispatcher_dispatch_command(&command);
+    if (err != ESP_OK)
+    {
+        LOGGER_LOG_ERROR(TAG, "Failed to request the resume of '%s': %s", s_program.program.name,
+                         esp_err_to_name(err));
+    }
+}
+
+void checkpoint_try_resume(coordinator_ctx_t* ctx)
+{
+    if (!ctx->resume_pending)
+    {
+        return; // Superseded by a profile start or stop dispatched before the resume
+    }
+    ctx->resume_pending = false;
+
+    if (ctx->running)
+    {
+        return;
+    }
+
+    /* Too far from the checkpoint means the furnace was off for long: the run cannot continue.
+     * A paused run does not heat, so it is restored paused whatever the furnace cooled to. */
+    const float drift_c = fabsf(ctx->current_temperature - ctx->resume.temperature_c);
+    if (!ctx->resume.paused && drift_c > (float)CONFIG_COORDINATOR_CHECKPOINT_RESUME_TOLERANCE_C)
+    {
+        LOGGER_LOG_WARN(TAG, "Not resuming '%s': %.1f C now, %.1f C at the checkpoint",
+                        s_program.program.name, ctx->current_temperature, ctx->resume.temperature_c);
+        checkpoint_clear(ctx);
+        return;
+    }
+
+    const esp_err_t err = resume_heating_profile_from_checkpoint(ctx, &s_program.program,
+                                                                 s_program.cooldown_rate_x10, &ctx->resume);
+    if (err != ESP_OK)
+    {
+        LOGGER_LOG_ERROR(TAG, "Failed to resume '%s': %s", s_program.program.name, esp_err_to_name(err));
+        checkpoint_clear(ctx);
+        return;
+    }
+
+    LOGGER_LOG_INFO(TAG, "Resumed '%s' %lu s in at %.1f C (checkpoint %lu)%s", s_program.program.name,
+                    (unsigned long)(ctx->resume.elapsed_ms / 1000), ctx->current_temperature,
+                    (unsigned long)ctx->resume.sequence, ctx->paused ? ", paused" : "");
+    post_coordinator_event(COORDINATOR_EVENT_PROFILE_STARTED, NULL, 0);
+    if (ctx->paused)
+    {
+        post_coordinator_event(COORDINATOR_EVENT_PROFILE_PAUSED, NULL, 0);
+    }
+}
@@ -36,10 +36,14 @@ static void temperature_processor_event_handler(void* handler_arg, esp_event_bas
         ctx->current_temperature = temperature;
         ctx->heating_task_state.current_temperature = temperature;
         LOGGER_LOG_DEBUG(TAG, "Updated current temperature to %.2f C", ctx->current_temperature);
+
+        /* A run interrupted by a reset continues once the furnace temperature is known */
+        checkpoint_request_resume(ctx);
     }
 }
 
-static esp_err_t coordinator_command_handler(void* handler_arg, void* command_data, const size_t command_data_size)
+static esp_err_t coordinator_command_handler(void* handler_arg, void* command_data, const size_t command_data_size,
+                                             command_reply_t* reply)
 {
     coordinator_ctx_t* ctx = (coordinator_ctx_t*)handler_arg;
     coordinator_command_data_t* data = (coordinator_command_data_t*)command_data;
@@ -87,6 +91,7 @@ static esp_err_t coordinator_command_handler(void* handler_arg, void* command_da
     case COMMAND_TYPE_COORDINATOR_STOP_PROFILE:
         {
             LOGGER_LOG_INFO(TAG, "Coordinator Event: Stop Profile");
+            checkpoint_clear(ctx);
             const esp_err_t err = stop_heating_profile(ctx);
             if (err != ESP_OK)
             {
@@ -130,11 +135,21 @@ static esp_err_t coordinator_command_handler(void* handler_arg, void* command_da
             post_coordinator_event(COORDINATOR_EVENT_PROFILE_RESUMED, NULL, 0);
             break;
         }
+    case COMMAND_TYPE_COORDINATOR_RESUME_CHECKPOINT:
+        {
+            LOGGER_LOG_INFO(TAG, "Coordinator Event: Resume Checkpoint");
+            checkpoint_try_resume(ctx);
+            break;
+        }
     case COMMAND_TYPE_COORDINATOR_GET_STATUS_REPORT:
         {
             LOGGER_LOG_INFO(TAG, "Coordinator Event: Get Status Report");
             heating_task_state_t state;
-            get_heating_task_state(ctx);
+            get_heating_task_state(ctx, &state);
+            if (reply != NULL)
+            {
+                return command_reply_set(reply, &state, sizeof(state));
+            }
             CHECK_ERR_LOG(
                 post_coordinator_event(COORDINATOR_EVENT_STATUS_UPDATE, &state, sizeof(heating_task_state_t)),
                 "Failed to send coordinator status report event");
@@ -144,7 +159,11 @@ static esp_err_t coordinator_command_handler(void* handler_arg, void* command_da
         {
             LOGGER_LOG_INFO(TAG, "Coordinator Event: Get Current Profile");
             size_t profile_index;
-            get_current_heating_profile(ctx);
+            const esp_err_t err = get_current_heating_profile(ctx, &profile_index);
+            if (reply != NULL || err != ESP_OK)
+            {
+                return err != ESP_OK ? err : command_reply_set(reply, &profile_index, sizeof(profile_index));
+            }
             CHECK_ERR_LOG(post_coordinator_event(COORDINATOR_EVENT_CURRENT_PROFILE, &profile_index, sizeof(size_t)),
                           "Failed to send coordinator current profile event");
             break;
@@ -157,6 +176,27 @@ static esp_err_t coordinator_command_handler(void* handler_arg, void* command_da
     return ESP_OK;
 }
 
+esp_err_t coordinator_get_status(heating_task_state_t* state, const TickType_t timeout)
+{
+    if (state == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    coordinator_command_data_t request = {
+        .type = COMMAND_TYPE_COORDINATOR_GET_STATUS_REPORT,
+    };
+    command_t command = {
+        .target = COMMAND_TARGET_COORDINATOR,
+        .data = &request,
+        .data_size = sizeof(request),
+    };
+    size_t reply_len = 0;
+    CHECK_ERR_LOG_RET(commands_dispatcher_call(&command, state, sizeof(*state), &reply_len, timeout),
+                      "Failed to get coordinator status");
+    return reply_len == sizeof(*state) ? ESP_OK : ESP_ERR_INVALID_RESPONSE;
+}
+
 esp_err_t post_heater_controller_command(command_t *command)
 {
     CHECK_ERR_LOG_RET(commands_dispatcher_dispatch_command(command),
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "commands_dispatcher.h"
+#include "coordinator_component.h"
 #include "esp_err.h"
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
@@ -8,6 +9,7 @@
 #include "core_types.h"
 #include "coordinator_component_types.h"
 #include "event_registry.h"
+#include "temperature_profile_types.h"
 
 #define INVALID_PROFILE_INDEX ((size_t) 0xFFFFFFFF)
 
@@ -24,13 +26,32 @@ typedef struct
     bool pending; ///< True when new values are waiting
 } pending_target_update_t;
 
+/**
+ * @brief One record of the checkpoint journal: the minimal resume state.
+ *
+ * The program itself is journaled once per run; records refer to it by
+ * program_hash.
+ */
+typedef struct
+{
+    uint32_t sequence; ///< Increases with every record; the highest valid one wins
+    uint32_t program_hash; ///< CRC of the journaled program and cooldown rate
+    uint32_t elapsed_ms; ///< heating_task_state.current_time_elapsed_ms
+    float temperature_c; ///< Measured when written, checked against the first reading on boot
+    bool paused; ///< Run was paused; it resumes paused
+    profile_tick_snapshot_t tick;
+    uint32_t crc; ///< Over all preceding fields
+} coordinator_checkpoint_t;
+
 typedef struct
 {
     TaskHandle_t task_handle;
     esp_timer_handle_t pid_tick_timer; // Periodic timer driving the PID control loop
 
     program_draft_t run_program; // Copy of the program being executed
+    int run_cooldown_rate_x10; // Cooldown rate the program runs with
     bool has_program; // True after a program has been loaded
+    uint32_t runs_started; // Profiles launched since boot; the running one has index runs_started - 1
 
     bool running;
     bool paused;
@@ -41,8 +62,27 @@ typedef struct
     bool events_initialized;
 
     pending_target_update_t target_update; ///< Live manual-mode mailbox
+
+    portMUX_TYPE timing_lock; ///< Guards tick_fire_us and loop_timing
+    int64_t tick_fire_us; ///< When pid_tick_timer last fired
+    coordinator_loop_timing_t loop_timing;
+    uint64_t wake_latency_sum_us;
+    uint64_t exec_sum_us;
+    int64_t last_timing_report_us;
+
+    uint32_t checkpoint_sequence; ///< Sequence of the newest journal record
+    uint32_t checkpoint_program_hash;
+    uint32_t last_checkpoint_elapsed_ms;
+    int last_checkpoint_stage; ///< Stage index of the newest record, to write on every change
+    stage_phase_t last_checkpoint_phase;
+    bool last_checkpoint_paused;
+    bool resume_pending; ///< Journal holds a run to resume on the first temperature reading
+    bool resume_requested; ///< The resume command has been dispatched
+    coordinator_checkpoint_t resume; ///< Newest record found on boot
 } coordinator_ctx_t;
 
+extern coordinator_ctx_t* g_coordinator_ctx;
+
 // ============================================
 // Event handling and posting functions
 // ============================================
@@ -62,12 +102,77 @@ esp_err_t post_heater_controller_command(command_t *command);
 // ============================================
 esp_err_t start_heating_profile(coordinator_ctx_t* ctx, const program_draft_t* program, int cooldown_rate_x10);
 
+/* Start the program from a checkpoint instead of its beginning */
+esp_err_t resume_heating_profile_from_checkpoint(coordinator_ctx_t* ctx, const program_draft_t* program,
+                                                 int cooldown_rate_x10, const coordinator_checkpoint_t* checkpoint);
+
 esp_err_t pause_heating_profile(coordinator_ctx_t* ctx);
 
 esp_err_t resume_heating_profile(coordinator_ctx_t* ctx);
 
-esp_err_t get_heating_task_state(const coordinator_ctx_t* ctx);
+esp_err_t get_heating_task_state(const coordinator_ctx_t* ctx, heating_task_state_t* state);
 
-esp_err_t get_current_heating_profile(const coordinator_ctx_t* ctx);
+/* ESP_ERR_NOT_FOUND while no program is loaded */
+esp_err_t get_current_heating_profile(const coordinator_ctx_t* ctx, size_t* profile_index);
 
 esp_err_t stop_heating_profile(coordinator_ctx_t* ctx);
+
+// ============================================
+// Control loop timing functions
+// ============================================
+void reset_loop_timing(coordinator_ctx_t* ctx);
+
+/* Called from the PID tick timer callback */
+void record_tick_fired(coordinator_ctx_t* ctx);
+
+/**
+ * @brief Account one control iteration.
+ *
+ * @param ticks   Pending timer notifications consumed by the wake-up
+ * @param dt_us   Interval since the previous iteration, 0 for the first one after (re)start
+ */
+void record_loop_iteration(coordinator_ctx_t* ctx, uint32_t ticks, int64_t wake_us, int64_t dt_us, int64_t end_us);
+
+// ============================================
+// Checkpoint journal functions
+// ============================================
+/* Read the journal; sets resume_pending when it holds a run to continue */
+esp_err_t checkpoint_load(coordinator_ctx_t* ctx);
+
+/* Journal the program of a new run; a resumed run keeps the journal it came from */
+esp_err_t checkpoint_begin(coordinator_ctx_t* ctx, const program_draft_t* program, int cooldown_rate_x10,
+                           bool resumed);
+
+/* Re-journal ctx->run_program after a live edit; the next checkpoint_record() writes a record for it */
+void checkpoint_update_program(coordinator_ctx_t* ctx);
+
+/* Append a record on a stage, phase or pause change, or when the checkpoint interval has passed */
+void checkpoint_record(coordinator_ctx_t* ctx, const profile_tick_result_t* tick_result);
+
+/* Journal that the run is paused, once per pause; called by the profile task while paused */
+void checkpoint_record_pause(coordinator_ctx_t* ctx);
+
+/* Forget the run: called when the profile completes or is stopped by the user */
+void checkpoint_clear(coordinator_ctx_t* ctx);
+
+/* Dispatch COMMAND_TYPE_COORDINATOR_RESUME_CHECKPOINT once a reading arrives, if the journal holds a run */
+void checkpoint_request_resume(coordinator_ctx_t* ctx);
+
+/* Resume the journaled run if the reading is consistent with it; runs as a coordinator command,
+ * so it is ordered with profile starts and stops */
+void checkpoint_try_resume(coordinator_ctx_t* ctx);
+
+// ============================================
+// Remaining-time prediction functions
+// ============================================
+/* Read the furnace rates learned from earlier runs */
+esp_err_t eta_load(void);
+
+/* Start sampling a new run and publish its first estimate */
+void eta_begin(coordinator_ctx_t* ctx);
+
+/* Sample what the furnace did since the previous tick and re-estimate the remaining time */
+void eta_update(coordinator_ctx_t* ctx, float power_output);
+
+/* Fold the rates sampled in the completed run into the learned ones and persist them */
+void eta_learn(void);
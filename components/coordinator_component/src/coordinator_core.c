@@ -23,9 +23,16 @@ esp_err_t init_coordinator(void)
             LOGGER_LOG_ERROR(TAG, "Failed to allocate coordinator context");
             return ESP_ERR_NO_MEM;
         }
+        g_coordinator_ctx->timing_lock = (portMUX_TYPE)portMUX_INITIALIZER_UNLOCKED;
     }
 
     g_coordinator_ctx->has_program = false;
+    g_coordinator_ctx->heating_task_state.profile_index = INVALID_PROFILE_INDEX;
+
+    CHECK_ERR_LOG(checkpoint_load(g_coordinator_ctx),
+                  "Failed to read the checkpoint journal");
+
+    CHECK_ERR_LOG(eta_load(), "Failed to read the learned furnace rates");
 
     // Initialize Coordinator Events
     CHECK_ERR_LOG_RET(init_coordinator_events(g_coordinator_ctx),
@@ -0,0 +1,501 @@
+/**
+ * @file coordinator_eta.c
+ * @brief Remaining-time prediction learned from completed runs.
+ *
+ * While a profile runs, every span where the PID has been flat out or off
+ * for a while is a sample of what the furnace can do on its own: its
+ * heating rate at full power, or its natural cooling rate.  Spans are cut
+ * where the temperature leaves a band and summed per band; when the run
+ * completes, they are folded into the rates learned from earlier runs,
+ * which are kept in NVS.
+ *
+ * The remaining time is re-estimated on every tick from the state of the
+ * profile controller: a stage lasts at least its planned time, longer when
+ * the learned heating or cooling rates cannot cover its temperature change
+ * in time, and the profile only completes once the furnace has cooled
+ * below CONFIG_COORDINATOR_PROFILE_COMPLETE_TEMP_C.  Bands with nothing
+ * learned yet fall back to the plan.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "coordinator_component_internal.h"
+#include "esp_timer.h"
+#include "logger_component.h"
+#include "nvs.h"
+#include "sdkconfig.h"
+#include "temperature_profile_controller.h"
+#include "utils.h"
+
+static const char* TAG = "COORDINATOR_ETA";
+
+#define ETA_NAMESPACE "coord_eta"
+#define ETA_MODEL_KEY "rates"
+#define ETA_BANDS     CONFIG_COORDINATOR_ETA_BAND_COUNT
+#define ETA_BAND_C    ((float)CONFIG_COORDINATOR_ETA_BAND_C)
+#define MS_PER_MIN    60000.0f
+
+/* PID outputs that count as the heater flat out or off */
+#define ETA_FULL_POWER 0.98f
+#define ETA_NO_POWER   0.02f
+
+/* Right after the heater switches, the element and the thermocouple still
+ * follow the previous power: sample only once it has been steady this long */
+#define ETA_STEADY_US (3LL * 60 * 1000 * 1000)
+
+/* A span leaves its band this far past the edge, so sensor noise at the
+ * edge does not cut it into pieces */
+#define ETA_BAND_HYSTERESIS_C 2.0f
+
+/* Less time than this in a band says little about its rate */
+#define ETA_MIN_BAND_SAMPLE_MS (5U * 60U * 1000U)
+
+/* A longer gap between two ticks (a pause) is not one heater interval */
+#define ETA_MAX_SAMPLE_GAP_US ((int64_t)CONFIG_COORDINATOR_PID_TICK_INTERVAL_MS * 2000)
+
+/**
+ * @brief Learned rates as persisted: 0.01 C/min per band, 0 where nothing
+ *        is learned yet.
+ */
+typedef struct
+{
+    uint16_t band_c; ///< Band width the rates were learned with
+    uint16_t runs; ///< Completed runs folded in
+    uint16_t heat_x100[ETA_BANDS]; ///< Heating rate at full power
+    uint16_t cool_x100[ETA_BANDS]; ///< Cooling rate with the heater off
+} eta_model_t;
+
+/* Samples of the current run */
+typedef struct
+{
+    float rise_c[ETA_BANDS];
+    uint32_t heat_ms[ETA_BANDS];
+    float fall_c[ETA_BANDS];
+    uint32_t cool_ms[ETA_BANDS];
+    bool have_sample;
+    float last_temp_c;
+    int last_drive; ///< Heater drive at the previous tick, from power_drive()
+    int64_t last_us;
+    int64_t drive_since_us; ///< When the heater last changed drive
+    bool span_open; ///< A span of steady drive is being measured
+    int span_drive;
+    int span_band;
+    float span_start_c;
+    int64_t span_start_us;
+} eta_run_t;
+
+static eta_model_t s_model;
+static float s_heat_c_per_ms[ETA_BANDS];
+static float s_cool_c_per_ms[ETA_BANDS];
+static eta_run_t s_run;
+
+/* =========================================================================
+ *  Helpers
+ * ========================================================================= */
+static int band_index(const float temp_c)
+{
+    if (temp_c <= 0.0f)
+    {
+        return 0;
+    }
+    const int band = (int)(temp_c / ETA_BAND_C);
+    return band < ETA_BANDS ? band : ETA_BANDS - 1;
+}
+
+/* 1: flat out, -1: off, 0: anything between, which says nothing about the furnace */
+static int power_drive(const float power_output)
+{
+    if (power_output >= ETA_FULL_POWER)
+    {
+        return 1;
+    }
+    return power_output <= ETA_NO_POWER ? -1 : 0;
+}
+
+static void open_span(const int drive, const float temp_c, const int64_t now_us)
+{
+    s_run.span_open = true;
+    s_run.span_drive = drive;
+    s_run.span_band = band_index(temp_c);
+    s_run.span_start_c = temp_c;
+    s_run.span_start_us = now_us;
+}
+
+/* Credit the span measured up to the given reading to its band */
+static void close_span(const float temp_c, const int64_t now_us)
+{
+    if (!s_run.span_open)
+    {
+        return;
+    }
+    s_run.span_open = false;
+
+    const int band = s_run.span_band;
+    const uint32_t span_ms = (uint32_t)((now_us - s_run.span_start_us) / 1000);
+    const float change_c = temp_c - s_run.span_start_c;
+    if (s_run.span_drive > 0)
+    {
+        s_run.rise_c[band] += change_c;
+        s_run.heat_ms[band] += span_ms;
+    }
+    else
+    {
+        s_run.fall_c[band] -= change_c;
+        s_run.cool_ms[band] += span_ms;
+    }
+}
+
+static bool left_span_band(const float temp_c)
+{
+    const int band = s_run.span_band;
+    return (band > 0 && temp_c < (float)band * ETA_BAND_C - ETA_BAND_HYSTERESIS_C) ||
+           (band < ETA_BANDS - 1 && temp_c > (float)(band + 1) * ETA_BAND_C + ETA_BAND_HYSTERESIS_C);
+}
+
+static void reset_model(void)
+{
+    memset(&s_model, 0, sizeof(s_model));
+    s_model.band_c = CONFIG_COORDINATOR_ETA_BAND_C;
+}
+
+static void model_to_rates(void)
+{
+    for (int band = 0; band < ETA_BANDS; band++)
+    {
+        s_heat_c_per_ms[band] = (float)s_model.heat_x100[band] / 100.0f / MS_PER_MIN;
+        s_cool_c_per_ms[band] = (float)s_model.cool_x100[band] / 100.0f / MS_PER_MIN;
+    }
+}
+
+/* Fold one run's rate into the learned one; false when the run saw too little of the band */
+static bool learn_rate(uint16_t* learned_x100, const float change_c, const uint32_t sample_ms)
+{
+    if (sample_ms < ETA_MIN_BAND_SAMPLE_MS || change_c <= 0.0f)
+    {
+        return false;
+    }
+
+    float rate_x100 = change_c / (float)sample_ms * MS_PER_MIN * 100.0f;
+    if (*learned_x100 != 0)
+    {
+        rate_x100 = (float)*learned_x100 +
+                    (rate_x100 - (float)*learned_x100) * (float)CONFIG_COORDINATOR_ETA_LEARNING_RATE_PCT / 100.0f;
+    }
+    *learned_x100 = (uint16_t)fminf(fmaxf(rate_x100 + 0.5f, 1.0f), (float)UINT16_MAX);
+    return true;
+}
+
+/**
+ * @brief Time for the furnace to cover a temperature change.
+ *
+ * @param c_per_ms  Learned rate per band
+ * @param ramp      Rate of a setpoint ramp the furnace follows, which it
+ *                  cannot outrun and which stands in where nothing is
+ *                  learned; 0 without a ramp, counting those bands as no time
+ */
+static float transit_ms(const float* c_per_ms, const float from_c, const float to_c, const float ramp)
+{
+    float lo_c = fminf(from_c, to_c);
+    const float hi_c = fmaxf(from_c, to_c);
+    float ms = 0.0f;
+
+    for (int band = band_index(lo_c); band < ETA_BANDS && lo_c < hi_c; band++)
+    {
+        const float edge_c = band == ETA_BANDS - 1 ? hi_c : fminf((float)(band + 1) * ETA_BAND_C, hi_c);
+        if (edge_c <= lo_c)
+        {
+            continue;
+        }
+        float rate = c_per_ms[band];
+        if (ramp > 0.0f)
+        {
+            rate = rate > 0.0f ? fminf(rate, ramp) : ramp;
+        }
+        if (rate > 0.0f)
+        {
+            ms += (edge_c - lo_c) / rate;
+        }
+        lo_c = edge_c;
+    }
+    return ms;
+}
+
+/* Temperature the furnace gets to in ms heading from from_c to to_c, at the learned rates */
+static float reached_c(const float* c_per_ms, const float from_c, const float to_c, float ms)
+{
+    const bool up = to_c >= from_c;
+    float temp_c = from_c;
+
+    for (int band = band_index(from_c); temp_c != to_c && band >= 0 && band < ETA_BANDS; band += up ? 1 : -1)
+    {
+        float edge_c;
+        if (up)
+        {
+            edge_c = band == ETA_BANDS - 1 ? to_c : fminf((float)(band + 1) * ETA_BAND_C, to_c);
+        }
+        else
+        {
+            edge_c = band == 0 ? to_c : fmaxf((float)band * ETA_BAND_C, to_c);
+        }
+        const float span_c = fabsf(edge_c - temp_c);
+        const float rate = c_per_ms[band];
+        if (rate > 0.0f)
+        {
+            if (span_c > rate * ms)
+            {
+                return up ? temp_c + rate * ms : temp_c - rate * ms;
+            }
+            ms -= span_c / rate;
+        }
+        temp_c = edge_c;
+    }
+    return to_c;
+}
+
+/**
+ * @brief Remaining time of a stage in the given phase, from the profile_tick() rules.
+ *
+ * @param temp_c  In: temperature now or at the start of the stage; out: at its end
+ */
+static float stage_remaining_ms(const stage_phase_t phase, const float planned_left_ms, const float overtime_ms,
+                                float* temp_c, const float target_c)
+{
+    const float settle_ms = (float)CONFIG_COORDINATOR_SETTLE_WINDOW_MIN * MS_PER_MIN;
+    const float max_ext_ms = (float)CONFIG_COORDINATOR_MAX_STAGE_EXTENSION_MIN * MS_PER_MIN;
+    const float* rates = target_c >= *temp_c ? s_heat_c_per_ms : s_cool_c_per_ms;
+    const float reach_ms = transit_ms(rates, *temp_c, target_c, 0.0f);
+
+    /* Time the stage has left before profile_tick() gives up on its target */
+    float limit_ms;
+    switch (phase)
+    {
+    case STAGE_PHASE_RAMPING:
+        limit_ms = planned_left_ms + max_ext_ms;
+        break;
+    case STAGE_PHASE_EXTEND:
+        limit_ms = fmaxf(max_ext_ms - overtime_ms, 0.0f);
+        break;
+    case STAGE_PHASE_HOLDING:
+        *temp_c = target_c;
+        return planned_left_ms;
+    case STAGE_PHASE_SETTLE:
+        *temp_c = target_c;
+        return fminf(reach_ms, fmaxf(settle_ms - overtime_ms, 0.0f));
+    default:
+        return 0.0f;
+    }
+
+    if (reach_ms > limit_ms)
+    {
+        /* Forced on short of the target: the next stage starts from wherever the furnace got to */
+        *temp_c = reached_c(rates, *temp_c, target_c, limit_ms);
+        return limit_ms;
+    }
+    *temp_c = target_c;
+    return phase == STAGE_PHASE_RAMPING ? fmaxf(planned_left_ms, reach_ms) : reach_ms;
+}
+
+/**
+ * The cooldown ends once its ramp is over and the furnace has cooled below
+ * the completion threshold.  The heater holds the furnace on the ramp while
+ * it would cool faster, so it falls behind only where it cools slower.
+ */
+static float cooldown_remaining_ms(const float ramp_left_ms, const float temp_c, const int cooldown_rate_x10)
+{
+    const float complete_c = (float)CONFIG_COORDINATOR_PROFILE_COMPLETE_TEMP_C;
+    if (temp_c <= complete_c)
+    {
+        return ramp_left_ms;
+    }
+    const float ramp = cooldown_rate_x10 > 0 ? (float)cooldown_rate_x10 / 10.0f / MS_PER_MIN : 0.0f;
+    return fmaxf(ramp_left_ms, transit_ms(s_cool_c_per_ms, temp_c, complete_c, ramp));
+}
+
+/* Cooldown ramp length as advance_stage() plans it */
+static float planned_cooldown_ms(const float start_c, const int cooldown_rate_x10)
+{
+    if (start_c <= 0.0f || cooldown_rate_x10 <= 0)
+    {
+        return 0.0f;
+    }
+    return fmaxf(start_c * 10.0f / (float)cooldown_rate_x10, 1.0f) * MS_PER_MIN;
+}
+
+static float predict_remaining_ms(const coordinator_ctx_t* ctx)
+{
+    const int cooldown_rate_x10 = ctx->run_cooldown_rate_x10;
+    float temp_c = ctx->current_temperature;
+    float remaining_ms = 0.0f;
+    int next_pos = 0; // Position among the set stages of the first stage not started yet
+
+    /* Before the first tick there is no controller state: the whole program is ahead */
+    profile_tick_snapshot_t tick;
+    if (profile_tick_get_snapshot(&tick) == PROFILE_CONTROLLER_ERROR_NONE)
+    {
+        const stage_phase_t phase = (stage_phase_t)tick.phase;
+        if (phase == STAGE_PHASE_COMPLETE)
+        {
+            return 0.0f;
+        }
+        if (phase == STAGE_PHASE_COOLDOWN)
+        {
+            const float ramp_left_ms = tick.cooldown_total_ms > tick.cooldown_elapsed_ms
+                                           ? (float)(tick.cooldown_total_ms - tick.cooldown_elapsed_ms)
+                                           : 0.0f;
+            return cooldown_remaining_ms(ramp_left_ms, temp_c, cooldown_rate_x10);
+        }
+
+        const float planned_left_ms = tick.stage_planned_ms > tick.stage_elapsed_ms
+                                          ? (float)(tick.stage_planned_ms - tick.stage_elapsed_ms)
+                                          : 0.0f;
+        remaining_ms = stage_remaining_ms(phase, planned_left_ms, (float)tick.overtime_ms, &temp_c,
+                                          tick.stage_target_temp);
+        next_pos = tick.active_pos + 1;
+    }
+
+    int pos = 0;
+    for (int i = 0; i < PROGRAMS_TOTAL_STAGE_COUNT; ++i)
+    {
+        const program_stage_t* stage = &ctx->run_program.stages[i];
+        if (!stage->is_set || pos++ < next_pos)
+        {
+            continue;
+        }
+        remaining_ms += stage_remaining_ms(STAGE_PHASE_RAMPING, (float)stage->t_min * MS_PER_MIN, 0.0f, &temp_c,
+                                           (float)stage->target_t_c);
+    }
+
+    /* The cooldown ramp is planned from where the last stage ends */
+    return remaining_ms + cooldown_remaining_ms(planned_cooldown_ms(temp_c, cooldown_rate_x10), temp_c,
+                                                cooldown_rate_x10);
+}
+
+static void publish_estimate(coordinator_ctx_t* ctx)
+{
+    const float remaining_ms = predict_remaining_ms(ctx);
+    const uint32_t remaining = remaining_ms < (float)UINT32_MAX ? (uint32_t)remaining_ms : UINT32_MAX;
+    ctx->heating_task_state.estimated_remaining_ms = remaining;
+    ctx->heating_task_state.estimated_total_duration_ms = ctx->heating_task_state.current_time_elapsed_ms + remaining;
+}
+
+/* =========================================================================
+ *  Internal API
+ * ========================================================================= */
+esp_err_t eta_load(void)
+{
+    reset_model();
+    model_to_rates();
+
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(ETA_NAMESPACE, NVS_READONLY, &nvs);
+    if (err == ESP_ERR_NVS_NOT_FOUND)
+    {
+        return ESP_OK; // Nothing learned yet
+    }
+    CHECK_ERR_LOG_RET(err, "Failed to open the remaining-time model");
+
+    eta_model_t model;
+    size_t len = sizeof(model);
+    err = nvs_get_blob(nvs, ETA_MODEL_KEY, &model, &len);
+    nvs_close(nvs);
+    if (err == ESP_ERR_NVS_NOT_FOUND)
+    {
+        return ESP_OK;
+    }
+
+    /* Rates learned with other bands do not map onto these */
+    if (err == ESP_ERR_NVS_INVALID_LENGTH || (err == ESP_OK && (len != sizeof(model) ||
+                                                                 model.band_c != CONFIG_COORDINATOR_ETA_BAND_C)))
+    {
+        LOGGER_LOG_WARN(TAG, "Learned furnace rates do not match the configured bands, starting over");
+        return ESP_OK;
+    }
+    CHECK_ERR_LOG_RET(err, "Failed to read the remaining-time model");
+
+    s_model = model;
+    model_to_rates();
+    LOGGER_LOG_INFO(TAG, "Furnace rates learned from %u runs loaded", (unsigned)s_model.runs);
+    return ESP_OK;
+}
+
+void eta_begin(coordinator_ctx_t* ctx)
+{
+    memset(&s_run, 0, sizeof(s_run));
+    publish_estimate(ctx);
+}
+
+void eta_update(coordinator_ctx_t* ctx, const float power_output)
+{
+    const int64_t now_us = esp_timer_get_time();
+    const float temp_c = ctx->current_temperature;
+    const int drive = power_drive(power_output);
+
+    /* The reading at a tick shows what the drive of the previous tick achieved */
+    if (!s_run.have_sample || now_us - s_run.last_us > ETA_MAX_SAMPLE_GAP_US)
+    {
+        close_span(s_run.last_temp_c, s_run.last_us); // Nothing is known about the gap
+        s_run.drive_since_us = now_us;
+    }
+    else if (drive != s_run.last_drive)
+    {
+        close_span(temp_c, now_us);
+        s_run.drive_since_us = now_us;
+    }
+    else if (s_run.span_open && left_span_band(temp_c))
+    {
+        close_span(temp_c, now_us);
+        open_span(drive, temp_c, now_us);
+    }
+    else if (!s_run.span_open && drive != 0 && now_us - s_run.drive_since_us >= ETA_STEADY_US)
+    {
+        open_span(drive, temp_c, now_us);
+    }
+
+    s_run.have_sample = true;
+    s_run.last_temp_c = temp_c;
+    s_run.last_drive = drive;
+    s_run.last_us = now_us;
+
+    publish_estimate(ctx);
+}
+
+void eta_learn(void)
+{
+    close_span(s_run.last_temp_c, s_run.last_us);
+
+    int heat_bands = 0;
+    int cool_bands = 0;
+    for (int band = 0; band < ETA_BANDS; band++)
+    {
+        heat_bands += learn_rate(&s_model.heat_x100[band], s_run.rise_c[band], s_run.heat_ms[band]);
+        cool_bands += learn_rate(&s_model.cool_x100[band], s_run.fall_c[band], s_run.cool_ms[band]);
+    }
+    if (heat_bands == 0 && cool_bands == 0)
+    {
+        return; // Nothing new: spare the flash
+    }
+    if (s_model.runs < UINT16_MAX)
+    {
+        s_model.runs++;
+    }
+    model_to_rates();
+
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(ETA_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err == ESP_OK)
+    {
+        err = nvs_set_blob(nvs, ETA_MODEL_KEY, &s_model, sizeof(s_model));
+        if (err == ESP_OK)
+        {
+            err = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+    if (err != ESP_OK)
+    {
+        LOGGER_LOG_WARN(TAG, "Failed to store the learned furnace rates: %s", esp_err_to_name(err));
+        return;
+    }
+    LOGGER_LOG_INFO(TAG, "Run %u: heating rate learned in %d bands, cooling rate in %d", (unsigned)s_model.runs,
+                    heat_bands, cool_bands);
+}
@@ -0,0 +1,157 @@
+/**
+ * @file coordinator_loop_timing.c
+ * @brief Determinism statistics of the PID control loop.
+ *
+ * The tick timer callback stamps its fire time; the profile task measures
+ * the wake-up latency from that stamp, the interval to its previous
+ * iteration and how long the iteration took.  The interval deviation from
+ * the nominal tick period goes into a jitter histogram.
+ */
+
+#include <string.h>
+#include "coordinator_component_internal.h"
+#include "logger_component.h"
+#include "sdkconfig.h"
+
+static const char* TAG = "COORDINATOR_TIMING";
+
+static const uint32_t jitter_bucket_limits_us[COORDINATOR_JITTER_BUCKETS - 1] = COORDINATOR_JITTER_BUCKET_LIMITS_US;
+
+#define NOMINAL_TICK_US ((int64_t)CONFIG_COORDINATOR_PID_TICK_INTERVAL_MS * 1000)
+
+/* =========================================================================
+ *  Helpers
+ * ========================================================================= */
+#if CONFIG_COORDINATOR_LOOP_TIMING_REPORT_MS > 0
+static void report_loop_timing(const coordinator_loop_timing_t* timing)
+{
+    LOGGER_LOG_INFO(TAG, "PID loop: %lu ticks, %lu missed, wake latency avg/max %lu/%lu us, "
+                    "exec avg/max %lu/%lu us, dt min/max %lu/%lu us",
+                    (unsigned long)timing->ticks, (unsigned long)timing->missed_ticks,
+                    (unsigned long)timing->wake_latency_avg_us, (unsigned long)timing->wake_latency_max_us,
+                    (unsigned long)timing->exec_avg_us, (unsigned long)timing->exec_max_us,
+                    (unsigned long)timing->dt_min_us, (unsigned long)timing->dt_max_us);
+    LOGGER_LOG_INFO(TAG, "    jitter max %lu us, us <100:%lu <250:%lu <500:%lu <1000:%lu "
+                    "<2500:%lu <5000:%lu <10000:%lu <25000:%lu >=25000:%lu",
+                    (unsigned long)timing->jitter_max_us,
+                    (unsigned long)timing->jitter_histogram[0], (unsigned long)timing->jitter_histogram[1],
+                    (unsigned long)timing->jitter_histogram[2], (unsigned long)timing->jitter_histogram[3],
+                    (unsigned long)timing->jitter_histogram[4], (unsigned long)timing->jitter_histogram[5],
+                    (unsigned long)timing->jitter_histogram[6], (unsigned long)timing->jitter_histogram[7],
+                    (unsigned long)timing->jitter_histogram[8]);
+}
+#endif
+
+/* =========================================================================
+ *  Internal API
+ * ========================================================================= */
+void reset_loop_timing(coordinator_ctx_t* ctx)
+{
+    taskENTER_CRITICAL(&ctx->timing_lock);
+    memset(&ctx->loop_timing, 0, sizeof(ctx->loop_timing));
+    ctx->tick_fire_us = 0;
+    ctx->wake_latency_sum_us = 0;
+    ctx->exec_sum_us = 0;
+    taskEXIT_CRITICAL(&ctx->timing_lock);
+    ctx->last_timing_report_us = esp_timer_get_time();
+}
+
+void record_tick_fired(coordinator_ctx_t* ctx)
+{
+    const int64_t now_us = esp_timer_get_time();
+
+    taskENTER_CRITICAL(&ctx->timing_lock);
+    ctx->tick_fire_us = now_us;
+    taskEXIT_CRITICAL(&ctx->timing_lock);
+}
+
+void record_loop_iteration(coordinator_ctx_t* ctx, const uint32_t ticks, const int64_t wake_us, const int64_t dt_us,
+                           const int64_t end_us)
+{
+    coordinator_loop_timing_t* timing = &ctx->loop_timing;
+    const uint32_t exec_us = (uint32_t)(end_us - wake_us);
+
+    taskENTER_CRITICAL(&ctx->timing_lock);
+    /* A wake-up by stop or resume rather than by the timer has no fire stamp to measure against */
+    const uint32_t latency_us = ctx->tick_fire_us > 0 && wake_us >= ctx->tick_fire_us
+                                    ? (uint32_t)(wake_us - ctx->tick_fire_us)
+                                    : 0;
+    ctx->tick_fire_us = 0;
+
+    timing->ticks++;
+    if (ticks > 1)
+    {
+        timing->missed_ticks += ticks - 1;
+    }
+    ctx->wake_latency_sum_us += latency_us;
+    ctx->exec_sum_us += exec_us;
+    timing->wake_latency_avg_us = (uint32_t)(ctx->wake_latency_sum_us / timing->ticks);
+    timing->exec_avg_us = (uint32_t)(ctx->exec_sum_us / timing->ticks);
+    if (latency_us > timing->wake_latency_max_us)
+    {
+        timing->wake_latency_max_us = latency_us;
+    }
+    if (exec_us > timing->exec_max_us)
+    {
+        timing->exec_max_us = exec_us;
+    }
+
+    if (dt_us > 0)
+    {
+        if (timing->dt_min_us == 0 || dt_us < timing->dt_min_us)
+        {
+            timing->dt_min_us = (uint32_t)dt_us;
+        }
+        if (dt_us > timing->dt_max_us)
+        {
+            timing->dt_max_us = (uint32_t)dt_us;
+        }
+
+        const int64_t deviation_us = dt_us > NOMINAL_TICK_US ? dt_us - NOMINAL_TICK_US : NOMINAL_TICK_US - dt_us;
+        const uint32_t jitter_us = (uint32_t)deviation_us;
+        if (jitter_us > timing->jitter_max_us)
+        {
+            timing->jitter_max_us = jitter_us;
+        }
+        uint8_t bucket = 0;
+        while (bucket < COORDINATOR_JITTER_BUCKETS - 1 && jitter_us >= jitter_bucket_limits_us[bucket])
+        {
+            bucket++;
+        }
+        timing->jitter_histogram[bucket]++;
+    }
+    taskEXIT_CRITICAL(&ctx->timing_lock);
+
+#if CONFIG_COORDINATOR_LOOP_TIMING_REPORT_MS > 0
+    if (end_us - ctx->last_timing_report_us >= (int64_t)CONFIG_COORDINATOR_LOOP_TIMING_REPORT_MS * 1000)
+    {
+        ctx->last_timing_report_us = end_us;
+
+        coordinator_loop_timing_t snapshot;
+        taskENTER_CRITICAL(&ctx->timing_lock);
+        snapshot = *timing;
+        taskEXIT_CRITICAL(&ctx->timing_lock);
+        report_loop_timing(&snapshot);
+    }
+#endif
+}
+
+/* =========================================================================
+ *  Public API
+ * ========================================================================= */
+esp_err_t coordinator_get_loop_timing(coordinator_loop_timing_t* timing)
+{
+    if (timing == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (g_coordinator_ctx == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    taskENTER_CRITICAL(&g_coordinator_ctx->timing_lock);
+    *timing = g_coordinator_ctx->loop_timing;
+    taskEXIT_CRITICAL(&g_coordinator_ctx->timing_lock);
+    return ESP_OK;
+}
@@ -36,13 +36,15 @@ static const CoordinatorTaskConfig_t coordinator_task_config = {
 
 /**
  * @brief esp_timer callback — wakes the heating profile task at a fixed interval.
- *        Runs in ISR context on ESP32, so only xTaskNotifyGive is safe here.
+ *        Runs in the esp_timer task, so it must stay short: stamp the fire
+ *        time for the wake latency statistics and notify.
  */
 static void pid_tick_timer_cb(void* arg)
 {
     coordinator_ctx_t* ctx = (coordinator_ctx_t*)arg;
     if (ctx->task_handle != NULL)
     {
+        record_tick_fired(ctx);
         xTaskNotifyGive(ctx->task_handle);
     }
 }
@@ -60,122 +62,127 @@ static void post_status_update(const coordinator_ctx_t *ctx,
         .power_output        = power_output,
         .elapsed_ms          = ctx->heating_task_state.current_time_elapsed_ms,
         .total_ms            = ctx->heating_task_state.estimated_total_duration_ms,
+        .remaining_ms        = ctx->heating_task_state.estimated_remaining_ms,
     };
     post_coordinator_event(COORDINATOR_EVENT_STATUS_UPDATE,
                            &status, sizeof(status));
 }
 
-static void heating_profile_task(void* args)
+/**
+ * @brief One control iteration: profile clock, PID and heater commands.
+ *
+ * @param elapsed_ms  Whole milliseconds to advance the profile by
+ * @param dt_ms       Exact interval since the previous iteration, for the PID
+ */
+static void run_control_iteration(coordinator_ctx_t* ctx, const uint32_t elapsed_ms, const float dt_ms,
+                                  profile_tick_result_t* tick_result)
 {
-    coordinator_ctx_t* ctx = (coordinator_ctx_t*)args;
+    /* ── Apply pending manual-mode target update ──────────────── */
+    if (atomic_exchange(&ctx->target_update.pending, false)) {
+        int new_target   = ctx->target_update.target_t_c;
+        int new_delta_x10 = ctx->target_update.delta_t_per_min_x10;
+        float cur_temp    = ctx->current_temperature;
+
+        /* Compute ramp time from current temp to new target at the given delta */
+        int abs_diff = new_target > (int)cur_temp
+                     ? new_target - (int)cur_temp
+                     : (int)cur_temp - new_target;
+        uint32_t ramp_ms;
+        if (new_delta_x10 > 0 && abs_diff > 0) {
+            /* time_min = abs_diff / (delta/10) = abs_diff * 10 / delta */
+            uint32_t ramp_min = ((uint32_t)abs_diff * 10U + (uint32_t)new_delta_x10 - 1U)
+                              / (uint32_t)new_delta_x10;  /* ceiling div */
+            if (ramp_min < 1) ramp_min = 1;
+            ramp_ms = ramp_min * 60U * 1000U;
+        } else {
+            ramp_ms = 60U * 1000U;  /* 1 min minimum */
+        }
 
-    LOGGER_LOG_INFO(TAG, "Coordinator task started");
+        /* The remaining-time estimate follows the edited stage from this tick on */
+        if (profile_update_stage_target((float)new_target, ramp_ms, cur_temp) == PROFILE_CONTROLLER_ERROR_NONE) {
+            /* The edit changed run_program: a resume must load the edited stage */
+            checkpoint_update_program(ctx);
+        }
 
-    uint32_t last_wake_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
-    profile_tick_result_t tick_result = {0};
+        LOGGER_LOG_INFO(TAG, "Manual target applied: %d C, delta_x10=%d, ramp=%lu ms",
+                        new_target, new_delta_x10, (unsigned long)ramp_ms);
+    }
 
-    while (ctx->running)
+    const profile_controller_error_t err = profile_tick(
+        elapsed_ms,
+        ctx->current_temperature,
+        tick_result);
+    ctx->heating_task_state.target_temperature = tick_result->setpoint;
+
+    LOGGER_LOG_INFO(TAG, "Elapsed: %lu ms, Stage: %d, Phase: %d, Setpoint: %.2f C",
+                    (unsigned long)ctx->heating_task_state.current_time_elapsed_ms,
+                    tick_result->current_stage_index,
+                    (int)tick_result->phase,
+                    tick_result->setpoint);
+
+    if (err != PROFILE_CONTROLLER_ERROR_NONE)
     {
-        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-        uint32_t last_update_duration = 0;
-        if (!ctx->paused)
-        {
-            uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
-            last_update_duration = current_time - last_wake_time;
-            ctx->heating_task_state.current_time_elapsed_ms += last_update_duration;
-            last_wake_time = current_time;
-        }
-        else
-        {
-            /* While paused, keep last_wake_time current so the first
-               iteration after resume doesn't accumulate paused time. */
-            last_wake_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
-            continue;   /* Skip PID computation while paused */
-        }
+        LOGGER_LOG_WARN(TAG, "profile_tick error: %d", err);
+        return;
+    }
 
-        //TODO extract to helper
-        /* ── Apply pending manual-mode target update ──────────────── */
-        if (atomic_exchange(&ctx->target_update.pending, false)) {
-            int new_target   = ctx->target_update.target_t_c;
-            int new_delta_x10 = ctx->target_update.delta_t_per_min_x10;
-            float cur_temp    = ctx->current_temperature;
-
-            /* Compute ramp time from current temp to new target at the given delta */
-            int abs_diff = new_target > (int)cur_temp
-                         ? new_target - (int)cur_temp
-                         : (int)cur_temp - new_target;
-            uint32_t ramp_ms;
-            if (new_delta_x10 > 0 && abs_diff > 0) {
-                /* time_min = abs_diff / (delta/10) = abs_diff * 10 / delta */
-                uint32_t ramp_min = ((uint32_t)abs_diff * 10U + (uint32_t)new_delta_x10 - 1U)
-                                  / (uint32_t)new_delta_x10;  /* ceiling div */
-                if (ramp_min < 1) ramp_min = 1;
-                ramp_ms = ramp_min * 60U * 1000U;
-            } else {
-                ramp_ms = 60U * 1000U;  /* 1 min minimum */
-            }
-
-            profile_update_stage_target((float)new_target, ramp_ms, cur_temp);
-
-            /* Also update estimated total for time-remaining display */
-            ctx->heating_task_state.estimated_total_duration_ms =
-                ctx->heating_task_state.current_time_elapsed_ms + ramp_ms;
-
-            LOGGER_LOG_INFO(TAG, "Manual target applied: %d C, delta_x10=%d, ramp=%lu ms",
-                            new_target, new_delta_x10, (unsigned long)ramp_ms);
-        }
+    /* Log stage transitions */
+    if (tick_result->stage_changed) {
+        LOGGER_LOG_INFO(TAG, "Stage changed → stage %d, phase %d",
+                        tick_result->current_stage_index, (int)tick_result->phase);
+    }
 
-        const profile_controller_error_t err = profile_tick(
-            last_update_duration,
-            ctx->current_temperature,
-            &tick_result);
-        ctx->heating_task_state.target_temperature = tick_result.setpoint;
+    /* Warn if a stage was forced to advance */
+    if (tick_result->extension_warning) {
+        LOGGER_LOG_WARN(TAG, "Stage extension limit reached — forced advance");
+    }
 
-        LOGGER_LOG_INFO(TAG, "Elapsed: %lu ms, Stage: %d, Phase: %d, Setpoint: %.2f C",
-                        (unsigned long)ctx->heating_task_state.current_time_elapsed_ms,
-                        tick_result.current_stage_index,
-                        (int)tick_result.phase,
-                        tick_result.setpoint);
+    // Calculate power output based on current and target temperature
+    float power_output = pid_controller_compute(tick_result->setpoint,
+                                                ctx->current_temperature,
+                                                dt_ms);
+    eta_update(ctx, power_output);
 
-        if (err != PROFILE_CONTROLLER_ERROR_NONE)
-        {
-            LOGGER_LOG_WARN(TAG, "profile_tick error: %d", err);
-            continue;
-        }
+    if (tick_result->stage_changed)
+    {
+        heater_command_data_t cmd = {
+            .type = COMMAND_TYPE_HEATER_CLEAR,
+            .power_level = power_output
+        };
 
-        /* Log stage transitions */
-        if (tick_result.stage_changed) {
-            LOGGER_LOG_INFO(TAG, "Stage changed → stage %d, phase %d",
-                            tick_result.current_stage_index, (int)tick_result.phase);
-        }
+        command_t command = {
+            .target = COMMAND_TARGET_HEATER,
+            .data = &cmd,
+            .data_size = sizeof(cmd)
+        };
+        post_heater_controller_command(&command);
+    }
 
-        /* Warn if a stage was forced to advance */
-        if (tick_result.extension_warning) {
-            LOGGER_LOG_WARN(TAG, "Stage extension limit reached — forced advance");
-        }
+    heater_command_data_t cmd = {
+        .type = COMMAND_TYPE_HEATER_SET_POWER,
+        .power_level = power_output
+    };
 
-        // Calculate power output based on current and target temperature
-        float power_output = pid_controller_compute(tick_result.setpoint,
-                                                    ctx->current_temperature,
-                                                    last_update_duration);
-        if (tick_result.stage_changed)
-        {
-            heater_command_data_t cmd = {
-                .type = COMMAND_TYPE_HEATER_CLEAR,
-                .power_level = power_output
-            };
-
-            command_t command = {
-                .target = COMMAND_TARGET_HEATER,
-                .data = &cmd,
-                .data_size = sizeof(cmd)
-            };
-            post_heater_controller_command(&command);
-        }
+    /* Only the newest level matters if the heater falls behind */
+    command_t command = {
+        .target = COMMAND_TARGET_HEATER,
+        .data = &cmd,
+        .data_size = sizeof(cmd),
+        .coalesce_key = COMMAND_COALESCE_HEATER_POWER
+    };
+
+    post_heater_controller_command(&command);
+
+    /* Push status update to HMI (elapsed, remaining, power, temps) */
+    post_status_update(ctx, tick_result->setpoint, power_output);
+
+    /* ── Profile completion — driven by profile_tick() state machine ── */
+    if (tick_result->profile_complete) {
+        LOGGER_LOG_INFO(TAG, "Profile complete (profile_tick): temp %.1f C",
+                        ctx->current_temperature);
 
         heater_command_data_t cmd = {
-            .type = COMMAND_TYPE_HEATER_SET_POWER,
-            .power_level = power_output
+            .type = COMMAND_TYPE_HEATER_CLEAR,
         };
 
         command_t command = {
@@ -186,43 +193,68 @@ static void heating_profile_task(void* args)
 
         post_heater_controller_command(&command);
 
-        /* Push status update to HMI (elapsed, remaining, power, temps) */
-        post_status_update(ctx, tick_result.setpoint, power_output);
+        /* Set power to zero before signaling completion */
+        float zero_power = 0.0f;
+
+        cmd.type = COMMAND_TYPE_HEATER_SET_POWER;
+        cmd.power_level = zero_power;
 
-        /* ── Profile completion — driven by profile_tick() state machine ── */
-        if (tick_result.profile_complete) {
-            LOGGER_LOG_INFO(TAG, "Profile complete (profile_tick): temp %.1f C",
-                            ctx->current_temperature);
+        post_heater_controller_command(&command);
 
-            heater_command_data_t cmd = {
-                .type = COMMAND_TYPE_HEATER_CLEAR,
-            };
+        ctx->heating_task_state.is_completed = true;
+        ctx->heating_task_state.is_active = false;
+        eta_learn();
+        checkpoint_clear(ctx);
+        post_coordinator_event(COORDINATOR_EVENT_PROFILE_COMPLETED, NULL, 0);
+        ctx->running = false;
+        return;
+    }
 
-            command_t command = {
-                .target = COMMAND_TARGET_HEATER,
-                .data = &cmd,
-                .data_size = sizeof(cmd)
-            };
+    /* After the heater and HMI updates: a journal write may wait on a flash erase */
+    checkpoint_record(ctx, tick_result);
 
-            post_heater_controller_command(&command);
+    LOGGER_LOG_INFO(TAG, "Coordinator notified. Current Temperature: %.2f C",
+                    ctx->current_temperature);
+    event_manager_post_health(HEALTH_MONITOR_EVENT_HEARTBEAT, &coordinator_health_data);
+}
 
-            /* Set power to zero before signaling completion */
-            float zero_power = 0.0f;
+static void heating_profile_task(void* args)
+{
+    coordinator_ctx_t* ctx = (coordinator_ctx_t*)args;
 
-            cmd.type = COMMAND_TYPE_HEATER_SET_POWER;
-            cmd.power_level = zero_power;
+    LOGGER_LOG_INFO(TAG, "Coordinator task started");
 
-            post_heater_controller_command(&command);
+    /* dt comes from the microsecond timer: the tick count is far too coarse
+     * for the PID integral and derivative terms.  Whole milliseconds go to
+     * the profile clock and the remainder carries over, so it does not drift. */
+    int64_t last_wake_us = esp_timer_get_time();
+    int64_t elapsed_remainder_us = 0;
+    bool first_iteration = true;   /* Task start is not a timer tick, so its interval is no jitter sample */
+    profile_tick_result_t tick_result = {0};
 
-            ctx->heating_task_state.is_completed = true;
-            post_coordinator_event(COORDINATOR_EVENT_PROFILE_COMPLETED, NULL, 0);
-            ctx->running = false;
-            break;
+    while (ctx->running)
+    {
+        const uint32_t ticks = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        const int64_t wake_us = esp_timer_get_time();
+        if (ctx->paused)
+        {
+            /* While paused, keep last_wake_us current so the first
+               iteration after resume doesn't accumulate paused time. */
+            last_wake_us = wake_us;
+            checkpoint_record_pause(ctx);
+            continue;   /* Skip PID computation while paused */
         }
 
-        LOGGER_LOG_INFO(TAG, "Coordinator notified. Current Temperature: %.2f C",
-                        ctx->current_temperature);
-        event_manager_post_health(HEALTH_MONITOR_EVENT_HEARTBEAT, &coordinator_health_data);
+        const int64_t dt_us = wake_us - last_wake_us;
+        last_wake_us = wake_us;
+        elapsed_remainder_us += dt_us;
+        const uint32_t last_update_duration = (uint32_t)(elapsed_remainder_us / 1000);
+        elapsed_remainder_us -= (int64_t)last_update_duration * 1000;
+        ctx->heating_task_state.current_time_elapsed_ms += last_update_duration;
+
+        run_control_iteration(ctx, last_update_duration, (float)dt_us / 1000.0f, &tick_result);
+        record_loop_iteration(ctx, ticks, wake_us, first_iteration ? 0 : dt_us, esp_timer_get_time());
+        first_iteration = false;
     }
 
     LOGGER_LOG_INFO(TAG, "Temperature monitor task exiting");
@@ -231,7 +263,14 @@ static void heating_profile_task(void* args)
     vTaskDelete(NULL);
 }
 
-esp_err_t start_heating_profile(coordinator_ctx_t* ctx, const program_draft_t *program, int cooldown_rate_x10)
+/**
+ * @brief Load the program and start the profile task and PID tick timer.
+ *
+ * With a checkpoint the profile controller continues from the journaled
+ * stage and phase, and the profile clock from the journaled elapsed time.
+ */
+static esp_err_t launch_heating_profile(coordinator_ctx_t* ctx, const program_draft_t *program, int cooldown_rate_x10,
+                                        const coordinator_checkpoint_t* checkpoint)
 {
     if (ctx->task_handle != NULL && ctx->running)
     {
@@ -245,36 +284,10 @@ esp_err_t start_heating_profile(coordinator_ctx_t* ctx, const program_draft_t *p
 
     // Store a local copy of the program for the task lifetime
     memcpy(&ctx->run_program, program, sizeof(ctx->run_program));
+    ctx->run_cooldown_rate_x10 = cooldown_rate_x10;
     ctx->has_program = true;
     const program_draft_t *prog = &ctx->run_program;
 
-    // Calculate total duration from stages
-    uint32_t stages_ms = 0;
-    float last_stage_temp = ctx->current_temperature;
-    for (int i = 0; i < PROGRAMS_TOTAL_STAGE_COUNT; ++i) {
-        if (prog->stages[i].is_set) {
-            stages_ms += (uint32_t)prog->stages[i].t_min * 60U * 1000U;
-            last_stage_temp = (float)prog->stages[i].target_t_c;
-        }
-    }
-    uint32_t total_ms = stages_ms;
-    /* Add implicit cooldown duration */
-    if (last_stage_temp > 0.0f && cooldown_rate_x10 > 0) {
-        float cooldown_min = (last_stage_temp * 10.0f) / (float)cooldown_rate_x10;
-        if (cooldown_min < 1.0f) cooldown_min = 1.0f;
-        total_ms += (uint32_t)(cooldown_min * 60.0f * 1000.0f);
-    }
-
-    ctx->heating_task_state.is_active = true;
-    ctx->heating_task_state.is_paused = false;
-    ctx->heating_task_state.is_completed = false;
-    ctx->heating_task_state.current_time_elapsed_ms = 0;
-    ctx->heating_task_state.estimated_total_duration_ms = total_ms;
-    ctx->heating_task_state.heating_stages_duration_ms = stages_ms;
-    ctx->heating_task_state.current_temperature = ctx->current_temperature;
-    ctx->heating_task_state.heating_element_on = false;
-    ctx->heating_task_state.fan_on = false;
-
     const temp_profile_config_t temp_profile_config = {
         .program = prog,
         .initial_temperature = ctx->current_temperature,
@@ -291,6 +304,35 @@ esp_err_t start_heating_profile(coordinator_ctx_t* ctx, const program_draft_t *p
         return ESP_FAIL;
     }
 
+    if (checkpoint != NULL && profile_tick_restore(&checkpoint->tick) != PROFILE_CONTROLLER_ERROR_NONE)
+    {
+        LOGGER_LOG_ERROR(TAG, "Checkpoint does not fit heating profile '%s'", prog->name);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Durations come from the planned curve compiled by load_heating_profile()
+    const profile_segment_table_t *segments = get_profile_segment_table();
+
+    /* A run paused when it was journaled comes back paused */
+    ctx->paused = checkpoint != NULL && checkpoint->paused;
+    ctx->heating_task_state.profile_index = ctx->runs_started++;
+    ctx->heating_task_state.is_active = true;
+    ctx->heating_task_state.is_paused = ctx->paused;
+    ctx->heating_task_state.is_completed = false;
+    ctx->heating_task_state.current_time_elapsed_ms = checkpoint != NULL ? checkpoint->elapsed_ms : 0;
+    ctx->heating_task_state.heating_stages_duration_ms = segments->heating_ms;
+    ctx->heating_task_state.current_temperature = ctx->current_temperature;
+    ctx->heating_task_state.heating_element_on = false;
+    ctx->heating_task_state.fan_on = false;
+
+    /* First estimate: the plan, corrected by the rates learned so far */
+    eta_begin(ctx);
+    reset_loop_timing(ctx);
+
+    /* Without a journal the profile still runs, it just cannot be resumed */
+    CHECK_ERR_LOG(checkpoint_begin(ctx, prog, cooldown_rate_x10, checkpoint != NULL),
+                  "Profile will not survive a reset");
+
     /* Set running BEFORE task creation — the new task checks ctx->running
      * in its while-loop condition and may be scheduled before we return. */
     ctx->running = true;
@@ -330,6 +372,21 @@ esp_err_t start_heating_profile(coordinator_ctx_t* ctx, const program_draft_t *p
     return ESP_OK;
 }
 
+esp_err_t start_heating_profile(coordinator_ctx_t* ctx, const program_draft_t *program, int cooldown_rate_x10)
+{
+    return launch_heating_profile(ctx, program, cooldown_rate_x10, NULL);
+}
+
+esp_err_t resume_heating_profile_from_checkpoint(coordinator_ctx_t* ctx, const program_draft_t* program,
+                                                 int cooldown_rate_x10, const coordinator_checkpoint_t* checkpoint)
+{
+    if (checkpoint == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return launch_heating_profile(ctx, program, cooldown_rate_x10, checkpoint);
+}
+
 esp_err_t pause_heating_profile(coordinator_ctx_t* ctx)
 {
     if (!ctx->running)
@@ -369,16 +426,20 @@ esp_err_t resume_heating_profile(coordinator_ctx_t* ctx)
     return ESP_OK;
 }
 
-esp_err_t get_heating_task_state(const coordinator_ctx_t* ctx)
+esp_err_t get_heating_task_state(const coordinator_ctx_t* ctx, heating_task_state_t* state)
 {
-    //TODO Post state event
-    return ESP_FAIL;
+    *state = ctx->heating_task_state;
+    return ESP_OK;
 }
 
-esp_err_t get_current_heating_profile(const coordinator_ctx_t* ctx)
+esp_err_t get_current_heating_profile(const coordinator_ctx_t* ctx, size_t* profile_index)
 {
-    //TODO Post current profile event
-    return ESP_FAIL;
+    if (!ctx->has_program || ctx->heating_task_state.profile_index == INVALID_PROFILE_INDEX)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    *profile_index = ctx->heating_task_state.profile_index;
+    return ESP_OK;
 }
 
 esp_err_t stop_heating_profile(coordinator_ctx_t *ctx)
@@ -404,13 +465,12 @@ esp_err_t stop_heating_profile(coordinator_ctx_t *ctx)
         xTaskNotifyGive(ctx->task_handle);
     }
     ctx->heating_task_state.profile_index = INVALID_PROFILE_INDEX;
+    ctx->heating_task_state.is_active = false;
     ctx->heating_task_state.is_paused = false;
 
-    /* Zero out heater power so the heater PWM task stops toggling */
-    float zero_power = 0.0f;
+    /* Clear first: a safety command, it cancels power levels still queued from the last ticks */
     heater_command_data_t heater_cmd = {
-        .type = COMMAND_TYPE_HEATER_SET_POWER,
-        .power_level = zero_power
+        .type = COMMAND_TYPE_HEATER_CLEAR,
     };
 
     command_t cmd = {
@@ -420,6 +480,12 @@ esp_err_t stop_heating_profile(coordinator_ctx_t *ctx)
     };
     commands_dispatcher_dispatch_command(&cmd);
 
+    /* Zero out heater power so the heater PWM task stops toggling */
+    float zero_power = 0.0f;
+    heater_cmd.type = COMMAND_TYPE_HEATER_SET_POWER;
+    heater_cmd.power_level = zero_power;
+    commands_dispatcher_dispatch_command(&cmd);
+
     shutdown_profile_controller();
 
     LOGGER_LOG_INFO(TAG, "Coordinator task shutdown complete");
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include "esp_err.h"
 
 typedef enum
@@ -8,7 +11,8 @@ typedef enum
     DEVICE_STATE_IDLE,
     DEVICE_STATE_RUNNING,
     DEVICE_STATE_ERROR,
-    DEVICE_STATE_DISABLED
+    DEVICE_STATE_DISABLED,
+    DEVICE_STATE_DEGRADED   // update() keeps failing; polled at a backed-off rate, reads refused
 } device_state_t;
 
 typedef enum
@@ -20,8 +24,18 @@ typedef enum
     DEVICE_TYPE_DISPLAY,
     DEVICE_TYPE_MODBUS_NODE,
     DEVICE_TYPE_CONTACTOR,
+    DEVICE_TYPE_COUNT
 } device_type_t;
 
+typedef enum
+{
+    DEVICE_BUS_LOCAL = 0,  // No shared bus (internal/virtual devices)
+    DEVICE_BUS_MODBUS,
+    DEVICE_BUS_SPI,
+    DEVICE_BUS_GPIO,
+    DEVICE_BUS_COUNT
+} device_bus_t;
+
 typedef struct
 {
     uint8_t cmd_id;     // Command identifier (custom per device type)
@@ -37,8 +51,40 @@ typedef struct
     esp_err_t (*read)(void *ctx, void* data);
     esp_err_t (*write)(void *ctx, const device_write_cmd_t* cmd);
     esp_err_t (*shutdown)(void *ctx);
+    bool (*is_available)(void *ctx);  // Optional; false skips update() and counts as a failure (e.g. Modbus circuit open)
+    device_bus_t bus;                 // Devices on different buses are updated by different worker tasks
 } device_ops_t;
 
+typedef struct
+{
+    uint32_t period_ms;    // Time between update() releases
+    uint32_t deadline_ms;  // Completion deadline relative to the release, 0 = period
+} device_schedule_t;
+
+/**
+ * @brief Visitor for device_manager_for_each_device(); return false to stop.
+ */
+typedef bool (*device_visitor_t)(device_t* device, void* arg);
+
+/* Upper bounds of the update() duration histogram buckets; the last bucket is open-ended */
+#define DEVICE_EXEC_BUCKET_LIMITS_MS {1, 2, 5, 10, 20, 50, 100, 200}
+#define DEVICE_EXEC_BUCKETS 9
+
+typedef struct
+{
+    uint32_t updates;
+    uint32_t deadline_misses;   // update() finished after its deadline
+    uint32_t skipped_releases;  // Releases dropped because the device fell a whole period behind
+    uint32_t jitter_max_us;     // Release to start of update()
+    uint32_t jitter_avg_us;
+    uint32_t exec_max_us;       // Duration of update()
+    uint32_t exec_avg_us;
+    uint32_t exec_histogram[DEVICE_EXEC_BUCKETS];
+    uint32_t failures;              // update() returned an error
+    uint32_t consecutive_failures;
+    uint32_t backoff_period_ms;     // Current period while DEGRADED, 0 otherwise
+} device_timing_stats_t;
+
 
 esp_err_t device_manager_init(void);
 
@@ -51,6 +97,34 @@ esp_err_t device_manager_write_device(const device_t* device, const device_write
 
 esp_err_t device_manager_set_device_state(device_t* device, device_state_t new_state);
 
+/**
+ * @brief Set the update period and deadline of a device.
+ *
+ * Devices start with CONFIG_DEVICE_MANAGER_UPDATE_INTERVAL_MS and an implicit
+ * deadline of one period. Due updates run earliest deadline first.
+ */
+esp_err_t device_manager_set_device_schedule(device_t* device, const device_schedule_t* schedule);
+
+esp_err_t device_manager_get_device_timing(const device_t* device, device_timing_stats_t* stats);
+
 esp_err_t device_manager_destroy(device_t* device);
 
+/**
+ * @brief Look up a device by its name (hash index).
+ *
+ * @return The first device created with @p name, or NULL.
+ */
+device_t* device_manager_find_device(const char* name);
+
+/**
+ * @brief Visit the devices of one type in creation order, without scanning other slots.
+ *
+ * Runs under the registry lock: @p visitor must be short and must not create
+ * or destroy devices.
+ *
+ * @param running_only Skip devices that are not DEVICE_STATE_RUNNING.
+ * @return Number of devices visited.
+ */
+size_t device_manager_for_each_device(device_type_t type, bool running_only, device_visitor_t visitor, void* arg);
+
 esp_err_t device_manager_shutdown(void);
@@ -0,0 +1,62 @@
+/**
+ * @file device_snapshot.h
+ * @brief Double-buffered, seqlock-protected device state for lock-free reads.
+ *
+ * A device's update() writes the next state into the back buffer and
+ * publishes it; read() copies the front buffer from any task without taking
+ * a lock and retries only if the writer got all the way round to the buffer
+ * being copied.  The writer never waits.
+ *
+ * There must be a single writer per snapshot — the device's bus worker.
+ * Plain C11 atomics, no FreeRTOS dependency (see tools/device_snapshot_stress).
+ *
+ *     static temp_reading_t storage[2];
+ *     device_snapshot_init(&snap, storage, sizeof(temp_reading_t));
+ *
+ *     temp_reading_t* next = device_snapshot_begin_write(&snap);
+ *     next->temperature = t;
+ *     device_snapshot_publish(&snap);
+ *
+ *     temp_reading_t reading;
+ *     if (device_snapshot_read(&snap, &reading)) { ... }
+ */
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct
+{
+    atomic_uint sequence;  // Odd while the back buffer is written, +2 per publish
+    size_t size;
+    uint8_t* buffers;      // 2 * size bytes
+} device_snapshot_t;
+
+/**
+ * @param storage Room for two values of @p size bytes, e.g. an array of two structs.
+ */
+void device_snapshot_init(device_snapshot_t* snapshot, void* storage, size_t size);
+
+/**
+ * @brief Back buffer for the next state, pre-filled with the last published one.
+ */
+void* device_snapshot_begin_write(device_snapshot_t* snapshot);
+
+/**
+ * @brief Make the back buffer the state returned by device_snapshot_read().
+ */
+void device_snapshot_publish(device_snapshot_t* snapshot);
+
+/**
+ * @brief Copy the latest published state into @p out.
+ *
+ * @return false if nothing has been published yet.
+ */
+bool device_snapshot_read(const device_snapshot_t* snapshot, void* out);
+
+/**
+ * @brief Number of states published so far.
+ */
+uint32_t device_snapshot_version(const device_snapshot_t* snapshot);
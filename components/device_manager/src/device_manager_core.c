@@ -6,6 +6,7 @@
 #include "esp_err.h"
 #include "device_manager_internal.h"
 #include "utils.h"
+#include "esp_timer.h"
 #include "sdkconfig.h"
 
 static const char* TAG = "DEVICE_MANAGER_CORE";
@@ -29,6 +30,9 @@ esp_err_t device_manager_init(void)
         }
     }
 
+    CHECK_ERR_LOG_RET(device_registry_init(g_device_manager_context),
+                      "Failed to initialize device registry");
+
     CHECK_ERR_LOG_CALL_RET(init_device_manager_task(g_device_manager_context),
                            device_manager_shutdown(),
                            "Failed to initialize device manager task");
@@ -51,36 +55,38 @@ esp_err_t device_manager_create_device(const void* device_ctx, const device_ops_
         return ESP_ERR_INVALID_STATE;
     }
 
-    if (g_device_manager_context->count >= CONFIG_DEVICE_MANAGER_MAX_DEVICES)
+    if (ops == NULL || ops->init == NULL || type >= DEVICE_TYPE_COUNT || ops->bus >= DEVICE_BUS_COUNT)
     {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    device_t* device = device_registry_alloc(g_device_manager_context);
+    if (device == NULL)
+    {
+        LOGGER_LOG_ERROR(TAG, "No free device slot for %s (%d devices)", name, g_device_manager_context->count);
         return ESP_ERR_NO_MEM;
     }
 
-    printf("Creating device: name=%s, type=%d\n", name, type);
-    for (uint8_t i = 0; i < CONFIG_DEVICE_MANAGER_MAX_DEVICES; i++)
+    device->type = type;
+    device->name = name;
+    device->ops = ops;
+    device->state = DEVICE_STATE_IDLE;
+    device->ctx = (void*)device_ctx;
+    device_schedule_reset(device, CONFIG_DEVICE_MANAGER_UPDATE_INTERVAL_MS, 0, esp_timer_get_time());
+    device_registry_link(g_device_manager_context, device);
+
+    *out_device = device;
+    CHECK_ERR_LOG_CALL_RET_FMT(device->ops->init(device->ctx),
+                               device_manager_destroy(device),
+                               "Failed to initialize device %s (id %d)", name, device->id);
+    if (g_device_manager_context->running)
     {
-        LOGGER_LOG_INFO(TAG, "Checking device slot %d: state=%d", i, g_device_manager_context->devices[i].state);
-        if (g_device_manager_context->devices[i].state == DEVICE_STATE_UNINITIALIZED)
-        {
-            device_t* device = &g_device_manager_context->devices[i];
-
-            LOGGER_LOG_INFO(TAG, "Found free device slot at index %d", i);
-            device->type = type;
-            device->name = name;
-            device->ops = ops;
-            device->id = i;
-            device->state = DEVICE_STATE_IDLE;
-            device->ctx = (void*)device_ctx;
-
-            *out_device = device;
-            CHECK_ERR_LOG_CALL_RET_FMT(device->ops->init(device->ctx),
-                                       device_manager_destroy(device),
-                                       "Failed to initialize device %s (id %d)", name, i);
-            LOGGER_LOG_INFO(TAG, "Device %s created successfully with id: %d", name, i);
-            return ESP_OK;
-        }
+        CHECK_ERR_LOG_CALL_RET_FMT(device_manager_start_bus_worker(g_device_manager_context, ops->bus),
+                                   device_manager_destroy(device),
+                                   "Failed to start the bus worker for device %s", name);
     }
-    return ESP_ERR_NO_MEM;
+    LOGGER_LOG_INFO(TAG, "Device %s created successfully with id: %d", name, device->id);
+    return ESP_OK;
 }
 
 esp_err_t device_manager_read_device(const device_t* device, void* data_out)
@@ -120,6 +126,41 @@ esp_err_t device_manager_set_device_state(device_t* device, device_state_t new_s
     return ESP_OK;
 }
 
+esp_err_t device_manager_set_device_schedule(device_t* device, const device_schedule_t* schedule)
+{
+    if (device == NULL || device->state == DEVICE_STATE_UNINITIALIZED || schedule == NULL || schedule->period_ms == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    device_registry_lock(g_device_manager_context);
+    device_schedule_reset(device, schedule->period_ms, schedule->deadline_ms, esp_timer_get_time());
+    device_registry_unlock(g_device_manager_context);
+    LOGGER_LOG_INFO(TAG, "Device %s (id %d) scheduled every %lu ms, deadline %lu ms", device->name, device->id,
+                    (unsigned long)schedule->period_ms,
+                    (unsigned long)(schedule->deadline_ms > 0 ? schedule->deadline_ms : schedule->period_ms));
+
+    /* Let the bus worker recompute its sleep for the new release */
+    if (g_device_manager_context != NULL && g_device_manager_context->running && device->ops != NULL)
+    {
+        device_manager_start_bus_worker(g_device_manager_context, device->ops->bus);
+    }
+    return ESP_OK;
+}
+
+esp_err_t device_manager_get_device_timing(const device_t* device, device_timing_stats_t* stats)
+{
+    if (device == NULL || device->state == DEVICE_STATE_UNINITIALIZED || stats == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    device_registry_lock(g_device_manager_context);
+    *stats = device->timing;
+    device_registry_unlock(g_device_manager_context);
+    return ESP_OK;
+}
+
 esp_err_t device_manager_destroy(device_t* device)
 {
     if (device == NULL || device->state == DEVICE_STATE_UNINITIALIZED)
@@ -128,6 +169,7 @@ esp_err_t device_manager_destroy(device_t* device)
     }
 
     device->state = DEVICE_STATE_UNINITIALIZED;
+    device_registry_release(g_device_manager_context, device);
     device->ops = NULL;
 
     return ESP_OK;
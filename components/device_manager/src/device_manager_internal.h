@@ -5,6 +5,8 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
 #include "device_manager.h"
 #include "sdkconfig.h"
 #include "esp_err.h"
@@ -29,18 +31,143 @@ struct device
     const char* name;
 
     const device_ops_t* ops;
+
+    bool unavailable;  // Last is_available() result was false
+
+    /* Registry indexes, see device_manager_registry.c */
+    device_t* next_of_type;
+    device_t* next_on_bus;
+    device_t* next_in_bucket;
+
+    /* EDF scheduling, see device_manager_schedule.c */
+    uint32_t period_us;
+    uint32_t deadline_us;
+    int64_t release_us;   // Current release; update() is due from here
+    uint64_t jitter_sum_us;
+    uint64_t exec_sum_us;
+    uint8_t backoff_shift;          // Period is multiplied by 2^shift while DEGRADED
+    uint32_t failures_since_report; // Aggregated into one error post per report interval
+    int64_t last_error_report_us;
+    device_timing_stats_t timing;
 };
 
+typedef struct device_manager_context device_manager_context_t;
+
 typedef struct
 {
-    device_t devices[CONFIG_DEVICE_MANAGER_MAX_DEVICES];
+    device_bus_t bus;
     TaskHandle_t task_handle;
+    volatile int64_t last_alive_us;  // Checked by the coordinator before each heartbeat
+    device_manager_context_t* owner;
+} device_bus_worker_t;
+
+#define DEVICE_SLOT_WORDS ((CONFIG_DEVICE_MANAGER_MAX_DEVICES + 31) / 32)
+
+struct device_manager_context
+{
+    device_t devices[CONFIG_DEVICE_MANAGER_MAX_DEVICES];
+
+    /* Registry */
+    uint32_t free_slots[DEVICE_SLOT_WORDS];  // Bit set = slot free
+    device_t* type_heads[DEVICE_TYPE_COUNT];
+    device_t* bus_heads[DEVICE_BUS_COUNT];
+    device_t* name_buckets[CONFIG_DEVICE_MANAGER_NAME_BUCKETS];
+    SemaphoreHandle_t registry_lock;
+
+    TaskHandle_t task_handle;  // Cycle coordinator
+    device_bus_worker_t workers[DEVICE_BUS_COUNT];
+    EventGroupHandle_t cycle_events;
     uint8_t count;
     bool running;
-} device_manager_context_t;
+};
 
 extern device_manager_context_t* g_device_manager_context;
 
 esp_err_t init_device_manager_task(device_manager_context_t* ctx);
 
 esp_err_t stop_device_manager_task(device_manager_context_t* ctx);
+
+/**
+ * @brief Start the worker of @p bus if it is not running yet.
+ */
+esp_err_t device_manager_start_bus_worker(device_manager_context_t* ctx, device_bus_t bus);
+
+// ----------------------------
+// Registry
+// ----------------------------
+esp_err_t device_registry_init(device_manager_context_t* ctx);
+
+/**
+ * @brief Take a free slot from the bitmap; NULL when all slots are in use.
+ */
+device_t* device_registry_alloc(device_manager_context_t* ctx);
+
+/**
+ * @brief Add a device with its type, ops and name set to the type, bus and name indexes.
+ */
+void device_registry_link(device_manager_context_t* ctx, device_t* device);
+
+/**
+ * @brief Remove a device from all indexes and return its slot to the bitmap.
+ */
+void device_registry_release(device_manager_context_t* ctx, device_t* device);
+
+void device_registry_lock(const device_manager_context_t* ctx);
+void device_registry_unlock(const device_manager_context_t* ctx);
+
+static inline device_bus_t device_bus(const device_t* device)
+{
+    return device->ops != NULL ? device->ops->bus : DEVICE_BUS_LOCAL;
+}
+
+// ----------------------------
+// EDF schedule
+// ----------------------------
+typedef enum
+{
+    DEVICE_HEALTH_UNCHANGED = 0,
+    DEVICE_HEALTH_DEGRADED,   // Failure threshold reached, backoff started
+    DEVICE_HEALTH_RECOVERED,  // First success while degraded, back to the normal period
+} device_health_change_t;
+
+static inline bool device_is_active(const device_t* device)
+{
+    return device->state == DEVICE_STATE_RUNNING || device->state == DEVICE_STATE_DEGRADED;
+}
+
+/**
+ * @brief Start a new schedule: timing, backoff and a DEGRADED state are cleared.
+ *
+ * The caller holds the registry lock once the device is linked; the bus
+ * worker records results and completions under the same lock.
+ */
+void device_schedule_reset(device_t* device, uint32_t period_ms, uint32_t deadline_ms, int64_t now_us);
+
+/**
+ * @brief Released device with the earliest absolute deadline, or NULL if nothing is due.
+ */
+device_t* device_schedule_pick(device_manager_context_t* ctx, device_bus_t bus, int64_t now_us);
+
+/**
+ * @brief Record an update that started at @p start_us and ended at @p end_us, and move to the next release.
+ */
+void device_schedule_complete(device_t* device, int64_t start_us, int64_t end_us);
+
+/**
+ * @brief Update failure and backoff bookkeeping, see device_manager_schedule.c.
+ *
+ * Call before device_schedule_complete() so the next release uses the new period.
+ */
+device_health_change_t device_schedule_record_result(device_t* device, esp_err_t result);
+
+/**
+ * @brief Release dropped without an update (device not running or unavailable).
+ */
+void device_schedule_skip(device_t* device, int64_t now_us);
+
+/**
+ * @brief Earliest release among scheduled devices on @p bus, or INT64_MAX if there is none.
+ */
+int64_t device_schedule_next_release_us(const device_manager_context_t* ctx, device_bus_t bus);
+
+void device_schedule_report(const device_manager_context_t* ctx);
@@ -0,0 +1,202 @@
+/**
+ * @file device_manager_registry.c
+ * @brief Device slots and indexes — free-slot bitmap, per-type and per-bus
+ *        intrusive lists, and a name hash.
+ *
+ * Slots stay in the fixed devices[] array so device_t pointers handed out
+ * never move; the indexes only link them.  Lists keep creation order.
+ * Mutations and walks of the lists happen under registry_lock; the state of
+ * a device can change without it, so walkers filter on state themselves.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "device_manager_internal.h"
+#include "logger_component.h"
+#include "sdkconfig.h"
+
+static const char* TAG = "DEVICE_MANAGER_REGISTRY";
+
+/* =========================================================================
+ *  Helpers
+ * ========================================================================= */
+static uint32_t name_hash(const char* name)
+{
+    /* FNV-1a */
+    uint32_t hash = 2166136261U;
+    for (const char* c = name; *c != '\0'; c++)
+    {
+        hash = (hash ^ (uint8_t)*c) * 16777619U;
+    }
+    return hash;
+}
+
+static device_t** name_bucket(device_manager_context_t* ctx, const char* name)
+{
+    return &ctx->name_buckets[name_hash(name) % CONFIG_DEVICE_MANAGER_NAME_BUCKETS];
+}
+
+/*
+ * The three lists differ only in the link field; the offset selects it so
+ * append/remove are written once.
+ */
+#define LINK(device, offset) (*(device_t**)((uint8_t*)(device) + (offset)))
+
+static void list_append(device_t** head, device_t* device, const size_t link_offset)
+{
+    LINK(device, link_offset) = NULL;
+    while (*head != NULL)
+    {
+        head = &LINK(*head, link_offset);
+    }
+    *head = device;
+}
+
+static void list_remove(device_t** head, const device_t* device, const size_t link_offset)
+{
+    while (*head != NULL)
+    {
+        if (*head == device)
+        {
+            *head = LINK(device, link_offset);
+            return;
+        }
+        head = &LINK(*head, link_offset);
+    }
+}
+
+/* =========================================================================
+ *  Internal API
+ * ========================================================================= */
+esp_err_t device_registry_init(device_manager_context_t* ctx)
+{
+    if (ctx->registry_lock == NULL)
+    {
+        ctx->registry_lock = xSemaphoreCreateMutex();
+        if (ctx->registry_lock == NULL)
+        {
+            LOGGER_LOG_ERROR(TAG, "Failed to create device registry mutex");
+            return ESP_ERR_NO_MEM;
+        }
+
+        /* First init: every slot is free */
+        for (uint16_t i = 0; i < CONFIG_DEVICE_MANAGER_MAX_DEVICES; i++)
+        {
+            ctx->free_slots[i / 32] |= 1U << (i % 32);
+        }
+    }
+    return ESP_OK;
+}
+
+void device_registry_lock(const device_manager_context_t* ctx)
+{
+    xSemaphoreTake(ctx->registry_lock, portMAX_DELAY);
+}
+
+void device_registry_unlock(const device_manager_context_t* ctx)
+{
+    xSemaphoreGive(ctx->registry_lock);
+}
+
+device_t* device_registry_alloc(device_manager_context_t* ctx)
+{
+    device_t* device = NULL;
+
+    device_registry_lock(ctx);
+    for (uint16_t word = 0; word < DEVICE_SLOT_WORDS; word++)
+    {
+        if (ctx->free_slots[word] != 0)
+        {
+            const uint16_t bit = (uint16_t)__builtin_ctz(ctx->free_slots[word]);
+            ctx->free_slots[word] &= ~(1U << bit);
+            device = &ctx->devices[word * 32 + bit];
+            memset(device, 0, sizeof(*device));
+            device->id = (uint16_t)(word * 32 + bit);
+            ctx->count++;
+            break;
+        }
+    }
+    device_registry_unlock(ctx);
+
+    return device;
+}
+
+void device_registry_link(device_manager_context_t* ctx, device_t* device)
+{
+    device_registry_lock(ctx);
+    list_append(&ctx->type_heads[device->type], device, offsetof(device_t, next_of_type));
+    list_append(&ctx->bus_heads[device_bus(device)], device, offsetof(device_t, next_on_bus));
+    if (device->name != NULL)
+    {
+        list_append(name_bucket(ctx, device->name), device, offsetof(device_t, next_in_bucket));
+    }
+    device_registry_unlock(ctx);
+}
+
+void device_registry_release(device_manager_context_t* ctx, device_t* device)
+{
+    device_registry_lock(ctx);
+    list_remove(&ctx->type_heads[device->type], device, offsetof(device_t, next_of_type));
+    list_remove(&ctx->bus_heads[device_bus(device)], device, offsetof(device_t, next_on_bus));
+    if (device->name != NULL)
+    {
+        list_remove(name_bucket(ctx, device->name), device, offsetof(device_t, next_in_bucket));
+    }
+    ctx->free_slots[device->id / 32] |= 1U << (device->id % 32);
+    ctx->count--;
+    device_registry_unlock(ctx);
+}
+
+/* =========================================================================
+ *  Public API
+ * ========================================================================= */
+device_t* device_manager_find_device(const char* name)
+{
+    device_manager_context_t* ctx = g_device_manager_context;
+    if (ctx == NULL || ctx->registry_lock == NULL || name == NULL)
+    {
+        return NULL;
+    }
+
+    device_t* found = NULL;
+    device_registry_lock(ctx);
+    for (device_t* device = *name_bucket(ctx, name); device != NULL; device = device->next_in_bucket)
+    {
+        if (strcmp(device->name, name) == 0)
+        {
+            found = device;
+            break;
+        }
+    }
+    device_registry_unlock(ctx);
+
+    return found;
+}
+
+size_t device_manager_for_each_device(const device_type_t type, const bool running_only,
+                                      const device_visitor_t visitor, void* arg)
+{
+    device_manager_context_t* ctx = g_device_manager_context;
+    if (ctx == NULL || ctx->registry_lock == NULL || type >= DEVICE_TYPE_COUNT || visitor == NULL)
+    {
+        return 0;
+    }
+
+    size_t visited = 0;
+    device_registry_lock(ctx);
+    for (device_t* device = ctx->type_heads[type]; device != NULL; device = device->next_of_type)
+    {
+        if (running_only && device->state != DEVICE_STATE_RUNNING)
+        {
+            continue;
+        }
+        visited++;
+        if (!visitor(device, arg))
+        {
+            break;
+        }
+    }
+    device_registry_unlock(ctx);
+
+    return visited;
+}
@@ -0,0 +1,233 @@
+/**
+ * @file device_manager_schedule.c
+ * @brief Earliest-deadline-first selection of due device updates.
+ *
+ * Every device has a period and a relative deadline.  Its update is released
+ * once per period; among released devices the one with the earliest absolute
+ * deadline (release + deadline) runs first.  A device that falls a whole
+ * period behind drops the missed releases instead of running back-to-back to
+ * catch up.  Each bus worker schedules only the devices on its own bus.
+ *
+ * A device whose update() fails CONFIG_DEVICE_MANAGER_FAILURE_THRESHOLD
+ * times in a row is DEGRADED: its period doubles with every further failure
+ * up to CONFIG_DEVICE_MANAGER_BACKOFF_MAX_MS, and the first success restores
+ * the normal period at once.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "device_manager_internal.h"
+#include "logger_component.h"
+#include "sdkconfig.h"
+
+static const char* TAG = "DEVICE_MANAGER_SCHEDULE";
+
+#define BACKOFF_MAX_US ((int64_t)CONFIG_DEVICE_MANAGER_BACKOFF_MAX_MS * 1000)
+
+static const uint32_t exec_bucket_limits_ms[DEVICE_EXEC_BUCKETS - 1] = DEVICE_EXEC_BUCKET_LIMITS_MS;
+
+static int64_t absolute_deadline_us(const device_t* device)
+{
+    return device->release_us + device->deadline_us;
+}
+
+static bool is_scheduled(const device_t* device)
+{
+    return device->state != DEVICE_STATE_UNINITIALIZED && device->period_us > 0;
+}
+
+static int64_t effective_period_us(const device_t* device)
+{
+    const int64_t period_us = (int64_t)device->period_us << device->backoff_shift;
+    if (device->backoff_shift == 0 || period_us < BACKOFF_MAX_US)
+    {
+        return period_us;
+    }
+    return BACKOFF_MAX_US > device->period_us ? BACKOFF_MAX_US : device->period_us;
+}
+
+/**
+ * @brief Move to the first release after @p now_us, counting the ones passed over.
+ */
+static uint32_t advance_release(device_t* device, const int64_t now_us)
+{
+    const int64_t period_us = effective_period_us(device);
+    device->release_us += period_us;
+    if (device->release_us > now_us)
+    {
+        return 0;
+    }
+
+    const uint32_t behind = (uint32_t)((now_us - device->release_us) / period_us) + 1;
+    device->release_us += (int64_t)behind * period_us;
+    return behind;
+}
+
+void device_schedule_reset(device_t* device, const uint32_t period_ms, const uint32_t deadline_ms,
+                           const int64_t now_us)
+{
+    device->period_us = period_ms * 1000U;
+    device->deadline_us = (deadline_ms > 0 ? deadline_ms : period_ms) * 1000U;
+    device->release_us = now_us;
+    device->jitter_sum_us = 0;
+    device->exec_sum_us = 0;
+    device->backoff_shift = 0;
+    device->failures_since_report = 0;
+    memset(&device->timing, 0, sizeof(device->timing));
+    /* The failure count and backoff are gone, so the degradation goes with them */
+    if (device->state == DEVICE_STATE_DEGRADED)
+    {
+        device->state = DEVICE_STATE_RUNNING;
+    }
+}
+
+device_t* device_schedule_pick(device_manager_context_t* ctx, const device_bus_t bus, const int64_t now_us)
+{
+    device_t* best = NULL;
+
+    device_registry_lock(ctx);
+    for (device_t* device = ctx->bus_heads[bus]; device != NULL; device = device->next_on_bus)
+    {
+        if (!is_scheduled(device) || device->release_us > now_us)
+        {
+            continue;
+        }
+        if (best == NULL || absolute_deadline_us(device) < absolute_deadline_us(best))
+        {
+            best = device;
+        }
+    }
+    device_registry_unlock(ctx);
+    return best;
+}
+
+void device_schedule_complete(device_t* device, const int64_t start_us, const int64_t end_us)
+{
+    device_timing_stats_t* timing = &device->timing;
+    const uint32_t jitter_us = (uint32_t)(start_us - device->release_us);
+    const uint32_t exec_us = (uint32_t)(end_us - start_us);
+
+    timing->updates++;
+    device->jitter_sum_us += jitter_us;
+    device->exec_sum_us += exec_us;
+    timing->jitter_avg_us = (uint32_t)(device->jitter_sum_us / timing->updates);
+    timing->exec_avg_us = (uint32_t)(device->exec_sum_us / timing->updates);
+    if (jitter_us > timing->jitter_max_us)
+    {
+        timing->jitter_max_us = jitter_us;
+    }
+    if (exec_us > timing->exec_max_us)
+    {
+        timing->exec_max_us = exec_us;
+    }
+    uint8_t bucket = 0;
+    while (bucket < DEVICE_EXEC_BUCKETS - 1 && exec_us >= exec_bucket_limits_ms[bucket] * 1000U)
+    {
+        bucket++;
+    }
+    timing->exec_histogram[bucket]++;
+
+    if (end_us > absolute_deadline_us(device))
+    {
+        timing->deadline_misses++;
+        LOGGER_LOG_DEBUG(TAG, "Device %s (ID: %d) missed its deadline by %lld us",
+                         device->name, device->id, (long long)(end_us - absolute_deadline_us(device)));
+    }
+
+    timing->skipped_releases += advance_release(device, end_us);
+}
+
+device_health_change_t device_schedule_record_result(device_t* device, const esp_err_t result)
+{
+    device_timing_stats_t* timing = &device->timing;
+
+    if (result == ESP_OK)
+    {
+        timing->consecutive_failures = 0;
+        if (device->state != DEVICE_STATE_DEGRADED)
+        {
+            return DEVICE_HEALTH_UNCHANGED;
+        }
+        device->backoff_shift = 0;
+        timing->backoff_period_ms = 0;
+        device->state = DEVICE_STATE_RUNNING;
+        return DEVICE_HEALTH_RECOVERED;
+    }
+
+    timing->failures++;
+    timing->consecutive_failures++;
+    device->failures_since_report++;
+    if (timing->consecutive_failures < CONFIG_DEVICE_MANAGER_FAILURE_THRESHOLD)
+    {
+        return DEVICE_HEALTH_UNCHANGED;
+    }
+
+    /* Stop doubling once the cap is reached so the shift cannot overflow */
+    if (((int64_t)device->period_us << device->backoff_shift) < BACKOFF_MAX_US)
+    {
+        device->backoff_shift++;
+    }
+    timing->backoff_period_ms = (uint32_t)(effective_period_us(device) / 1000);
+
+    if (device->state == DEVICE_STATE_DEGRADED)
+    {
+        return DEVICE_HEALTH_UNCHANGED;
+    }
+    device->state = DEVICE_STATE_DEGRADED;
+    return DEVICE_HEALTH_DEGRADED;
+}
+
+void device_schedule_skip(device_t* device, const int64_t now_us)
+{
+    advance_release(device, now_us);
+}
+
+int64_t device_schedule_next_release_us(const device_manager_context_t* ctx, const device_bus_t bus)
+{
+    int64_t next_us = INT64_MAX;
+
+    device_registry_lock(ctx);
+    for (const device_t* device = ctx->bus_heads[bus]; device != NULL; device = device->next_on_bus)
+    {
+        if (is_scheduled(device) && device->release_us < next_us)
+        {
+            next_us = device->release_us;
+        }
+    }
+    device_registry_unlock(ctx);
+    return next_us;
+}
+
+void device_schedule_report(const device_manager_context_t* ctx)
+{
+    device_registry_lock(ctx);
+    for (int bus = 0; bus < DEVICE_BUS_COUNT; bus++)
+    {
+        for (const device_t* device = ctx->bus_heads[bus]; device != NULL; device = device->next_on_bus)
+        {
+            if (!is_scheduled(device) || device->timing.updates == 0)
+            {
+                continue;
+            }
+
+            const device_timing_stats_t* timing = &device->timing;
+            LOGGER_LOG_INFO(TAG, "%s (ID: %d) period %lu ms: %lu updates, %lu misses, %lu skipped, "
+                            "jitter avg/max %lu/%lu us, exec avg/max %lu/%lu us",
+                            device->name, device->id, (unsigned long)(device->period_us / 1000U),
+                            (unsigned long)timing->updates, (unsigned long)timing->deadline_misses,
+                            (unsigned long)timing->skipped_releases,
+                            (unsigned long)timing->jitter_avg_us, (unsigned long)timing->jitter_max_us,
+                            (unsigned long)timing->exec_avg_us, (unsigned long)timing->exec_max_us);
+            LOGGER_LOG_INFO(TAG, "    failures %lu (%lu in a row)%s, exec ms <1:%lu <2:%lu <5:%lu <10:%lu "
+                            "<20:%lu <50:%lu <100:%lu <200:%lu >=200:%lu",
+                            (unsigned long)timing->failures, (unsigned long)timing->consecutive_failures,
+                            device->state == DEVICE_STATE_DEGRADED ? ", DEGRADED" : "",
+                            (unsigned long)timing->exec_histogram[0], (unsigned long)timing->exec_histogram[1],
+                            (unsigned long)timing->exec_histogram[2], (unsigned long)timing->exec_histogram[3],
+                            (unsigned long)timing->exec_histogram[4], (unsigned long)timing->exec_histogram[5],
+                            (unsigned long)timing->exec_histogram[6], (unsigned long)timing->exec_histogram[7],
+                            (unsigned long)timing->exec_histogram[8]);
+        }
+    }
+    device_registry_unlock(ctx);
+}
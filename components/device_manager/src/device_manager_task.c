@@ -2,12 +2,14 @@
 // Created by vesko on 9.3.2026 г..
 //
 
+#include <stdio.h>
 #include "utils.h"
 #include "device_manager_internal.h"
 #include "logger_component.h"
 #include "sdkconfig.h"
 #include "event_manager.h"
 #include "furnace_error_types.h"
+#include "esp_timer.h"
 
 static const char* TAG = "DEVICE_MANAGER_TASK";
 
@@ -20,59 +22,325 @@ static const health_monitor_data_t health_monitor_data = {
     .timeout_ticks = pdMS_TO_TICKS(CONFIG_DEVICE_MANAGER_HEARTBEAT_TIMEOUT_MS)
 };
 
-static void device_manager_task(void* args)
+/**
+ * @brief Log and post update failures without flooding the error bus.
+ *
+ * One error post when a device becomes DEGRADED, then at most one per
+ * DEVICE_MANAGER_ERROR_REPORT_INTERVAL_MS summarising the failures since.
+ */
+static void report_update_result(device_t* device, const esp_err_t err, const device_health_change_t change,
+                                 const int64_t now_us)
 {
-    device_manager_context_t* ctx = (device_manager_context_t*)args;
+    const device_timing_stats_t* timing = &device->timing;
 
-    LOGGER_LOG_INFO(TAG, "Device manager task started");
+    switch (change)
+    {
+    case DEVICE_HEALTH_RECOVERED:
+        LOGGER_LOG_INFO(TAG, "Device %s (ID: %d) recovered, back to %lu ms updates",
+                        device->name, device->id, (unsigned long)(device->period_us / 1000U));
+        device->failures_since_report = 0;
+        return;
+    case DEVICE_HEALTH_DEGRADED:
+        LOGGER_LOG_ERROR(TAG, "Device %s (ID: %d) failed %lu updates in a row (%s), degraded to %lu ms updates",
+                         device->name, device->id, (unsigned long)timing->consecutive_failures,
+                         esp_err_to_name(err), (unsigned long)timing->backoff_period_ms);
+        break;
+    case DEVICE_HEALTH_UNCHANGED:
+    default:
+        if (err == ESP_OK)
+        {
+            return;
+        }
+        if (device->state != DEVICE_STATE_DEGRADED)
+        {
+            LOGGER_LOG_WARN(TAG, "Failed to update device %s (ID: %d): %s (%lu in a row)",
+                            device->name, device->id, esp_err_to_name(err),
+                            (unsigned long)timing->consecutive_failures);
+            return;
+        }
+        if (now_us - device->last_error_report_us < (int64_t)CONFIG_DEVICE_MANAGER_ERROR_REPORT_INTERVAL_MS * 1000)
+        {
+            return;
+        }
+        LOGGER_LOG_ERROR(TAG, "Device %s (ID: %d) still failing: %lu failures since last report, polling every %lu ms",
+                         device->name, device->id, (unsigned long)device->failures_since_report,
+                         (unsigned long)timing->backoff_period_ms);
+        break;
+    }
+
+    device->failures_since_report = 0;
+    device->last_error_report_us = now_us;
+    //TODO add critical error end device failed threshold
+    post_furnace_error((furnace_error_t){
+        .source = SOURCE_DEVICE_MANAGER,
+        .severity = SEVERITY_WARNING,
+        .error_code = device->id,
+    });
+}
+
+/**
+ * @brief Run one released update, or drop the release if the device cannot be updated now.
+ *
+ * @return true if update() was called.
+ */
+static bool run_device_update(const device_manager_context_t* ctx, device_t* device)
+{
+    if (!device_is_active(device))
+    {
+        device_schedule_skip(device, esp_timer_get_time());
+        return false;
+    }
+    if (device->ops == NULL || device->ops->update == NULL)
+    {
+        LOGGER_LOG_WARN(TAG, "Invalid device or device operations for device at index %d", device->id);
+        device_schedule_skip(device, esp_timer_get_time());
+        return false;
+    }
+
+    if (device->ops->is_available != NULL && !device->ops->is_available(device->ctx))
+    {
+        /* No bus I/O while unavailable, but the release counts as a failed
+         * update so the device degrades and its reads are refused */
+        if (!device->unavailable)
+        {
+            device->unavailable = true;
+            LOGGER_LOG_WARN(TAG, "Device %s (ID: %d) unavailable, skipping updates", device->name, device->id);
+        }
+        const int64_t now_us = esp_timer_get_time();
+        device_registry_lock(ctx);
+        const device_health_change_t change = device_schedule_record_result(device, ESP_ERR_INVALID_STATE);
+        device_schedule_skip(device, now_us);
+        device_registry_unlock(ctx);
+        report_update_result(device, ESP_ERR_INVALID_STATE, change, now_us);
+        return false;
+    }
+    if (device->unavailable)
+    {
+        device->unavailable = false;
+        LOGGER_LOG_INFO(TAG, "Device %s (ID: %d) available again", device->name, device->id);
+    }
+
+    const int64_t start_us = esp_timer_get_time();
+    const esp_err_t err = device->ops->update(device->ctx);
+    const int64_t end_us = esp_timer_get_time();
+
+    /* Under the registry lock: a concurrent schedule change resets these fields */
+    device_registry_lock(ctx);
+    const device_health_change_t change = device_schedule_record_result(device, err);
+    device_schedule_complete(device, start_us, end_us);
+    device_registry_unlock(ctx);
+    report_update_result(device, err, change, end_us);
+
+    LOGGER_LOG_DEBUG(TAG, "Device manager: updated device %s (ID: %d)", device->name, device->id);
+    return true;
+}
+
+/* =========================================================================
+ *  Bus workers
+ * ========================================================================= */
+/*
+ * Cycle bits in ctx->cycle_events, one of each per bus: a worker sets
+ * PASS_STARTED before its first update of a pass, PASS_UPDATED if any
+ * update() ran and PASS_DONE when the pass ends.
+ */
+#define PASS_STARTED_BIT(bus) ((EventBits_t)1 << (bus))
+#define PASS_DONE_BIT(bus)    ((EventBits_t)1 << ((bus) + 8))
+#define PASS_UPDATED_BIT(bus) ((EventBits_t)1 << ((bus) + 16))
+#define ALL_BUSES_MASK        (((EventBits_t)1 << DEVICE_BUS_COUNT) - 1)
+#define STOP_BIT              ((EventBits_t)1 << 23)
+#define STARTED_BITS(bits)    ((bits) & ALL_BUSES_MASK)
+#define DONE_BITS(bits)       (((bits) >> 8) & ALL_BUSES_MASK)
+#define UPDATED_BITS(bits)    (((bits) >> 16) & ALL_BUSES_MASK)
 
-    const TickType_t period = pdMS_TO_TICKS(CONFIG_DEVICE_MANAGER_UPDATE_INTERVAL_MS);
+static const char* bus_names[DEVICE_BUS_COUNT] = {"local", "modbus", "spi", "gpio"};
 
-    TickType_t next_wake_time = xTaskGetTickCount();
+static const int bus_worker_cores[DEVICE_BUS_COUNT] = {
+    CONFIG_DEVICE_MANAGER_LOCAL_WORKER_CORE,
+    CONFIG_DEVICE_MANAGER_MODBUS_WORKER_CORE,
+    CONFIG_DEVICE_MANAGER_SPI_WORKER_CORE,
+    CONFIG_DEVICE_MANAGER_GPIO_WORKER_CORE,
+};
+
+/**
+ * @brief Ticks until the next release on @p bus, capped so the worker reports itself alive regularly.
+ */
+static TickType_t ticks_until_next_release(const device_manager_context_t* ctx, const device_bus_t bus)
+{
+    const int64_t max_sleep_us = (int64_t)CONFIG_DEVICE_MANAGER_UPDATE_INTERVAL_MS * 1000;
+    int64_t sleep_us = device_schedule_next_release_us(ctx, bus) - esp_timer_get_time();
+    if (sleep_us > max_sleep_us)
+    {
+        sleep_us = max_sleep_us;
+    }
+    if (sleep_us <= 0)
+    {
+        return 0;
+    }
+
+    const TickType_t ticks = pdMS_TO_TICKS((uint32_t)((sleep_us + 999) / 1000));
+    return ticks > 0 ? ticks : 1;
+}
+
+static void device_bus_worker_task(void* args)
+{
+    device_bus_worker_t* worker = (device_bus_worker_t*)args;
+    device_manager_context_t* ctx = worker->owner;
+    const device_bus_t bus = worker->bus;
+
+    LOGGER_LOG_INFO(TAG, "Device worker for the %s bus started", bus_names[bus]);
 
     while (ctx->running)
     {
-        next_wake_time += period;
+        worker->last_alive_us = esp_timer_get_time();
 
-        for (uint8_t i = 0; i < CONFIG_DEVICE_MANAGER_MAX_DEVICES; i++)
+        /* Drain everything that is due, earliest deadline first */
+        bool started = false;
+        bool updated = false;
+        device_t* device;
+        while (ctx->running && (device = device_schedule_pick(ctx, bus, esp_timer_get_time())) != NULL)
         {
-            const device_t* device = &(ctx->devices[i]);
-            if (device->state != DEVICE_STATE_RUNNING)
+            if (!started)
             {
-                continue;
-            }
-            if (device->ops == NULL || device->ops->update == NULL)
-            {
-                LOGGER_LOG_WARN(TAG, "Invalid device or device operations for device at index %d", i);
-                continue;
+                xEventGroupSetBits(ctx->cycle_events, PASS_STARTED_BIT(bus));
+                started = true;
             }
+            updated |= run_device_update(ctx, device);
+        }
+        if (started)
+        {
+            xEventGroupSetBits(ctx->cycle_events,
+                               PASS_DONE_BIT(bus) | (updated ? PASS_UPDATED_BIT(bus) : 0));
+        }
 
-            const esp_err_t err = device->ops->update(device->ctx);
-            if (err != ESP_OK)
-            {
-                LOGGER_LOG_ERROR(TAG, "Failed to update device %s (ID: %d)", device->name, device->id);
-                //TODO add critical error end device failed threshold
-                post_furnace_error((furnace_error_t){
-                    .source = SOURCE_DEVICE_MANAGER,
-                    .severity = SEVERITY_WARNING,
-                    .error_code = device->id,
-                });
-            }
-            LOGGER_LOG_INFO(TAG, "Device manager tick: updated device %s (ID: %d)", device->name, device->id);
+        const TickType_t wait_ticks = ticks_until_next_release(ctx, bus);
+        if (wait_ticks > 0)
+        {
+            ulTaskNotifyTake(pdTRUE, wait_ticks);
         }
-        LOGGER_LOG_INFO(TAG, "Device manager tick complete, posting update event and heartbeat");
+    }
+
+    LOGGER_LOG_INFO(TAG, "Device worker for the %s bus stopping", bus_names[bus]);
+    worker->task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+esp_err_t device_manager_start_bus_worker(device_manager_context_t* ctx, const device_bus_t bus)
+{
+    if (bus >= DEVICE_BUS_COUNT || !ctx->running)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    device_bus_worker_t* worker = &ctx->workers[bus];
+    if (worker->task_handle != NULL)
+    {
+        /* A new device may be due before the worker's current sleep ends */
+        xTaskNotifyGive(worker->task_handle);
+        return ESP_OK;
+    }
+
+    char task_name[configMAX_TASK_NAME_LEN];
+    snprintf(task_name, sizeof(task_name), "dm_%s", bus_names[bus]);
+
+    worker->bus = bus;
+    worker->owner = ctx;
+    worker->last_alive_us = esp_timer_get_time();
+
+    /* Single-core targets ignore the affinity */
+    const int core = bus_worker_cores[bus];
+    CHECK_ERR_LOG_RET_FMT(xTaskCreatePinnedToCore(
+                              device_bus_worker_task,
+                              task_name,
+                              CONFIG_DEVICE_MANAGER_WORKER_STACK_SIZE,
+                              worker,
+                              CONFIG_DEVICE_MANAGER_TASK_PRIORITY,
+                              &worker->task_handle,
+                              core >= 0 && core < portNUM_PROCESSORS ? core : tskNO_AFFINITY) == pdPASS
+                          ? ESP_OK
+                          : ESP_FAIL,
+                          "Failed to create device worker for the %s bus", bus_names[bus]);
+
+    return ESP_OK;
+}
+
+/* =========================================================================
+ *  Cycle coordinator
+ * ========================================================================= */
+static bool workers_alive(const device_manager_context_t* ctx)
+{
+    const int64_t now_us = esp_timer_get_time();
+    for (int bus = 0; bus < DEVICE_BUS_COUNT; bus++)
+    {
+        const device_bus_worker_t* worker = &ctx->workers[bus];
+        if (worker->task_handle != NULL &&
+            now_us - worker->last_alive_us > (int64_t)CONFIG_DEVICE_MANAGER_HEARTBEAT_TIMEOUT_MS * 1000 / 2)
+        {
+            LOGGER_LOG_WARN(TAG, "Device worker for the %s bus is stuck, withholding heartbeat", bus_names[bus]);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Wait for the passes that started alongside the first finished one, then post one combined event.
+ */
+static void complete_cycle(const device_manager_context_t* ctx, EventBits_t bits)
+{
+    const EventBits_t pending = STARTED_BITS(bits) & ~DONE_BITS(bits);
+    if (pending != 0)
+    {
+        bits = xEventGroupWaitBits(ctx->cycle_events, pending << 8, pdFALSE, pdTRUE,
+                                   pdMS_TO_TICKS(CONFIG_DEVICE_MANAGER_UPDATE_INTERVAL_MS));
+    }
+
+    const EventBits_t finished = DONE_BITS(bits);
+    xEventGroupClearBits(ctx->cycle_events, finished | finished << 8 | finished << 16);
+
+    if (UPDATED_BITS(bits) & finished)
+    {
+        LOGGER_LOG_DEBUG(TAG, "Device cycle complete, buses 0x%02lx updated",
+                         (unsigned long)(UPDATED_BITS(bits) & finished));
         post_device_manager_event(DEVICE_MANAGER_UPDATED_EVENT, NULL, 0);
-        event_manager_post_health(HEALTH_MONITOR_EVENT_HEARTBEAT, &health_monitor_data);
+    }
+}
 
-        const TickType_t now = xTaskGetTickCount();
+static void device_manager_task(void* args)
+{
+    device_manager_context_t* ctx = (device_manager_context_t*)args;
+
+    LOGGER_LOG_INFO(TAG, "Device manager task started");
+
+#if CONFIG_DEVICE_MANAGER_TIMING_REPORT_MS > 0
+    int64_t last_report_us = esp_timer_get_time();
+#endif
+
+    while (ctx->running)
+    {
+        const EventBits_t bits = xEventGroupWaitBits(ctx->cycle_events, ALL_BUSES_MASK << 8 | STOP_BIT, pdFALSE,
+                                                     pdFALSE, pdMS_TO_TICKS(CONFIG_DEVICE_MANAGER_UPDATE_INTERVAL_MS));
+        if (!ctx->running)
+        {
+            break;
+        }
+        if (DONE_BITS(bits) != 0)
+        {
+            complete_cycle(ctx, bits);
+        }
 
-        if (now < next_wake_time)
+        if (workers_alive(ctx))
         {
-            const TickType_t wait_ticks = next_wake_time - now;
-            ulTaskNotifyTake(pdTRUE, wait_ticks);
+            event_manager_post_health(HEALTH_MONITOR_EVENT_HEARTBEAT, &health_monitor_data);
+        }
+
+#if CONFIG_DEVICE_MANAGER_TIMING_REPORT_MS > 0
+        const int64_t now_us = esp_timer_get_time();
+        if (now_us - last_report_us >= (int64_t)CONFIG_DEVICE_MANAGER_TIMING_REPORT_MS * 1000)
+        {
+            last_report_us = now_us;
+            device_schedule_report(ctx);
         }
-        else
-            next_wake_time = now;
+#endif
     }
     LOGGER_LOG_INFO(TAG, "Device manager task stopping");
     ctx->task_handle = NULL;
@@ -86,6 +354,17 @@ esp_err_t init_device_manager_task(device_manager_context_t* ctx)
         return ESP_OK;
     }
 
+    if (ctx->cycle_events == NULL)
+    {
+        ctx->cycle_events = xEventGroupCreate();
+        if (ctx->cycle_events == NULL)
+        {
+            LOGGER_LOG_ERROR(TAG, "Failed to create device cycle event group");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    xEventGroupClearBits(ctx->cycle_events, STOP_BIT);
     ctx->running = true;
 
     CHECK_ERR_LOG_CALL_RET(xTaskCreate(
@@ -100,6 +379,16 @@ esp_err_t init_device_manager_task(device_manager_context_t* ctx)
                            ctx->running = false,
                            "Failed to create device manager task");
 
+    /* Devices created before a restart keep their bus */
+    for (int bus = 0; bus < DEVICE_BUS_COUNT; bus++)
+    {
+        if (ctx->bus_heads[bus] != NULL)
+        {
+            CHECK_ERR_LOG_RET(device_manager_start_bus_worker(ctx, (device_bus_t)bus),
+                              "Failed to start device bus worker");
+        }
+    }
+
     event_manager_post_health(HEALTH_MONITOR_EVENT_REGISTER, &health_monitor_data);
 
     return ESP_OK;
@@ -113,9 +402,13 @@ esp_err_t stop_device_manager_task(device_manager_context_t* ctx)
     }
 
     ctx->running = false;
-    if (ctx->task_handle != NULL)
+    xEventGroupSetBits(ctx->cycle_events, STOP_BIT);
+    for (int bus = 0; bus < DEVICE_BUS_COUNT; bus++)
     {
-        xTaskNotifyGive(ctx->task_handle);
+        if (ctx->workers[bus].task_handle != NULL)
+        {
+            xTaskNotifyGive(ctx->workers[bus].task_handle);
+        }
     }
 
     return ESP_OK;
@@ -0,0 +1,78 @@
+/**
+ * @file device_snapshot.c
+ * @brief Seqlock over two buffers — see device_snapshot.h.
+ *
+ * With sequence s, the front buffer is (s / 2) % 2 and the writer, while s is
+ * odd, fills the other one.  A reader that started at s can only be
+ * overwritten once the writer begins the write after next, i.e. when the
+ * sequence passes (s & ~1) + 2.
+ */
+
+#include "device_snapshot.h"
+
+#include <string.h>
+
+static uint8_t* buffer_at(const device_snapshot_t* snapshot, const unsigned index)
+{
+    return snapshot->buffers + (size_t)index * snapshot->size;
+}
+
+static unsigned front_index(const unsigned sequence)
+{
+    return (sequence >> 1) & 1U;
+}
+
+void device_snapshot_init(device_snapshot_t* snapshot, void* storage, const size_t size)
+{
+    snapshot->size = size;
+    snapshot->buffers = storage;
+    memset(storage, 0, 2 * size);
+    atomic_init(&snapshot->sequence, 0U);
+}
+
+void* device_snapshot_begin_write(device_snapshot_t* snapshot)
+{
+    const unsigned sequence = atomic_load_explicit(&snapshot->sequence, memory_order_relaxed);
+    atomic_store_explicit(&snapshot->sequence, sequence + 1U, memory_order_relaxed);
+    /* Order the odd sequence before any write to the back buffer */
+    atomic_thread_fence(memory_order_release);
+
+    uint8_t* back = buffer_at(snapshot, front_index(sequence) ^ 1U);
+    memcpy(back, buffer_at(snapshot, front_index(sequence)), snapshot->size);
+    return back;
+}
+
+void device_snapshot_publish(device_snapshot_t* snapshot)
+{
+    const unsigned sequence = atomic_load_explicit(&snapshot->sequence, memory_order_relaxed);
+    atomic_store_explicit(&snapshot->sequence, sequence + 1U, memory_order_release);
+}
+
+bool device_snapshot_read(const device_snapshot_t* snapshot, void* out)
+{
+    device_snapshot_t* snap = (device_snapshot_t*)snapshot;
+
+    for (;;)
+    {
+        const unsigned before = atomic_load_explicit(&snap->sequence, memory_order_acquire);
+        if (before < 2U)
+        {
+            return false;
+        }
+
+        memcpy(out, buffer_at(snapshot, front_index(before)), snapshot->size);
+
+        atomic_thread_fence(memory_order_acquire);
+        const unsigned after = atomic_load_explicit(&snap->sequence, memory_order_relaxed);
+        if (after - (before & ~1U) <= 2U)
+        {
+            return true;
+        }
+    }
+}
+
+uint32_t device_snapshot_version(const device_snapshot_t* snapshot)
+{
+    device_snapshot_t* snap = (device_snapshot_t*)snapshot;
+    return atomic_load_explicit(&snap->sequence, memory_order_acquire) >> 1;
+}
@@ -61,7 +61,8 @@ typedef struct
     float target_temperature;
     float power_output;         // 0.0 – 1.0  (PID output)
     uint32_t elapsed_ms;
-    uint32_t total_ms;
+    uint32_t total_ms;          // elapsed_ms + remaining_ms
+    uint32_t remaining_ms;      // Predicted time to completion
 } coordinator_status_data_t;
 
 // ============================================================================
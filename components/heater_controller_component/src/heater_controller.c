@@ -30,6 +30,10 @@ esp_err_t toggle_heater(bool state)
     CHECK_ERR_LOG_RET(gpio_master_set_level(CONFIG_HEATER_CONTROLLER_GPIO, state ? 1 : 0),
                       "Failed to set heater GPIO level");
 
+    if (g_heater_controller_context != NULL)
+    {
+        g_heater_controller_context->heater_state = state;
+    }
     post_heater_controller_event(HEATER_CONTROLLER_HEATER_TOGGLED, &state, sizeof(state));
 
     return ESP_OK;
@@ -6,7 +6,8 @@
 
 static const char* TAG = "HEATER_CTRL_EVENTS";
 
-static esp_err_t heater_command_handler(void* handler_arg, void* command_data, const size_t command_data_size);
+static esp_err_t heater_command_handler(void* handler_arg, void* command_data, const size_t command_data_size,
+                                        command_reply_t* reply);
 
 esp_err_t init_events(heater_controller_context_t* ctx)
 {
@@ -40,7 +41,8 @@ esp_err_t post_heater_controller_event(heater_controller_event_t event_type, voi
     return ESP_OK;
 }
 
-static esp_err_t heater_command_handler(void* handler_arg, void* command_data, const size_t command_data_size)
+static esp_err_t heater_command_handler(void* handler_arg, void* command_data, const size_t command_data_size,
+                                        command_reply_t* reply)
 {
     heater_controller_context_t* ctx = (heater_controller_context_t*)handler_arg;
     const heater_command_data_t* data = (heater_command_data_t*)command_data;
@@ -55,7 +57,11 @@ static esp_err_t heater_command_handler(void* handler_arg, void* command_data, c
     case COMMAND_TYPE_HEATER_SET_POWER:
         return set_heater_target_power_level(ctx, data->power_level);
     case COMMAND_TYPE_HEATER_GET_STATUS:
-        return ESP_OK; //TODO Implement get status
+        {
+            heater_status_t status;
+            get_heater_status(ctx, &status);
+            return command_reply_set(reply, &status, sizeof(status));
+        }
     case COMMAND_TYPE_HEATER_TOGGLE:
         return toggle_heater(data->heater_state);
     case COMMAND_TYPE_HEATER_CLEAR:
@@ -7,6 +7,8 @@
 #include "furnace_error_types.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
+#include "sdkconfig.h"
+#include "commands_dispatcher.h"
 
 static const bool HEATER_ON = true;
 static const bool HEATER_OFF = false;
@@ -24,9 +26,11 @@ typedef struct
     // Current heater state
     volatile bool heater_state;
 
-    // Target power level (0.0 to 1.0)
-    float accumulated_power_level;
-    uint8_t power_level_sample_count;
+    // Target power level (0.0 to 1.0), averaged over the last HEATER_POWER_AVERAGE_SAMPLES commands
+    float power_samples[CONFIG_HEATER_POWER_AVERAGE_SAMPLES];
+    float power_sum;
+    uint8_t power_sample_count; // Saturates at the window size
+    uint8_t power_sample_next;
 
     // Task running flag
     volatile bool task_running;
@@ -51,6 +55,7 @@ esp_err_t shutdown_heater_controller_task(heater_controller_context_t* ctx);
 esp_err_t init_heater_controller();
 esp_err_t set_heater_target_power_level(heater_controller_context_t* ctx, float power_level);
 esp_err_t reset_heater_power_level_samples(heater_controller_context_t* ctx);
+void get_heater_status(heater_controller_context_t* ctx, heater_status_t* status);
 esp_err_t toggle_heater(bool state);
 esp_err_t shutdown_heater_controller();
 
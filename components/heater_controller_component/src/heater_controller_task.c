@@ -122,8 +122,24 @@ esp_err_t set_heater_target_power_level(heater_controller_context_t* ctx, const
         return ESP_ERR_INVALID_ARG;
     }
     xSemaphoreTake(ctx->power_mutex, portMAX_DELAY);
-    ctx->accumulated_power_level += power_level;
-    ctx->power_level_sample_count++;
+    if (power_level == 0.0f)
+    {
+        /* Off means off now, not once the window has aged out the last non-zero levels */
+        ctx->power_sum = 0.0f;
+        ctx->power_sample_count = 0;
+        ctx->power_sample_next = 0;
+    }
+    if (ctx->power_sample_count == CONFIG_HEATER_POWER_AVERAGE_SAMPLES)
+    {
+        ctx->power_sum -= ctx->power_samples[ctx->power_sample_next];
+    }
+    else
+    {
+        ctx->power_sample_count++;
+    }
+    ctx->power_samples[ctx->power_sample_next] = power_level;
+    ctx->power_sum += power_level;
+    ctx->power_sample_next = (uint8_t)((ctx->power_sample_next + 1) % CONFIG_HEATER_POWER_AVERAGE_SAMPLES);
     xSemaphoreGive(ctx->power_mutex);
 
     return ESP_OK;
@@ -132,8 +148,9 @@ esp_err_t set_heater_target_power_level(heater_controller_context_t* ctx, const
 esp_err_t reset_heater_power_level_samples(heater_controller_context_t* ctx)
 {
     xSemaphoreTake(ctx->power_mutex, portMAX_DELAY);
-    ctx->accumulated_power_level = 0.0f;
-    ctx->power_level_sample_count = 0;
+    ctx->power_sum = 0.0f;
+    ctx->power_sample_count = 0;
+    ctx->power_sample_next = 0;
     xSemaphoreGive(ctx->power_mutex);
 
     return ESP_OK;
@@ -142,13 +159,22 @@ esp_err_t reset_heater_power_level_samples(heater_controller_context_t* ctx)
 static float get_heater_target_power_level(const heater_controller_context_t* ctx)
 {
     xSemaphoreTake(ctx->power_mutex, portMAX_DELAY);
-    float average_power_level = ctx->power_level_sample_count > 0
-                                    ? ctx->accumulated_power_level / ((float)ctx->power_level_sample_count)
+    float average_power_level = ctx->power_sample_count > 0
+                                    ? ctx->power_sum / ((float)ctx->power_sample_count)
                                     : 0.0f;
     xSemaphoreGive(ctx->power_mutex);
     return average_power_level;
 }
 
+void get_heater_status(heater_controller_context_t* ctx, heater_status_t* status)
+{
+    xSemaphoreTake(ctx->power_mutex, portMAX_DELAY);
+    status->power_samples = ctx->power_sample_count;
+    xSemaphoreGive(ctx->power_mutex);
+    status->power_level = get_heater_target_power_level(ctx);
+    status->heater_on = ctx->heater_state;
+}
+
 static void check_error_and_post_event(const esp_err_t err)
 {
     if (err != ESP_OK)
@@ -0,0 +1,74 @@
+/**
+ * @file modbus_master_async.h
+ * @brief Asynchronous Modbus transactions executed by a single bus-owner task.
+ *
+ * Every transaction on the RS-485 segment goes through one task that owns the
+ * esp_modbus master handle.  Producers submit a request and return
+ * immediately; the bus task executes requests highest priority first,
+ * enforces the RTU inter-frame gap and reports completion through a callback,
+ * a task notification, or both.
+ *
+ * The blocking modbus_master_read_registers()/write_registers() API is kept
+ * and implemented on top of this queue.
+ */
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "modbus_master.h"
+
+typedef enum
+{
+    MODBUS_PRIORITY_HIGH = 0,  // Writes and operator-initiated commands
+    MODBUS_PRIORITY_NORMAL,    // Default for blocking calls
+    MODBUS_PRIORITY_LOW,       // Background polling
+    MODBUS_PRIORITY_COUNT
+} modbus_priority_t;
+
+typedef struct modbus_request modbus_request_t;
+
+/**
+ * @brief Completion callback, invoked from the bus task.
+ *
+ * @p result is ESP_ERR_INVALID_STATE without any bus traffic when the
+ * slave's circuit is open (see modbus_slave_health.h).
+ *
+ * Keep it short — the next transaction does not start until it returns.
+ * Must not submit a blocking request.
+ */
+typedef void (*modbus_completion_cb_t)(const modbus_request_t* request, esp_err_t result);
+
+struct modbus_request
+{
+    uint8_t slave_addr;
+    mb_function_code_t command;
+    uint16_t reg_start;
+    uint16_t reg_count;
+    void* data;                       // Read destination / write source, must stay valid until completion
+
+    modbus_priority_t priority;
+    modbus_completion_cb_t callback;  // Optional
+    void* user_ctx;                   // Passed back untouched in the callback
+
+    TaskHandle_t notify_task;         // Optional, notified with eSetBits(notify_bits) on completion
+    uint32_t notify_bits;
+    esp_err_t* result;                // Optional, written before the callback / notification
+};
+
+/**
+ * @brief Queue a transaction for the bus task.
+ *
+ * The request is copied; @p request itself may live on the caller's stack.
+ *
+ * @param ticks_to_wait How long to wait for room in the priority queue.
+ * @return ESP_ERR_TIMEOUT if the queue stayed full, ESP_ERR_INVALID_STATE if
+ *         the master is not running.
+ */
+esp_err_t modbus_master_submit(const modbus_request_t* request, TickType_t ticks_to_wait);
+
+/**
+ * @brief Number of requests waiting in a priority queue.
+ */
+uint32_t modbus_master_get_queue_depth(modbus_priority_t priority);
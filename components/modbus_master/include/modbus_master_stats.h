@@ -0,0 +1,73 @@
+/**
+ * @file modbus_master_stats.h
+ * @brief Bus telemetry — per slave and function code counters, RTT histogram
+ *        and bus utilisation.
+ *
+ * Everything is recorded by the bus task as transactions complete, so the
+ * numbers describe what actually went over the wire, including requests
+ * rejected by an open circuit (which cost no bus time).
+ */
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+/* Upper bounds of the RTT histogram buckets; the last bucket is open-ended */
+#define MODBUS_STATS_RTT_BUCKET_LIMITS_MS {5, 10, 20, 50, 100, 200, 500, 1000}
+#define MODBUS_STATS_RTT_BUCKETS 9
+
+typedef enum
+{
+    MODBUS_STATS_FC_READ_HOLDING = 0,
+    MODBUS_STATS_FC_READ_INPUT,
+    MODBUS_STATS_FC_WRITE_SINGLE,
+    MODBUS_STATS_FC_WRITE_MULTIPLE,
+    MODBUS_STATS_FC_OTHER,
+    MODBUS_STATS_FC_COUNT
+} modbus_stats_fc_t;
+
+typedef struct
+{
+    uint32_t requests;     // Transactions put on the wire
+    uint32_t ok;
+    uint32_t timeouts;
+    uint32_t crc_errors;   // Corrupt or malformed responses
+    uint32_t exceptions;   // Slave answered with a Modbus exception
+    uint32_t rejected;     // Failed fast by an open circuit, never sent
+    uint64_t bytes_tx;     // RTU frame bytes including address and CRC
+    uint64_t bytes_rx;
+    uint32_t rtt_max_us;
+    uint32_t rtt_histogram[MODBUS_STATS_RTT_BUCKETS];
+} modbus_fc_stats_t;
+
+typedef struct
+{
+    uint8_t slave_addr;
+    modbus_fc_stats_t fc[MODBUS_STATS_FC_COUNT];
+} modbus_slave_stats_t;
+
+typedef struct
+{
+    uint32_t window_ms;            // Length of the last completed window
+    float bus_busy_pct;            // Time spent in transactions (request, turnaround, response)
+    float wire_pct;                // Time characters were actually on the wire
+    float transactions_per_sec;
+    uint32_t read_requests;        // Register reads requested by consumers in the window
+    uint32_t read_round_trips;     // Read transactions that served them (fewer when merged)
+    uint32_t queued[3];            // Current depth of the high/normal/low queues
+    uint8_t slave_count;           // Slaves with recorded traffic
+} modbus_bus_stats_t;
+
+esp_err_t modbus_master_get_bus_stats(modbus_bus_stats_t* stats);
+
+/**
+ * @return ESP_ERR_NOT_FOUND if nothing has been sent to @p slave_addr.
+ */
+esp_err_t modbus_master_get_slave_stats(uint8_t slave_addr, modbus_slave_stats_t* stats);
+
+esp_err_t modbus_master_reset_stats(void);
+
+/**
+ * @brief Log a table of all bus and per-slave statistics.
+ */
+void modbus_master_dump_stats(void);
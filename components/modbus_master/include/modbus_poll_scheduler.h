@@ -0,0 +1,56 @@
+/**
+ * @file modbus_poll_scheduler.h
+ * @brief Round-robin poll scheduler for several slaves on one RS-485 segment.
+ *
+ * Consumers register a register block (slave, start, count, period) once and
+ * then read the most recent sample from the scheduler instead of issuing a
+ * blocking Modbus transaction themselves.  The scheduler task owns the poll
+ * cadence: requests are sent back to back, separated only by the RTU
+ * inter-frame gap, and slaves that stop answering are demoted to a slow probe
+ * rate so they do not stretch the cycle for everyone else.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef struct modbus_poll_slot modbus_poll_slot_t;
+
+typedef struct
+{
+    const char* name;      // Label used in logs (not copied, must outlive the slot)
+    uint8_t slave_addr;
+    uint16_t reg_start;
+    uint16_t reg_count;    // <= CONFIG_MODBUS_POLL_MAX_REGS
+    uint32_t period_ms;    // Desired poll period for this block
+} modbus_poll_config_t;
+
+typedef struct
+{
+    uint32_t samples_ok;
+    uint32_t samples_failed;
+    uint32_t consecutive_failures;
+    float samples_per_sec;  // Achieved rate over the last stats window
+    bool silent;            // True while demoted to the probe rate
+} modbus_poll_stats_t;
+
+esp_err_t modbus_poll_scheduler_add(const modbus_poll_config_t* config, modbus_poll_slot_t** out_slot);
+
+esp_err_t modbus_poll_scheduler_remove(modbus_poll_slot_t* slot);
+
+/**
+ * @brief Copy the latest sample of a slot.
+ *
+ * @param slot        Slot returned by modbus_poll_scheduler_add().
+ * @param dest        Destination buffer, at least @p reg_count registers.
+ * @param reg_count   Number of registers to copy (<= slot reg_count).
+ * @param[out] age_ms Age of the sample in milliseconds (may be NULL).
+ * @return ESP_ERR_NOT_FOUND if the slot has not produced a sample yet.
+ */
+esp_err_t modbus_poll_scheduler_get_sample(const modbus_poll_slot_t* slot,
+                                           uint16_t* dest,
+                                           uint16_t reg_count,
+                                           uint32_t* age_ms);
+
+esp_err_t modbus_poll_scheduler_get_stats(const modbus_poll_slot_t* slot, modbus_poll_stats_t* stats);
@@ -0,0 +1,111 @@
+/**
+ * @file modbus_rtu.h
+ * @brief Self-contained Modbus RTU master engine — CRC, framing, t3.5 timing.
+ *
+ * Plain C99 with no ESP-IDF or FreeRTOS dependency so the same code runs on
+ * the target (behind modbus_backend_native.c) and on a Linux host (behind a
+ * termios transport, see tools/modbus_rtu_bench).  All I/O goes through a
+ * small transport vtable; the engine itself only builds frames, enforces the
+ * inter-frame gap, reads exactly the expected response length and validates
+ * it.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MODBUS_RTU_MAX_FRAME      256
+#define MODBUS_RTU_MAX_READ_REGS  125
+#define MODBUS_RTU_MAX_WRITE_REGS 123
+
+typedef enum
+{
+    MODBUS_RTU_OK = 0,
+    MODBUS_RTU_ERR_ARG,        // Request cannot be encoded
+    MODBUS_RTU_ERR_IO,         // Transport write/read failed
+    MODBUS_RTU_ERR_TIMEOUT,    // No (complete) response in time
+    MODBUS_RTU_ERR_CRC,        // Response CRC mismatch
+    MODBUS_RTU_ERR_FRAME,      // Wrong slave, function, length or echo
+    MODBUS_RTU_ERR_EXCEPTION,  // Slave answered with an exception PDU
+} modbus_rtu_err_t;
+
+typedef struct
+{
+    void* ctx;
+    /** Write the whole buffer and return once the last bit is on the wire. */
+    int (*write)(void* ctx, const uint8_t* data, size_t len);
+    /** Read up to @p len bytes, waiting at most @p timeout_us. Returns bytes read, 0 on timeout, <0 on error. */
+    int (*read)(void* ctx, uint8_t* data, size_t len, uint32_t timeout_us);
+    /** Discard anything already received (late answers, line noise). */
+    void (*flush_input)(void* ctx);
+    int64_t (*now_us)(void* ctx);
+    void (*delay_us)(void* ctx, uint32_t us);
+} modbus_rtu_transport_t;
+
+typedef struct
+{
+    uint8_t slave_addr;
+    uint8_t function;          // 0x03, 0x04, 0x06 or 0x10
+    uint16_t reg_start;
+    uint16_t reg_count;        // 1 for 0x06
+    const uint16_t* values;    // Source registers for 0x06 / 0x10
+} modbus_rtu_request_t;
+
+typedef struct
+{
+    uint32_t gap_wait_us;      // Time spent honouring t3.5 before sending
+    uint32_t tx_us;            // Request on the wire
+    uint32_t response_us;      // End of request to first response byte
+    uint32_t rx_us;            // First to last response byte
+} modbus_rtu_timing_t;
+
+typedef struct
+{
+    const modbus_rtu_transport_t* transport;
+    uint32_t baud_rate;
+    uint32_t t35_us;
+    uint32_t inter_char_timeout_us;
+    int64_t last_activity_us;  // End of the last frame seen or sent
+    modbus_rtu_timing_t last_timing;
+} modbus_rtu_master_t;
+
+/**
+ * @brief t3.5 for @p baud_rate: 3.5 characters of 11 bits, fixed 1750 us above 19200 baud.
+ */
+uint32_t modbus_rtu_frame_gap_us(uint32_t baud_rate);
+
+void modbus_rtu_init(modbus_rtu_master_t* master, const modbus_rtu_transport_t* transport, uint32_t baud_rate);
+
+/**
+ * @brief CRC-16/MODBUS, table driven. Append low byte first.
+ */
+uint16_t modbus_rtu_crc16(const uint8_t* data, size_t len);
+
+/**
+ * @return Encoded frame length including CRC, or 0 if the request is invalid.
+ */
+size_t modbus_rtu_encode_request(const modbus_rtu_request_t* request, uint8_t* frame, size_t frame_size);
+
+/**
+ * @brief Length of the normal (non-exception) response to @p request.
+ */
+size_t modbus_rtu_expected_response_len(const modbus_rtu_request_t* request);
+
+/**
+ * @brief Validate a response frame and extract read data.
+ *
+ * @param[out] dest      Register values for 0x03/0x04 (may be NULL for writes).
+ * @param[out] exception Exception code when MODBUS_RTU_ERR_EXCEPTION is returned (may be NULL).
+ */
+modbus_rtu_err_t modbus_rtu_decode_response(const modbus_rtu_request_t* request, const uint8_t* frame, size_t len,
+                                            uint16_t* dest, uint8_t* exception);
+
+/**
+ * @brief Send one request and wait for its response.
+ *
+ * @param timeout_us Time allowed from the end of the request to the first response byte.
+ */
+modbus_rtu_err_t modbus_rtu_transact(modbus_rtu_master_t* master, const modbus_rtu_request_t* request,
+                                     uint16_t* dest, uint32_t timeout_us, uint8_t* exception);
+
+const char* modbus_rtu_err_to_name(modbus_rtu_err_t err);
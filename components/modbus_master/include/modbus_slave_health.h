@@ -0,0 +1,47 @@
+/**
+ * @file modbus_slave_health.h
+ * @brief Per-slave round-trip tracking, adaptive timeouts and circuit breaker.
+ *
+ * The bus task records the round-trip time and outcome of every transaction
+ * per slave address.  From the RTT history it derives an adaptive response
+ * timeout (the larger of the configured percentile and SRTT + 4 * RTTVAR).
+ * After CONFIG_MODBUS_HEALTH_FAILURE_THRESHOLD consecutive failures the
+ * slave's circuit opens: its requests fail immediately without touching the
+ * bus, and a single probe is let through after an exponentially growing
+ * back-off.  A successful probe closes the circuit again.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum
+{
+    MODBUS_CIRCUIT_CLOSED = 0,  // Healthy, all requests go out
+    MODBUS_CIRCUIT_OPEN,        // Failing, requests are rejected until the next probe
+    MODBUS_CIRCUIT_HALF_OPEN,   // One probe request is on the bus
+} modbus_circuit_state_t;
+
+typedef struct
+{
+    modbus_circuit_state_t circuit;
+    uint32_t rtt_ewma_us;           // Smoothed round-trip time
+    uint32_t rtt_percentile_us;     // CONFIG_MODBUS_HEALTH_TIMEOUT_PERCENTILE over the RTT window
+    uint32_t timeout_ms;            // Adaptive response timeout
+    uint32_t consecutive_failures;
+    uint32_t circuit_trips;         // Times the circuit has opened
+    uint32_t next_probe_in_ms;      // 0 unless the circuit is open
+} modbus_slave_health_t;
+
+/**
+ * @return ESP_ERR_NOT_FOUND if no transaction has been sent to @p slave_addr yet.
+ */
+esp_err_t modbus_master_get_slave_health(uint8_t slave_addr, modbus_slave_health_t* health);
+
+/**
+ * @brief False while the slave's circuit is open.
+ *
+ * Unknown slaves are reported as available.
+ */
+bool modbus_master_is_slave_available(uint8_t slave_addr);
@@ -0,0 +1,110 @@
+/**
+ * @file modbus_backend_esp_modbus.c
+ * @brief Backend on top of the esp_modbus serial master.
+ */
+
+#include "sdkconfig.h"
+
+#if CONFIG_MODBUS_MASTER_BACKEND_ESP_MODBUS
+
+#include "esp_err.h"
+#include "esp_modbus_common.h"
+#include "esp_modbus_master.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "logger_component.h"
+#include "modbus_master.h"
+#include "modbus_master_internal.h"
+#include "utils.h"
+
+static const char* TAG = "MODBUS_ESP_BACKEND";
+
+static void* master_handle;
+
+esp_err_t modbus_backend_init(const modbus_config_t* config)
+{
+    mb_communication_info_t comm_info = {
+        .ser_opts.port = config->uart_num,
+        .ser_opts.mode = MB_RTU,
+        .ser_opts.baudrate = config->baud_rate,
+        .ser_opts.parity = MB_PARITY_NONE,
+        .ser_opts.data_bits = UART_DATA_8_BITS,
+        .ser_opts.stop_bits = UART_STOP_BITS_1,
+        .ser_opts.uid = 0,
+        .ser_opts.response_tout_ms = CONFIG_MODBUS_RESPONSE_TIMEOUT_MS,
+    };
+
+    CHECK_ERR_LOG_CALL_RET(mbc_master_create_serial(&comm_info, &master_handle),
+                           modbus_backend_shutdown(),
+                           "Failed to create Modbus master");
+    if (master_handle == NULL)
+    {
+        LOGGER_LOG_ERROR(TAG, "Failed to create Modbus master");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    CHECK_ERR_LOG_CALL_RET(
+        uart_set_pin(config->uart_num, config->tx_pin, config->rx_pin, config->de_pin, UART_PIN_NO_CHANGE),
+        modbus_backend_shutdown(),
+        "Failed to set UART pins");
+
+    CHECK_ERR_LOG_CALL_RET(
+        uart_set_mode(config->uart_num, UART_MODE_RS485_HALF_DUPLEX),
+        modbus_backend_shutdown(),
+        "Failed to set UART mode"
+    );
+
+    vTaskDelay(pdMS_TO_TICKS(5)); // Let the UART settle
+
+    CHECK_ERR_LOG_CALL_RET(mbc_master_start(master_handle),
+                           modbus_backend_shutdown(),
+                           "Failed to start Modbus master");
+
+    return ESP_OK;
+}
+
+esp_err_t modbus_backend_shutdown(void)
+{
+    if (master_handle == NULL)
+    {
+        return ESP_OK;
+    }
+
+    CHECK_ERR_LOG_RET(mbc_master_stop(master_handle),
+                      "Failed to stop Modbus master");
+    CHECK_ERR_LOG_RET(mbc_master_delete(master_handle),
+                      "Failed to delete Modbus master");
+    master_handle = NULL;
+
+    return ESP_OK;
+}
+
+esp_err_t modbus_backend_execute(const uint8_t slave_addr,
+                                 const mb_function_code_t command,
+                                 const uint16_t reg_start,
+                                 const uint16_t reg_count,
+                                 void* data)
+{
+    if (master_handle == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    /* esp_modbus only supports the response timeout given at creation, so the
+     * adaptive per-slave timeout is not applied here (see the Kconfig choice). */
+    mb_param_request_t request = {
+        .slave_addr = slave_addr,
+        .command = command,
+        .reg_start = reg_start,
+        .reg_size = reg_count
+    };
+
+    return mbc_master_send_request(master_handle, &request, data);
+}
+
+const char* modbus_backend_name(void)
+{
+    return "esp_modbus";
+}
+
+#endif // CONFIG_MODBUS_MASTER_BACKEND_ESP_MODBUS
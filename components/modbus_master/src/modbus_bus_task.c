@@ -0,0 +1,491 @@
+/**
+ * @file modbus_bus_task.c
+ * @brief Bus-owner task — the only caller of modbus_master_execute().
+ *
+ * Requests are kept in one bounded queue per priority.  After every
+ * transaction the task rescans from the highest priority, so a write
+ * submitted behind a burst of background polls goes out next.
+ *
+ * Register reads to the same slave are merged: before a read goes out the
+ * task pulls a few more requests into a small staging area, folds every
+ * read of the same slave and function whose range overlaps or touches the
+ * growing span into one transaction (at most 125 registers), and copies the
+ * slices back to each requester.  Requests that were staged but not merged
+ * keep their priority and arrival order.
+ */
+
+#include "modbus_master_async.h"
+#include "modbus_master_internal.h"
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#include "core_types.h"
+#include "logger_component.h"
+#include "sdkconfig.h"
+#include "utils.h"
+
+static const char* TAG = "MODBUS_BUS";
+
+#define MERGE_MAX_REGS 125  /* FC03/FC04 limit */
+
+#if CONFIG_MODBUS_READ_MERGE_ENABLE
+#define STAGING_SIZE CONFIG_MODBUS_READ_MERGE_LOOKAHEAD
+#else
+#define STAGING_SIZE 1
+#endif
+
+typedef struct
+{
+    QueueHandle_t queues[MODBUS_PRIORITY_COUNT];
+    TaskHandle_t task_handle;
+    volatile bool running;
+    int64_t last_frame_end_us;  // End of the previous transaction, for the t3.5 gap
+
+    /* Requests pulled from the queues while looking for reads to merge, in arrival order */
+    modbus_request_t staged[STAGING_SIZE];
+    uint8_t staged_count;
+    volatile uint8_t staged_per_priority[MODBUS_PRIORITY_COUNT];
+
+    modbus_request_t merged[STAGING_SIZE + 1];
+    uint16_t merge_buffer[MERGE_MAX_REGS];
+} modbus_bus_ctx_t;
+
+static modbus_bus_ctx_t bus_ctx = {0};
+
+static const task_config_t bus_task_config = {
+    .task_name = CONFIG_MODBUS_BUS_TASK_NAME,
+    .stack_size = CONFIG_MODBUS_BUS_TASK_STACK_SIZE,
+    .task_priority = CONFIG_MODBUS_BUS_TASK_PRIORITY,
+};
+
+/* =========================================================================
+ *  Bus timing
+ * ========================================================================= */
+static void wait_inter_frame_gap(const modbus_bus_ctx_t* ctx)
+{
+    const int64_t ready_us = ctx->last_frame_end_us + modbus_master_get_frame_gap_us();
+    const int64_t now_us = esp_timer_get_time();
+    if (now_us >= ready_us)
+    {
+        return;
+    }
+
+    const uint32_t remaining_us = (uint32_t)(ready_us - now_us);
+    if (remaining_us >= portTICK_PERIOD_MS * 1000U)
+    {
+        vTaskDelay(pdMS_TO_TICKS(remaining_us / 1000U));
+    }
+    else
+    {
+        esp_rom_delay_us(remaining_us);
+    }
+}
+
+/* =========================================================================
+ *  Completion
+ * ========================================================================= */
+static void complete_request(const modbus_request_t* request, const esp_err_t result)
+{
+    if (request->result != NULL)
+    {
+        *request->result = result;
+    }
+    if (request->callback != NULL)
+    {
+        request->callback(request, result);
+    }
+    if (request->notify_task != NULL)
+    {
+        xTaskNotify(request->notify_task, request->notify_bits, eSetBits);
+    }
+}
+
+/* =========================================================================
+ *  Staging
+ * ========================================================================= */
+static void unstage(modbus_bus_ctx_t* ctx, const uint8_t index, modbus_request_t* request)
+{
+    *request = ctx->staged[index];
+    ctx->staged_per_priority[request->priority]--;
+    ctx->staged_count--;
+    memmove(&ctx->staged[index], &ctx->staged[index + 1],
+            (size_t)(ctx->staged_count - index) * sizeof(modbus_request_t));
+}
+
+/**
+ * @brief Pull waiting requests into the staging area, highest priority first.
+ */
+static void fill_staging(modbus_bus_ctx_t* ctx)
+{
+    for (int p = 0; p < MODBUS_PRIORITY_COUNT && ctx->staged_count < STAGING_SIZE; p++)
+    {
+        while (ctx->staged_count < STAGING_SIZE &&
+               xQueueReceive(ctx->queues[p], &ctx->staged[ctx->staged_count], 0) == pdTRUE)
+        {
+            ctx->staged_per_priority[p]++;
+            ctx->staged_count++;
+        }
+    }
+}
+
+/**
+ * @brief Highest priority request; staged requests are older than queued ones of the same priority.
+ */
+static bool next_request(modbus_bus_ctx_t* ctx, modbus_request_t* request)
+{
+    for (int p = 0; p < MODBUS_PRIORITY_COUNT; p++)
+    {
+        for (uint8_t i = 0; i < ctx->staged_count; i++)
+        {
+            if (ctx->staged[i].priority == (modbus_priority_t)p)
+            {
+                unstage(ctx, i, request);
+                return true;
+            }
+        }
+        if (xQueueReceive(ctx->queues[p], request, 0) == pdTRUE)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* =========================================================================
+ *  Transactions
+ * ========================================================================= */
+static bool is_register_read(const mb_function_code_t command)
+{
+    return command == MB_FUNC_READ_HOLDING_REGISTER || command == MB_FUNC_READ_INPUT_REGISTER;
+}
+
+static esp_err_t run_transaction(modbus_bus_ctx_t* ctx, const uint8_t slave_addr, const mb_function_code_t command,
+                                 const uint16_t reg_start, const uint16_t reg_count, void* data)
+{
+    wait_inter_frame_gap(ctx);
+    const int64_t start_us = esp_timer_get_time();
+    const esp_err_t result = modbus_master_execute(slave_addr, command, reg_start, reg_count, data);
+    ctx->last_frame_end_us = esp_timer_get_time();
+
+    const uint32_t rtt_us = (uint32_t)(ctx->last_frame_end_us - start_us);
+    modbus_health_record(slave_addr, result, rtt_us, ctx->last_frame_end_us);
+    modbus_stats_record(slave_addr, command, reg_count, result, rtt_us, ctx->last_frame_end_us);
+    if (is_register_read(command))
+    {
+        modbus_stats_record_reads(0, 1);
+    }
+    return result;
+}
+
+static bool admit(const modbus_request_t* request)
+{
+    if (modbus_health_admit(request->slave_addr, esp_timer_get_time()))
+    {
+        return true;
+    }
+
+    /* Circuit open — fail fast instead of spending a response timeout on a dead slave */
+    modbus_stats_record_rejected(request->slave_addr, request->command);
+    complete_request(request, ESP_ERR_INVALID_STATE);
+    return false;
+}
+
+#if CONFIG_MODBUS_READ_MERGE_ENABLE
+/**
+ * @brief Give producers that submit a batch (e.g. one poll period) the chance
+ *        to finish before an idle bus starts on the first request.
+ *
+ * Only normal and low priority reads wait, and only once another request is
+ * already staged: a lone read has nothing to merge with.
+ */
+static void wait_merge_window(modbus_bus_ctx_t* ctx, const modbus_request_t* request)
+{
+#if CONFIG_MODBUS_READ_MERGE_WINDOW_MS > 0
+    if (request->priority == MODBUS_PRIORITY_HIGH || ctx->staged_count == 0)
+    {
+        return;
+    }
+    const int64_t idle_us = esp_timer_get_time() - ctx->last_frame_end_us;
+    if (idle_us > (int64_t)CONFIG_MODBUS_READ_MERGE_WINDOW_MS * 1000)
+    {
+        const TickType_t ticks = pdMS_TO_TICKS(CONFIG_MODBUS_READ_MERGE_WINDOW_MS);
+        vTaskDelay(ticks > 0 ? ticks : 1);
+        fill_staging(ctx);
+    }
+#else
+    (void)ctx;
+    (void)request;
+#endif
+}
+
+/**
+ * @brief Move every staged read that extends the span of ctx->merged[0] into ctx->merged.
+ *
+ * @return Number of merged requests, including the first one.
+ */
+static uint8_t collect_mergeable(modbus_bus_ctx_t* ctx, uint16_t* span_start, uint16_t* span_count)
+{
+    const modbus_request_t* first = &ctx->merged[0];
+    uint32_t lo = first->reg_start;
+    uint32_t hi = lo + first->reg_count;
+    uint8_t count = 1;
+
+    bool grown = true;
+    while (grown)
+    {
+        grown = false;
+        uint8_t i = 0;
+        while (i < ctx->staged_count)
+        {
+            const modbus_request_t* candidate = &ctx->staged[i];
+            const uint32_t start = candidate->reg_start;
+            const uint32_t end = start + candidate->reg_count;
+            const uint32_t new_lo = start < lo ? start : lo;
+            const uint32_t new_hi = end > hi ? end : hi;
+
+            if (candidate->slave_addr != first->slave_addr || candidate->command != first->command ||
+                start > hi + CONFIG_MODBUS_READ_MERGE_MAX_GAP || end + CONFIG_MODBUS_READ_MERGE_MAX_GAP < lo ||
+                new_hi - new_lo > MERGE_MAX_REGS)
+            {
+                i++;
+                continue;
+            }
+
+            /* unstage() shifts the rest down, so index i now holds the next candidate */
+            unstage(ctx, i, &ctx->merged[count++]);
+            lo = new_lo;
+            hi = new_hi;
+            grown = true;
+        }
+    }
+
+    *span_start = (uint16_t)lo;
+    *span_count = (uint16_t)(hi - lo);
+    return count;
+}
+
+static void serve_reads(modbus_bus_ctx_t* ctx, const modbus_request_t* request)
+{
+    fill_staging(ctx);
+    wait_merge_window(ctx, request);
+
+    ctx->merged[0] = *request;
+    uint16_t span_start = 0;
+    uint16_t span_count = 0;
+    const uint8_t count = collect_mergeable(ctx, &span_start, &span_count);
+    modbus_stats_record_reads(count, 0);
+    if (count == 1)
+    {
+        const esp_err_t result = run_transaction(ctx, request->slave_addr, request->command, request->reg_start,
+                                                 request->reg_count, request->data);
+        complete_request(request, result);
+        return;
+    }
+
+    const esp_err_t result = run_transaction(ctx, request->slave_addr, request->command, span_start, span_count,
+                                             ctx->merge_buffer);
+
+    if (result == ESP_OK)
+    {
+        for (uint8_t i = 0; i < count; i++)
+        {
+            const modbus_request_t* merged = &ctx->merged[i];
+            memcpy(merged->data, &ctx->merge_buffer[merged->reg_start - span_start],
+                   merged->reg_count * sizeof(uint16_t));
+            complete_request(merged, ESP_OK);
+        }
+        return;
+    }
+
+    if (result == ESP_ERR_TIMEOUT || result == ESP_ERR_INVALID_STATE)
+    {
+        /* The slave is not answering — retrying each range would only multiply the timeout */
+        for (uint8_t i = 0; i < count; i++)
+        {
+            complete_request(&ctx->merged[i], result);
+        }
+        return;
+    }
+
+    /* Exception or bad frame for the span: one of the ranges may be invalid, isolate it */
+    LOGGER_LOG_DEBUG(TAG, "Merged read of slave %d regs %d..%d failed (%s), retrying %d reads separately",
+                     request->slave_addr, span_start, span_start + span_count - 1, esp_err_to_name(result), count);
+    for (uint8_t i = 0; i < count; i++)
+    {
+        const modbus_request_t* merged = &ctx->merged[i];
+        if (!admit(merged))
+        {
+            continue;
+        }
+        complete_request(merged, run_transaction(ctx, merged->slave_addr, merged->command, merged->reg_start,
+                                                 merged->reg_count, merged->data));
+    }
+}
+#endif // CONFIG_MODBUS_READ_MERGE_ENABLE
+
+static void modbus_bus_task(void* args)
+{
+    modbus_bus_ctx_t* ctx = (modbus_bus_ctx_t*)args;
+    modbus_request_t request;
+
+    LOGGER_LOG_INFO(TAG, "Modbus bus task started (frame gap %lu us)",
+                    (unsigned long)modbus_master_get_frame_gap_us());
+
+    while (ctx->running)
+    {
+        if (!next_request(ctx, &request))
+        {
+            /* Wake once per stats window while idle so the window still rolls */
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CONFIG_MODBUS_STATS_WINDOW_MS));
+            modbus_stats_periodic(esp_timer_get_time());
+            continue;
+        }
+
+        if (!admit(&request))
+        {
+            continue;
+        }
+
+#if CONFIG_MODBUS_READ_MERGE_ENABLE
+        if (is_register_read(request.command))
+        {
+            serve_reads(ctx, &request);
+        }
+        else
+#endif
+        {
+            if (is_register_read(request.command))
+            {
+                modbus_stats_record_reads(1, 0);
+            }
+            complete_request(&request, run_transaction(ctx, request.slave_addr, request.command, request.reg_start,
+                                                       request.reg_count, request.data));
+        }
+        modbus_stats_periodic(ctx->last_frame_end_us);
+    }
+
+    /* Nobody may be left waiting on a request that will never run */
+    while (next_request(ctx, &request))
+    {
+        complete_request(&request, ESP_ERR_INVALID_STATE);
+    }
+
+    LOGGER_LOG_INFO(TAG, "Modbus bus task stopping");
+    ctx->task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+/* =========================================================================
+ *  Lifecycle
+ * ========================================================================= */
+esp_err_t init_bus_task(void)
+{
+    if (bus_ctx.running)
+    {
+        return ESP_OK;
+    }
+
+    CHECK_ERR_LOG_RET(init_slave_health(), "Failed to initialize slave health tracking");
+    CHECK_ERR_LOG_RET(init_master_stats(), "Failed to initialize Modbus statistics");
+
+    for (int p = 0; p < MODBUS_PRIORITY_COUNT; p++)
+    {
+        if (bus_ctx.queues[p] == NULL)
+        {
+            bus_ctx.queues[p] = xQueueCreate(CONFIG_MODBUS_BUS_QUEUE_LENGTH, sizeof(modbus_request_t));
+            if (bus_ctx.queues[p] == NULL)
+            {
+                LOGGER_LOG_ERROR(TAG, "Failed to create Modbus request queue %d", p);
+                return ESP_ERR_NO_MEM;
+            }
+        }
+    }
+
+    bus_ctx.running = true;
+
+    CHECK_ERR_LOG_CALL_RET(xTaskCreate(
+                               modbus_bus_task,
+                               bus_task_config.task_name,
+                               bus_task_config.stack_size,
+                               &bus_ctx,
+                               bus_task_config.task_priority,
+                               &bus_ctx.task_handle) == pdPASS
+                           ? ESP_OK
+                           : ESP_FAIL,
+                           bus_ctx.running = false,
+                           "Failed to create Modbus bus task");
+
+    return ESP_OK;
+}
+
+esp_err_t shutdown_bus_task(void)
+{
+    if (!bus_ctx.running)
+    {
+        return ESP_OK;
+    }
+
+    bus_ctx.running = false;
+    if (bus_ctx.task_handle != NULL)
+    {
+        xTaskNotifyGive(bus_ctx.task_handle);
+    }
+
+    /* The master handle is deleted right after this — wait for the in-flight transaction */
+    for (int i = 0; i < CONFIG_MODBUS_BUS_SHUTDOWN_TIMEOUT_MS / 10 && bus_ctx.task_handle != NULL; i++)
+    {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    if (bus_ctx.task_handle != NULL)
+    {
+        LOGGER_LOG_ERROR(TAG, "Modbus bus task did not stop in time");
+        return ESP_ERR_TIMEOUT;
+    }
+
+    return ESP_OK;
+}
+
+bool modbus_bus_task_is_current(void)
+{
+    return bus_ctx.task_handle != NULL && xTaskGetCurrentTaskHandle() == bus_ctx.task_handle;
+}
+
+/* =========================================================================
+ *  Public API
+ * ========================================================================= */
+esp_err_t modbus_master_submit(const modbus_request_t* request, const TickType_t ticks_to_wait)
+{
+    if (request == NULL || request->priority >= MODBUS_PRIORITY_COUNT ||
+        request->reg_count == 0 || request->data == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!bus_ctx.running)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (xQueueSend(bus_ctx.queues[request->priority], request, ticks_to_wait) != pdTRUE)
+    {
+        LOGGER_LOG_WARN(TAG, "Request queue %d full, dropping request for slave %d",
+                        request->priority, request->slave_addr);
+        return ESP_ERR_TIMEOUT;
+    }
+
+    xTaskNotifyGive(bus_ctx.task_handle);
+    return ESP_OK;
+}
+
+uint32_t modbus_master_get_queue_depth(const modbus_priority_t priority)
+{
+    if (priority >= MODBUS_PRIORITY_COUNT || bus_ctx.queues[priority] == NULL)
+    {
+        return 0;
+    }
+    return (uint32_t)uxQueueMessagesWaiting(bus_ctx.queues[priority]) + bus_ctx.staged_per_priority[priority];
+}
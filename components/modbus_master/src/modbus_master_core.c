@@ -2,15 +2,19 @@
 // Created by vesko on 3.3.2026 г..
 //
 #include "esp_err.h"
-#include "esp_modbus_common.h"
-#include "esp_modbus_master.h"
 #include "logger_component.h"
 #include "modbus_master.h"
+#include "modbus_master_async.h"
+#include "modbus_master_internal.h"
+#include "modbus_rtu.h"
 #include "utils.h"
+#include "sdkconfig.h"
+#include "freertos/semphr.h"
 
 static const char* TAG = "MODBUS_MASTER";
 
-static void* master_handle;
+static bool master_started;
+static uint32_t master_baud_rate;
 
 esp_err_t modbus_master_init(const modbus_config_t* config)
 {
@@ -21,69 +25,66 @@ esp_err_t modbus_master_init(const modbus_config_t* config)
         return ESP_ERR_INVALID_ARG;
     }
 
-    mb_communication_info_t comm_info = {
-        .ser_opts.port = config->uart_num,
-        .ser_opts.mode = MB_RTU,
-        .ser_opts.baudrate = config->baud_rate,
-        .ser_opts.parity = MB_PARITY_NONE,
-        .ser_opts.data_bits = UART_DATA_8_BITS,
-        .ser_opts.stop_bits = UART_STOP_BITS_1,
-        .ser_opts.uid = 0,
-        .ser_opts.response_tout_ms = 1000,
-    };
-
-    CHECK_ERR_LOG_CALL_RET(mbc_master_create_serial(&comm_info, &master_handle),
-                           modbus_master_shutdown(),
-                           "Failed to create Modbus master");
-    if (master_handle == NULL)
-    {
-        LOGGER_LOG_ERROR(TAG, "Failed to create Modbus master: %d");
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    CHECK_ERR_LOG_CALL_RET(
-        uart_set_pin(config->uart_num, config->tx_pin, config->rx_pin, config->de_pin, UART_PIN_NO_CHANGE),
-        modbus_master_shutdown(),
-        "Failed to set UART pins");
-
-    CHECK_ERR_LOG_CALL_RET(
-        uart_set_mode(config->uart_num, UART_MODE_RS485_HALF_DUPLEX),
-        modbus_master_shutdown(),
-        "Failed to set UART mode"
-    );
+    CHECK_ERR_LOG_RET(modbus_backend_init(config),
+                      "Failed to start Modbus backend");
+    master_started = true;
 
-    vTaskDelay(pdMS_TO_TICKS(5)); // Let the UART settle
-
-    CHECK_ERR_LOG_CALL_RET(mbc_master_start(master_handle),
-                           modbus_master_shutdown(),
-                           "Failed to start Modbus master");
-
-    LOGGER_LOG_INFO(TAG, "Modbus master initialized on UART%d (TX=%d, RX=%d, DE=%d, baud=%d)",
+    LOGGER_LOG_INFO(TAG, "Modbus master initialized on UART%d (TX=%d, RX=%d, DE=%d, baud=%d, backend %s)",
                     config->uart_num,
                     config->tx_pin,
                     config->rx_pin,
                     config->de_pin,
-                    config->baud_rate);
+                    config->baud_rate,
+                    modbus_backend_name());
+
+    master_baud_rate = config->baud_rate;
+
+    CHECK_ERR_LOG_CALL_RET(init_bus_task(),
+                           modbus_master_shutdown(),
+                           "Failed to start Modbus bus task");
+
+    CHECK_ERR_LOG_CALL_RET(init_poll_scheduler(),
+                           modbus_master_shutdown(),
+                           "Failed to start Modbus poll scheduler");
 
     return ESP_OK;
 }
 
 esp_err_t modbus_master_shutdown(void)
 {
-    if (master_handle == NULL)
+    if (!master_started)
     {
         return ESP_OK;
     }
 
-    CHECK_ERR_LOG_RET(mbc_master_stop(master_handle),
-                      "Failed to stop Modbus master");
-    CHECK_ERR_LOG_RET(mbc_master_delete(master_handle),
-                      "Failed to delete Modbus master");
+    CHECK_ERR_LOG_RET(shutdown_poll_scheduler(),
+                      "Failed to stop Modbus poll scheduler");
+    CHECK_ERR_LOG_RET(shutdown_bus_task(),
+                      "Failed to stop Modbus bus task");
+    CHECK_ERR_LOG_RET(modbus_backend_shutdown(),
+                      "Failed to stop Modbus backend");
+    master_started = false;
 
     LOGGER_LOG_INFO(TAG, "Modbus transport shutdown complete");
     return ESP_OK;
 }
 
+static void request_done_cb(const modbus_request_t* request, esp_err_t result)
+{
+    (void)result;
+    xSemaphoreGive((SemaphoreHandle_t)request->user_ctx);
+}
+
+uint32_t modbus_master_get_baud_rate(void)
+{
+    return master_baud_rate;
+}
+
+uint32_t modbus_master_get_frame_gap_us(void)
+{
+    return modbus_rtu_frame_gap_us(master_baud_rate);
+}
+
 esp_err_t modbus_master_read_register(uint8_t slave_addr,
                                       uint16_t reg,
                                       uint16_t* dest)
@@ -122,12 +123,47 @@ esp_err_t modbus_master_send_request_raw(uint8_t slave_addr,
                                          void* data)
 
 {
-    mb_param_request_t request = {
+    if (modbus_bus_task_is_current())
+    {
+        /* Called from a completion callback — queueing would deadlock */
+        return modbus_master_execute(slave_addr, command, reg_start, reg_size, data);
+    }
+
+    StaticSemaphore_t done_buffer;
+    SemaphoreHandle_t done = xSemaphoreCreateBinaryStatic(&done_buffer);
+    esp_err_t result = ESP_FAIL;
+
+    const modbus_request_t request = {
         .slave_addr = slave_addr,
         .command = command,
         .reg_start = reg_start,
-        .reg_size = reg_size
+        .reg_count = reg_size,
+        .data = data,
+        .priority = MODBUS_PRIORITY_NORMAL,
+        .callback = request_done_cb,
+        .user_ctx = done,
+        .result = &result,
     };
 
-    return mbc_master_send_request(master_handle, &request, data);
-}
\ No newline at end of file
+    CHECK_ERR_LOG_RET_FMT(modbus_master_submit(&request, portMAX_DELAY),
+                          "Failed to queue request for slave %d", slave_addr);
+
+    /* The bus task always completes a queued request (the esp_modbus response
+     * timeout bounds it), so waiting forever cannot outlive done_buffer. */
+    xSemaphoreTake(done, portMAX_DELAY);
+    return result;
+}
+
+esp_err_t modbus_master_execute(uint8_t slave_addr,
+                                mb_function_code_t command,
+                                uint16_t reg_start,
+                                uint16_t reg_count,
+                                void* data)
+{
+    if (!master_started)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    return modbus_backend_execute(slave_addr, command, reg_start, reg_count, data);
+}
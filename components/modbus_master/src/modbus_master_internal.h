@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "modbus_master.h"
+
+// ----------------------------
+// Bus timing
+// ----------------------------
+/**
+ * @brief RTU t3.5 inter-frame gap for the configured baud rate.
+ *
+ * Per the Modbus serial line spec the gap is fixed at 1750 us above 19200 baud.
+ */
+uint32_t modbus_master_get_frame_gap_us(void);
+
+uint32_t modbus_master_get_baud_rate(void);
+
+// ----------------------------
+// Poll scheduler
+// ----------------------------
+esp_err_t init_poll_scheduler(void);
+esp_err_t shutdown_poll_scheduler(void);
+
+// ----------------------------
+// Backend (esp_modbus or the native RTU engine, selected in Kconfig)
+// ----------------------------
+esp_err_t modbus_backend_init(const modbus_config_t* config);
+
+esp_err_t modbus_backend_shutdown(void);
+
+esp_err_t modbus_backend_execute(uint8_t slave_addr, mb_function_code_t command, uint16_t reg_start,
+                                 uint16_t reg_count, void* data);
+
+const char* modbus_backend_name(void);
+
+// ----------------------------
+// Slave health
+// ----------------------------
+esp_err_t init_slave_health(void);
+
+/**
+ * @brief Ask whether a request to @p slave_addr may go on the bus now.
+ *
+ * Moves an open circuit to half-open once its probe time has come.
+ */
+bool modbus_health_admit(uint8_t slave_addr, int64_t now_us);
+
+void modbus_health_record(uint8_t slave_addr, esp_err_t result, uint32_t rtt_us, int64_t now_us);
+
+uint32_t modbus_health_get_timeout_ms(uint8_t slave_addr);
+
+// ----------------------------
+// Statistics
+// ----------------------------
+esp_err_t init_master_stats(void);
+
+void modbus_stats_record(uint8_t slave_addr, mb_function_code_t command, uint16_t reg_count,
+                         esp_err_t result, uint32_t rtt_us, int64_t now_us);
+
+void modbus_stats_record_rejected(uint8_t slave_addr, mb_function_code_t command);
+
+/**
+ * @brief Count register reads served and the bus round trips they took (differ when reads are merged).
+ */
+void modbus_stats_record_reads(uint16_t requests, uint16_t round_trips);
+
+/**
+ * @brief Roll the rate window and do the periodic log dump, called from the bus task.
+ */
+void modbus_stats_periodic(int64_t now_us);
+
+// ----------------------------
+// Bus task
+// ----------------------------
+esp_err_t init_bus_task(void);
+esp_err_t shutdown_bus_task(void);
+
+/**
+ * @brief True when called from the bus task itself (e.g. inside a completion callback).
+ */
+bool modbus_bus_task_is_current(void);
+
+/**
+ * @brief Run one transaction on the wire. Only the bus task may call this.
+ */
+esp_err_t modbus_master_execute(uint8_t slave_addr, mb_function_code_t command, uint16_t reg_start,
+                                uint16_t reg_count, void* data);
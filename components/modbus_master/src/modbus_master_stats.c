@@ -0,0 +1,379 @@
+/**
+ * @file modbus_master_stats.c
+ * @brief Bus telemetry recorded by the bus task.
+ */
+
+#include "modbus_master_stats.h"
+#include "modbus_master_async.h"
+#include "modbus_master_internal.h"
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "logger_component.h"
+#include "sdkconfig.h"
+
+static const char* TAG = "MODBUS_STATS";
+
+#define RTU_CHAR_BITS 11  /* start + 8 data + parity/stop + stop */
+
+static const uint32_t rtt_bucket_limits_ms[MODBUS_STATS_RTT_BUCKETS - 1] = MODBUS_STATS_RTT_BUCKET_LIMITS_MS;
+
+typedef struct
+{
+    modbus_slave_stats_t slaves[CONFIG_MODBUS_STATS_MAX_SLAVES];
+    uint8_t slave_count;
+    SemaphoreHandle_t lock;
+
+    /* Current window accumulators */
+    int64_t window_start_us;
+    uint64_t window_busy_us;
+    uint64_t window_bytes;
+    uint32_t window_transactions;
+    uint32_t window_read_requests;
+    uint32_t window_read_round_trips;
+
+    /* Last completed window */
+    modbus_bus_stats_t bus;
+    int64_t last_dump_us;
+} modbus_stats_ctx_t;
+
+static modbus_stats_ctx_t stats_ctx = {0};
+
+/* =========================================================================
+ *  Helpers
+ * ========================================================================= */
+static modbus_stats_fc_t classify_function(const mb_function_code_t command)
+{
+    switch (command)
+    {
+    case MB_FUNC_READ_HOLDING_REGISTER: return MODBUS_STATS_FC_READ_HOLDING;
+    case MB_FUNC_READ_INPUT_REGISTER: return MODBUS_STATS_FC_READ_INPUT;
+    case MB_FUNC_WRITE_SINGLE_REGISTER: return MODBUS_STATS_FC_WRITE_SINGLE;
+    case MB_FUNC_WRITE_MULTIPLE_REGISTERS: return MODBUS_STATS_FC_WRITE_MULTIPLE;
+    default: return MODBUS_STATS_FC_OTHER;
+    }
+}
+
+static const char* function_name(const modbus_stats_fc_t fc)
+{
+    static const char* names[MODBUS_STATS_FC_COUNT] = {"RD_HOLD", "RD_INPUT", "WR_SINGLE", "WR_MULTI", "OTHER"};
+    return names[fc];
+}
+
+/**
+ * @brief RTU frame sizes (address + PDU + CRC) for a request and its normal response.
+ */
+static void frame_sizes(const mb_function_code_t command, const uint16_t count, uint32_t* tx, uint32_t* rx)
+{
+    const uint32_t coil_bytes = (count + 7U) / 8U;
+    switch (command)
+    {
+    case MB_FUNC_READ_COILS:
+    case MB_FUNC_READ_DISCRETE_INPUTS:
+        *tx = 8;
+        *rx = 5 + coil_bytes;
+        break;
+    case MB_FUNC_READ_HOLDING_REGISTER:
+    case MB_FUNC_READ_INPUT_REGISTER:
+        *tx = 8;
+        *rx = 5 + 2U * count;
+        break;
+    case MB_FUNC_WRITE_MULTIPLE_COILS:
+        *tx = 9 + coil_bytes;
+        *rx = 8;
+        break;
+    case MB_FUNC_WRITE_MULTIPLE_REGISTERS:
+        *tx = 9 + 2U * count;
+        *rx = 8;
+        break;
+    default:
+        *tx = 8;
+        *rx = 8;
+        break;
+    }
+}
+
+static modbus_slave_stats_t* get_or_create_slave(const uint8_t slave_addr)
+{
+    for (uint8_t i = 0; i < stats_ctx.slave_count; i++)
+    {
+        if (stats_ctx.slaves[i].slave_addr == slave_addr)
+        {
+            return &stats_ctx.slaves[i];
+        }
+    }
+    if (stats_ctx.slave_count == CONFIG_MODBUS_STATS_MAX_SLAVES)
+    {
+        return NULL;
+    }
+
+    modbus_slave_stats_t* slave = &stats_ctx.slaves[stats_ctx.slave_count++];
+    memset(slave, 0, sizeof(*slave));
+    slave->slave_addr = slave_addr;
+    return slave;
+}
+
+static void roll_window(const int64_t now_us)
+{
+    const int64_t window_us = now_us - stats_ctx.window_start_us;
+    if (window_us < (int64_t)CONFIG_MODBUS_STATS_WINDOW_MS * 1000)
+    {
+        return;
+    }
+
+    const uint32_t baud = modbus_master_get_baud_rate();
+    const double wire_us = baud > 0 ? (double)stats_ctx.window_bytes * RTU_CHAR_BITS * 1e6 / baud : 0.0;
+
+    stats_ctx.bus.window_ms = (uint32_t)(window_us / 1000);
+    stats_ctx.bus.bus_busy_pct = (float)(100.0 * (double)stats_ctx.window_busy_us / (double)window_us);
+    stats_ctx.bus.wire_pct = (float)(100.0 * wire_us / (double)window_us);
+    stats_ctx.bus.transactions_per_sec = (float)stats_ctx.window_transactions * 1e6f / (float)window_us;
+    stats_ctx.bus.read_requests = stats_ctx.window_read_requests;
+    stats_ctx.bus.read_round_trips = stats_ctx.window_read_round_trips;
+
+    stats_ctx.window_start_us = now_us;
+    stats_ctx.window_busy_us = 0;
+    stats_ctx.window_bytes = 0;
+    stats_ctx.window_transactions = 0;
+    stats_ctx.window_read_requests = 0;
+    stats_ctx.window_read_round_trips = 0;
+}
+
+/* =========================================================================
+ *  Bus task hooks
+ * ========================================================================= */
+esp_err_t init_master_stats(void)
+{
+    if (stats_ctx.lock == NULL)
+    {
+        stats_ctx.lock = xSemaphoreCreateMutex();
+        if (stats_ctx.lock == NULL)
+        {
+            LOGGER_LOG_ERROR(TAG, "Failed to create Modbus stats mutex");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    stats_ctx.window_start_us = esp_timer_get_time();
+    stats_ctx.last_dump_us = stats_ctx.window_start_us;
+    return ESP_OK;
+}
+
+void modbus_stats_record(const uint8_t slave_addr, const mb_function_code_t command, const uint16_t reg_count,
+                         const esp_err_t result, const uint32_t rtt_us, const int64_t now_us)
+{
+    uint32_t tx = 0, rx = 0;
+    frame_sizes(command, reg_count, &tx, &rx);
+
+    xSemaphoreTake(stats_ctx.lock, portMAX_DELAY);
+    modbus_slave_stats_t* slave = get_or_create_slave(slave_addr);
+    if (slave != NULL)
+    {
+        modbus_fc_stats_t* fc = &slave->fc[classify_function(command)];
+        fc->requests++;
+        switch (result)
+        {
+        case ESP_OK:
+            fc->ok++;
+            break;
+        case ESP_ERR_TIMEOUT:
+            fc->timeouts++;
+            rx = 0;
+            break;
+        case ESP_ERR_INVALID_RESPONSE:
+        case ESP_ERR_INVALID_CRC:
+            fc->crc_errors++;
+            break;
+        default:
+            /* esp_modbus reports slave exceptions as ESP_FAIL / ESP_ERR_NOT_SUPPORTED */
+            fc->exceptions++;
+            rx = 5;
+            break;
+        }
+        fc->bytes_tx += tx;
+        fc->bytes_rx += rx;
+
+        if (rtt_us > fc->rtt_max_us)
+        {
+            fc->rtt_max_us = rtt_us;
+        }
+        uint8_t bucket = 0;
+        while (bucket < MODBUS_STATS_RTT_BUCKETS - 1 && rtt_us >= rtt_bucket_limits_ms[bucket] * 1000U)
+        {
+            bucket++;
+        }
+        fc->rtt_histogram[bucket]++;
+    }
+
+    stats_ctx.window_busy_us += rtt_us;
+    stats_ctx.window_bytes += tx + rx;
+    stats_ctx.window_transactions++;
+    roll_window(now_us);
+    xSemaphoreGive(stats_ctx.lock);
+}
+
+void modbus_stats_record_rejected(const uint8_t slave_addr, const mb_function_code_t command)
+{
+    xSemaphoreTake(stats_ctx.lock, portMAX_DELAY);
+    modbus_slave_stats_t* slave = get_or_create_slave(slave_addr);
+    if (slave != NULL)
+    {
+        slave->fc[classify_function(command)].rejected++;
+    }
+    xSemaphoreGive(stats_ctx.lock);
+}
+
+void modbus_stats_record_reads(const uint16_t requests, const uint16_t round_trips)
+{
+    xSemaphoreTake(stats_ctx.lock, portMAX_DELAY);
+    stats_ctx.window_read_requests += requests;
+    stats_ctx.window_read_round_trips += round_trips;
+    xSemaphoreGive(stats_ctx.lock);
+}
+
+void modbus_stats_periodic(const int64_t now_us)
+{
+    /* Close the window even when no transaction completes, so an idle bus reads as idle */
+    xSemaphoreTake(stats_ctx.lock, portMAX_DELAY);
+    roll_window(now_us);
+    xSemaphoreGive(stats_ctx.lock);
+
+#if CONFIG_MODBUS_STATS_DUMP_INTERVAL_MS > 0
+    if (now_us - stats_ctx.last_dump_us < (int64_t)CONFIG_MODBUS_STATS_DUMP_INTERVAL_MS * 1000)
+    {
+        return;
+    }
+    stats_ctx.last_dump_us = now_us;
+    modbus_master_dump_stats();
+#else
+    (void)now_us;
+#endif
+}
+
+/* =========================================================================
+ *  Public API
+ * ========================================================================= */
+esp_err_t modbus_master_get_bus_stats(modbus_bus_stats_t* stats)
+{
+    if (stats == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (stats_ctx.lock == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(stats_ctx.lock, portMAX_DELAY);
+    roll_window(esp_timer_get_time());
+    *stats = stats_ctx.bus;
+    stats->slave_count = stats_ctx.slave_count;
+    xSemaphoreGive(stats_ctx.lock);
+
+    for (int p = 0; p < MODBUS_PRIORITY_COUNT; p++)
+    {
+        stats->queued[p] = modbus_master_get_queue_depth((modbus_priority_t)p);
+    }
+    return ESP_OK;
+}
+
+esp_err_t modbus_master_get_slave_stats(const uint8_t slave_addr, modbus_slave_stats_t* stats)
+{
+    if (stats == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (stats_ctx.lock == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    xSemaphoreTake(stats_ctx.lock, portMAX_DELAY);
+    for (uint8_t i = 0; i < stats_ctx.slave_count; i++)
+    {
+        if (stats_ctx.slaves[i].slave_addr == slave_addr)
+        {
+            *stats = stats_ctx.slaves[i];
+            err = ESP_OK;
+            break;
+        }
+    }
+    xSemaphoreGive(stats_ctx.lock);
+
+    return err;
+}
+
+esp_err_t modbus_master_reset_stats(void)
+{
+    if (stats_ctx.lock == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(stats_ctx.lock, portMAX_DELAY);
+    stats_ctx.slave_count = 0;
+    memset(&stats_ctx.bus, 0, sizeof(stats_ctx.bus));
+    stats_ctx.window_start_us = esp_timer_get_time();
+    stats_ctx.window_busy_us = 0;
+    stats_ctx.window_bytes = 0;
+    stats_ctx.window_transactions = 0;
+    stats_ctx.window_read_requests = 0;
+    stats_ctx.window_read_round_trips = 0;
+    xSemaphoreGive(stats_ctx.lock);
+
+    return ESP_OK;
+}
+
+void modbus_master_dump_stats(void)
+{
+    if (stats_ctx.lock == NULL)
+    {
+        return;
+    }
+
+    modbus_bus_stats_t bus;
+    modbus_master_get_bus_stats(&bus);
+
+    LOGGER_LOG_INFO(TAG, "═══════════════ Modbus bus statistics ═══════════════");
+    LOGGER_LOG_INFO(TAG, "baud %lu, window %lu ms: busy %.1f%%, wire %.1f%%, %.1f txn/s, queued %lu/%lu/%lu",
+                    (unsigned long)modbus_master_get_baud_rate(), (unsigned long)bus.window_ms,
+                    bus.bus_busy_pct, bus.wire_pct, bus.transactions_per_sec,
+                    (unsigned long)bus.queued[0], (unsigned long)bus.queued[1], (unsigned long)bus.queued[2]);
+    LOGGER_LOG_INFO(TAG, "reads: %lu requested, %lu round trips (%.2f reads per trip)",
+                    (unsigned long)bus.read_requests, (unsigned long)bus.read_round_trips,
+                    bus.read_round_trips > 0 ? (double)bus.read_requests / bus.read_round_trips : 0.0);
+
+    for (uint8_t i = 0; i < bus.slave_count; i++)
+    {
+        modbus_slave_stats_t slave;
+        xSemaphoreTake(stats_ctx.lock, portMAX_DELAY);
+        slave = stats_ctx.slaves[i];
+        xSemaphoreGive(stats_ctx.lock);
+
+        for (int f = 0; f < MODBUS_STATS_FC_COUNT; f++)
+        {
+            const modbus_fc_stats_t* fc = &slave.fc[f];
+            if (fc->requests == 0 && fc->rejected == 0)
+            {
+                continue;
+            }
+            LOGGER_LOG_INFO(TAG, "slave %3d %-9s req %lu ok %lu tmo %lu crc %lu exc %lu rej %lu "
+                            "tx %llu B rx %llu B max %lu us",
+                            slave.slave_addr, function_name((modbus_stats_fc_t)f),
+                            (unsigned long)fc->requests, (unsigned long)fc->ok, (unsigned long)fc->timeouts,
+                            (unsigned long)fc->crc_errors, (unsigned long)fc->exceptions,
+                            (unsigned long)fc->rejected, (unsigned long long)fc->bytes_tx,
+                            (unsigned long long)fc->bytes_rx, (unsigned long)fc->rtt_max_us);
+            LOGGER_LOG_INFO(TAG, "          RTT ms <5:%lu <10:%lu <20:%lu <50:%lu <100:%lu <200:%lu <500:%lu "
+                            "<1000:%lu >=1000:%lu",
+                            (unsigned long)fc->rtt_histogram[0], (unsigned long)fc->rtt_histogram[1],
+                            (unsigned long)fc->rtt_histogram[2], (unsigned long)fc->rtt_histogram[3],
+                            (unsigned long)fc->rtt_histogram[4], (unsigned long)fc->rtt_histogram[5],
+                            (unsigned long)fc->rtt_histogram[6], (unsigned long)fc->rtt_histogram[7],
+                            (unsigned long)fc->rtt_histogram[8]);
+        }
+    }
+    LOGGER_LOG_INFO(TAG, "═════════════════════════════════════════════════════");
+}
@@ -0,0 +1,467 @@
+/**
+ * @file modbus_poll_scheduler.c
+ * @brief Round-robin poll scheduler — one task cycles through all registered
+ *        register blocks on the segment and caches the latest sample of each.
+ *
+ * The scheduler only decides what is due; reads are submitted to the bus
+ * task at low priority and complete asynchronously.
+ */
+
+#include "modbus_poll_scheduler.h"
+#include "modbus_master.h"
+#include "modbus_master_async.h"
+#include "modbus_master_internal.h"
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "core_types.h"
+#include "logger_component.h"
+#include "sdkconfig.h"
+#include "utils.h"
+
+static const char* TAG = "MODBUS_POLL";
+
+struct modbus_poll_slot
+{
+    modbus_poll_config_t config;
+    uint16_t regs[CONFIG_MODBUS_POLL_MAX_REGS];
+    uint16_t rx[CONFIG_MODBUS_POLL_MAX_REGS];  // Written by the bus task while in_flight
+    int64_t last_sample_us;
+    int64_t next_due_us;
+
+    uint32_t samples_ok;
+    uint32_t samples_failed;
+    uint32_t consecutive_failures;
+    uint32_t window_samples;
+    float samples_per_sec;
+
+    bool has_sample;
+    bool in_use;
+    bool in_flight;  // Read queued on the bus task; the slot cannot be reused until it completes
+};
+
+typedef struct
+{
+    modbus_poll_slot_t slots[CONFIG_MODBUS_POLL_MAX_SLOTS];
+    SemaphoreHandle_t lock;
+    SemaphoreHandle_t exited;   // Given by the task right before it deletes itself
+    TaskHandle_t task_handle;
+    volatile bool running;
+
+    uint8_t cursor;             // Round-robin position for the next due scan
+    int64_t window_start_us;
+} modbus_poll_scheduler_ctx_t;
+
+static modbus_poll_scheduler_ctx_t poll_ctx = {0};
+
+static const task_config_t poll_task_config = {
+    .task_name = CONFIG_MODBUS_POLL_TASK_NAME,
+    .stack_size = CONFIG_MODBUS_POLL_TASK_STACK_SIZE,
+    .task_priority = CONFIG_MODBUS_POLL_TASK_PRIORITY,
+};
+
+static bool is_silent(const modbus_poll_slot_t* slot)
+{
+    return slot->consecutive_failures >= CONFIG_MODBUS_POLL_SILENT_THRESHOLD;
+}
+
+/* =========================================================================
+ *  Polling
+ * ========================================================================= */
+static void schedule_next(modbus_poll_slot_t* slot, const int64_t now_us)
+{
+    const int64_t period_us = (int64_t)slot->config.period_ms * 1000;
+
+    /* Silent slaves are only probed at a fraction of their nominal rate */
+    const int64_t step_us = is_silent(slot) ? period_us * CONFIG_MODBUS_POLL_SILENT_PROBE_PERIODS : period_us;
+    slot->next_due_us += step_us;
+    if (slot->next_due_us < now_us)
+    {
+        /* Fell behind — do not burst to catch up, just realign */
+        slot->next_due_us = now_us + step_us;
+    }
+}
+
+/**
+ * @brief Bus task completion — fold the result into the slot.
+ */
+static void poll_complete(const modbus_request_t* request, const esp_err_t err)
+{
+    modbus_poll_scheduler_ctx_t* ctx = &poll_ctx;
+    modbus_poll_slot_t* slot = (modbus_poll_slot_t*)request->user_ctx;
+    const int64_t now_us = esp_timer_get_time();
+
+    xSemaphoreTake(ctx->lock, portMAX_DELAY);
+    slot->in_flight = false;
+    if (!slot->in_use)
+    {
+        /* Removed while the transaction was in flight */
+        xSemaphoreGive(ctx->lock);
+        return;
+    }
+
+    if (err == ESP_OK)
+    {
+        if (is_silent(slot))
+        {
+            LOGGER_LOG_INFO(TAG, "%s (slave %d) responding again", slot->config.name, slot->config.slave_addr);
+        }
+        memcpy(slot->regs, slot->rx, slot->config.reg_count * sizeof(uint16_t));
+        slot->last_sample_us = now_us;
+        slot->has_sample = true;
+        slot->consecutive_failures = 0;
+        slot->samples_ok++;
+        slot->window_samples++;
+    }
+    else
+    {
+        slot->samples_failed++;
+        slot->consecutive_failures++;
+        if (slot->consecutive_failures == CONFIG_MODBUS_POLL_SILENT_THRESHOLD)
+        {
+            LOGGER_LOG_WARN(TAG, "%s (slave %d) silent after %d failures, probing every %d periods",
+                            slot->config.name, slot->config.slave_addr,
+                            CONFIG_MODBUS_POLL_SILENT_THRESHOLD, CONFIG_MODBUS_POLL_SILENT_PROBE_PERIODS);
+        }
+    }
+
+    schedule_next(slot, now_us);
+    xSemaphoreGive(ctx->lock);
+
+    /* Let the scheduler re-evaluate with the new due time */
+    if (ctx->task_handle != NULL)
+    {
+        xTaskNotifyGive(ctx->task_handle);
+    }
+}
+
+static void poll_slot(modbus_poll_scheduler_ctx_t* ctx, modbus_poll_slot_t* slot)
+{
+    const modbus_request_t request = {
+        .slave_addr = slot->config.slave_addr,
+        .command = MB_FUNC_READ_HOLDING_REGISTER,
+        .reg_start = slot->config.reg_start,
+        .reg_count = slot->config.reg_count,
+        .data = slot->rx,
+        .priority = MODBUS_PRIORITY_LOW,
+        .callback = poll_complete,
+        .user_ctx = slot,
+    };
+
+    if (modbus_master_submit(&request, 0) != ESP_OK)
+    {
+        /* Bus backlog — skip this period rather than pile up more polls */
+        xSemaphoreTake(ctx->lock, portMAX_DELAY);
+        slot->in_flight = false;
+        schedule_next(slot, esp_timer_get_time());
+        xSemaphoreGive(ctx->lock);
+    }
+}
+
+/**
+ * @brief Pick the next due slot, scanning round-robin from the cursor.
+ *
+ * @param[out] next_due_us Earliest due time among the slots that are not due yet.
+ */
+static modbus_poll_slot_t* next_due_slot(modbus_poll_scheduler_ctx_t* ctx, const int64_t now_us, int64_t* next_due_us)
+{
+    modbus_poll_slot_t* due = NULL;
+    *next_due_us = INT64_MAX;
+
+    xSemaphoreTake(ctx->lock, portMAX_DELAY);
+    for (uint8_t n = 0; n < CONFIG_MODBUS_POLL_MAX_SLOTS; n++)
+    {
+        const uint8_t i = (uint8_t)((ctx->cursor + n) % CONFIG_MODBUS_POLL_MAX_SLOTS);
+        modbus_poll_slot_t* slot = &ctx->slots[i];
+        if (!slot->in_use || slot->in_flight)
+        {
+            continue;
+        }
+        if (slot->next_due_us <= now_us)
+        {
+            due = slot;
+            slot->in_flight = true;
+            ctx->cursor = (uint8_t)((i + 1) % CONFIG_MODBUS_POLL_MAX_SLOTS);
+            break;
+        }
+        if (slot->next_due_us < *next_due_us)
+        {
+            *next_due_us = slot->next_due_us;
+        }
+    }
+    xSemaphoreGive(ctx->lock);
+
+    return due;
+}
+
+static void update_rate_window(modbus_poll_scheduler_ctx_t* ctx, const int64_t now_us)
+{
+    const int64_t window_us = now_us - ctx->window_start_us;
+    if (window_us < (int64_t)CONFIG_MODBUS_POLL_STATS_WINDOW_MS * 1000)
+    {
+        return;
+    }
+
+    xSemaphoreTake(ctx->lock, portMAX_DELAY);
+    for (uint8_t i = 0; i < CONFIG_MODBUS_POLL_MAX_SLOTS; i++)
+    {
+        modbus_poll_slot_t* slot = &ctx->slots[i];
+        if (!slot->in_use)
+        {
+            continue;
+        }
+        slot->samples_per_sec = (float)slot->window_samples * 1000000.0f / (float)window_us;
+        slot->window_samples = 0;
+
+        LOGGER_LOG_INFO(TAG, "%s (slave %d): %.2f samples/s, %lu ok, %lu failed%s",
+                        slot->config.name, slot->config.slave_addr, slot->samples_per_sec,
+                        (unsigned long)slot->samples_ok, (unsigned long)slot->samples_failed,
+                        is_silent(slot) ? " [silent]" : "");
+    }
+    xSemaphoreGive(ctx->lock);
+
+    ctx->window_start_us = now_us;
+}
+
+static void modbus_poll_task(void* args)
+{
+    modbus_poll_scheduler_ctx_t* ctx = (modbus_poll_scheduler_ctx_t*)args;
+
+    LOGGER_LOG_INFO(TAG, "Modbus poll scheduler started");
+
+    ctx->window_start_us = esp_timer_get_time();
+
+    while (ctx->running)
+    {
+        int64_t now_us = esp_timer_get_time();
+        int64_t next_due_us;
+        modbus_poll_slot_t* slot = next_due_slot(ctx, now_us, &next_due_us);
+
+        if (slot != NULL)
+        {
+            /* Back to back: queue every due slot, the bus task spaces the frames */
+            poll_slot(ctx, slot);
+            update_rate_window(ctx, esp_timer_get_time());
+            continue;
+        }
+
+        update_rate_window(ctx, now_us);
+
+        /* Nothing due — sleep until the earliest slot is due or we are woken
+         * by a completion, add/remove or stop. */
+        TickType_t wait_ticks = pdMS_TO_TICKS(CONFIG_MODBUS_POLL_STATS_WINDOW_MS);
+        if (next_due_us != INT64_MAX)
+        {
+            const TickType_t due_ticks = pdMS_TO_TICKS((uint32_t)((next_due_us - now_us) / 1000));
+            wait_ticks = due_ticks < wait_ticks ? due_ticks : wait_ticks;
+        }
+        ulTaskNotifyTake(pdTRUE, wait_ticks > 0 ? wait_ticks : 1);
+    }
+
+    LOGGER_LOG_INFO(TAG, "Modbus poll scheduler stopping");
+    ctx->task_handle = NULL;
+    xSemaphoreGive(ctx->exited);
+    vTaskDelete(NULL);
+}
+
+/* =========================================================================
+ *  Lifecycle
+ * ========================================================================= */
+esp_err_t init_poll_scheduler(void)
+{
+    if (poll_ctx.running)
+    {
+        return ESP_OK;
+    }
+    if (poll_ctx.task_handle != NULL)
+    {
+        /* A previous shutdown timed out and the old task is still draining */
+        LOGGER_LOG_ERROR(TAG, "Previous poll scheduler task has not exited");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (poll_ctx.lock == NULL)
+    {
+        poll_ctx.lock = xSemaphoreCreateMutex();
+        if (poll_ctx.lock == NULL)
+        {
+            LOGGER_LOG_ERROR(TAG, "Failed to create poll scheduler mutex");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    if (poll_ctx.exited == NULL)
+    {
+        poll_ctx.exited = xSemaphoreCreateBinary();
+        if (poll_ctx.exited == NULL)
+        {
+            LOGGER_LOG_ERROR(TAG, "Failed to create poll scheduler exit semaphore");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    /* Drop a stale exit signal left by a task that outlived a timed-out shutdown */
+    xSemaphoreTake(poll_ctx.exited, 0);
+
+    poll_ctx.running = true;
+
+    CHECK_ERR_LOG_CALL_RET(xTaskCreate(
+                               modbus_poll_task,
+                               poll_task_config.task_name,
+                               poll_task_config.stack_size,
+                               &poll_ctx,
+                               poll_task_config.task_priority,
+                               &poll_ctx.task_handle) == pdPASS
+                           ? ESP_OK
+                           : ESP_FAIL,
+                           poll_ctx.running = false,
+                           "Failed to create Modbus poll scheduler task");
+
+    return ESP_OK;
+}
+
+esp_err_t shutdown_poll_scheduler(void)
+{
+    if (!poll_ctx.running)
+    {
+        return ESP_OK;
+    }
+
+    poll_ctx.running = false;
+    if (poll_ctx.task_handle == NULL)
+    {
+        return ESP_OK;
+    }
+    xTaskNotifyGive(poll_ctx.task_handle);
+
+    /* The bus task is stopped right after this — the poll task must not
+     * submit into it or be restarted alongside a second instance. */
+    if (xSemaphoreTake(poll_ctx.exited, pdMS_TO_TICKS(CONFIG_MODBUS_BUS_SHUTDOWN_TIMEOUT_MS)) != pdTRUE)
+    {
+        LOGGER_LOG_ERROR(TAG, "Modbus poll scheduler task did not stop in time");
+        return ESP_ERR_TIMEOUT;
+    }
+
+    return ESP_OK;
+}
+
+/* =========================================================================
+ *  Public API
+ * ========================================================================= */
+esp_err_t modbus_poll_scheduler_add(const modbus_poll_config_t* config, modbus_poll_slot_t** out_slot)
+{
+    if (config == NULL || out_slot == NULL || config->reg_count == 0 ||
+        config->reg_count > CONFIG_MODBUS_POLL_MAX_REGS || config->period_ms == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (poll_ctx.lock == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t err = ESP_ERR_NO_MEM;
+    xSemaphoreTake(poll_ctx.lock, portMAX_DELAY);
+    for (uint8_t i = 0; i < CONFIG_MODBUS_POLL_MAX_SLOTS; i++)
+    {
+        modbus_poll_slot_t* slot = &poll_ctx.slots[i];
+        if (slot->in_use || slot->in_flight)
+        {
+            continue;
+        }
+
+        memset(slot, 0, sizeof(*slot));
+        slot->config = *config;
+        slot->next_due_us = esp_timer_get_time();
+        slot->in_use = true;
+        *out_slot = slot;
+        err = ESP_OK;
+        break;
+    }
+    xSemaphoreGive(poll_ctx.lock);
+
+    if (err != ESP_OK)
+    {
+        LOGGER_LOG_ERROR(TAG, "No free poll slot for %s (slave %d)", config->name, config->slave_addr);
+        return err;
+    }
+
+    LOGGER_LOG_INFO(TAG, "Polling %s: slave %d, regs %d..%d every %lu ms",
+                    config->name, config->slave_addr, config->reg_start,
+                    config->reg_start + config->reg_count - 1, (unsigned long)config->period_ms);
+
+    if (poll_ctx.task_handle != NULL)
+    {
+        xTaskNotifyGive(poll_ctx.task_handle);
+    }
+    return ESP_OK;
+}
+
+esp_err_t modbus_poll_scheduler_remove(modbus_poll_slot_t* slot)
+{
+    if (slot == NULL || poll_ctx.lock == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(poll_ctx.lock, portMAX_DELAY);
+    slot->in_use = false;
+    slot->has_sample = false;
+    xSemaphoreGive(poll_ctx.lock);
+
+    return ESP_OK;
+}
+
+esp_err_t modbus_poll_scheduler_get_sample(const modbus_poll_slot_t* slot,
+                                           uint16_t* dest,
+                                           const uint16_t reg_count,
+                                           uint32_t* age_ms)
+{
+    if (slot == NULL || dest == NULL || poll_ctx.lock == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t err = ESP_OK;
+    xSemaphoreTake(poll_ctx.lock, portMAX_DELAY);
+    if (!slot->in_use || reg_count > slot->config.reg_count)
+    {
+        err = ESP_ERR_INVALID_ARG;
+    }
+    else if (!slot->has_sample)
+    {
+        err = ESP_ERR_NOT_FOUND;
+    }
+    else
+    {
+        memcpy(dest, slot->regs, reg_count * sizeof(uint16_t));
+        if (age_ms != NULL)
+        {
+            *age_ms = (uint32_t)((esp_timer_get_time() - slot->last_sample_us) / 1000);
+        }
+    }
+    xSemaphoreGive(poll_ctx.lock);
+
+    return err;
+}
+
+esp_err_t modbus_poll_scheduler_get_stats(const modbus_poll_slot_t* slot, modbus_poll_stats_t* stats)
+{
+    if (slot == NULL || stats == NULL || poll_ctx.lock == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(poll_ctx.lock, portMAX_DELAY);
+    *stats = (modbus_poll_stats_t){
+        .samples_ok = slot->samples_ok,
+        .samples_failed = slot->samples_failed,
+        .consecutive_failures = slot->consecutive_failures,
+        .samples_per_sec = slot->samples_per_sec,
+        .silent = is_silent(slot),
+    };
+    xSemaphoreGive(poll_ctx.lock);
+
+    return ESP_OK;
+}
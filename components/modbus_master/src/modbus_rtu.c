@@ -0,0 +1,344 @@
+/**
+ * @file modbus_rtu.c
+ * @brief Modbus RTU master engine — see modbus_rtu.h.
+ */
+
+#include "modbus_rtu.h"
+
+#include <string.h>
+
+#define RTU_CHAR_BITS       11U
+#define EXCEPTION_FRAME_LEN 5U
+
+/* CRC-16/MODBUS (poly 0xA001 reflected), one lookup per byte */
+static const uint16_t crc_table[256] = {
+    0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241,
+    0xC601, 0x06C0, 0x0780, 0xC741, 0x0500, 0xC5C1, 0xC481, 0x0440,
+    0xCC01, 0x0CC0, 0x0D80, 0xCD41, 0x0F00, 0xCFC1, 0xCE81, 0x0E40,
+    0x0A00, 0xCAC1, 0xCB81, 0x0B40, 0xC901, 0x09C0, 0x0880, 0xC841,
+    0xD801, 0x18C0, 0x1980, 0xD941, 0x1B00, 0xDBC1, 0xDA81, 0x1A40,
+    0x1E00, 0xDEC1, 0xDF81, 0x1F40, 0xDD01, 0x1DC0, 0x1C80, 0xDC41,
+    0x1400, 0xD4C1, 0xD581, 0x1540, 0xD701, 0x17C0, 0x1680, 0xD641,
+    0xD201, 0x12C0, 0x1380, 0xD341, 0x1100, 0xD1C1, 0xD081, 0x1040,
+    0xF001, 0x30C0, 0x3180, 0xF141, 0x3300, 0xF3C1, 0xF281, 0x3240,
+    0x3600, 0xF6C1, 0xF781, 0x3740, 0xF501, 0x35C0, 0x3480, 0xF441,
+    0x3C00, 0xFCC1, 0xFD81, 0x3D40, 0xFF01, 0x3FC0, 0x3E80, 0xFE41,
+    0xFA01, 0x3AC0, 0x3B80, 0xFB41, 0x3900, 0xF9C1, 0xF881, 0x3840,
+    0x2800, 0xE8C1, 0xE981, 0x2940, 0xEB01, 0x2BC0, 0x2A80, 0xEA41,
+    0xEE01, 0x2EC0, 0x2F80, 0xEF41, 0x2D00, 0xEDC1, 0xEC81, 0x2C40,
+    0xE401, 0x24C0, 0x2580, 0xE541, 0x2700, 0xE7C1, 0xE681, 0x2640,
+    0x2200, 0xE2C1, 0xE381, 0x2340, 0xE101, 0x21C0, 0x2080, 0xE041,
+    0xA001, 0x60C0, 0x6180, 0xA141, 0x6300, 0xA3C1, 0xA281, 0x6240,
+    0x6600, 0xA6C1, 0xA781, 0x6740, 0xA501, 0x65C0, 0x6480, 0xA441,
+    0x6C00, 0xACC1, 0xAD81, 0x6D40, 0xAF01, 0x6FC0, 0x6E80, 0xAE41,
+    0xAA01, 0x6AC0, 0x6B80, 0xAB41, 0x6900, 0xA9C1, 0xA881, 0x6840,
+    0x7800, 0xB8C1, 0xB981, 0x7940, 0xBB01, 0x7BC0, 0x7A80, 0xBA41,
+    0xBE01, 0x7EC0, 0x7F80, 0xBF41, 0x7D00, 0xBDC1, 0xBC81, 0x7C40,
+    0xB401, 0x74C0, 0x7580, 0xB541, 0x7700, 0xB7C1, 0xB681, 0x7640,
+    0x7200, 0xB2C1, 0xB381, 0x7340, 0xB101, 0x71C0, 0x7080, 0xB041,
+    0x5000, 0x90C1, 0x9181, 0x5140, 0x9301, 0x53C0, 0x5280, 0x9241,
+    0x9601, 0x56C0, 0x5780, 0x9741, 0x5500, 0x95C1, 0x9481, 0x5440,
+    0x9C01, 0x5CC0, 0x5D80, 0x9D41, 0x5F00, 0x9FC1, 0x9E81, 0x5E40,
+    0x5A00, 0x9AC1, 0x9B81, 0x5B40, 0x9901, 0x59C0, 0x5880, 0x9841,
+    0x8801, 0x48C0, 0x4980, 0x8941, 0x4B00, 0x8BC1, 0x8A81, 0x4A40,
+    0x4E00, 0x8EC1, 0x8F81, 0x4F40, 0x8D01, 0x4DC0, 0x4C80, 0x8C41,
+    0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641,
+    0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040
+};
+
+/* =========================================================================
+ *  Timing
+ * ========================================================================= */
+uint32_t modbus_rtu_frame_gap_us(const uint32_t baud_rate)
+{
+    if (baud_rate == 0 || baud_rate > 19200)
+    {
+        return 1750;
+    }
+    return (uint32_t)((35ULL * RTU_CHAR_BITS * 1000000ULL) / (10ULL * baud_rate));
+}
+
+static uint32_t char_time_us(const uint32_t baud_rate)
+{
+    return baud_rate > 0 ? (RTU_CHAR_BITS * 1000000U + baud_rate - 1) / baud_rate : 1146;
+}
+
+void modbus_rtu_init(modbus_rtu_master_t* master, const modbus_rtu_transport_t* transport, const uint32_t baud_rate)
+{
+    memset(master, 0, sizeof(*master));
+    master->transport = transport;
+    master->baud_rate = baud_rate;
+    master->t35_us = modbus_rtu_frame_gap_us(baud_rate);
+    /* t1.5 is the spec limit between characters, but UART FIFOs and PTYs
+     * deliver in bursts — allow a full t3.5 before calling a frame short. */
+    master->inter_char_timeout_us = master->t35_us + 2 * char_time_us(baud_rate);
+    master->last_activity_us = transport->now_us(transport->ctx);
+}
+
+/* =========================================================================
+ *  CRC and framing
+ * ========================================================================= */
+uint16_t modbus_rtu_crc16(const uint8_t* data, const size_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc = (uint16_t)((crc >> 8) ^ crc_table[(crc ^ data[i]) & 0xFF]);
+    }
+    return crc;
+}
+
+static size_t append_crc(uint8_t* frame, const size_t len)
+{
+    const uint16_t crc = modbus_rtu_crc16(frame, len);
+    frame[len] = (uint8_t)(crc & 0xFF);
+    frame[len + 1] = (uint8_t)(crc >> 8);
+    return len + 2;
+}
+
+size_t modbus_rtu_encode_request(const modbus_rtu_request_t* request, uint8_t* frame, const size_t frame_size)
+{
+    if (request == NULL || frame == NULL || request->slave_addr > 247)
+    {
+        return 0;
+    }
+
+    frame[0] = request->slave_addr;
+    frame[1] = request->function;
+    frame[2] = (uint8_t)(request->reg_start >> 8);
+    frame[3] = (uint8_t)(request->reg_start & 0xFF);
+
+    switch (request->function)
+    {
+    case 0x03:
+    case 0x04:
+        if (request->reg_count == 0 || request->reg_count > MODBUS_RTU_MAX_READ_REGS || frame_size < 8)
+        {
+            return 0;
+        }
+        frame[4] = (uint8_t)(request->reg_count >> 8);
+        frame[5] = (uint8_t)(request->reg_count & 0xFF);
+        return append_crc(frame, 6);
+
+    case 0x06:
+        if (request->values == NULL || frame_size < 8)
+        {
+            return 0;
+        }
+        frame[4] = (uint8_t)(request->values[0] >> 8);
+        frame[5] = (uint8_t)(request->values[0] & 0xFF);
+        return append_crc(frame, 6);
+
+    case 0x10:
+        {
+            const uint16_t count = request->reg_count;
+            if (request->values == NULL || count == 0 || count > MODBUS_RTU_MAX_WRITE_REGS ||
+                frame_size < 9U + 2U * count)
+            {
+                return 0;
+            }
+            frame[4] = (uint8_t)(count >> 8);
+            frame[5] = (uint8_t)(count & 0xFF);
+            frame[6] = (uint8_t)(count * 2);
+            for (uint16_t i = 0; i < count; i++)
+            {
+                frame[7 + 2 * i] = (uint8_t)(request->values[i] >> 8);
+                frame[8 + 2 * i] = (uint8_t)(request->values[i] & 0xFF);
+            }
+            return append_crc(frame, 7U + 2U * count);
+        }
+
+    default:
+        return 0;
+    }
+}
+
+size_t modbus_rtu_expected_response_len(const modbus_rtu_request_t* request)
+{
+    switch (request->function)
+    {
+    case 0x03:
+    case 0x04:
+        return 5U + 2U * request->reg_count;
+    case 0x06:
+    case 0x10:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+modbus_rtu_err_t modbus_rtu_decode_response(const modbus_rtu_request_t* request, const uint8_t* frame,
+                                            const size_t len, uint16_t* dest, uint8_t* exception)
+{
+    if (len < EXCEPTION_FRAME_LEN)
+    {
+        return MODBUS_RTU_ERR_FRAME;
+    }
+    const uint16_t crc = (uint16_t)(frame[len - 2] | (frame[len - 1] << 8));
+    if (modbus_rtu_crc16(frame, len - 2) != crc)
+    {
+        return MODBUS_RTU_ERR_CRC;
+    }
+    if (frame[0] != request->slave_addr)
+    {
+        return MODBUS_RTU_ERR_FRAME;
+    }
+    if (frame[1] == (request->function | 0x80))
+    {
+        if (exception != NULL)
+        {
+            *exception = frame[2];
+        }
+        return len == EXCEPTION_FRAME_LEN ? MODBUS_RTU_ERR_EXCEPTION : MODBUS_RTU_ERR_FRAME;
+    }
+    if (frame[1] != request->function || len != modbus_rtu_expected_response_len(request))
+    {
+        return MODBUS_RTU_ERR_FRAME;
+    }
+
+    switch (request->function)
+    {
+    case 0x03:
+    case 0x04:
+        if (frame[2] != request->reg_count * 2)
+        {
+            return MODBUS_RTU_ERR_FRAME;
+        }
+        if (dest != NULL)
+        {
+            for (uint16_t i = 0; i < request->reg_count; i++)
+            {
+                dest[i] = (uint16_t)((frame[3 + 2 * i] << 8) | frame[4 + 2 * i]);
+            }
+        }
+        return MODBUS_RTU_OK;
+
+    case 0x06:
+        {
+            /* Normal response is an echo of the request */
+            const uint16_t reg = (uint16_t)((frame[2] << 8) | frame[3]);
+            const uint16_t value = (uint16_t)((frame[4] << 8) | frame[5]);
+            return reg == request->reg_start && value == request->values[0] ? MODBUS_RTU_OK : MODBUS_RTU_ERR_FRAME;
+        }
+
+    case 0x10:
+        {
+            const uint16_t reg = (uint16_t)((frame[2] << 8) | frame[3]);
+            const uint16_t count = (uint16_t)((frame[4] << 8) | frame[5]);
+            return reg == request->reg_start && count == request->reg_count ? MODBUS_RTU_OK : MODBUS_RTU_ERR_FRAME;
+        }
+
+    default:
+        return MODBUS_RTU_ERR_FRAME;
+    }
+}
+
+/* =========================================================================
+ *  Transaction
+ * ========================================================================= */
+static void wait_frame_gap(modbus_rtu_master_t* master)
+{
+    const modbus_rtu_transport_t* t = master->transport;
+    const int64_t ready_us = master->last_activity_us + master->t35_us;
+    const int64_t now_us = t->now_us(t->ctx);
+    master->last_timing.gap_wait_us = 0;
+    if (now_us < ready_us)
+    {
+        master->last_timing.gap_wait_us = (uint32_t)(ready_us - now_us);
+        t->delay_us(t->ctx, master->last_timing.gap_wait_us);
+    }
+}
+
+/**
+ * @brief Read until @p want bytes arrived or the line went quiet.
+ */
+static size_t read_rest(modbus_rtu_master_t* master, uint8_t* frame, size_t have, const size_t want)
+{
+    const modbus_rtu_transport_t* t = master->transport;
+    while (have < want)
+    {
+        const int n = t->read(t->ctx, frame + have, want - have, master->inter_char_timeout_us);
+        if (n <= 0)
+        {
+            break;
+        }
+        have += (size_t)n;
+    }
+    return have;
+}
+
+modbus_rtu_err_t modbus_rtu_transact(modbus_rtu_master_t* master, const modbus_rtu_request_t* request,
+                                     uint16_t* dest, const uint32_t timeout_us, uint8_t* exception)
+{
+    const modbus_rtu_transport_t* t = master->transport;
+    uint8_t frame[MODBUS_RTU_MAX_FRAME];
+
+    const size_t tx_len = modbus_rtu_encode_request(request, frame, sizeof(frame));
+    const size_t rx_len = modbus_rtu_expected_response_len(request);
+    if (tx_len == 0 || rx_len == 0)
+    {
+        return MODBUS_RTU_ERR_ARG;
+    }
+
+    wait_frame_gap(master);
+    t->flush_input(t->ctx);
+
+    const int64_t tx_start_us = t->now_us(t->ctx);
+    if (t->write(t->ctx, frame, tx_len) != (int)tx_len)
+    {
+        master->last_activity_us = t->now_us(t->ctx);
+        return MODBUS_RTU_ERR_IO;
+    }
+    const int64_t tx_end_us = t->now_us(t->ctx);
+    master->last_timing.tx_us = (uint32_t)(tx_end_us - tx_start_us);
+
+    /* Broadcast — no response */
+    if (request->slave_addr == 0)
+    {
+        master->last_activity_us = tx_end_us;
+        master->last_timing.response_us = 0;
+        master->last_timing.rx_us = 0;
+        return MODBUS_RTU_OK;
+    }
+
+    /* First byte: the slave's turnaround, bounded by the (adaptive) response timeout */
+    const int first = t->read(t->ctx, frame, 1, timeout_us);
+    const int64_t rx_start_us = t->now_us(t->ctx);
+    master->last_timing.response_us = (uint32_t)(rx_start_us - tx_end_us);
+    if (first <= 0)
+    {
+        master->last_activity_us = rx_start_us;
+        master->last_timing.rx_us = 0;
+        return first < 0 ? MODBUS_RTU_ERR_IO : MODBUS_RTU_ERR_TIMEOUT;
+    }
+
+    /* Exception responses are shorter — look at the function byte before deciding how much to wait for */
+    size_t have = read_rest(master, frame, (size_t)first, 2);
+    const size_t want = have >= 2 && (frame[1] & 0x80) ? EXCEPTION_FRAME_LEN : rx_len;
+    have = read_rest(master, frame, have, want);
+
+    master->last_activity_us = t->now_us(t->ctx);
+    master->last_timing.rx_us = (uint32_t)(master->last_activity_us - rx_start_us);
+
+    if (have < want)
+    {
+        return have < EXCEPTION_FRAME_LEN ? MODBUS_RTU_ERR_TIMEOUT : MODBUS_RTU_ERR_FRAME;
+    }
+    return modbus_rtu_decode_response(request, frame, have, dest, exception);
+}
+
+const char* modbus_rtu_err_to_name(const modbus_rtu_err_t err)
+{
+    switch (err)
+    {
+    case MODBUS_RTU_OK: return "OK";
+    case MODBUS_RTU_ERR_ARG: return "ARG";
+    case MODBUS_RTU_ERR_IO: return "IO";
+    case MODBUS_RTU_ERR_TIMEOUT: return "TIMEOUT";
+    case MODBUS_RTU_ERR_CRC: return "CRC";
+    case MODBUS_RTU_ERR_FRAME: return "FRAME";
+    case MODBUS_RTU_ERR_EXCEPTION: return "EXCEPTION";
+    default: return "UNKNOWN";
+    }
+}
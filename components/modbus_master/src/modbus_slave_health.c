@@ -0,0 +1,329 @@
+/**
+ * @file modbus_slave_health.c
+ * @brief Per-slave RTT estimator and circuit breaker, driven by the bus task.
+ */
+
+#include "modbus_slave_health.h"
+#include "modbus_master_internal.h"
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "logger_component.h"
+#include "sdkconfig.h"
+
+static const char* TAG = "MODBUS_HEALTH";
+
+typedef struct
+{
+    uint8_t slave_addr;
+    bool in_use;
+    modbus_circuit_state_t circuit;
+
+    /* RTT estimator (RFC 6298 style, in microseconds) */
+    uint32_t srtt_us;
+    uint32_t rttvar_us;
+    uint32_t rtt_window[CONFIG_MODBUS_HEALTH_RTT_WINDOW];
+    uint8_t rtt_head;
+    uint8_t rtt_count;
+    uint32_t rtt_percentile_us;
+    uint32_t timeout_ms;
+
+    uint32_t consecutive_failures;
+    uint32_t circuit_trips;
+    uint32_t backoff_ms;
+    int64_t probe_at_us;
+} slave_health_entry_t;
+
+typedef struct
+{
+    slave_health_entry_t entries[CONFIG_MODBUS_HEALTH_MAX_SLAVES];
+    SemaphoreHandle_t lock;
+} slave_health_ctx_t;
+
+static slave_health_ctx_t health_ctx = {0};
+
+/* =========================================================================
+ *  Helpers (called with the lock held)
+ * ========================================================================= */
+static slave_health_entry_t* find_entry(const uint8_t slave_addr)
+{
+    for (int i = 0; i < CONFIG_MODBUS_HEALTH_MAX_SLAVES; i++)
+    {
+        if (health_ctx.entries[i].in_use && health_ctx.entries[i].slave_addr == slave_addr)
+        {
+            return &health_ctx.entries[i];
+        }
+    }
+    return NULL;
+}
+
+static slave_health_entry_t* get_or_create_entry(const uint8_t slave_addr)
+{
+    slave_health_entry_t* entry = find_entry(slave_addr);
+    if (entry != NULL)
+    {
+        return entry;
+    }
+
+    for (int i = 0; i < CONFIG_MODBUS_HEALTH_MAX_SLAVES; i++)
+    {
+        if (!health_ctx.entries[i].in_use)
+        {
+            entry = &health_ctx.entries[i];
+            memset(entry, 0, sizeof(*entry));
+            entry->slave_addr = slave_addr;
+            entry->in_use = true;
+            entry->timeout_ms = CONFIG_MODBUS_RESPONSE_TIMEOUT_MS;
+            entry->backoff_ms = CONFIG_MODBUS_HEALTH_PROBE_BASE_MS;
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static uint32_t window_percentile(const slave_health_entry_t* entry)
+{
+    uint32_t sorted[CONFIG_MODBUS_HEALTH_RTT_WINDOW];
+    const uint8_t n = entry->rtt_count;
+    memcpy(sorted, entry->rtt_window, n * sizeof(uint32_t));
+
+    /* Insertion sort — the window is a handful of samples */
+    for (uint8_t i = 1; i < n; i++)
+    {
+        const uint32_t v = sorted[i];
+        int j = i - 1;
+        while (j >= 0 && sorted[j] > v)
+        {
+            sorted[j + 1] = sorted[j];
+            j--;
+        }
+        sorted[j + 1] = v;
+    }
+
+    const uint32_t rank = (n * CONFIG_MODBUS_HEALTH_TIMEOUT_PERCENTILE + 99) / 100;
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+static void record_rtt(slave_health_entry_t* entry, const uint32_t rtt_us)
+{
+    if (entry->rtt_count == 0)
+    {
+        entry->srtt_us = rtt_us;
+        entry->rttvar_us = rtt_us / 2;
+    }
+    else
+    {
+        const uint32_t delta = rtt_us > entry->srtt_us ? rtt_us - entry->srtt_us : entry->srtt_us - rtt_us;
+        entry->rttvar_us = (3 * entry->rttvar_us + delta) / 4;
+        entry->srtt_us = (7 * entry->srtt_us + rtt_us) / 8;
+    }
+
+    entry->rtt_window[entry->rtt_head] = rtt_us;
+    entry->rtt_head = (uint8_t)((entry->rtt_head + 1) % CONFIG_MODBUS_HEALTH_RTT_WINDOW);
+    if (entry->rtt_count < CONFIG_MODBUS_HEALTH_RTT_WINDOW)
+    {
+        entry->rtt_count++;
+    }
+    entry->rtt_percentile_us = window_percentile(entry);
+
+    const uint32_t rto_us = entry->srtt_us + 4 * entry->rttvar_us;
+    uint32_t timeout_ms = (entry->rtt_percentile_us > rto_us ? entry->rtt_percentile_us : rto_us) / 1000
+        + CONFIG_MODBUS_HEALTH_TIMEOUT_MARGIN_MS;
+    if (timeout_ms < CONFIG_MODBUS_HEALTH_MIN_TIMEOUT_MS)
+    {
+        timeout_ms = CONFIG_MODBUS_HEALTH_MIN_TIMEOUT_MS;
+    }
+    if (timeout_ms > CONFIG_MODBUS_RESPONSE_TIMEOUT_MS)
+    {
+        timeout_ms = CONFIG_MODBUS_RESPONSE_TIMEOUT_MS;
+    }
+    entry->timeout_ms = timeout_ms;
+}
+
+static void open_circuit(slave_health_entry_t* entry, const int64_t now_us)
+{
+    entry->circuit = MODBUS_CIRCUIT_OPEN;
+    entry->probe_at_us = now_us + (int64_t)entry->backoff_ms * 1000;
+
+    LOGGER_LOG_WARN(TAG, "Slave %d circuit open after %lu failures, next probe in %lu ms",
+                    entry->slave_addr, (unsigned long)entry->consecutive_failures,
+                    (unsigned long)entry->backoff_ms);
+
+    const uint32_t next_backoff = entry->backoff_ms * 2;
+    entry->backoff_ms = next_backoff > CONFIG_MODBUS_HEALTH_PROBE_MAX_MS
+                            ? CONFIG_MODBUS_HEALTH_PROBE_MAX_MS
+                            : next_backoff;
+}
+
+/* =========================================================================
+ *  Bus task hooks
+ * ========================================================================= */
+esp_err_t init_slave_health(void)
+{
+    if (health_ctx.lock == NULL)
+    {
+        health_ctx.lock = xSemaphoreCreateMutex();
+        if (health_ctx.lock == NULL)
+        {
+            LOGGER_LOG_ERROR(TAG, "Failed to create slave health mutex");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
+bool modbus_health_admit(const uint8_t slave_addr, const int64_t now_us)
+{
+    bool admit = true;
+
+    xSemaphoreTake(health_ctx.lock, portMAX_DELAY);
+    slave_health_entry_t* entry = get_or_create_entry(slave_addr);
+    if (entry != NULL)
+    {
+        switch (entry->circuit)
+        {
+        case MODBUS_CIRCUIT_OPEN:
+            if (now_us >= entry->probe_at_us)
+            {
+                entry->circuit = MODBUS_CIRCUIT_HALF_OPEN;
+                LOGGER_LOG_INFO(TAG, "Probing slave %d", slave_addr);
+            }
+            else
+            {
+                admit = false;
+            }
+            break;
+        case MODBUS_CIRCUIT_HALF_OPEN:
+            /* Only the probe itself goes out; it completes before the next admit */
+            break;
+        case MODBUS_CIRCUIT_CLOSED:
+        default:
+            break;
+        }
+    }
+    xSemaphoreGive(health_ctx.lock);
+
+    return admit;
+}
+
+/* Only a silent or garbled slave counts against the circuit */
+static bool is_link_failure(const esp_err_t result)
+{
+    return result == ESP_ERR_TIMEOUT || result == ESP_ERR_INVALID_CRC || result == ESP_ERR_INVALID_RESPONSE;
+}
+
+void modbus_health_record(const uint8_t slave_addr, const esp_err_t result, const uint32_t rtt_us,
+                          const int64_t now_us)
+{
+    xSemaphoreTake(health_ctx.lock, portMAX_DELAY);
+    slave_health_entry_t* entry = get_or_create_entry(slave_addr);
+    if (entry == NULL)
+    {
+        xSemaphoreGive(health_ctx.lock);
+        return;
+    }
+
+    /* An exception reply is a well-formed answer: the slave is alive */
+    if (result == ESP_OK || result == ESP_ERR_NOT_SUPPORTED)
+    {
+        if (result == ESP_OK)
+        {
+            record_rtt(entry, rtt_us);
+        }
+        if (entry->circuit != MODBUS_CIRCUIT_CLOSED)
+        {
+            LOGGER_LOG_INFO(TAG, "Slave %d responding again, circuit closed", slave_addr);
+        }
+        entry->circuit = MODBUS_CIRCUIT_CLOSED;
+        entry->consecutive_failures = 0;
+        entry->backoff_ms = CONFIG_MODBUS_HEALTH_PROBE_BASE_MS;
+    }
+    else if (is_link_failure(result))
+    {
+        entry->consecutive_failures++;
+        if (entry->circuit == MODBUS_CIRCUIT_HALF_OPEN)
+        {
+            open_circuit(entry, now_us);
+        }
+        else if (entry->circuit == MODBUS_CIRCUIT_CLOSED &&
+                 entry->consecutive_failures >= CONFIG_MODBUS_HEALTH_FAILURE_THRESHOLD)
+        {
+            entry->circuit_trips++;
+            open_circuit(entry, now_us);
+        }
+    }
+    xSemaphoreGive(health_ctx.lock);
+}
+
+uint32_t modbus_health_get_timeout_ms(const uint8_t slave_addr)
+{
+    uint32_t timeout_ms = CONFIG_MODBUS_RESPONSE_TIMEOUT_MS;
+
+    xSemaphoreTake(health_ctx.lock, portMAX_DELAY);
+    const slave_health_entry_t* entry = find_entry(slave_addr);
+    if (entry != NULL && entry->rtt_count > 0)
+    {
+        timeout_ms = entry->timeout_ms;
+    }
+    xSemaphoreGive(health_ctx.lock);
+
+    return timeout_ms;
+}
+
+/* =========================================================================
+ *  Public API
+ * ========================================================================= */
+esp_err_t modbus_master_get_slave_health(const uint8_t slave_addr, modbus_slave_health_t* health)
+{
+    if (health == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (health_ctx.lock == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t err = ESP_OK;
+    xSemaphoreTake(health_ctx.lock, portMAX_DELAY);
+    const slave_health_entry_t* entry = find_entry(slave_addr);
+    if (entry == NULL)
+    {
+        err = ESP_ERR_NOT_FOUND;
+    }
+    else
+    {
+        const int64_t until_probe_us = entry->probe_at_us - esp_timer_get_time();
+        *health = (modbus_slave_health_t){
+            .circuit = entry->circuit,
+            .rtt_ewma_us = entry->srtt_us,
+            .rtt_percentile_us = entry->rtt_percentile_us,
+            .timeout_ms = entry->timeout_ms,
+            .consecutive_failures = entry->consecutive_failures,
+            .circuit_trips = entry->circuit_trips,
+            .next_probe_in_ms = entry->circuit == MODBUS_CIRCUIT_OPEN && until_probe_us > 0
+                                    ? (uint32_t)(until_probe_us / 1000)
+                                    : 0,
+        };
+    }
+    xSemaphoreGive(health_ctx.lock);
+
+    return err;
+}
+
+bool modbus_master_is_slave_available(const uint8_t slave_addr)
+{
+    if (health_ctx.lock == NULL)
+    {
+        return true;
+    }
+
+    xSemaphoreTake(health_ctx.lock, portMAX_DELAY);
+    const slave_health_entry_t* entry = find_entry(slave_addr);
+    const bool available = entry == NULL || entry->circuit != MODBUS_CIRCUIT_OPEN;
+    xSemaphoreGive(health_ctx.lock);
+
+    return available;
+}
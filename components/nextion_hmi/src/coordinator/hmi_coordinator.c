@@ -9,6 +9,7 @@
 #include "logger_component.h"
 #include "event_manager.h"
 #include "event_registry.h"
+#include "coordinator_component.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
@@ -103,6 +104,33 @@ static void flush_deferred(void)
     LOGGER_LOG_INFO(TAG, "Deferred commands flushed");
 }
 
+/**
+ * Show a run that was already going before the display came up. The
+ * coordinator is started first and may have resumed a checkpointed run
+ * whose PROFILE_STARTED event went out before we subscribed.
+ */
+static void sync_run_state(void)
+{
+    heating_task_state_t state;
+    const esp_err_t err = coordinator_get_status(
+        &state, pdMS_TO_TICKS(CONFIG_NEXTION_COORDINATOR_STATUS_TIMEOUT_MS));
+    if (err != ESP_OK)
+    {
+        LOGGER_LOG_WARN(TAG, "Run state unknown at display init: %s", esp_err_to_name(err));
+        return;
+    }
+    if (!state.is_active)
+    {
+        return;
+    }
+
+    nextion_event_handle_profile_started();
+    if (state.is_paused)
+    {
+        nextion_event_handle_profile_paused();
+    }
+}
+
 /* ── ESP event → HMI queue bridge handlers ─────────────────────── */
 // These run on the event_manager's event-loop task and simply serialize
 // incoming system events into the HMI command queue. The actual UI work
@@ -303,6 +331,7 @@ static void hmi_coordinator_task(void* arg)
         {
         case HMI_CMD_INIT_DISPLAY:
             nextion_event_handle_init();
+            sync_run_state();
             break;
 
         case HMI_CMD_HANDLE_LINE:
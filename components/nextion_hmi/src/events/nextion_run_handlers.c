@@ -10,6 +10,7 @@
 #include "heating_program_models_internal.h"
 #include "heating_program_validation.h"
 #include "heating_program_graph_internal.h"
+#include "profile_segment_table.h"
 #include "event_manager.h"
 #include "event_registry.h"
 #include "logger_component.h"
@@ -200,23 +201,10 @@ void nextion_event_handle_profile_started(void)
     snprintf(cmd, sizeof(cmd), "progNameDisp.txt=\"%s\"", draft.name);
     nextion_send_cmd(cmd);
 
-    uint32_t total_min = 0;
-    float last_stage_temp = 0.0f;
-    for (int i = 0; i < PROGRAMS_TOTAL_STAGE_COUNT; ++i) {
-        if (draft.stages[i].is_set) {
-            total_min += (uint32_t)draft.stages[i].t_min;
-            last_stage_temp = (float)draft.stages[i].target_t_c;
-        }
-    }
-    s_waveform_total_ms = total_min * 60U * 1000U;
-
-    /* Include implicit cooldown in the graph time span */
-    int cd_rate = program_get_cooldown_rate_x10();
-    if (last_stage_temp > 0.0f && cd_rate > 0) {
-        float cooldown_min = (last_stage_temp * 10.0f) / (float)cd_rate;
-        if (cooldown_min < 1.0f) cooldown_min = 1.0f;
-        s_waveform_total_ms += (uint32_t)(cooldown_min * 60.0f * 1000.0f);
-    }
+    /* Graph time span: the stages plus the implicit cooldown */
+    profile_segment_table_t segments;
+    profile_segment_table_build(&segments, &draft, 0.0f, program_get_cooldown_rate_x10());
+    s_waveform_total_ms = segments.total_ms;
 
     /* Init time tracking */
     s_total_ms         = s_waveform_total_ms;
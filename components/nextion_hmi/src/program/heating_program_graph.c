@@ -1,5 +1,6 @@
 #include "heating_program_graph_internal.h"
 #include "heating_program_models_internal.h"
+#include "profile_segment_table.h"
 
 #include "sdkconfig.h"
 #include <string.h>
@@ -24,51 +25,22 @@ size_t program_build_graph(const program_draft_t *draft, uint8_t *out, size_t ma
     memset(out, 0, max_len);
 
     /*
-     * Build keypoints: each active stage adds one (cumulative_time, temperature)
-     * entry.  The first keypoint is the starting condition at time 0.
+     * Only stages with both a time and a target are drawn; the table
+     * compiles is_set stages, so clear it on the incomplete ones.
      */
-    float kp_time[PROGRAMS_TOTAL_STAGE_COUNT + 2];  /* +2: start + cooldown */
-    float kp_temp[PROGRAMS_TOTAL_STAGE_COUNT + 2];
-    int   n_keys = 0;
-
-    kp_time[0] = 0.0f;
-    kp_temp[0] = (float)start_temp_c;
-    n_keys = 1;
-
-    float total_time = 0.0f;
-
+    program_draft_t complete = *draft;
     for (int i = 0; i < PROGRAMS_TOTAL_STAGE_COUNT; ++i) {
-        const program_stage_t *stage = &draft->stages[i];
-        if (!stage->is_set || !stage->t_set || !stage->target_set) {
-            continue;
-        }
-        total_time += (float)stage->t_min;
-        kp_time[n_keys] = total_time;
-        kp_temp[n_keys] = (float)stage->target_t_c;
-        n_keys++;
+        program_stage_t *stage = &complete.stages[i];
+        stage->is_set = stage->is_set && stage->t_set && stage->target_set;
     }
 
-    if (n_keys <= 1 || total_time <= 0.0f) {
+    /* Stages plus the implicit cooldown from the configured natural cooling rate */
+    profile_segment_table_t segments;
+    profile_segment_table_build(&segments, &complete, (float)start_temp_c, program_get_cooldown_rate_x10());
+    if (segments.stage_count == 0 || segments.heating_ms == 0) {
         return 0;
     }
 
-    /*
-     * Implicit cooldown stage: ramp from last temperature to 0 C.
-     * Duration is derived from the configured natural cooling rate.
-     */
-    float last_temp = kp_temp[n_keys - 1];
-    int cd_rate = program_get_cooldown_rate_x10();
-    if (last_temp > 0.0f && cd_rate > 0) {
-        float cooldown_min = (last_temp * 10.0f) / (float)cd_rate;
-        if (cooldown_min < 1.0f) {
-            cooldown_min = 1.0f;
-        }
-        total_time += cooldown_min;
-        kp_time[n_keys] = total_time;
-        kp_temp[n_keys] = 0.0f;
-        n_keys++;
-    }
-
     /* Output count is the full available width, clamped to buffer size. */
     size_t count = (size_t)width_px;
     if (count > max_len) {
@@ -76,28 +48,23 @@ size_t program_build_graph(const program_draft_t *draft, uint8_t *out, size_t ma
     }
 
     /*
-     * For every output pixel, compute the time it represents and linearly
-     * interpolate the temperature from the surrounding keypoints.  This
-     * always stretches (or compresses) the profile to fill the full width.
+     * For every output pixel, compute the time it represents and evaluate
+     * the segment covering it.  Pixel times only increase, so the segment
+     * is found by stepping forward rather than searching.  This always
+     * stretches (or compresses) the profile to fill the full width.
      */
+    const float ms_per_px = (count > 1) ? (float)segments.total_ms / (float)(count - 1) : 0.0f;
+    size_t seg = 0;
     for (size_t x = 0; x < count; ++x) {
-        float t = (count > 1)
-                  ? (total_time * (float)x / (float)(count - 1))
-                  : 0.0f;
-
-        /* Find the segment this time falls into */
-        float temp_val = kp_temp[n_keys - 1]; /* default: last keypoint */
-        for (int k = 1; k < n_keys; ++k) {
-            if (t <= kp_time[k]) {
-                float seg_len = kp_time[k] - kp_time[k - 1];
-                float frac = (seg_len > 0.0f)
-                             ? ((t - kp_time[k - 1]) / seg_len)
-                             : 1.0f;
-                temp_val = kp_temp[k - 1]
-                         + (kp_temp[k] - kp_temp[k - 1]) * frac;
-                break;
-            }
+        /* Float rounding must not push the last pixel past the end of the curve */
+        uint32_t t_ms = (uint32_t)(ms_per_px * (float)x);
+        if (t_ms > segments.total_ms) {
+            t_ms = segments.total_ms;
+        }
+        while (seg + 1 < segments.segment_count && segments.segments[seg + 1].start_ms <= t_ms) {
+            seg++;
         }
+        float temp_val = profile_segment_temperature_at(&segments.segments[seg], t_ms);
 
         int capped = (int)temp_val;
         if (capped < 0) {
@@ -6,7 +6,8 @@
 typedef enum
 {
     TEMP_SENSOR_DEVICE_COMMAND_SET_REGISTER_VALUE = 0,
-    TEMP_SENSOR_REPAIR_FORM_GOOD_UNIT
+    TEMP_SENSOR_REPAIR_FORM_GOOD_UNIT,
+    TEMP_SENSOR_DEVICE_COMMAND_DUMP_CONFIG
 } temp_sensor_device_cmd_id_t;
 
 typedef struct temp_sensor_device temp_sensor_device_t;
@@ -17,7 +18,7 @@ typedef struct
     uint16_t value;
 } temp_sensor_device_set_register_value_cmd_params_t;
 
-esp_err_t temp_sensor_create(temp_sensor_device_t** device);
+esp_err_t temp_sensor_create(uint8_t modbus_address, temp_sensor_device_t** device);
 
 esp_err_t temp_sensor_set_device_state(const temp_sensor_device_t* device, device_state_t new_state);
 
@@ -25,4 +26,11 @@ esp_err_t temp_sensor_read_device(const temp_sensor_device_t* device, void* data
 
 esp_err_t temp_sensor_write_device(const temp_sensor_device_t* device, const device_write_cmd_t* cmd);
 
+/**
+ * @brief Time from boot until the device produced its first valid temperature.
+ *
+ * @return ESP_ERR_NOT_FOUND if no valid temperature has been read yet.
+ */
+esp_err_t temp_sensor_get_time_to_first_reading(const temp_sensor_device_t* device, uint32_t* out_ms);
+
 esp_err_t temp_sensor_destroy(temp_sensor_device_t* device);
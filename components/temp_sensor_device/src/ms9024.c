@@ -7,6 +7,7 @@
 #include "ms9024.h"
 #include "modbus_master.h"
 
+#include <stdio.h>
 #include <string.h>
 #include <math.h>
 #include "freertos/FreeRTOS.h"
@@ -14,9 +15,13 @@
 #include "logger_component.h"
 #include "utils.h"
 #include "modbus_utils.h"
+#include "nvs.h"
 
 static const char* TAG = "MS9024";
 
+#define NVS_NAMESPACE "ms9024"
+#define NVS_KEY_FMT   "cfg_fp_%u"
+
 /* =========================================================================
  *  Sensor name lookup table
  * ========================================================================= */
@@ -64,16 +69,20 @@ esp_err_t ms9024_read_float(uint8_t slave_address,
                           "Failed to read float from reg %d",
                           reg);
 
+    return ms9024_decode_float(output_buffer, out);
+}
 
+esp_err_t ms9024_decode_float(const uint16_t* registers, float* out)
+{
     uint32_t raw = 0;
-    const float val = modbus_master_swap_float_cdab(output_buffer, &raw);
+    const float val = modbus_master_swap_float_cdab(registers, &raw);
 
-    LOGGER_LOG_INFO(TAG, "CDAB decode: raw=0x%08lX → %.4f C", (unsigned long)raw, val);
+    LOGGER_LOG_DEBUG(TAG, "CDAB decode: raw=0x%08lX → %.4f C", (unsigned long)raw, val);
 
     /* Reject NaN / Infinity */
     if (isnan(val) || isinf(val))
     {
-        LOGGER_LOG_WARN(TAG, "Decoded NaN/Inf from reg %d — invalid data", reg);
+        LOGGER_LOG_WARN(TAG, "Decoded NaN/Inf (raw=0x%08lX) — invalid data", (unsigned long)raw);
         return ESP_FAIL;
     }
 
@@ -98,47 +107,38 @@ esp_err_t ms9024_read_float(uint8_t slave_address,
 /* =========================================================================
  *  Register write + verify
  * ========================================================================= */
-esp_err_t ms9024_write_and_verify(const uint8_t slave_address, const uint16_t reg, const uint16_t value, const char *reg_name)
+esp_err_t ms9024_write_and_verify(ms9024_shadow_t* shadow, const uint16_t reg, const uint16_t value,
+                                  const char *reg_name)
 {
-    LOGGER_LOG_INFO(TAG, "Writing %s (reg %d) = %d ...", reg_name, reg, value);
-
-    CHECK_ERR_LOG_RET_FMT(modbus_master_write_register(slave_address, reg, value),
-                          "Failed to write %s to reg %d", reg_name, reg);
-
-    vTaskDelay(pdMS_TO_TICKS(100));  /* Let MS9024 process the write */
-
-    /* Read back to verify */
-    uint16_t readback = 0;
-    CHECK_ERR_LOG_RET_FMT(ms9024_read_uint16(slave_address, reg, &readback),
-                           "Failed to read back %s for verification", reg_name);
-
-    const uint16_t rb_lsb = readback & 0xFF;
-    if (rb_lsb == (value & 0xFF)) {
-        LOGGER_LOG_INFO(TAG, "✓ %s verified: %d", reg_name, rb_lsb);
+    bool changed = false;
+    CHECK_ERR_LOG_RET_FMT(ms9024_shadow_stage(shadow, reg, value, MS9024_MASK_LSB, &changed),
+                          "Failed to stage %s (reg %d)", reg_name, reg);
+    if (!changed)
+    {
+        LOGGER_LOG_INFO(TAG, "%s (reg %d) already %d — write skipped", reg_name, reg, value & 0xFF);
         return ESP_OK;
     }
 
-    LOGGER_LOG_ERROR(TAG, "✗ %s mismatch: wrote %d, read back %d",
-                      reg_name, value & 0xFF, rb_lsb);
-    return ESP_FAIL;
+    LOGGER_LOG_INFO(TAG, "Writing %s (reg %d) = %d ...", reg_name, reg, value);
+    return ms9024_shadow_flush(shadow, true, reg_name);
 }
 
 /* =========================================================================
  *  Auto-correct a register to match desired value
  * ========================================================================= */
-esp_err_t ms9024_auto_correct_register(const uint8_t slave_address, const uint16_t reg, const uint16_t desired)
+esp_err_t ms9024_auto_correct_register(ms9024_shadow_t* shadow, const uint16_t reg, const uint16_t desired)
 {
     uint16_t current = 0;
-    CHECK_ERR_LOG_RET(ms9024_read_uint16(slave_address, reg, &current),
+    CHECK_ERR_LOG_RET(ms9024_shadow_get(shadow, reg, &current),
                       "Failed to read for auto-correct");
 
     const uint8_t cv = current & 0xFF;
     if (cv != (desired & 0xFF))
     {
         LOGGER_LOG_WARN(TAG, """Mismatch: MS9024 has %d, desired %d — correcting", cv, desired & 0xFF);
-        CHECK_ERR_LOG_CALL_RET_FMT(ms9024_write_and_verify(slave_address, reg, desired, "auto-correct"),
-                                   vTaskDelay(pdMS_TO_TICKS(500)),
-                                   "Auto-correct failed for reg %d", reg);
+        CHECK_ERR_LOG_RET_FMT(ms9024_write_and_verify(shadow, reg, desired, "auto-correct"),
+                              "Auto-correct failed for reg %d", reg);
+        return ESP_OK;
     }
 
     LOGGER_LOG_INFO(TAG, "OK: %d (matches config)", cv);
@@ -265,6 +265,72 @@ void ms9024_log_config(const uint8_t slave_address,
     LOGGER_LOG_INFO(TAG, "═══════════════ end config ═══════════════");
 }
 
+/* =========================================================================
+ *  Configuration fingerprint (fast boot)
+ * ========================================================================= */
+esp_err_t ms9024_read_config_fingerprint(ms9024_shadow_t* shadow, uint32_t* fingerprint)
+{
+    if (shadow == NULL || fingerprint == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /* Goes through the shadow so later writes to the config block start from a warm cache */
+    const uint8_t slave_address = shadow->slave_address;
+    uint16_t block[MS9024_CONFIG_BLOCK_COUNT];
+    CHECK_ERR_LOG_RET_FMT(ms9024_shadow_prefetch(shadow, MS9024_CONFIG_BLOCK_START, MS9024_CONFIG_BLOCK_COUNT, block),
+                          "Failed to read config block from slave %d", slave_address);
+
+    /* FNV-1a over the slave address and the raw register words */
+    uint32_t hash = 2166136261U;
+    hash = (hash ^ slave_address) * 16777619U;
+    for (size_t i = 0; i < MS9024_CONFIG_BLOCK_COUNT; i++)
+    {
+        hash = (hash ^ (block[i] & 0xFF)) * 16777619U;
+        hash = (hash ^ (block[i] >> 8)) * 16777619U;
+    }
+
+    *fingerprint = hash;
+    return ESP_OK;
+}
+
+esp_err_t ms9024_load_config_fingerprint(const uint8_t slave_address, uint32_t* fingerprint)
+{
+    char key[16];
+    snprintf(key, sizeof(key), NVS_KEY_FMT, slave_address);
+
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    err = nvs_get_u32(nvs, key, fingerprint);
+    nvs_close(nvs);
+    return err;
+}
+
+esp_err_t ms9024_store_config_fingerprint(const uint8_t slave_address, const uint32_t fingerprint)
+{
+    char key[16];
+    snprintf(key, sizeof(key), NVS_KEY_FMT, slave_address);
+
+    nvs_handle_t nvs;
+    CHECK_ERR_LOG_RET(nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs),
+                      "Failed to open NVS for config fingerprint");
+    esp_err_t err = nvs_set_u32(nvs, key, fingerprint);
+    if (err == ESP_OK)
+    {
+        err = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+
+    CHECK_ERR_LOG_RET_FMT(err, "Failed to store config fingerprint for slave %d", slave_address);
+    LOGGER_LOG_INFO(TAG, "Stored config fingerprint 0x%08lX for slave %d", (unsigned long)fingerprint,
+                    slave_address);
+    return ESP_OK;
+}
+
 /* =========================================================================
  *  Comprehensive register scan — compare good vs. bad transmitter
  * ========================================================================= */
@@ -360,7 +426,7 @@ void ms9024_diagnostic_scan(uint8_t slave_address)
  *  Repair a bad MS9024 — write known-good register values
  *  Values captured from a known-good reference unit.
  * ========================================================================= */
-esp_err_t ms9024_repair_from_good_unit(uint8_t slave_address)
+esp_err_t ms9024_repair_from_good_unit(ms9024_shadow_t* shadow)
 {
     LOGGER_LOG_WARN(TAG, "╔══════════════════════════════════════════════════╗");
     LOGGER_LOG_WARN(TAG, "║  MS9024 REPAIR MODE — writing good-unit values   ║");
@@ -384,15 +450,20 @@ esp_err_t ms9024_repair_from_good_unit(uint8_t slave_address)
         {129, 282, "REG129 (config/cal param)"},
     };
 
-    int ok = 0, fail = 0;
+    /*
+     * Regs 27 and 30 sit inside the config block, so one block read warms the
+     * shadow for both.  The unit is known to hold bad values, so 28/29 are not
+     * bridged — the flush writes only the registers staged below.
+     */
+    CHECK_ERR_LOG_RET(ms9024_shadow_prefetch(shadow, MS9024_CONFIG_BLOCK_START, MS9024_CONFIG_BLOCK_COUNT, NULL),
+                      "Cannot read config block — repair aborted");
+
+    int staged = 0, fail = 0;
 
     for (size_t i = 0; i < sizeof(repairs) / sizeof(repairs[0]); i++)
     {
-        /* Read current value first */
         uint16_t current = 0;
-        esp_err_t err = ms9024_read_uint16(slave_address, repairs[i].reg,
-                                           &current);
-        if (err != ESP_OK)
+        if (ms9024_shadow_get(shadow, repairs[i].reg, &current) != ESP_OK)
         {
             LOGGER_LOG_ERROR(TAG, "  Cannot read %s (reg %d) — skipping",
                              repairs[i].name, repairs[i].reg);
@@ -404,7 +475,6 @@ esp_err_t ms9024_repair_from_good_unit(uint8_t slave_address)
         {
             LOGGER_LOG_INFO(TAG, "  %s (reg %d) already correct: %d",
                             repairs[i].name, repairs[i].reg, current);
-            ok++;
             continue;
         }
 
@@ -412,23 +482,23 @@ esp_err_t ms9024_repair_from_good_unit(uint8_t slave_address)
                         repairs[i].name, repairs[i].reg,
                         current, repairs[i].good_val);
 
-        err = ms9024_write_and_verify( slave_address, repairs[i].reg,
-                                      repairs[i].good_val,
-                                      repairs[i].name);
-        if (err == ESP_OK)
+        if (ms9024_shadow_stage(shadow, repairs[i].reg, repairs[i].good_val, MS9024_MASK_WORD, NULL) == ESP_OK)
         {
-            LOGGER_LOG_INFO(TAG, "  ✓ %s repaired successfully", repairs[i].name);
-            ok++;
+            staged++;
         }
         else
         {
-            LOGGER_LOG_ERROR(TAG, "  ✗ %s repair FAILED", repairs[i].name);
             fail++;
         }
-        vTaskDelay(pdMS_TO_TICKS(500)); /* Let MS9024 save to EEPROM */
     }
 
-    LOGGER_LOG_WARN(TAG, "Repair complete: %d OK, %d FAILED", ok, fail);
+    /* All staged registers go out with a single settle delay and block verify */
+    if (staged > 0 && ms9024_shadow_flush(shadow, false, "repair") != ESP_OK)
+    {
+        fail++;
+    }
+
+    LOGGER_LOG_WARN(TAG, "Repair complete: %d written, %d FAILED", staged, fail);
     LOGGER_LOG_WARN(TAG, "Power-cycle the MS9024 and re-check temperature.");
     LOGGER_LOG_WARN(TAG, "REMEMBER: Disable CONFIG_MODBUS_TEMP_REPAIR_BAD_UNIT after repair!");
 
@@ -6,6 +6,7 @@
 
 #include <stdint.h>
 #include "esp_err.h"
+#include "ms9024_shadow.h"
 
 /* ── MS9024 register addresses (from datasheet) ─────────────────────────── */
 #define MS9024_REG_SENS       28   /* Sensor type   (LSByte, R/W)          */
@@ -18,6 +19,10 @@
 #define MS9024_REG_T2         730  /* Cold junction T2 (Float, +512)       */
 #define MS9024_REG_IN_OFFSET  524  /* Input offset (Float, +512)           */
 
+/* Contiguous configuration block (FIN … WIRE) hashed for the boot fingerprint */
+#define MS9024_CONFIG_BLOCK_START  MS9024_REG_FIN
+#define MS9024_CONFIG_BLOCK_COUNT  (MS9024_REG_WIRE - MS9024_REG_FIN + 1)
+
 /* Sensor type IDs */
 #define SENS_PT100_385   16
 #define SENS_PT100_392   20
@@ -38,24 +43,54 @@ esp_err_t ms9024_read_uint16(uint8_t slave_address, uint16_t reg, uint16_t* out)
  */
 esp_err_t ms9024_read_float(uint8_t slave, uint16_t reg, float* out);
 
+/**
+ * @brief Decode and validate a CDAB float from two already-read registers.
+ *
+ * Rejects NaN/Inf, the -0.0 "no measurement yet" marker and out-of-range values.
+ */
+esp_err_t ms9024_decode_float(const uint16_t* registers, float* out);
+
 /**
  * @brief Write a register and verify by reading back.
+ *
+ * Skipped when the shadow already holds the same LSByte.
  */
-esp_err_t ms9024_write_and_verify(uint8_t slave_address, uint16_t reg, uint16_t value, const char *reg_name);
+esp_err_t ms9024_write_and_verify(ms9024_shadow_t* shadow, uint16_t reg, uint16_t value, const char *reg_name);
 
 /**
  * @brief Auto-correct a register if it doesn't match the desired value.
  *
- * Reads the register, and if the LSByte doesn't match @p desired, writes
- * the correct value and verifies. Skips the write if already correct.
+ * Reads the register (from the shadow when cached), and if the LSByte doesn't
+ * match @p desired, writes the correct value and verifies. Skips the write if
+ * already correct.
  */
-esp_err_t ms9024_auto_correct_register(uint8_t slave_address, uint16_t reg, uint16_t desired);
+esp_err_t ms9024_auto_correct_register(ms9024_shadow_t* shadow, uint16_t reg, uint16_t desired);
 
 /**
  * @brief Dump MS9024 configuration to the log (runs once at startup).
  */
 void ms9024_log_config(uint8_t slave_address, uint16_t pv_reg);
 
+/**
+ * @brief Read the configuration block in a single transaction and hash it.
+ *
+ * Covers FIN, SENS, WIRE and the repair registers 27/30 (regs 26 – 32).
+ * The block is cached in @p shadow as a side effect.
+ */
+esp_err_t ms9024_read_config_fingerprint(ms9024_shadow_t* shadow, uint32_t* fingerprint);
+
+/**
+ * @brief Load the fingerprint stored in NVS for a slave.
+ *
+ * @return ESP_ERR_NVS_NOT_FOUND if no fingerprint has been stored yet.
+ */
+esp_err_t ms9024_load_config_fingerprint(uint8_t slave_address, uint32_t* fingerprint);
+
+/**
+ * @brief Persist the fingerprint for a slave to NVS.
+ */
+esp_err_t ms9024_store_config_fingerprint(uint8_t slave_address, uint32_t fingerprint);
+
 /**
  * @brief Comprehensive register scan for diagnostics.
  *
@@ -69,8 +104,9 @@ void ms9024_diagnostic_scan(uint8_t slave);
  * @brief Repair a bad MS9024 by writing known-good register values.
  *
  * Writes the correct values to registers 27, 30, and 129 as captured
- * from a known-good reference unit.
+ * from a known-good reference unit. Registers that already hold the good
+ * value are skipped; the rest are flushed as one batch.
  *
  * @return ESP_OK if all writes verified successfully.
  */
-esp_err_t ms9024_repair_from_good_unit(uint8_t slave);
+esp_err_t ms9024_repair_from_good_unit(ms9024_shadow_t* shadow);
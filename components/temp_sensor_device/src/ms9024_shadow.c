@@ -0,0 +1,394 @@
+/**
+ * @file ms9024_shadow.c
+ * @brief MS9024 register shadow — staged writes, coalesced flush, block verify.
+ */
+
+#include "ms9024_shadow.h"
+#include "modbus_master.h"
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "logger_component.h"
+#include "utils.h"
+
+static const char* TAG = "MS9024_SHADOW";
+
+#define MODBUS_MAX_READ_REGS 125
+
+/* =========================================================================
+ *  Entry lookup (entries are kept sorted by register address)
+ * ========================================================================= */
+static ms9024_shadow_entry_t* find_entry(ms9024_shadow_t* shadow, const uint16_t reg)
+{
+    for (uint8_t i = 0; i < shadow->count; i++)
+    {
+        if (shadow->entries[i].reg == reg)
+        {
+            return &shadow->entries[i];
+        }
+        if (shadow->entries[i].reg > reg)
+        {
+            break;
+        }
+    }
+    return NULL;
+}
+
+static ms9024_shadow_entry_t* get_or_insert_entry(ms9024_shadow_t* shadow, const uint16_t reg)
+{
+    ms9024_shadow_entry_t* entry = find_entry(shadow, reg);
+    if (entry != NULL)
+    {
+        return entry;
+    }
+
+    if (shadow->count == CONFIG_TEMP_SENSOR_SHADOW_MAX_REGS)
+    {
+        /* Full — evict the first clean entry, dirty ones must survive until flushed */
+        uint8_t victim = shadow->count;
+        for (uint8_t i = 0; i < shadow->count; i++)
+        {
+            if (!shadow->entries[i].dirty)
+            {
+                victim = i;
+                break;
+            }
+        }
+        if (victim == shadow->count)
+        {
+            return NULL;
+        }
+        memmove(&shadow->entries[victim], &shadow->entries[victim + 1],
+                (shadow->count - victim - 1) * sizeof(shadow->entries[0]));
+        shadow->count--;
+    }
+
+    uint8_t pos = 0;
+    while (pos < shadow->count && shadow->entries[pos].reg < reg)
+    {
+        pos++;
+    }
+    memmove(&shadow->entries[pos + 1], &shadow->entries[pos],
+            (shadow->count - pos) * sizeof(shadow->entries[0]));
+    shadow->count++;
+
+    entry = &shadow->entries[pos];
+    memset(entry, 0, sizeof(*entry));
+    entry->reg = reg;
+    entry->mask = MS9024_MASK_WORD;
+    return entry;
+}
+
+/* =========================================================================
+ *  Public API
+ * ========================================================================= */
+void ms9024_shadow_init(ms9024_shadow_t* shadow, const uint8_t slave_address)
+{
+    memset(shadow, 0, sizeof(*shadow));
+    shadow->slave_address = slave_address;
+}
+
+void ms9024_shadow_invalidate(ms9024_shadow_t* shadow)
+{
+    for (uint8_t i = 0; i < shadow->count; i++)
+    {
+        shadow->entries[i].valid = false;
+    }
+}
+
+esp_err_t ms9024_shadow_prefetch(ms9024_shadow_t* shadow, const uint16_t reg_start, const uint16_t count,
+                                 uint16_t* values)
+{
+    if (shadow == NULL || count == 0 || count > MODBUS_MAX_READ_REGS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint16_t block[MODBUS_MAX_READ_REGS];
+    CHECK_ERR_LOG_RET_FMT(modbus_master_read_registers(shadow->slave_address, reg_start, count, block),
+                          "Failed to prefetch regs %d – %d from slave %d",
+                          reg_start, reg_start + count - 1, shadow->slave_address);
+
+    for (uint16_t i = 0; i < count; i++)
+    {
+        ms9024_shadow_entry_t* entry = get_or_insert_entry(shadow, reg_start + i);
+        if (entry == NULL)
+        {
+            break;
+        }
+        entry->value = block[i];
+        entry->valid = true;
+    }
+
+    if (values != NULL)
+    {
+        memcpy(values, block, count * sizeof(uint16_t));
+    }
+    return ESP_OK;
+}
+
+esp_err_t ms9024_shadow_get(ms9024_shadow_t* shadow, const uint16_t reg, uint16_t* out)
+{
+    if (shadow == NULL || out == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const ms9024_shadow_entry_t* entry = find_entry(shadow, reg);
+    if (entry != NULL && entry->valid)
+    {
+        *out = entry->value;
+        return ESP_OK;
+    }
+
+    return ms9024_shadow_prefetch(shadow, reg, 1, out);
+}
+
+esp_err_t ms9024_shadow_stage(ms9024_shadow_t* shadow, const uint16_t reg, const uint16_t value,
+                              const uint16_t mask, bool* changed)
+{
+    if (shadow == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ms9024_shadow_entry_t* entry = get_or_insert_entry(shadow, reg);
+    if (entry == NULL)
+    {
+        LOGGER_LOG_ERROR(TAG, "Shadow for slave %d full of dirty registers, cannot stage reg %d",
+                         shadow->slave_address, reg);
+        return ESP_ERR_NO_MEM;
+    }
+
+    const bool differs = !entry->valid || (entry->value & mask) != (value & mask);
+    if (differs)
+    {
+        entry->pending = value;
+        entry->mask = mask;
+        entry->dirty = true;
+    }
+    else if (entry->dirty)
+    {
+        /* Staged back to what the device already holds — nothing to write */
+        entry->dirty = false;
+    }
+
+    if (changed != NULL)
+    {
+        *changed = differs;
+    }
+    return ESP_OK;
+}
+
+/* =========================================================================
+ *  Flush — coalesced writes, single settle, block verify
+ * ========================================================================= */
+
+/*
+ * A write run is a range of dirty registers, optionally bridging gaps of up
+ * to @p fill_gap clean-but-cached registers, which are rewritten with their
+ * current value so the whole run fits one FC 0x10 frame.
+ */
+static uint8_t next_write_run(const ms9024_shadow_t* shadow, const uint8_t from, const uint8_t fill_gap,
+                              uint8_t* run_end)
+{
+    uint8_t start = from;
+    while (start < shadow->count && !shadow->entries[start].dirty)
+    {
+        start++;
+    }
+    if (start == shadow->count)
+    {
+        return start;
+    }
+
+    uint8_t end = start;
+    uint8_t i = start + 1;
+    while (i < shadow->count)
+    {
+        const ms9024_shadow_entry_t* e = &shadow->entries[i];
+        if (e->reg != shadow->entries[i - 1].reg + 1 || (!e->dirty && (!e->valid || fill_gap == 0)))
+        {
+            break;
+        }
+        if (e->dirty)
+        {
+            end = i;
+        }
+        else if (e->reg - shadow->entries[end].reg > fill_gap)
+        {
+            break;
+        }
+        i++;
+    }
+
+    *run_end = end;
+    return start;
+}
+
+static esp_err_t write_runs(ms9024_shadow_t* shadow, const bool bridge_gaps, uint16_t* transactions)
+{
+    uint16_t values[MODBUS_MAX_READ_REGS];
+    const uint8_t fill_gap = bridge_gaps ? CONFIG_TEMP_SENSOR_SHADOW_FILL_GAP : 0;
+    uint8_t end = 0;
+
+    for (uint8_t start = next_write_run(shadow, 0, fill_gap, &end); start < shadow->count;
+         start = next_write_run(shadow, end + 1, fill_gap, &end))
+    {
+        const uint16_t reg_start = shadow->entries[start].reg;
+        const uint16_t reg_count = end - start + 1;
+
+        for (uint8_t i = start; i <= end; i++)
+        {
+            const ms9024_shadow_entry_t* e = &shadow->entries[i];
+            values[i - start] = e->dirty ? e->pending : e->value;
+        }
+
+        if (reg_count == 1)
+        {
+            CHECK_ERR_LOG_RET_FMT(modbus_master_write_register(shadow->slave_address, reg_start, values[0]),
+                                  "Failed to write reg %d on slave %d", reg_start, shadow->slave_address);
+        }
+        else
+        {
+            CHECK_ERR_LOG_RET_FMT(modbus_master_write_registers(shadow->slave_address, reg_start, reg_count, values),
+                                  "Failed to write regs %d – %d on slave %d",
+                                  reg_start, reg_start + reg_count - 1, shadow->slave_address);
+        }
+        (*transactions)++;
+    }
+    return ESP_OK;
+}
+
+static int check_readback(ms9024_shadow_t* shadow, const uint16_t reg_start, const uint16_t count,
+                          const uint16_t* block, const char* label)
+{
+    int mismatches = 0;
+    for (uint8_t i = 0; i < shadow->count; i++)
+    {
+        ms9024_shadow_entry_t* e = &shadow->entries[i];
+        if (!e->dirty || e->reg < reg_start || e->reg >= reg_start + count)
+        {
+            continue;
+        }
+
+        const uint16_t readback = block[e->reg - reg_start];
+        if ((readback & e->mask) == (e->pending & e->mask))
+        {
+            LOGGER_LOG_INFO(TAG, "✓ %s reg %d verified: %d", label, e->reg, readback & e->mask);
+            e->value = readback;
+            e->valid = true;
+        }
+        else
+        {
+            LOGGER_LOG_ERROR(TAG, "✗ %s reg %d mismatch: wrote %d, read back %d",
+                             label, e->reg, e->pending & e->mask, readback & e->mask);
+            e->valid = false;
+            mismatches++;
+        }
+        e->dirty = false;
+    }
+    return mismatches;
+}
+
+esp_err_t ms9024_shadow_flush(ms9024_shadow_t* shadow, const bool bridge_gaps, const char* label)
+{
+    if (shadow == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int first = -1, last = -1;
+    for (uint8_t i = 0; i < shadow->count; i++)
+    {
+        if (shadow->entries[i].dirty)
+        {
+            if (first < 0) first = i;
+            last = i;
+        }
+    }
+    if (first < 0)
+    {
+        LOGGER_LOG_DEBUG(TAG, "%s: nothing to flush on slave %d", label, shadow->slave_address);
+        return ESP_OK;
+    }
+
+    uint16_t transactions = 0;
+    const esp_err_t write_err = write_runs(shadow, bridge_gaps, &transactions);
+    if (write_err != ESP_OK)
+    {
+        /* Device state unknown for anything we staged — force a re-read next time */
+        for (uint8_t i = 0; i < shadow->count; i++)
+        {
+            if (shadow->entries[i].dirty)
+            {
+                shadow->entries[i].dirty = false;
+                shadow->entries[i].valid = false;
+            }
+        }
+        return write_err;
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(CONFIG_TEMP_SENSOR_SHADOW_SETTLE_MS)); /* One settle for the whole batch */
+
+    uint16_t block[MODBUS_MAX_READ_REGS];
+    int mismatches = 0;
+    const uint16_t span_start = shadow->entries[first].reg;
+    const uint16_t span_count = shadow->entries[last].reg - span_start + 1;
+
+    /* One block read covering every dirty register when the span is short enough */
+    if (span_count <= CONFIG_TEMP_SENSOR_SHADOW_VERIFY_MAX_SPAN &&
+        modbus_master_read_registers(shadow->slave_address, span_start, span_count, block) == ESP_OK)
+    {
+        transactions++;
+        mismatches = check_readback(shadow, span_start, span_count, block, label);
+    }
+
+    /* Far-apart or unreadable span — verify in clusters that each fit one block read */
+    for (uint8_t i = 0; i < shadow->count; i++)
+    {
+        if (!shadow->entries[i].dirty)
+        {
+            continue;
+        }
+        const uint16_t run_start = shadow->entries[i].reg;
+        uint8_t j = i;
+        for (uint8_t k = i + 1; k < shadow->count; k++)
+        {
+            if (shadow->entries[k].reg - run_start >= CONFIG_TEMP_SENSOR_SHADOW_VERIFY_MAX_SPAN)
+            {
+                break;
+            }
+            if (shadow->entries[k].dirty)
+            {
+                j = k;
+            }
+        }
+        const uint16_t run_count = shadow->entries[j].reg - run_start + 1;
+        if (modbus_master_read_registers(shadow->slave_address, run_start, run_count, block) == ESP_OK)
+        {
+            transactions++;
+            mismatches += check_readback(shadow, run_start, run_count, block, label);
+        }
+        else
+        {
+            LOGGER_LOG_ERROR(TAG, "%s: failed to read back regs %d – %d", label, run_start,
+                             run_start + run_count - 1);
+            for (uint8_t k = i; k <= j; k++)
+            {
+                if (shadow->entries[k].dirty)
+                {
+                    shadow->entries[k].dirty = false;
+                    shadow->entries[k].valid = false;
+                    mismatches++;
+                }
+            }
+        }
+        i = j;
+    }
+
+    LOGGER_LOG_INFO(TAG, "%s: flushed slave %d in %d transactions, %d mismatches",
+                    label, shadow->slave_address, transactions, mismatches);
+    return mismatches == 0 ? ESP_OK : ESP_FAIL;
+}
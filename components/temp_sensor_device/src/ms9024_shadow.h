@@ -0,0 +1,73 @@
+/**
+ * @file ms9024_shadow.h
+ * @brief Per-device shadow copy of MS9024 holding registers with dirty tracking.
+ *
+ * Writes are staged against the cached value and skipped when nothing
+ * changes.  A flush coalesces contiguous dirty registers into one
+ * WRITE_MULTIPLE_REGISTERS transaction, waits a single settle delay and
+ * verifies everything with as few block reads as possible.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#define MS9024_MASK_LSB   0x00FF  /* Config registers — only the LSByte is significant */
+#define MS9024_MASK_WORD  0xFFFF
+
+typedef struct
+{
+    uint16_t reg;
+    uint16_t value;    // Last value known to be on the device
+    uint16_t pending;  // Value waiting to be flushed
+    uint16_t mask;     // Bits compared when skipping and verifying
+    bool valid;        // value mirrors the device
+    bool dirty;        // pending must be written
+} ms9024_shadow_entry_t;
+
+typedef struct
+{
+    uint8_t slave_address;
+    uint8_t count;
+    ms9024_shadow_entry_t entries[CONFIG_TEMP_SENSOR_SHADOW_MAX_REGS]; // Sorted by reg
+} ms9024_shadow_t;
+
+void ms9024_shadow_init(ms9024_shadow_t* shadow, uint8_t slave_address);
+
+/**
+ * @brief Drop every cached value (e.g. after the transmitter was power-cycled).
+ */
+void ms9024_shadow_invalidate(ms9024_shadow_t* shadow);
+
+/**
+ * @brief Read a register block in one transaction and cache it.
+ *
+ * @param[out] values Optional copy of the raw block (may be NULL).
+ */
+esp_err_t ms9024_shadow_prefetch(ms9024_shadow_t* shadow, uint16_t reg_start, uint16_t count, uint16_t* values);
+
+/**
+ * @brief Return a register value, reading it from the device only on a cache miss.
+ */
+esp_err_t ms9024_shadow_get(ms9024_shadow_t* shadow, uint16_t reg, uint16_t* out);
+
+/**
+ * @brief Stage a register write.
+ *
+ * If the cached value already matches under @p mask the write is skipped and
+ * @p changed is set to false.  An uncached register is always staged.
+ */
+esp_err_t ms9024_shadow_stage(ms9024_shadow_t* shadow, uint16_t reg, uint16_t value, uint16_t mask, bool* changed);
+
+/**
+ * @brief Write all dirty registers and verify them.
+ *
+ * @param bridge_gaps Let a write run rewrite up to CONFIG_TEMP_SENSOR_SHADOW_FILL_GAP
+ *                    clean registers with their cached value.  Pass false when the
+ *                    cached values themselves are suspect (e.g. repairing a unit),
+ *                    so only the staged registers are touched.
+ * @return ESP_OK if every dirty register read back with the staged value.
+ */
+esp_err_t ms9024_shadow_flush(ms9024_shadow_t* shadow, bool bridge_gaps, const char* label);
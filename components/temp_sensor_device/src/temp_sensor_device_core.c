@@ -1,35 +1,53 @@
+#include <stdio.h>
+
 #include "modbus_master.h"
+#include "modbus_poll_scheduler.h"
+#include "modbus_slave_health.h"
 #include "temp_sensor_device.h"
 #include "temp_sensor_device_internal.h"
 #include "sdkconfig.h"
 #include "utils.h"
 #include "ms9024.h"
+#include "esp_timer.h"
 
 static const char* TAG = "TEMP_SENSOR_DEVICE";
 
 static temp_sensor_device_t ctx_pool[CONFIG_TEMP_SENSOR_DEVICE_MAX_DEVICES] = {0};
 
 static esp_err_t temp_sensor_update(void* ctx);
+static void temp_sensor_check_config(temp_sensor_device_t* device_ctx, bool force_dump);
 
 static esp_err_t temp_sensor_init(void* ctx);
 static esp_err_t temp_sensor_read(void* ctx, void* data_out);
 static esp_err_t temp_sensor_write(void* ctx, const device_write_cmd_t* cmd);
+static bool temp_sensor_is_available(void* ctx);
 
 static device_ops_t device_ops = {
     .init = temp_sensor_init,
     .update = temp_sensor_update,
     .read = temp_sensor_read,
     .write = temp_sensor_write,
-    .shutdown = NULL
+    .shutdown = NULL,
+    .is_available = temp_sensor_is_available,
+    .bus = DEVICE_BUS_MODBUS,
 };
 
-esp_err_t temp_sensor_create(temp_sensor_device_t** device)
+esp_err_t temp_sensor_create(const uint8_t modbus_address, temp_sensor_device_t** device)
 {
     if (device == NULL)
     {
         return ESP_ERR_INVALID_ARG;
     }
 
+    for (uint16_t i = 0; i < CONFIG_TEMP_SENSOR_DEVICE_MAX_DEVICES; i++)
+    {
+        if (ctx_pool[i].allocated && ctx_pool[i].modbus_address == modbus_address)
+        {
+            LOGGER_LOG_ERROR(TAG, "Modbus address %d already used by temp sensor %d", modbus_address, i);
+            return ESP_ERR_INVALID_STATE;
+        }
+    }
+
     LOGGER_LOG_DEBUG(TAG, "Creating temp sensor device %d", CONFIG_TEMP_SENSOR_DEVICE_MAX_DEVICES);
     for (uint16_t i = 0; i < CONFIG_TEMP_SENSOR_DEVICE_MAX_DEVICES; i++)
     {
@@ -38,14 +56,22 @@ esp_err_t temp_sensor_create(temp_sensor_device_t** device)
             ctx_pool[i].allocated = true;
             ctx_pool[i].valid = true;
             ctx_pool[i].id = i;
-            ctx_pool[i].last_temperature = 0.0f;
-            ctx_pool[i].modbus_address = CONFIG_TEMP_SENSOR_MODBUS_START_ADDRESS;
+            device_snapshot_init(&ctx_pool[i].reading, ctx_pool[i].reading_storage, sizeof(temp_sensor_reading_t));
+            ctx_pool[i].first_reading_ms = 0;
+            ctx_pool[i].modbus_address = modbus_address;
             ctx_pool[i].modbus_register = MS9024_REG_PV;
+            ms9024_shadow_init(&ctx_pool[i].shadow, modbus_address);
+            snprintf(ctx_pool[i].name, sizeof(ctx_pool[i].name), "temp_sensor_%u", modbus_address);
             CHECK_ERR_LOG_RET(
-                device_manager_create_device(&ctx_pool[i], &device_ops, "temp_sensor", DEVICE_TYPE_TEMP_SENSOR, &
+                device_manager_create_device(&ctx_pool[i], &device_ops, ctx_pool[i].name, DEVICE_TYPE_TEMP_SENSOR, &
                     ctx_pool
                     [i].device_handle),
                 "Failed to create temp sensor device");
+
+            /* No point updating faster than the poll scheduler samples the transmitter */
+            const device_schedule_t schedule = {.period_ms = CONFIG_TEMP_SENSOR_POLL_PERIOD_MS};
+            CHECK_ERR_LOG(device_manager_set_device_schedule(ctx_pool[i].device_handle, &schedule),
+                          "Failed to set temp sensor update period");
             LOGGER_LOG_INFO(TAG, "Temp sensor device created with ID %d", ctx_pool[i].id);
             *device = &ctx_pool[i];
             return ESP_OK;
@@ -63,6 +89,12 @@ esp_err_t temp_sensor_destroy(temp_sensor_device_t* device)
     device->allocated = false;
     device->valid = false;
 
+    if (device->poll_slot != NULL)
+    {
+        modbus_poll_scheduler_remove(device->poll_slot);
+        device->poll_slot = NULL;
+    }
+
     CHECK_ERR_LOG_RET(device_manager_destroy(device->device_handle),
                       "Failed to destroy temp sensor device");
 
@@ -108,6 +140,69 @@ esp_err_t temp_sensor_write_device(const temp_sensor_device_t* device, const dev
     return ESP_OK;
 }
 
+esp_err_t temp_sensor_get_time_to_first_reading(const temp_sensor_device_t* device, uint32_t* out_ms)
+{
+    if (device == NULL || !device->allocated || !device->valid || out_ms == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (device->first_reading_ms == 0)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    *out_ms = device->first_reading_ms;
+    return ESP_OK;
+}
+
+/**
+ * @brief Compare the transmitter's config block against the NVS fingerprint.
+ *
+ * The full register dump is slow (dozens of reads with settle delays), so
+ * it only runs when the fingerprint changed, none is stored, or on request.
+ */
+static void temp_sensor_check_config(temp_sensor_device_t* device_ctx, const bool force_dump)
+{
+    const uint8_t address = (uint8_t)device_ctx->modbus_address;
+
+    uint32_t current = 0;
+    const esp_err_t read_err = ms9024_read_config_fingerprint(&device_ctx->shadow, &current);
+    if (read_err != ESP_OK)
+    {
+        LOGGER_LOG_WARN(TAG, "Config fingerprint read failed for sensor at address %d, dumping config", address);
+        ms9024_log_config(address, MS9024_REG_PV);
+        return;
+    }
+
+    uint32_t stored = 0;
+    const bool matches = ms9024_load_config_fingerprint(address, &stored) == ESP_OK && stored == current;
+    if (matches && !force_dump)
+    {
+        LOGGER_LOG_INFO(TAG, "Sensor at address %d config unchanged (fingerprint 0x%08lX), skipping dump",
+                        address, (unsigned long)current);
+        return;
+    }
+
+    if (!matches)
+    {
+        LOGGER_LOG_WARN(TAG, "Sensor at address %d config fingerprint changed: 0x%08lX → 0x%08lX",
+                        address, (unsigned long)stored, (unsigned long)current);
+    }
+    ms9024_log_config(address, MS9024_REG_PV);
+
+    if (!matches)
+    {
+        CHECK_ERR_LOG(ms9024_store_config_fingerprint(address, current),
+                      "Failed to store config fingerprint");
+    }
+}
+
+static bool temp_sensor_is_available(void* ctx)
+{
+    const temp_sensor_device_t* device_ctx = (temp_sensor_device_t*)ctx;
+    return device_ctx != NULL && modbus_master_is_slave_available((uint8_t)device_ctx->modbus_address);
+}
+
 static esp_err_t temp_sensor_read(void* ctx, void* data_out)
 {
     const temp_sensor_device_t* device_ctx = (temp_sensor_device_t*)ctx;
@@ -117,7 +212,20 @@ static esp_err_t temp_sensor_read(void* ctx, void* data_out)
         return ESP_ERR_INVALID_STATE;
     }
 
-    *(float*)data_out = device_ctx->last_temperature;
+    temp_sensor_reading_t reading;
+    if (!device_snapshot_read(&device_ctx->reading, &reading))
+    {
+        /* No valid temperature yet — do not hand out the 0.0 placeholder */
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    if (esp_timer_get_time() - reading.timestamp_us > (int64_t)CONFIG_TEMP_SENSOR_SAMPLE_MAX_AGE_MS * 1000)
+    {
+        /* update() stopped publishing (transmitter gone, circuit open) — do not hand out a frozen value */
+        return ESP_ERR_TIMEOUT;
+    }
+
+    *(float*)data_out = reading.temperature;
     return ESP_OK;
 }
 
@@ -129,7 +237,27 @@ static esp_err_t temp_sensor_init(void* ctx)
         return ESP_ERR_INVALID_STATE;
     }
 
-    ms9024_log_config(device_ctx->modbus_address, MS9024_REG_PV);
+    device_ctx->init_time_us = esp_timer_get_time();
+
+#if CONFIG_TEMP_SENSOR_FORCE_CONFIG_DUMP
+    temp_sensor_check_config(device_ctx, true);
+#else
+    temp_sensor_check_config(device_ctx, false);
+#endif
+
+    if (device_ctx->poll_slot == NULL)
+    {
+        const modbus_poll_config_t poll_config = {
+            .name = device_ctx->name,
+            .slave_addr = (uint8_t)device_ctx->modbus_address,
+            .reg_start = device_ctx->modbus_register,
+            .reg_count = 2,
+            .period_ms = CONFIG_TEMP_SENSOR_POLL_PERIOD_MS,
+        };
+        CHECK_ERR_LOG_RET_FMT(modbus_poll_scheduler_add(&poll_config, &device_ctx->poll_slot),
+                              "Failed to register poll slot for sensor at address %d",
+                              device_ctx->modbus_address);
+    }
 
     return ESP_OK;
 }
@@ -142,13 +270,44 @@ static esp_err_t temp_sensor_update(void* ctx)
         return ESP_ERR_INVALID_STATE;
     }
 
-    /* Read temperature from Modbus register */
+    /* Pick up the latest sample from the poll scheduler — no bus I/O here */
+    uint16_t registers[2];
+    uint32_t age_ms = 0;
+    const esp_err_t sample_err = modbus_poll_scheduler_get_sample(device_ctx->poll_slot, registers, 2, &age_ms);
+    if (sample_err == ESP_ERR_NOT_FOUND &&
+        esp_timer_get_time() - device_ctx->init_time_us < (int64_t)CONFIG_TEMP_SENSOR_SAMPLE_MAX_AGE_MS * 1000)
+    {
+        /* First poll not completed yet — not an error during start-up */
+        return ESP_OK;
+    }
+    CHECK_ERR_LOG_RET_FMT(sample_err,
+                          "No sample from sensor at address %d, register %d",
+                          device_ctx->modbus_address, device_ctx->modbus_register);
+
+    if (age_ms > CONFIG_TEMP_SENSOR_SAMPLE_MAX_AGE_MS)
+    {
+        LOGGER_LOG_WARN(TAG, "Sample from sensor at address %d is stale (%lu ms)",
+                        device_ctx->modbus_address, (unsigned long)age_ms);
+        return ESP_ERR_TIMEOUT;
+    }
+
     float last_temperature;
-    CHECK_ERR_LOG_RET_FMT(ms9024_read_float(device_ctx->modbus_address, device_ctx->modbus_register, &last_temperature),
-                          "Failed to read temperature from sensor at address %d, register %d",
+    CHECK_ERR_LOG_RET_FMT(ms9024_decode_float(registers, &last_temperature),
+                          "Invalid temperature from sensor at address %d, register %d",
                           device_ctx->modbus_address, device_ctx->modbus_register);
 
-    device_ctx->last_temperature = last_temperature;
+    temp_sensor_reading_t* reading = device_snapshot_begin_write(&device_ctx->reading);
+    reading->temperature = last_temperature;
+    reading->timestamp_us = esp_timer_get_time();
+    reading->sample_age_ms = age_ms;
+    device_snapshot_publish(&device_ctx->reading);
+
+    if (device_ctx->first_reading_ms == 0)
+    {
+        device_ctx->first_reading_ms = (uint32_t)(esp_timer_get_time() / 1000);
+        LOGGER_LOG_INFO(TAG, "Sensor at address %d: first valid temperature %.2f C, %lu ms after boot",
+                        device_ctx->modbus_address, last_temperature, (unsigned long)device_ctx->first_reading_ms);
+    }
     return ESP_OK;
 }
 
@@ -177,7 +336,7 @@ static esp_err_t temp_sensor_write(void* ctx, const device_write_cmd_t* cmd)
                 (temp_sensor_device_set_register_value_cmd_params_t*)cmd->params;
 
             CHECK_ERR_LOG_RET_FMT(
-                ms9024_write_and_verify(device_ctx->modbus_address, params->register_address, params->value,
+                ms9024_write_and_verify(&device_ctx->shadow, params->register_address, params->value,
                     "temp sensor register"),
                 "Failed to write register %d at address %d",
                 params->register_address, device_ctx->modbus_address);
@@ -185,11 +344,16 @@ static esp_err_t temp_sensor_write(void* ctx, const device_write_cmd_t* cmd)
         }
     case TEMP_SENSOR_REPAIR_FORM_GOOD_UNIT:
         {
-            CHECK_ERR_LOG_RET_FMT(ms9024_repair_from_good_unit(device_ctx->modbus_address),
+            CHECK_ERR_LOG_RET_FMT(ms9024_repair_from_good_unit(&device_ctx->shadow),
                                   "Failed to repair temp sensor at address %d",
                                   device_ctx->modbus_address);
             break;
         }
+    case TEMP_SENSOR_DEVICE_COMMAND_DUMP_CONFIG:
+        {
+            temp_sensor_check_config(device_ctx, true);
+            break;
+        }
     default:
         return ESP_ERR_INVALID_ARG;
     }
@@ -7,14 +7,31 @@
 
 #include "esp_err.h"
 #include "device_manager.h"
+#include "device_snapshot.h"
+#include "modbus_poll_scheduler.h"
+#include "ms9024_shadow.h"
+
+/* Published by update() on the Modbus worker, copied lock-free by read() */
+typedef struct
+{
+    float temperature;
+    int64_t timestamp_us;   // When update() decoded the sample
+    uint32_t sample_age_ms; // Age of the poll sample at that time
+} temp_sensor_reading_t;
 
 struct temp_sensor_device
 {
     uint16_t id;
-    float last_temperature;
+    char name[20];              // "temp_sensor_<address>", the device manager keeps the pointer
+    device_snapshot_t reading;
+    temp_sensor_reading_t reading_storage[2];
+    int64_t init_time_us;
+    uint32_t first_reading_ms;  // Time from boot to first valid temperature, 0 = none yet
     bool valid;
     bool allocated;
     uint16_t modbus_address;
     uint16_t modbus_register;
+    modbus_poll_slot_t* poll_slot;
+    ms9024_shadow_t shadow;     // Cached holding registers, see ms9024_shadow.h
     device_t * device_handle;
 };
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "temperature_profile_types.h"
+
+/* Every stage slot plus the implicit cooldown */
+#define PROFILE_SEGMENT_TABLE_CAPACITY (PROGRAMS_TOTAL_STAGE_COUNT + 1)
+
+/**
+ * @brief One linear piece of the planned temperature curve.
+ */
+typedef struct
+{
+    uint32_t start_ms;          ///< Cumulative program time at which the segment begins
+    uint32_t duration_ms;
+    float start_temp_c;
+    float slope_c_per_ms;
+    int stage_index;            ///< Index into program stages[], -1 for the cooldown
+    stage_phase_t phase;        ///< STAGE_PHASE_RAMPING for stages, STAGE_PHASE_COOLDOWN for the cooldown
+} profile_segment_t;
+
+/**
+ * @brief A program compiled into its planned curve.
+ *
+ * Built once from a program_draft_t and never modified afterwards, so the
+ * stage walk, minute-to-ms conversion and cooldown estimate are done in one
+ * place.  Segments are ordered by start_ms and back to back; the curve is 0 C
+ * after total_ms.  A stage with no duration is a step to its target.
+ */
+typedef struct
+{
+    profile_segment_t segments[PROFILE_SEGMENT_TABLE_CAPACITY];
+    uint8_t segment_count;
+    uint8_t stage_count;        ///< Segments that come from program stages
+    uint32_t heating_ms;        ///< End of the last stage
+    uint32_t total_ms;          ///< End of the cooldown
+} profile_segment_table_t;
+
+/**
+ * @brief Compile a program into a segment table.
+ *
+ * Stages without is_set are skipped.  The cooldown runs from the last stage
+ * target (or start_temp_c when there are no stages) to 0 C at
+ * cooldown_rate_x10 / 10 C per minute, at least one minute, and is omitted
+ * when the rate is not positive.
+ *
+ * @param[out] table          Table to fill.
+ * @param program             Program to compile.
+ * @param start_temp_c        Furnace temperature at time 0.
+ * @param cooldown_rate_x10   Natural cooling rate x10 (C/min).
+ * @return PROFILE_CONTROLLER_ERROR_INVALID_ARG on NULL arguments.
+ */
+profile_controller_error_t profile_segment_table_build(profile_segment_table_t *table,
+                                                       const program_draft_t *program,
+                                                       float start_temp_c,
+                                                       int cooldown_rate_x10);
+
+/**
+ * @brief Last segment starting at or before time_ms, or NULL after total_ms.  O(log n).
+ */
+const profile_segment_t *profile_segment_table_find(const profile_segment_table_t *table, uint32_t time_ms);
+
+/**
+ * @brief Temperature of a segment at time_ms (not range-checked).
+ *
+ * For callers sweeping forward through the curve, e.g. a graph render,
+ * which can step from segment to segment instead of searching per sample.
+ */
+static inline float profile_segment_temperature_at(const profile_segment_t *segment, const uint32_t time_ms)
+{
+    return segment->start_temp_c + segment->slope_c_per_ms * (float)(time_ms - segment->start_ms);
+}
+
+/**
+ * @brief Planned temperature at time_ms; 0 C after total_ms.
+ */
+float profile_segment_table_temperature_at(const profile_segment_table_t *table, uint32_t time_ms);
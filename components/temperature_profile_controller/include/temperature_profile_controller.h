@@ -1,5 +1,6 @@
 #pragma once
 
+#include "profile_segment_table.h"
 #include "temperature_profile_types.h"
 
 profile_controller_error_t load_heating_profile(const temp_profile_config_t config);
@@ -7,12 +8,19 @@ profile_controller_error_t load_heating_profile(const temp_profile_config_t conf
 /**
  * @brief (Legacy) Get the planned/projected target temperature at a given time.
  *
- * Pure time-based linear interpolation through stages.  Used by the graph
- * builder to render the projected curve.  Does NOT account for real-world
- * temperature deviations — use profile_tick() for actual execution.
+ * Pure time-based linear interpolation through stages, looked up in the
+ * segment table compiled by load_heating_profile().  Does NOT account for
+ * real-world temperature deviations — use profile_tick() for actual execution.
  */
 profile_controller_error_t get_target_temperature_at_time(const uint32_t time_ms, float *temperature);
 
+/**
+ * @brief Planned curve of the loaded profile, or NULL when none is loaded.
+ *
+ * Valid until the next load_heating_profile() or shutdown_profile_controller().
+ */
+const profile_segment_table_t *get_profile_segment_table(void);
+
 /**
  * @brief Advance the stateful profile controller by one tick.
  *
@@ -37,6 +45,25 @@ profile_controller_error_t profile_tick(uint32_t elapsed_since_last_ms,
  */
 void profile_tick_reset(void);
 
+/**
+ * @brief Capture the tick state so a profile can be resumed after a reset.
+ *
+ * @param[out] snapshot  Filled with the current stage, phase and timers.
+ * @return PROFILE_CONTROLLER_ERROR_NO_PROFILE_LOADED before the first tick.
+ */
+profile_controller_error_t profile_tick_get_snapshot(profile_tick_snapshot_t *snapshot);
+
+/**
+ * @brief Continue the loaded profile from a snapshot.
+ *
+ * Call after load_heating_profile() with the program the snapshot was taken
+ * from; the next profile_tick() carries on from the saved stage and phase.
+ *
+ * @return PROFILE_CONTROLLER_ERROR_INVALID_ARG if the snapshot does not fit
+ *         the loaded program.
+ */
+profile_controller_error_t profile_tick_restore(const profile_tick_snapshot_t *snapshot);
+
 /**
  * @brief Live-update the current stage target and re-ramp from now.
  *
@@ -41,3 +41,23 @@ typedef struct {
     bool         profile_complete;     ///< True when cooldown is done + temp below threshold
     bool         extension_warning;    ///< True if a stage hit max extension and was forced to advance
 } profile_tick_result_t;
+
+/**
+ * @brief Resume state of the profile_tick() state machine.
+ *
+ * With the same program loaded, profile_tick_restore() puts the controller
+ * back where profile_tick_get_snapshot() found it.
+ */
+typedef struct {
+    int8_t       active_pos;           ///< Position among the set stages; the stage count means cooldown
+    uint8_t      phase;                ///< stage_phase_t
+    bool         extension_warning;
+    uint32_t     stage_elapsed_ms;
+    uint32_t     stage_planned_ms;
+    uint32_t     overtime_ms;
+    float        stage_start_temp;
+    float        stage_target_temp;
+    float        cooldown_start_temp;
+    uint32_t     cooldown_elapsed_ms;
+    uint32_t     cooldown_total_ms;
+} profile_tick_snapshot_t;
@@ -0,0 +1,107 @@
+/**
+ * @file profile_segment_table.c
+ * @brief Compiles a program into its planned temperature curve.
+ */
+
+#include "profile_segment_table.h"
+
+#include <string.h>
+
+/* ── Helpers ──────────────────────────────────────────────────────── */
+
+static void append_segment(profile_segment_table_t *table, const uint32_t start_ms, const uint32_t duration_ms,
+                           const float start_temp_c, const float end_temp_c, const int stage_index,
+                           const stage_phase_t phase)
+{
+    profile_segment_t *segment = &table->segments[table->segment_count++];
+    segment->start_ms = start_ms;
+    segment->duration_ms = duration_ms;
+    segment->stage_index = stage_index;
+    segment->phase = phase;
+
+    if (duration_ms > 0) {
+        segment->start_temp_c = start_temp_c;
+        segment->slope_c_per_ms = (end_temp_c - start_temp_c) / (float)duration_ms;
+    } else {
+        /* No time to ramp in: the whole segment sits at its target */
+        segment->start_temp_c = end_temp_c;
+        segment->slope_c_per_ms = 0.0f;
+    }
+}
+
+/* ── Public API ───────────────────────────────────────────────────── */
+
+profile_controller_error_t profile_segment_table_build(profile_segment_table_t *table,
+                                                       const program_draft_t *program,
+                                                       const float start_temp_c,
+                                                       const int cooldown_rate_x10)
+{
+    if (table == NULL || program == NULL)
+    {
+        return PROFILE_CONTROLLER_ERROR_INVALID_ARG;
+    }
+
+    memset(table, 0, sizeof(*table));
+
+    uint32_t elapsed_ms = 0;
+    float temp_c = start_temp_c;
+
+    for (int i = 0; i < PROGRAMS_TOTAL_STAGE_COUNT; ++i)
+    {
+        const program_stage_t *stage = &program->stages[i];
+        if (!stage->is_set) {
+            continue;
+        }
+
+        const uint32_t duration_ms = (uint32_t)stage->t_min * 60U * 1000U;
+        append_segment(table, elapsed_ms, duration_ms, temp_c, (float)stage->target_t_c, i, STAGE_PHASE_RAMPING);
+
+        elapsed_ms += duration_ms;
+        temp_c = (float)stage->target_t_c;
+    }
+    table->stage_count = table->segment_count;
+    table->heating_ms = elapsed_ms;
+
+    /* Implicit cooldown: ramp from the last stage temperature to 0 C */
+    if (temp_c > 0.0f && cooldown_rate_x10 > 0) {
+        float cooldown_min = (temp_c * 10.0f) / (float)cooldown_rate_x10;
+        if (cooldown_min < 1.0f) {
+            cooldown_min = 1.0f;
+        }
+        const uint32_t cooldown_ms = (uint32_t)(cooldown_min * 60.0f * 1000.0f);
+        append_segment(table, elapsed_ms, cooldown_ms, temp_c, 0.0f, -1, STAGE_PHASE_COOLDOWN);
+        elapsed_ms += cooldown_ms;
+    }
+    table->total_ms = elapsed_ms;
+
+    return PROFILE_CONTROLLER_ERROR_NONE;
+}
+
+const profile_segment_t *profile_segment_table_find(const profile_segment_table_t *table, const uint32_t time_ms)
+{
+    if (table == NULL || table->segment_count == 0 || time_ms > table->total_ms) {
+        return NULL;
+    }
+
+    /* Last segment with start_ms <= time_ms; segments[0] always starts at 0 */
+    size_t lo = 0;
+    size_t hi = table->segment_count;
+    while (hi - lo > 1) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (table->segments[mid].start_ms <= time_ms) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return &table->segments[lo];
+}
+
+float profile_segment_table_temperature_at(const profile_segment_table_t *table, const uint32_t time_ms)
+{
+    const profile_segment_t *segment = profile_segment_table_find(table, time_ms);
+    if (segment == NULL) {
+        return 0.0f;
+    }
+    return profile_segment_temperature_at(segment, time_ms);
+}
@@ -1,7 +1,9 @@
 #include "temperature_profile_controller.h"
+#include "profile_segment_table.h"
 #include "sdkconfig.h"
 #include "logger_component.h"
 #include <math.h>
+#include <stdlib.h>
 #include <string.h>
 
 static const char *TAG = "TEMP_PROFILE_CONTROLLER";
@@ -10,6 +12,7 @@ typedef struct {
     float initial_temperature;
     const program_draft_t *program;    // Points to the ProgramDraft being executed
     int cooldown_rate_x10;          // User-configured cooldown rate (x10)
+    profile_segment_table_t segments;  // Planned curve, compiled on load
 } temperature_profile_controller_context_t;
 
 static temperature_profile_controller_context_t *g_temp_profile_controller_ctx = NULL;
@@ -79,6 +82,8 @@ profile_controller_error_t load_heating_profile(const temp_profile_config_t conf
     g_temp_profile_controller_ctx->program = config.program;
     g_temp_profile_controller_ctx->initial_temperature = config.initial_temperature;
     g_temp_profile_controller_ctx->cooldown_rate_x10 = config.cooldown_rate_x10;
+    profile_segment_table_build(&g_temp_profile_controller_ctx->segments, config.program,
+                                config.initial_temperature, config.cooldown_rate_x10);
 
     /* Reset tick state for new profile */
     profile_tick_reset();
@@ -86,7 +91,7 @@ profile_controller_error_t load_heating_profile(const temp_profile_config_t conf
     return PROFILE_CONTROLLER_ERROR_NONE;
 }
 
-/* ── Legacy time-based interpolation (for graph rendering) ────────── */
+/* ── Planned curve lookups ────────────────────────────────────────── */
 
 profile_controller_error_t get_target_temperature_at_time(const uint32_t time_ms, float *temperature)
 {
@@ -96,52 +101,22 @@ profile_controller_error_t get_target_temperature_at_time(const uint32_t time_ms
         return PROFILE_CONTROLLER_ERROR_NO_PROFILE_LOADED;
     }
 
-    const program_draft_t *prog = g_temp_profile_controller_ctx->program;
-    uint32_t elapsed_time = 0;
-    float start_temp = g_temp_profile_controller_ctx->initial_temperature;
-
-    for (int i = 0; i < PROGRAMS_TOTAL_STAGE_COUNT; ++i)
+    if (temperature == NULL)
     {
-        const program_stage_t *stage = &prog->stages[i];
-        if (!stage->is_set)
-        {
-            continue;
-        }
-
-        uint32_t stage_duration_ms = (uint32_t)stage->t_min * 60U * 1000U;
-
-        if (time_ms <= elapsed_time + stage_duration_ms)
-        {
-            // Linear interpolation within this stage
-            float t = (float)(time_ms - elapsed_time) / (float)stage_duration_ms;
-            *temperature = start_temp + ((float)stage->target_t_c - start_temp) * t;
-            return PROFILE_CONTROLLER_ERROR_NONE;
-        }
-
-        elapsed_time += stage_duration_ms;
-        start_temp = (float)stage->target_t_c;
+        return PROFILE_CONTROLLER_ERROR_INVALID_ARG;
     }
 
-    /* Implicit cooldown: ramp from last stage temp to 0 C */
-    int cd_rate = g_temp_profile_controller_ctx->cooldown_rate_x10;
-    if (start_temp > 0.0f && cd_rate > 0) {
-        float cooldown_min = (start_temp * 10.0f) / (float)cd_rate;
-        if (cooldown_min < 1.0f) {
-            cooldown_min = 1.0f;
-        }
-        uint32_t cooldown_ms = (uint32_t)(cooldown_min * 60.0f * 1000.0f);
+    *temperature = profile_segment_table_temperature_at(&g_temp_profile_controller_ctx->segments, time_ms);
+    return PROFILE_CONTROLLER_ERROR_NONE;
+}
 
-        if (time_ms <= elapsed_time + cooldown_ms) {
-            float t = (float)(time_ms - elapsed_time) / (float)cooldown_ms;
-            *temperature = start_temp * (1.0f - t);
-            return PROFILE_CONTROLLER_ERROR_NONE;
-        }
-        elapsed_time += cooldown_ms;
+const profile_segment_table_t *get_profile_segment_table(void)
+{
+    if (g_temp_profile_controller_ctx == NULL || g_temp_profile_controller_ctx->program == NULL)
+    {
+        return NULL;
     }
-
-    /* Past cooldown — hold at 0 */
-    *temperature = 0.0f;
-    return PROFILE_CONTROLLER_ERROR_NONE;
+    return &g_temp_profile_controller_ctx->segments;
 }
 
 /* ── Stateful profile tick ────────────────────────────────────────── */
@@ -436,6 +411,73 @@ profile_controller_error_t shutdown_profile_controller(void)
     return PROFILE_CONTROLLER_ERROR_NONE;
 }
 
+/* ── Checkpoint snapshot / restore ────────────────────────────────── */
+
+profile_controller_error_t profile_tick_get_snapshot(profile_tick_snapshot_t *snapshot)
+{
+    if (snapshot == NULL) {
+        return PROFILE_CONTROLLER_ERROR_INVALID_ARG;
+    }
+    if (!s_tick.initialized) {
+        return PROFILE_CONTROLLER_ERROR_NO_PROFILE_LOADED;
+    }
+
+    *snapshot = (profile_tick_snapshot_t){
+        .active_pos          = (int8_t)s_tick.active_pos,
+        .phase               = (uint8_t)s_tick.phase,
+        .extension_warning   = s_tick.extension_warning,
+        .stage_elapsed_ms    = s_tick.stage_elapsed_ms,
+        .stage_planned_ms    = s_tick.stage_planned_ms,
+        .overtime_ms         = s_tick.overtime_ms,
+        .stage_start_temp    = s_tick.stage_start_temp,
+        .stage_target_temp   = s_tick.stage_target_temp,
+        .cooldown_start_temp = s_tick.cooldown_start_temp,
+        .cooldown_elapsed_ms = s_tick.cooldown_elapsed_ms,
+        .cooldown_total_ms   = s_tick.cooldown_total_ms,
+    };
+    return PROFILE_CONTROLLER_ERROR_NONE;
+}
+
+profile_controller_error_t profile_tick_restore(const profile_tick_snapshot_t *snapshot)
+{
+    if (!g_temp_profile_controller_ctx || !g_temp_profile_controller_ctx->program) {
+        return PROFILE_CONTROLLER_ERROR_NO_PROFILE_LOADED;
+    }
+    if (snapshot == NULL || snapshot->phase > STAGE_PHASE_COMPLETE) {
+        return PROFILE_CONTROLLER_ERROR_INVALID_ARG;
+    }
+
+    profile_tick_reset();
+    build_active_stage_list(g_temp_profile_controller_ctx->program);
+
+    /* Active stages run RAMPING..EXTEND; past the last stage only cooldown or complete */
+    const bool in_stage = snapshot->phase < STAGE_PHASE_COOLDOWN;
+    if (snapshot->active_pos < 0 || snapshot->active_pos > s_tick.num_active_stages ||
+        in_stage != (snapshot->active_pos < s_tick.num_active_stages)) {
+        LOGGER_LOG_ERROR(TAG, "Snapshot (stage %d, phase %d) does not fit the loaded program (%d stages)",
+                         snapshot->active_pos, snapshot->phase, s_tick.num_active_stages);
+        return PROFILE_CONTROLLER_ERROR_INVALID_ARG;
+    }
+
+    s_tick.initialized         = true;
+    s_tick.active_pos          = snapshot->active_pos;
+    s_tick.stage_index         = in_stage ? s_tick.active_stages[snapshot->active_pos] : -1;
+    s_tick.phase               = (stage_phase_t)snapshot->phase;
+    s_tick.extension_warning   = snapshot->extension_warning;
+    s_tick.stage_elapsed_ms    = snapshot->stage_elapsed_ms;
+    s_tick.stage_planned_ms    = snapshot->stage_planned_ms;
+    s_tick.overtime_ms         = snapshot->overtime_ms;
+    s_tick.stage_start_temp    = snapshot->stage_start_temp;
+    s_tick.stage_target_temp   = snapshot->stage_target_temp;
+    s_tick.cooldown_start_temp = snapshot->cooldown_start_temp;
+    s_tick.cooldown_elapsed_ms = snapshot->cooldown_elapsed_ms;
+    s_tick.cooldown_total_ms   = snapshot->cooldown_total_ms;
+
+    LOGGER_LOG_INFO(TAG, "Restored stage %d, phase %d, %lu ms into the stage",
+                    s_tick.stage_index + 1, (int)s_tick.phase, (unsigned long)s_tick.stage_elapsed_ms);
+    return PROFILE_CONTROLLER_ERROR_NONE;
+}
+
 /* ── Live target update (manual mode) ─────────────────────────────── */
 
 profile_controller_error_t profile_update_stage_target(float new_target,
@@ -474,6 +516,11 @@ profile_controller_error_t profile_update_stage_target(float new_target,
             prog->stages[idx].target_t_c = (int)new_target;
             prog->stages[idx].t_min      = (int)(new_planned_ms / 60000U);
         }
+
+        /* Keep the planned curve in step with the edited stage */
+        profile_segment_table_build(&g_temp_profile_controller_ctx->segments, prog,
+                                    g_temp_profile_controller_ctx->initial_temperature,
+                                    g_temp_profile_controller_ctx->cooldown_rate_x10);
     }
 
     LOGGER_LOG_INFO(TAG, "Live target update: %.0f C → %.0f C, ramp from %.1f C over %lu ms",
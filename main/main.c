@@ -5,6 +5,7 @@
 #include "heater_controller_component.h"
 #include "event_manager.h"
 #include "event_registry.h"
+#include "furnace_error_types.h"
 #include "nextion_hmi.h"
 #include "run_indicator.h"
 #include "utils.h"
@@ -14,9 +15,81 @@
 #include "modbus_master.h"
 #include "temp_sensor_device.h"
 #include "nvs_flash.h"
+#include "esp_timer.h"
+#include <stdio.h>
 
 static const char *TAG = "main";
 
+typedef struct
+{
+    float sum;
+    float min;
+    float max;
+    int count;
+} temperature_fusion_t;
+
+static bool accumulate_temperature(device_t* device, void* arg)
+{
+    temperature_fusion_t* fusion = (temperature_fusion_t*)arg;
+    float reading;
+    if (device_manager_read_device(device, &reading) == ESP_OK)
+    {
+        if (fusion->count == 0 || reading < fusion->min)
+        {
+            fusion->min = reading;
+        }
+        if (fusion->count == 0 || reading > fusion->max)
+        {
+            fusion->max = reading;
+        }
+        fusion->sum += reading;
+        fusion->count++;
+    }
+    return true;
+}
+
+static esp_err_t fuse_temperature(const temperature_fusion_t* fusion, float* temperature)
+{
+#if CONFIG_TEMP_FUSION_POLICY_CONTROL_SENSOR
+    (void)fusion;
+    static device_t* control_sensor = NULL;
+    if (control_sensor == NULL)
+    {
+        char name[20];
+        snprintf(name, sizeof(name), "temp_sensor_%u", (unsigned)CONFIG_TEMP_FUSION_CONTROL_SENSOR_ADDRESS);
+        control_sensor = device_manager_find_device(name);
+        if (control_sensor == NULL)
+        {
+            return ESP_ERR_NOT_FOUND;
+        }
+    }
+    return device_manager_read_device(control_sensor, temperature);
+#elif CONFIG_TEMP_FUSION_POLICY_MIN
+    *temperature = fusion->min;
+    return ESP_OK;
+#elif CONFIG_TEMP_FUSION_POLICY_MAX
+    *temperature = fusion->max;
+    return ESP_OK;
+#else
+    *temperature = fusion->sum / (float)fusion->count;
+    return ESP_OK;
+#endif
+}
+
+static void post_sensor_loss_error(void)
+{
+    furnace_error_t furnace_error = {
+        .severity = SEVERITY_ERROR,
+        .source = SOURCE_TEMP_MONITOR,
+        .error_code = ESP_ERR_INVALID_STATE,
+    };
+    CHECK_ERR_LOG(event_manager_post_blocking(FURNACE_ERROR_EVENT,
+                                              FURNACE_ERROR_EVENT_ID,
+                                              &furnace_error,
+                                              sizeof(furnace_error)),
+                  "Failed to post sensor loss error");
+}
+
 void app_main(void)
 {
     logger_init();
@@ -71,29 +144,72 @@ void app_main(void)
     CHECK_ERR_LOG(device_manager_init(),
                   "Failed to initialize device manager");
 
-    vTaskDelay(pdMS_TO_TICKS(2000)); // Let the device manager start and initialize devices
-
-    temp_sensor_device_t *temp_sensor_device;
+    temp_sensor_device_t *temp_sensor_devices[CONFIG_TEMP_SENSOR_DEVICE_COUNT] = {0};
 
-    CHECK_ERR_LOG(temp_sensor_create(&temp_sensor_device),
-                  "Failed to create temp sensor device");
+    for (int i = 0; i < CONFIG_TEMP_SENSOR_DEVICE_COUNT; i++)
+    {
+        CHECK_ERR_LOG_FMT(temp_sensor_create(CONFIG_TEMP_SENSOR_MODBUS_START_ADDRESS + i, &temp_sensor_devices[i]),
+                          "Failed to create temp sensor device %d", i);
+    }
 
-    vTaskDelay(pdMS_TO_TICKS(2000));
+    for (int i = 0; i < CONFIG_TEMP_SENSOR_DEVICE_COUNT; i++)
+    {
+        if (temp_sensor_devices[i] == NULL)
+        {
+            continue;
+        }
+        CHECK_ERR_LOG_FMT(temp_sensor_set_device_state(temp_sensor_devices[i], DEVICE_STATE_RUNNING),
+                          "Failed to set temp sensor device %d state to running", i);
+    }
 
-    CHECK_ERR_LOG(temp_sensor_set_device_state(temp_sensor_device, DEVICE_STATE_RUNNING),
-                  "Failed to set temp sensor device state to running");
+    bool first_temperature_reported = false;
+    bool sensor_loss_reported = false;
 
     while (1)
     {
-        float temperature;
-        CHECK_ERR_LOG(temp_sensor_read_device(temp_sensor_device, &temperature),
-                      "Failed to read temperature from device");
+        temperature_fusion_t fusion = {0};
+        device_manager_for_each_device(DEVICE_TYPE_TEMP_SENSOR, true, accumulate_temperature, &fusion);
+        const int valid_readings = fusion.count;
+
+        float temperature = 0.0f;
+        const esp_err_t fuse_err = valid_readings >= CONFIG_TEMP_FUSION_MIN_LIVE_SENSORS
+                                       ? fuse_temperature(&fusion, &temperature)
+                                       : ESP_ERR_INVALID_STATE;
+        if (fuse_err != ESP_OK)
+        {
+            if (!sensor_loss_reported)
+            {
+                sensor_loss_reported = true;
+                LOGGER_LOG_ERROR(TAG, "Temperature unavailable: %d/%d sensors live (minimum %d): %s",
+                                 valid_readings, CONFIG_TEMP_SENSOR_DEVICE_COUNT,
+                                 CONFIG_TEMP_FUSION_MIN_LIVE_SENSORS, esp_err_to_name(fuse_err));
+                post_sensor_loss_error();
+            }
+            vTaskDelay(pdMS_TO_TICKS(500));
+            continue;
+        }
+
+        if (sensor_loss_reported)
+        {
+            sensor_loss_reported = false;
+            LOGGER_LOG_INFO(TAG, "Temperature restored: %d/%d sensors live", valid_readings,
+                            CONFIG_TEMP_SENSOR_DEVICE_COUNT);
+        }
+
+        if (!first_temperature_reported)
+        {
+            first_temperature_reported = true;
+            LOGGER_LOG_INFO(TAG, "Time to first valid temperature: %lu ms after boot",
+                            (unsigned long)(esp_timer_get_time() / 1000));
+        }
+
         CHECK_ERR_LOG(event_manager_post_immediate(TEMP_PROCESSOR_EVENT,
                                                    PROCESS_TEMPERATURE_EVENT_DATA,
                                                    &temperature,
                                                    sizeof(temperature)),
                       "Failed to publish temperature update");
-        LOGGER_LOG_INFO(TAG, "Temperature: %.2f C", temperature);
+        LOGGER_LOG_INFO(TAG, "Temperature: %.2f C (%d/%d sensors)", temperature, valid_readings,
+                        CONFIG_TEMP_SENSOR_DEVICE_COUNT);
         vTaskDelay(pdMS_TO_TICKS(500));
     }
 }
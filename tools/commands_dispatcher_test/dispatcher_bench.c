@@ -0,0 +1,317 @@
+/**
+ * @file dispatcher_bench.c
+ * @brief Host benchmark: heater traffic behind a slow coordinator handler.
+ *
+ * Runs components/commands_dispatcher unchanged on the virtual clock.  A PID
+ * stand-in sends coalesced SET_POWER commands to the heater every tick while
+ * an HMI stand-in keeps starting profiles whose coordinator handler blocks
+ * for a while (profile load, checkpoint write).  Handlers spend virtual time,
+ * so the queue-wait and handler times reported by
+ * commands_dispatcher_get_target_stats() are deterministic.
+ *
+ * Built twice: dispatcher_bench_per_target and dispatcher_bench_shared.  With
+ * one shared worker the heater's wait tracks the coordinator handler; with
+ * per-target workers it stays at the heater's own handler time.
+ *
+ *   dispatcher_bench_<workers> [options]
+ *     -d, --duration S          Virtual run time (default 600)
+ *     -t, --tick MS             SET_POWER period (default 1000)
+ *     -H, --heater-handler MS   Heater handler time, one Modbus write (default 5)
+ *     -i, --interval MS         Period of the slow coordinator command (default 5000)
+ *     -c, --coordinator MS      Coordinator handler time (default 1500)
+ *     -v, --verbose             Dispatcher log, including its periodic stats
+ *
+ * Build: cmake -S tools/commands_dispatcher_test -B build/commands_dispatcher_test && cmake --build build/commands_dispatcher_test
+ */
+
+#include <getopt.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "commands_dispatcher.h"
+#include "esp_timer.h"
+#include "event_manager.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "logger_component.h"
+#include "virtual_clock.h"
+
+#define SETTLE_MS 5000
+
+typedef struct
+{
+    uint32_t duration_s;
+    uint32_t tick_ms;
+    uint32_t heater_handler_ms;
+    uint32_t interval_ms;
+    uint32_t coordinator_ms;
+    bool verbose;
+} bench_options_t;
+
+static bench_options_t options = {
+    .duration_s = 600,
+    .tick_ms = 1000,
+    .heater_handler_ms = 5,
+    .interval_ms = 5000,
+    .coordinator_ms = 1500,
+};
+
+static volatile bool traffic_running;
+static volatile bool bench_done;
+static uint32_t power_sent;
+static uint32_t power_handled;
+static uint32_t starts_sent;
+static esp_err_t bench_err = ESP_OK;
+
+static command_target_stats_t target_stats[2];
+static command_lane_stats_t normal_lane;
+
+/* ── Handlers: spend virtual time like the real ones spend wall time ─── */
+static esp_err_t coordinator_handler(void* handler_arg, void* command_data, const size_t command_data_size,
+                                     command_reply_t* reply)
+{
+    (void)handler_arg;
+    (void)command_data;
+    (void)command_data_size;
+    (void)reply;
+    vTaskDelay(pdMS_TO_TICKS(options.coordinator_ms));
+    return ESP_OK;
+}
+
+static esp_err_t heater_handler(void* handler_arg, void* command_data, const size_t command_data_size,
+                                command_reply_t* reply)
+{
+    (void)handler_arg;
+    (void)command_data_size;
+    (void)reply;
+    const heater_command_data_t* command = command_data;
+    if (command->type == COMMAND_TYPE_HEATER_SET_POWER)
+    {
+        power_handled++;
+    }
+    vTaskDelay(pdMS_TO_TICKS(options.heater_handler_ms));
+    return ESP_OK;
+}
+
+/* ── Traffic ──────────────────────────────────────────────────────────── */
+static void pid_task(void* arg)
+{
+    (void)arg;
+    TickType_t wake = xTaskGetTickCount();
+    while (traffic_running)
+    {
+        heater_command_data_t data = {
+            .type = COMMAND_TYPE_HEATER_SET_POWER,
+            .power_level = 0.1f + 0.8f * (float)(power_sent % 8) / 8.0f,
+        };
+        command_t command = {
+            .target = COMMAND_TARGET_HEATER,
+            .data = &data,
+            .data_size = sizeof(data),
+            .coalesce_key = COMMAND_COALESCE_HEATER_POWER,
+        };
+        if (commands_dispatcher_dispatch_command(&command) == ESP_OK)
+        {
+            power_sent++;
+        }
+        /* Fixed rate, like the coordinator's PID tick */
+        wake += pdMS_TO_TICKS(options.tick_ms);
+        const TickType_t now = xTaskGetTickCount();
+        if ((int32_t)(wake - now) > 0)
+        {
+            vTaskDelay(wake - now);
+        }
+        else
+        {
+            wake = now;
+        }
+    }
+    vTaskDelete(NULL);
+}
+
+static void hmi_task(void* arg)
+{
+    (void)arg;
+    /* Out of phase with the PID tick */
+    vTaskDelay(pdMS_TO_TICKS(options.tick_ms / 2));
+    while (traffic_running)
+    {
+        coordinator_command_data_t data = {.type = COMMAND_TYPE_COORDINATOR_START_PROFILE};
+        command_t command = {
+            .target = COMMAND_TARGET_COORDINATOR,
+            .data = &data,
+            .data_size = sizeof(data),
+        };
+        if (commands_dispatcher_dispatch_command(&command) == ESP_OK)
+        {
+            starts_sent++;
+        }
+        vTaskDelay(pdMS_TO_TICKS(options.interval_ms));
+    }
+    vTaskDelete(NULL);
+}
+
+static void bench_task(void* arg)
+{
+    (void)arg;
+
+    bench_err = commands_dispatcher_init();
+    if (bench_err == ESP_OK)
+    {
+        bench_err = register_command_handler(COMMAND_TARGET_HEATER, heater_handler, NULL);
+    }
+    if (bench_err == ESP_OK)
+    {
+        bench_err = register_command_handler(COMMAND_TARGET_COORDINATOR, coordinator_handler, NULL);
+    }
+    if (bench_err == ESP_OK)
+    {
+        traffic_running = true;
+        xTaskCreate(pid_task, "pid", 4096, NULL, 5, NULL);
+        xTaskCreate(hmi_task, "hmi", 4096, NULL, 5, NULL);
+        vTaskDelay(pdMS_TO_TICKS(options.duration_s * 1000U));
+        traffic_running = false;
+        vTaskDelay(pdMS_TO_TICKS(options.coordinator_ms + SETTLE_MS));
+
+        commands_dispatcher_get_target_stats(COMMAND_TARGET_HEATER, &target_stats[COMMAND_TARGET_HEATER]);
+        commands_dispatcher_get_target_stats(COMMAND_TARGET_COORDINATOR, &target_stats[COMMAND_TARGET_COORDINATOR]);
+        commands_dispatcher_get_lane_stats(COMMAND_LANE_NORMAL, &normal_lane);
+    }
+    commands_dispatcher_shutdown();
+
+    bench_done = true;
+    vTaskDelete(NULL);
+}
+
+/* ── Report ───────────────────────────────────────────────────────────── */
+static void print_target(const char* name, const command_target_stats_t* stats)
+{
+    printf("  %-12s %6lu handled   wait avg/max %8.1f/%8.1f ms   handler avg/max %8.1f/%8.1f ms\n", name,
+           (unsigned long)stats->handled, stats->wait_avg_us / 1000.0, stats->wait_max_us / 1000.0,
+           stats->handler_avg_us / 1000.0, stats->handler_max_us / 1000.0);
+}
+
+static void usage(const char* argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-d S] [-t MS] [-H MS] [-i MS] [-c MS] [-v]\n"
+            "  -d, --duration S          Virtual run time (default 600)\n"
+            "  -t, --tick MS             SET_POWER period (default 1000)\n"
+            "  -H, --heater-handler MS   Heater handler time (default 5)\n"
+            "  -i, --interval MS         Period of the slow coordinator command (default 5000)\n"
+            "  -c, --coordinator MS      Coordinator handler time (default 1500)\n"
+            "  -v, --verbose             Dispatcher log\n",
+            argv0);
+}
+
+static bool parse_options(const int argc, char** argv)
+{
+    static const struct option long_options[] = {
+        {"duration", required_argument, NULL, 'd'},
+        {"tick", required_argument, NULL, 't'},
+        {"heater-handler", required_argument, NULL, 'H'},
+        {"interval", required_argument, NULL, 'i'},
+        {"coordinator", required_argument, NULL, 'c'},
+        {"verbose", no_argument, NULL, 'v'},
+        {NULL, 0, NULL, 0},
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "d:t:H:i:c:v", long_options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'd':
+            options.duration_s = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 't':
+            options.tick_ms = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 'H':
+            options.heater_handler_ms = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 'i':
+            options.interval_ms = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 'c':
+            options.coordinator_ms = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 'v':
+            options.verbose = true;
+            break;
+        default:
+            return false;
+        }
+    }
+    return options.duration_s > 0 && options.tick_ms > 0 && options.interval_ms > 0;
+}
+
+int main(const int argc, char** argv)
+{
+    if (!parse_options(argc, argv))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    virtual_clock_init(0.0);
+    if (xTaskCreate(bench_task, "dispatcher_bench", 4096, NULL, 5, NULL) != pdPASS)
+    {
+        fprintf(stderr, "Failed to start the benchmark task\n");
+        return 1;
+    }
+
+    const int64_t limit_us = ((int64_t)options.duration_s * 1000 + options.coordinator_ms + 2 * SETTLE_MS) * 1000;
+    for (int64_t until_us = 1000000; !bench_done && until_us <= 2 * limit_us; until_us += 1000000)
+    {
+        virtual_clock_advance_to(until_us);
+    }
+    if (!bench_done || bench_err != ESP_OK)
+    {
+        fprintf(stderr, "Benchmark did not complete (%d)\n", bench_err);
+        return 1;
+    }
+
+    printf("Commands dispatcher, %s workers: %lu s, SET_POWER every %lu ms (%lu ms handler), "
+           "START every %lu ms (%lu ms handler)\n",
+           CONFIG_COMMANDS_DISPATCHER_PER_TARGET_WORKERS ? "per-target" : "shared",
+           (unsigned long)options.duration_s, (unsigned long)options.tick_ms,
+           (unsigned long)options.heater_handler_ms, (unsigned long)options.interval_ms,
+           (unsigned long)options.coordinator_ms);
+    print_target("heater", &target_stats[COMMAND_TARGET_HEATER]);
+    print_target("coordinator", &target_stats[COMMAND_TARGET_COORDINATOR]);
+    printf("  SET_POWER    %6lu sent, %lu handled, %lu coalesced; %lu START sent\n", (unsigned long)power_sent,
+           (unsigned long)power_handled, (unsigned long)normal_lane.coalesced, (unsigned long)starts_sent);
+    return 0;
+}
+
+/* ── Host stand-ins ───────────────────────────────────────────────────── */
+void logger_send(const log_level_t log_level, const char* tag, const char* message, ...)
+{
+    if (!options.verbose && log_level > LOG_LEVEL_WARN)
+    {
+        return;
+    }
+
+    static const char level_chars[] = {'-', 'E', 'W', 'I', 'D'};
+    fprintf(stderr, "[%9.3f s] %c %s: ", (double)esp_timer_get_time() / 1e6, level_chars[log_level], tag);
+    va_list args;
+    va_start(args, message);
+    vfprintf(stderr, message, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+const char* esp_err_to_name(const esp_err_t code)
+{
+    (void)code;
+    return "ESP_ERR";
+}
+
+esp_err_t event_manager_post_health(const health_monitor_event_id_t event_id, const health_monitor_data_t* event_data)
+{
+    (void)event_id;
+    (void)event_data;
+    return ESP_OK;
+}
@@ -0,0 +1,481 @@
+/**
+ * @file dispatcher_test.c
+ * @brief Host tests for the commands dispatcher lanes on the virtual clock.
+ *
+ * Runs components/commands_dispatcher unchanged against model heater and
+ * coordinator handlers.  A slow command keeps a worker busy while the test
+ * queues more behind it, so what reaches the handlers — and in which order —
+ * is deterministic.
+ *
+ *   dispatcher_test [-v]     Exit status 0 when every check passes
+ *
+ * Built twice, with per-target workers and with one shared worker.
+ * Build: cmake -S tools/commands_dispatcher_test -B build/commands_dispatcher_test && cmake --build build/commands_dispatcher_test
+ * Run:   ctest --test-dir build/commands_dispatcher_test --output-on-failure
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "commands_dispatcher.h"
+#include "esp_timer.h"
+#include "event_manager.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "logger_component.h"
+#include "virtual_clock.h"
+
+#define SLOW_HANDLER_MS 200
+#define SETTLE_MS       1000
+#define MAX_LOGGED      32
+
+static bool verbose;
+static int checks;
+static int failures;
+
+#define CHECK(cond)                                                              \
+    do                                                                           \
+    {                                                                            \
+        checks++;                                                                \
+        if (!(cond))                                                             \
+        {                                                                        \
+            failures++;                                                          \
+            fprintf(stderr, "%s:%d: %s: check failed: %s\n", __FILE__, __LINE__, \
+                    __func__, #cond);                                            \
+        }                                                                        \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                       \
+    do                                                                                   \
+    {                                                                                    \
+        checks++;                                                                        \
+        const long long a_ = (long long)(actual), e_ = (long long)(expected);            \
+        if (a_ != e_)                                                                    \
+        {                                                                                \
+            failures++;                                                                  \
+            fprintf(stderr, "%s:%d: %s: %s == %lld, expected %lld\n", __FILE__, __LINE__, \
+                    __func__, #actual, a_, e_);                                          \
+        }                                                                                \
+    } while (0)
+
+/* ── Model handlers ───────────────────────────────────────────────────── */
+typedef struct
+{
+    bool profile_running;
+    uint32_t busy_ms;           // How long UPDATE_MANUAL_TARGET blocks its worker
+    coordinator_command_type_t handled[MAX_LOGGED];
+    int handled_count;
+
+    float heater_power;
+    int power_updates;
+} model_t;
+
+static model_t model;
+static volatile int heartbeats;
+
+static esp_err_t coordinator_handler(void* handler_arg, void* command_data, const size_t command_data_size,
+                                     command_reply_t* reply)
+{
+    model_t* m = handler_arg;
+    const coordinator_command_data_t* command = command_data;
+    if (command_data_size != sizeof(*command))
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (m->handled_count < MAX_LOGGED)
+    {
+        m->handled[m->handled_count++] = command->type;
+    }
+
+    switch (command->type)
+    {
+    case COMMAND_TYPE_UPDATE_MANUAL_TARGET:
+        vTaskDelay(pdMS_TO_TICKS(m->busy_ms));  // Keeps the worker busy while the test queues more
+        return ESP_OK;
+    case COMMAND_TYPE_COORDINATOR_START_PROFILE:
+    case COMMAND_TYPE_COORDINATOR_RESUME_PROFILE:
+        m->profile_running = true;
+        return ESP_OK;
+    case COMMAND_TYPE_COORDINATOR_STOP_PROFILE:
+    case COMMAND_TYPE_COORDINATOR_PAUSE_PROFILE:
+        m->profile_running = false;
+        return ESP_OK;
+    case COMMAND_TYPE_COORDINATOR_GET_STATUS_REPORT:
+        return command_reply_set(reply, &m->profile_running, sizeof(m->profile_running));
+    default:
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+}
+
+static esp_err_t heater_handler(void* handler_arg, void* command_data, const size_t command_data_size,
+                                command_reply_t* reply)
+{
+    model_t* m = handler_arg;
+    const heater_command_data_t* command = command_data;
+    if (command_data_size != sizeof(*command))
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    switch (command->type)
+    {
+    case COMMAND_TYPE_HEATER_TOGGLE:
+        vTaskDelay(pdMS_TO_TICKS(SLOW_HANDLER_MS));
+        return ESP_OK;
+    case COMMAND_TYPE_HEATER_SET_POWER:
+        m->heater_power = command->power_level;
+        m->power_updates++;
+        return ESP_OK;
+    case COMMAND_TYPE_HEATER_CLEAR:
+        m->heater_power = 0.0f;
+        return ESP_OK;
+    case COMMAND_TYPE_HEATER_GET_STATUS:
+        return command_reply_set(reply, &m->heater_power, sizeof(m->heater_power));
+    default:
+        return ESP_OK;
+    }
+}
+
+/* ── Helpers ──────────────────────────────────────────────────────────── */
+static esp_err_t dispatch_coordinator(const coordinator_command_type_t type, const command_lane_t lane)
+{
+    coordinator_command_data_t data = {.type = type};
+    command_t command = {
+        .target = COMMAND_TARGET_COORDINATOR,
+        .data = &data,
+        .data_size = sizeof(data),
+        .lane = lane,
+    };
+    return commands_dispatcher_dispatch_command(&command);
+}
+
+static esp_err_t dispatch_heater(const heater_command_type_t type, const float power, const bool state,
+                                 const uint8_t coalesce_key)
+{
+    heater_command_data_t data = {.type = type, .power_level = power, .heater_state = state};
+    command_t command = {
+        .target = COMMAND_TARGET_HEATER,
+        .data = &data,
+        .data_size = sizeof(data),
+        .coalesce_key = coalesce_key,
+    };
+    return commands_dispatcher_dispatch_command(&command);
+}
+
+/*
+ * Occupy a worker so the next commands queue up behind it.  Virtual time only
+ * moves once every task is blocked, so after the 1 ms wait the worker is
+ * inside the slow handler.
+ */
+static void keep_coordinator_busy(void)
+{
+    CHECK_EQ(dispatch_coordinator(COMMAND_TYPE_UPDATE_MANUAL_TARGET, COMMAND_LANE_NORMAL), ESP_OK);
+    vTaskDelay(pdMS_TO_TICKS(1));
+}
+
+static void keep_heater_busy(void)
+{
+    CHECK_EQ(dispatch_heater(COMMAND_TYPE_HEATER_TOGGLE, 0.0f, true, COMMAND_COALESCE_NONE), ESP_OK);
+    vTaskDelay(pdMS_TO_TICKS(1));
+}
+
+static void settle(void)
+{
+    vTaskDelay(pdMS_TO_TICKS(SETTLE_MS));
+}
+
+static uint32_t cancelled(const command_lane_t lane)
+{
+    command_lane_stats_t stats;
+    commands_dispatcher_get_lane_stats(lane, &stats);
+    return stats.cancelled;
+}
+
+static bool was_handled(const coordinator_command_type_t type)
+{
+    for (int i = 0; i < model.handled_count; i++)
+    {
+        if (model.handled[i] == type)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void reset_model(void)
+{
+    settle();
+    memset(&model, 0, sizeof(model));
+    model.busy_ms = SLOW_HANDLER_MS;
+}
+
+/* ── Tests ────────────────────────────────────────────────────────────── */
+static void test_stop_cancels_earlier_start(void)
+{
+    reset_model();
+    const uint32_t cancelled_before = cancelled(COMMAND_LANE_NORMAL);
+
+    keep_coordinator_busy();
+    CHECK_EQ(dispatch_coordinator(COMMAND_TYPE_COORDINATOR_START_PROFILE, COMMAND_LANE_NORMAL), ESP_OK);
+    CHECK_EQ(dispatch_coordinator(COMMAND_TYPE_COORDINATOR_STOP_PROFILE, COMMAND_LANE_NORMAL), ESP_OK);
+    settle();
+
+    CHECK(!model.profile_running);
+    CHECK(was_handled(COMMAND_TYPE_COORDINATOR_STOP_PROFILE));
+    CHECK(!was_handled(COMMAND_TYPE_COORDINATOR_START_PROFILE));
+    CHECK_EQ(cancelled(COMMAND_LANE_NORMAL) - cancelled_before, 1);
+}
+
+static void test_commands_after_stop_still_run(void)
+{
+    reset_model();
+
+    keep_coordinator_busy();
+    CHECK_EQ(dispatch_coordinator(COMMAND_TYPE_COORDINATOR_START_PROFILE, COMMAND_LANE_NORMAL), ESP_OK);
+    CHECK_EQ(dispatch_coordinator(COMMAND_TYPE_COORDINATOR_STOP_PROFILE, COMMAND_LANE_CRITICAL), ESP_OK);
+    CHECK_EQ(dispatch_coordinator(COMMAND_TYPE_COORDINATOR_START_PROFILE, COMMAND_LANE_NORMAL), ESP_OK);
+    settle();
+
+    /* The second start was requested after the stop and keeps its place */
+    CHECK(model.profile_running);
+    CHECK_EQ(model.handled_count, 3);
+    CHECK_EQ(model.handled[1], COMMAND_TYPE_COORDINATOR_STOP_PROFILE);
+    CHECK_EQ(model.handled[2], COMMAND_TYPE_COORDINATOR_START_PROFILE);
+}
+
+static void test_stop_leaves_other_targets(void)
+{
+    reset_model();
+
+    keep_coordinator_busy();
+    CHECK_EQ(dispatch_heater(COMMAND_TYPE_HEATER_SET_POWER, 0.5f, true, COMMAND_COALESCE_NONE), ESP_OK);
+    CHECK_EQ(dispatch_coordinator(COMMAND_TYPE_COORDINATOR_START_PROFILE, COMMAND_LANE_NORMAL), ESP_OK);
+    CHECK_EQ(dispatch_coordinator(COMMAND_TYPE_COORDINATOR_STOP_PROFILE, COMMAND_LANE_NORMAL), ESP_OK);
+    settle();
+
+    CHECK(!model.profile_running);
+    CHECK_EQ(model.power_updates, 1);
+    CHECK(model.heater_power == 0.5f);
+}
+
+static void test_heater_clear_cancels_earlier_power(void)
+{
+    reset_model();
+    const uint32_t cancelled_before = cancelled(COMMAND_LANE_NORMAL);
+
+    keep_heater_busy();
+    CHECK_EQ(dispatch_heater(COMMAND_TYPE_HEATER_SET_POWER, 0.8f, true, COMMAND_COALESCE_NONE), ESP_OK);
+    CHECK_EQ(dispatch_heater(COMMAND_TYPE_HEATER_SET_POWER, 0.9f, true, COMMAND_COALESCE_HEATER_POWER), ESP_OK);
+    CHECK_EQ(dispatch_heater(COMMAND_TYPE_HEATER_CLEAR, 0.0f, false, COMMAND_COALESCE_NONE), ESP_OK);
+    settle();
+
+    /* Only the clear reaches the heater; the coalesced 0.9 is superseded too */
+    CHECK_EQ(model.power_updates, 0);
+    CHECK(model.heater_power == 0.0f);
+    CHECK_EQ(cancelled(COMMAND_LANE_NORMAL) - cancelled_before, 2);
+}
+
+static void test_zero_power_is_a_normal_tick(void)
+{
+    reset_model();
+    const uint32_t cancelled_before = cancelled(COMMAND_LANE_NORMAL);
+
+    keep_heater_busy();
+    CHECK_EQ(dispatch_heater(COMMAND_TYPE_HEATER_SET_POWER, 0.8f, true, COMMAND_COALESCE_NONE), ESP_OK);
+    CHECK_EQ(dispatch_heater(COMMAND_TYPE_HEATER_SET_POWER, 0.0f, false, COMMAND_COALESCE_HEATER_POWER), ESP_OK);
+    settle();
+
+    /* Delivered in order like any other level, nothing cancelled */
+    CHECK_EQ(model.power_updates, 2);
+    CHECK(model.heater_power == 0.0f);
+    CHECK_EQ(cancelled(COMMAND_LANE_NORMAL) - cancelled_before, 0);
+}
+
+static void test_stop_answers_status_requests(void)
+{
+    reset_model();
+    const uint32_t cancelled_before = cancelled(COMMAND_LANE_BULK);
+
+    keep_coordinator_busy();
+    bool running = true;
+    coordinator_command_data_t data = {.type = COMMAND_TYPE_COORDINATOR_GET_STATUS_REPORT};
+    command_t command = {
+        .target = COMMAND_TARGET_COORDINATOR,
+        .data = &data,
+        .data_size = sizeof(data),
+        .lane = COMMAND_LANE_BULK,
+    };
+    command_future_t* future = NULL;
+    CHECK_EQ(commands_dispatcher_request(&command, &running, sizeof(running), &future), ESP_OK);
+    CHECK_EQ(dispatch_coordinator(COMMAND_TYPE_COORDINATOR_STOP_PROFILE, COMMAND_LANE_CRITICAL), ESP_OK);
+
+    /* Read-only: answered after the stop instead of failing */
+    size_t reply_len = 0;
+    CHECK_EQ(commands_dispatcher_wait(future, pdMS_TO_TICKS(SETTLE_MS), &reply_len), ESP_OK);
+    CHECK_EQ(reply_len, sizeof(running));
+    CHECK(!running);
+    CHECK_EQ(cancelled(COMMAND_LANE_BULK) - cancelled_before, 0);
+}
+
+static void test_heater_off_answers_status(void)
+{
+    reset_model();
+    model.heater_power = 0.5f;
+
+    keep_heater_busy();
+    heater_command_data_t data = {.type = COMMAND_TYPE_HEATER_GET_STATUS};
+    command_t command = {
+        .target = COMMAND_TARGET_HEATER,
+        .data = &data,
+        .data_size = sizeof(data),
+        .lane = COMMAND_LANE_BULK,
+    };
+    float power = 1.0f;
+    command_future_t* future = NULL;
+    CHECK_EQ(commands_dispatcher_request(&command, &power, sizeof(power), &future), ESP_OK);
+    CHECK_EQ(dispatch_heater(COMMAND_TYPE_HEATER_TOGGLE, 0.0f, false, COMMAND_COALESCE_NONE), ESP_OK);
+
+    size_t reply_len = 0;
+    CHECK_EQ(commands_dispatcher_wait(future, pdMS_TO_TICKS(SETTLE_MS), &reply_len), ESP_OK);
+    CHECK_EQ(reply_len, sizeof(power));
+}
+
+static void test_request_leaves_task_notifications(void)
+{
+    reset_model();
+
+    coordinator_command_data_t data = {.type = COMMAND_TYPE_COORDINATOR_GET_STATUS_REPORT};
+    command_t command = {
+        .target = COMMAND_TARGET_COORDINATOR,
+        .data = &data,
+        .data_size = sizeof(data),
+    };
+    bool running = true;
+    size_t reply_len = 0;
+
+    /* Completed before the wait: the left-over wake must not answer the next request early */
+    command_future_t* future = NULL;
+    CHECK_EQ(commands_dispatcher_request(&command, &running, sizeof(running), &future), ESP_OK);
+    settle();
+    CHECK_EQ(commands_dispatcher_wait(future, 0, &reply_len), ESP_OK);
+    CHECK(!running);
+
+    /* A caller counting its own notifications sees them untouched */
+    xTaskNotifyGive(xTaskGetCurrentTaskHandle());
+    xTaskNotifyGive(xTaskGetCurrentTaskHandle());
+    keep_coordinator_busy();
+    running = true;
+    CHECK_EQ(commands_dispatcher_call(&command, &running, sizeof(running), &reply_len, pdMS_TO_TICKS(SETTLE_MS)),
+             ESP_OK);
+    CHECK_EQ(reply_len, sizeof(running));
+    CHECK(!running);
+    CHECK_EQ(ulTaskNotifyTake(pdTRUE, 0), 2);
+}
+
+static void test_stuck_worker_stops_heartbeats(void)
+{
+    reset_model();
+    const uint32_t timeout_ms = CONFIG_COMMANDS_DISPATCHER_HEARTBEAT_TIMEOUT_MS;
+
+    /* The coordinator's worker hangs; with per-target workers the heater's stays responsive */
+    model.busy_ms = 3 * timeout_ms;
+    keep_coordinator_busy();
+    vTaskDelay(pdMS_TO_TICKS(timeout_ms + SETTLE_MS));
+    const int before = heartbeats;
+    CHECK_EQ(dispatch_heater(COMMAND_TYPE_HEATER_SET_POWER, 0.25f, false, COMMAND_COALESCE_NONE), ESP_OK);
+    vTaskDelay(pdMS_TO_TICKS(timeout_ms));
+    CHECK_EQ(heartbeats, before);
+    CHECK(model.heater_power == (CONFIG_COMMANDS_DISPATCHER_PER_TARGET_WORKERS ? 0.25f : 0.0f));
+
+    /* Back to healthy once the handler returns */
+    vTaskDelay(pdMS_TO_TICKS(timeout_ms + 3 * SETTLE_MS));
+    CHECK(heartbeats > before);
+}
+
+/* ── Harness ──────────────────────────────────────────────────────────── */
+static volatile bool tests_done;
+
+static void test_task(void* arg)
+{
+    (void)arg;
+
+    CHECK_EQ(commands_dispatcher_init(), ESP_OK);
+    CHECK_EQ(register_command_handler(COMMAND_TARGET_HEATER, heater_handler, &model), ESP_OK);
+    CHECK_EQ(register_command_handler(COMMAND_TARGET_COORDINATOR, coordinator_handler, &model), ESP_OK);
+
+    test_stop_cancels_earlier_start();
+    test_commands_after_stop_still_run();
+    test_stop_leaves_other_targets();
+    test_heater_clear_cancels_earlier_power();
+    test_zero_power_is_a_normal_tick();
+    test_stop_answers_status_requests();
+    test_heater_off_answers_status();
+    test_request_leaves_task_notifications();
+    test_stuck_worker_stops_heartbeats();
+
+    CHECK_EQ(commands_dispatcher_shutdown(), ESP_OK);
+    tests_done = true;
+    vTaskDelete(NULL);
+}
+
+void logger_send(const log_level_t log_level, const char* tag, const char* message, ...)
+{
+    if (!verbose && log_level > LOG_LEVEL_WARN)
+    {
+        return;
+    }
+
+    static const char level_chars[] = {'-', 'E', 'W', 'I', 'D'};
+    fprintf(stderr, "[%9.3f s] %c %s: ", (double)esp_timer_get_time() / 1e6, level_chars[log_level], tag);
+    va_list args;
+    va_start(args, message);
+    vfprintf(stderr, message, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+const char* esp_err_to_name(const esp_err_t code)
+{
+    (void)code;
+    return "ESP_ERR";
+}
+
+esp_err_t event_manager_post_health(const health_monitor_event_id_t event_id, const health_monitor_data_t* event_data)
+{
+    (void)event_data;
+    if (event_id == HEALTH_MONITOR_EVENT_HEARTBEAT)
+    {
+        heartbeats++;
+    }
+    return ESP_OK;
+}
+
+int main(const int argc, char** argv)
+{
+    verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+
+    virtual_clock_init(0.0);
+    TaskHandle_t task = NULL;
+    if (xTaskCreate(test_task, "dispatcher_test", 4096, NULL, 5, &task) != pdPASS)
+    {
+        fprintf(stderr, "Failed to start the test task\n");
+        return 1;
+    }
+
+    /* Generous bound: each test takes a few virtual seconds */
+    for (int64_t until_us = 1000000; !tests_done && until_us <= 600 * 1000000LL; until_us += 1000000)
+    {
+        virtual_clock_advance_to(until_us);
+    }
+    if (!tests_done)
+    {
+        fprintf(stderr, "Tests did not finish in virtual time\n");
+        failures++;
+    }
+
+    printf("dispatcher_test (%s workers): %d checks, %d failed\n",
+           CONFIG_COMMANDS_DISPATCHER_PER_TARGET_WORKERS ? "per-target" : "shared", checks, failures);
+    return failures == 0 ? 0 : 1;
+}
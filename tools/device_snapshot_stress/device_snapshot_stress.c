@@ -0,0 +1,255 @@
+/**
+ * @file device_snapshot_stress.c
+ * @brief Host stress test for the device_manager seqlock snapshot (device_snapshot.c).
+ *
+ * Several snapshots are hammered at once.  Each has one writer thread that
+ * publishes a multi-field record where every field is derived from a single
+ * counter.  Reader threads copy the records as fast as they can and check
+ * that every copy is internally consistent (no tearing) and that versions
+ * never go backwards.  The exit code is non-zero if any bad copy was seen.
+ *
+ * --unsafe reads the front buffer with a plain memcpy instead, to show the
+ * checker does catch tearing when the seqlock is bypassed.
+ *
+ *   device_snapshot_stress [options]
+ *     -w, --writers N   Snapshots, one writer thread each (default 2)
+ *     -r, --readers N   Reader threads (default 4)
+ *     -t, --seconds S   Duration (default 5)
+ *     -u, --unsafe      Bypass the seqlock in readers (negative control)
+ *
+ * Build: cmake -S tools/device_snapshot_stress -B build/device_snapshot_stress && cmake --build build/device_snapshot_stress
+ */
+
+#define _GNU_SOURCE
+#include <getopt.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "device_snapshot.h"
+
+#define MAX_WRITERS  16
+#define MAX_READERS  64
+#define RECORD_WORDS 30
+
+/* A record big enough that a torn copy is overwhelmingly likely to be caught */
+typedef struct
+{
+    uint64_t counter;
+    float temperature;
+    int64_t timestamp_us;
+    uint32_t words[RECORD_WORDS];
+    uint64_t checksum;
+} stress_record_t;
+
+typedef struct
+{
+    device_snapshot_t snapshot;
+    stress_record_t storage[2];
+    uint64_t published;
+} stress_target_t;
+
+typedef struct
+{
+    int index;
+    uint64_t reads;
+    uint64_t empty;
+    uint64_t torn;
+    uint64_t regressions;
+} reader_stats_t;
+
+static stress_target_t targets[MAX_WRITERS];
+static int writer_count = 2;
+static int reader_count = 4;
+static bool unsafe_reads = false;
+static atomic_bool stop = false;
+
+static uint64_t record_checksum(const stress_record_t* record)
+{
+    uint64_t sum = record->counter * 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < RECORD_WORDS; i++)
+    {
+        sum = (sum ^ record->words[i]) * 0x100000001B3ULL;
+    }
+    return sum ^ (uint64_t)record->timestamp_us;
+}
+
+static void fill_record(stress_record_t* record, const uint64_t counter)
+{
+    record->counter = counter;
+    record->temperature = (float)(counter % 100000U) * 0.01f;
+    record->timestamp_us = (int64_t)counter * 1000;
+    for (int i = 0; i < RECORD_WORDS; i++)
+    {
+        record->words[i] = (uint32_t)(counter * (uint64_t)(i + 1));
+    }
+    record->checksum = record_checksum(record);
+}
+
+static bool record_consistent(const stress_record_t* record)
+{
+    if (record->temperature != (float)(record->counter % 100000U) * 0.01f ||
+        record->timestamp_us != (int64_t)record->counter * 1000)
+    {
+        return false;
+    }
+    for (int i = 0; i < RECORD_WORDS; i++)
+    {
+        if (record->words[i] != (uint32_t)(record->counter * (uint64_t)(i + 1)))
+        {
+            return false;
+        }
+    }
+    return record->checksum == record_checksum(record);
+}
+
+static void* writer_thread(void* arg)
+{
+    stress_target_t* target = arg;
+    uint64_t counter = 0;
+
+    while (!atomic_load_explicit(&stop, memory_order_relaxed))
+    {
+        stress_record_t* next = device_snapshot_begin_write(&target->snapshot);
+        fill_record(next, ++counter);
+        device_snapshot_publish(&target->snapshot);
+    }
+    target->published = counter;
+    return NULL;
+}
+
+static bool unsafe_read(const device_snapshot_t* snapshot, void* out)
+{
+    const unsigned sequence = atomic_load_explicit(&((device_snapshot_t*)snapshot)->sequence, memory_order_acquire);
+    if (sequence < 2U)
+    {
+        return false;
+    }
+    /* Deliberately racy: the writer may already be filling this buffer */
+    memcpy(out, snapshot->buffers + (size_t)((sequence >> 1) & 1U) * snapshot->size, snapshot->size);
+    return true;
+}
+
+static void* reader_thread(void* arg)
+{
+    reader_stats_t* stats = arg;
+    uint64_t last_counter[MAX_WRITERS] = {0};
+    stress_record_t record;
+
+    while (!atomic_load_explicit(&stop, memory_order_relaxed))
+    {
+        for (int w = 0; w < writer_count; w++)
+        {
+            const bool ok = unsafe_reads
+                                ? unsafe_read(&targets[w].snapshot, &record)
+                                : device_snapshot_read(&targets[w].snapshot, &record);
+            if (!ok)
+            {
+                stats->empty++;
+                continue;
+            }
+
+            stats->reads++;
+            if (!record_consistent(&record))
+            {
+                stats->torn++;
+                continue;
+            }
+            if (record.counter < last_counter[w])
+            {
+                stats->regressions++;
+            }
+            last_counter[w] = record.counter;
+        }
+    }
+    return NULL;
+}
+
+static void usage(const char* argv0)
+{
+    fprintf(stderr, "usage: %s [-w writers] [-r readers] [-t seconds] [-u]\n", argv0);
+}
+
+int main(int argc, char** argv)
+{
+    unsigned seconds = 5;
+
+    static const struct option options[] = {
+        {"writers", required_argument, NULL, 'w'},
+        {"readers", required_argument, NULL, 'r'},
+        {"seconds", required_argument, NULL, 't'},
+        {"unsafe", no_argument, NULL, 'u'},
+        {NULL, 0, NULL, 0},
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "w:r:t:u", options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'w': writer_count = atoi(optarg); break;
+        case 'r': reader_count = atoi(optarg); break;
+        case 't': seconds = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'u': unsafe_reads = true; break;
+        default: usage(argv[0]); return 2;
+        }
+    }
+    if (writer_count < 1 || writer_count > MAX_WRITERS || reader_count < 1 || reader_count > MAX_READERS)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    pthread_t writers[MAX_WRITERS];
+    pthread_t readers[MAX_READERS];
+    reader_stats_t reader_stats[MAX_READERS];
+    memset(reader_stats, 0, sizeof(reader_stats));
+
+    for (int w = 0; w < writer_count; w++)
+    {
+        device_snapshot_init(&targets[w].snapshot, targets[w].storage, sizeof(stress_record_t));
+        pthread_create(&writers[w], NULL, writer_thread, &targets[w]);
+    }
+    for (int r = 0; r < reader_count; r++)
+    {
+        reader_stats[r].index = r;
+        pthread_create(&readers[r], NULL, reader_thread, &reader_stats[r]);
+    }
+
+    sleep(seconds);
+    atomic_store(&stop, true);
+
+    uint64_t published = 0, reads = 0, torn = 0, regressions = 0;
+    for (int w = 0; w < writer_count; w++)
+    {
+        pthread_join(writers[w], NULL);
+        published += targets[w].published;
+    }
+    for (int r = 0; r < reader_count; r++)
+    {
+        pthread_join(readers[r], NULL);
+        reads += reader_stats[r].reads;
+        torn += reader_stats[r].torn;
+        regressions += reader_stats[r].regressions;
+    }
+
+    printf("%s: %d writer(s), %d reader(s), %u s, record %zu bytes\n",
+           unsafe_reads ? "UNSAFE reads (seqlock bypassed)" : "seqlock reads",
+           writer_count, reader_count, seconds, sizeof(stress_record_t));
+    printf("  published %" PRIu64 ", reads %" PRIu64 ", torn %" PRIu64 ", version regressions %" PRIu64 "\n",
+           published, reads, torn, regressions);
+
+    if (unsafe_reads)
+    {
+        return 0;
+    }
+    const bool pass = torn == 0 && regressions == 0 && reads > 0;
+    printf("  %s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,611 @@
+/**
+ * @file coordinator_sim.c
+ * @brief Runs the coordinator's heating profile task faster than real time.
+ *
+ * heating_profile_task.c and coordinator_loop_timing.c are compiled
+ * unchanged against the virtual clock, which stands in for esp_timer and the
+ * FreeRTOS task API.  The PID tick timer fires in virtual time, so the task,
+ * profile_tick() and the PID run exactly as on the controller while a whole
+ * firing program passes in minutes.  Readings come from the furnace model or
+ * from a scripted curve; heater commands drive the heater emulator.
+ *
+ * Writes a CSV of the status updates the task posts (setpoint, measured
+ * temperature, power) with the stage and phase of each tick, and reports
+ * how much wall-clock time each simulated hour took.  --reset-at cuts the
+ * power mid-run and boots the coordinator again, which resumes from the
+ * checkpoint journal kept in the in-memory NVS.  --flash keeps that NVS in
+ * a file, so the furnace rates the remaining-time estimate learns carry
+ * over from one simulated firing to the next; the report shows how far the
+ * estimate was off along the run.
+ *
+ *   coordinator_sim [options]
+ *     -p, --program FILE       Stages, lines of "minutes,target_c" ('#' comments)
+ *     -s, --stage MIN:TARGET   Append a stage (repeatable); default is a built-in bisque
+ *     -c, --cooldown X10       Cooldown rate x10 (default CONFIG_NEXTION_COOLDOWN_RATE_X10)
+ *     -x, --speed N            Virtual seconds per wall second (default 1000, 0 = unpaced)
+ *     -C, --curve FILE         Scripted readings, lines of "seconds,celsius", instead of the model
+ *     -o, --csv FILE           Write a trace to FILE ("-" for stdout)
+ *     -i, --csv-interval SEC   Trace sample interval (default 10)
+ *     -H, --max-hours H        Stop the profile after H simulated hours (default 48)
+ *     -R, --reset-at H[:SEC]   Lose power after H hours for SEC seconds (default 0), then reboot
+ *     -F, --flash FILE         Load the simulated NVS from FILE and save it back at the end
+ *     -t, --start T            Initial furnace temperature (default: ambient)
+ *     -a, --ambient T          Ambient temperature (default 20)
+ *     -m, --mass J_PER_K       Thermal mass (default 45000)
+ *     -P, --power W            Element power (default 5000)
+ *     -l, --sensor-lag SEC     Thermocouple time constant (default 20)
+ *     -N, --noise SIGMA        Sensor noise in degrees C (default 0.3)
+ *     -S, --seed N             Random seed (default 1)
+ *     -v, --verbose            Print firmware log messages
+ *
+ * Build: cmake -S tools/furnace_sim -B build/furnace_sim && cmake --build build/furnace_sim
+ */
+
+#include <getopt.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "coordinator_component_internal.h"
+#include "event_manager.h"
+#include "furnace_model.h"
+#include "heater_emulator.h"
+#include "logger_component.h"
+#include "pid_component.h"
+#include "sdkconfig.h"
+#include "sim_nvs.h"
+#include "sim_program.h"
+#include "temperature_curve.h"
+#include "temperature_profile_controller.h"
+#include "virtual_clock.h"
+
+#define SIM_STEP_MS   100U
+#define MS_PER_MINUTE 60000.0
+
+typedef struct
+{
+    sim_program_t program;
+    int cooldown_rate_x10;
+    double speed;
+    const char* curve_path;
+    const char* csv_path;
+    uint32_t csv_interval_ms;
+    double max_hours;
+    double reset_at_h;              // < 0: no power loss
+    double outage_s;
+    const char* flash_path;
+    double start_c;
+    bool start_set;
+    furnace_params_t furnace;
+    uint64_t seed;
+} sim_options_t;
+
+/* Everything the firmware reports back; only touched while the task runs or the clock is stopped */
+static struct
+{
+    furnace_model_t furnace;
+    heater_emulator_t heater;
+    temperature_curve_t curve;
+    bool use_curve;
+    FILE* csv;
+    uint32_t csv_interval_ms;
+    int64_t next_csv_us;
+    profile_tick_result_t last_tick;
+    uint64_t phase_ticks[STAGE_PHASE_COMPLETE + 1];
+    uint32_t status_updates;
+    uint32_t heater_commands;
+    bool completed;
+    bool reset_done;
+    bool resumed;
+    uint32_t reset_elapsed_ms;      // Profile clock when the power went
+    uint32_t resumed_elapsed_ms;    // Profile clock restored from the journal
+    uint32_t initial_total_ms;      // First remaining-time estimate
+    uint32_t* eta_totals_ms;        // elapsed_ms + remaining_ms of every status update
+    size_t eta_count;
+    size_t eta_capacity;
+} sim;
+
+static bool verbose;
+
+coordinator_ctx_t* g_coordinator_ctx;
+
+/* =========================================================================
+ *  Helpers
+ * ========================================================================= */
+static const char* phase_name(const stage_phase_t phase)
+{
+    switch (phase)
+    {
+    case STAGE_PHASE_RAMPING: return "RAMPING";
+    case STAGE_PHASE_HOLDING: return "HOLDING";
+    case STAGE_PHASE_SETTLE: return "SETTLE";
+    case STAGE_PHASE_EXTEND: return "EXTEND";
+    case STAGE_PHASE_COOLDOWN: return "COOLDOWN";
+    case STAGE_PHASE_COMPLETE: return "COMPLETE";
+    default: return "?";
+    }
+}
+
+static double chamber_c(const int64_t now_us)
+{
+    return sim.use_curve ? temperature_curve_at(&sim.curve, (double)now_us / 1e6) : sim.furnace.chamber_c;
+}
+
+static float read_sensor(const int64_t now_us)
+{
+    if (!sim.use_curve)
+    {
+        return furnace_model_read_sensor(&sim.furnace);
+    }
+
+    /* The model supplies the noise and quantisation around the scripted value */
+    sim.furnace.sensor_c = temperature_curve_at(&sim.curve, (double)now_us / 1e6);
+    return furnace_model_read_sensor(&sim.furnace);
+}
+
+static void usage(const char* argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-p FILE | -s MIN:TARGET ...] [-c X10] [-x SPEED] [-C CURVE] [-o CSV] [-i SEC]\n"
+            "          [-H HOURS] [-R H[:SEC]] [-F FILE] [-t START] [-a AMBIENT] [-m J_PER_K] [-P W] [-l LAG_S] [-N SIGMA]\n"
+            "          [-S SEED] [-v]\n",
+            argv0);
+}
+
+static bool parse_options(const int argc, char** argv, sim_options_t* options)
+{
+    static const struct option long_options[] = {
+        {"program", required_argument, NULL, 'p'},
+        {"stage", required_argument, NULL, 's'},
+        {"cooldown", required_argument, NULL, 'c'},
+        {"speed", required_argument, NULL, 'x'},
+        {"curve", required_argument, NULL, 'C'},
+        {"csv", required_argument, NULL, 'o'},
+        {"csv-interval", required_argument, NULL, 'i'},
+        {"max-hours", required_argument, NULL, 'H'},
+        {"reset-at", required_argument, NULL, 'R'},
+        {"flash", required_argument, NULL, 'F'},
+        {"start", required_argument, NULL, 't'},
+        {"ambient", required_argument, NULL, 'a'},
+        {"mass", required_argument, NULL, 'm'},
+        {"power", required_argument, NULL, 'P'},
+        {"sensor-lag", required_argument, NULL, 'l'},
+        {"noise", required_argument, NULL, 'N'},
+        {"seed", required_argument, NULL, 'S'},
+        {"verbose", no_argument, NULL, 'v'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0},
+    };
+
+    memset(options, 0, sizeof(*options));
+    options->cooldown_rate_x10 = CONFIG_NEXTION_COOLDOWN_RATE_X10;
+    options->speed = 1000.0;
+    options->csv_interval_ms = 10000;
+    options->max_hours = 48.0;
+    options->reset_at_h = -1.0;
+    options->seed = 1;
+    furnace_default_params(&options->furnace);
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "p:s:c:x:C:o:i:H:R:F:t:a:m:P:l:N:S:vh", long_options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'p':
+            if (!sim_program_load_file(&options->program, optarg))
+            {
+                return false;
+            }
+            break;
+        case 's':
+            if (!sim_program_add_stage_arg(&options->program, optarg))
+            {
+                return false;
+            }
+            break;
+        case 'c': options->cooldown_rate_x10 = atoi(optarg); break;
+        case 'x': options->speed = atof(optarg); break;
+        case 'C': options->curve_path = optarg; break;
+        case 'o': options->csv_path = optarg; break;
+        case 'i': options->csv_interval_ms = (uint32_t)(atof(optarg) * 1000.0); break;
+        case 'H': options->max_hours = atof(optarg); break;
+        case 'R':
+        {
+            char* rest;
+            options->reset_at_h = strtod(optarg, &rest);
+            options->outage_s = *rest == ':' ? atof(rest + 1) : 0.0;
+            break;
+        }
+        case 'F': options->flash_path = optarg; break;
+        case 't':
+            options->start_c = atof(optarg);
+            options->start_set = true;
+            break;
+        case 'a': options->furnace.ambient_c = atof(optarg); break;
+        case 'm': options->furnace.thermal_mass_j_per_k = atof(optarg); break;
+        case 'P': options->furnace.heater_power_w = atof(optarg); break;
+        case 'l': options->furnace.sensor_lag_s = atof(optarg); break;
+        case 'N': options->furnace.sensor_noise_c = atof(optarg); break;
+        case 'S': options->seed = strtoull(optarg, NULL, 0); break;
+        case 'v': verbose = true; break;
+        default:
+            usage(argv[0]);
+            return false;
+        }
+    }
+
+    if (options->program.stage_count == 0)
+    {
+        sim_program_load_default(&options->program);
+    }
+    if (options->speed < 0.0 || options->furnace.thermal_mass_j_per_k <= 0.0)
+    {
+        fprintf(stderr, "Speed must not be negative and the thermal mass must be positive\n");
+        return false;
+    }
+    return true;
+}
+
+static void print_report(FILE* out, const sim_options_t* options, const double wall_s)
+{
+    const int64_t now_us = virtual_clock_now_us();
+    const double simulated_h = (double)now_us / 3.6e9;
+
+    fprintf(out, "Program \"%s\": %d stages, %.0f min planned before cooldown, readings from %s\n",
+            options->program.draft.name, options->program.stage_count,
+            sim_program_planned_minutes(&options->program), sim.use_curve ? options->curve_path : "furnace model");
+    fprintf(out, "%s after %.2f h simulated, profile clock %.1f min, initial estimate %.1f min\n",
+            sim.completed                 ? "Profile complete"
+            : sim.reset_done && !sim.resumed ? "Abandoned at the power loss"
+                                             : "Stopped at the time limit",
+            simulated_h,
+            g_coordinator_ctx->heating_task_state.current_time_elapsed_ms / MS_PER_MINUTE,
+            sim.initial_total_ms / MS_PER_MINUTE);
+
+    fprintf(out, "Time per phase:");
+    for (int phase = STAGE_PHASE_RAMPING; phase <= STAGE_PHASE_COMPLETE; phase++)
+    {
+        if (sim.phase_ticks[phase] > 0)
+        {
+            fprintf(out, " %s %.1f min", phase_name((stage_phase_t)phase),
+                    (double)sim.phase_ticks[phase] * CONFIG_COORDINATOR_PID_TICK_INTERVAL_MS / MS_PER_MINUTE);
+        }
+    }
+    fprintf(out, "\n");
+
+    if (sim.reset_done)
+    {
+        if (sim.resumed)
+        {
+            fprintf(out, "Power loss at %.2f h for %.0f s: resumed from the journal at %.1f min, %.1f min of "
+                    "progress lost\n", options->reset_at_h, options->outage_s, sim.resumed_elapsed_ms / MS_PER_MINUTE,
+                    (double)(sim.reset_elapsed_ms - sim.resumed_elapsed_ms) / MS_PER_MINUTE);
+        }
+        else
+        {
+            fprintf(out, "Power loss at %.2f h for %.0f s: not resumed\n", options->reset_at_h, options->outage_s);
+        }
+    }
+
+    if (sim.completed && sim.eta_count > 0)
+    {
+        /* Against the profile clock at completion, the length the estimates aimed at */
+        const double actual_ms = g_coordinator_ctx->heating_task_state.current_time_elapsed_ms;
+        double error_sum_ms = 0.0;
+        for (size_t i = 0; i < sim.eta_count; i++)
+        {
+            error_sum_ms += fabs((double)sim.eta_totals_ms[i] - actual_ms);
+        }
+        fprintf(out, "Remaining-time estimate: mean error %.1f min, at 0/25/50/75%% of the run %+.1f/%+.1f/%+.1f/%+.1f "
+                "min\n", error_sum_ms / (double)sim.eta_count / MS_PER_MINUTE,
+                ((double)sim.eta_totals_ms[0] - actual_ms) / MS_PER_MINUTE,
+                ((double)sim.eta_totals_ms[sim.eta_count / 4] - actual_ms) / MS_PER_MINUTE,
+                ((double)sim.eta_totals_ms[sim.eta_count / 2] - actual_ms) / MS_PER_MINUTE,
+                ((double)sim.eta_totals_ms[sim.eta_count * 3 / 4] - actual_ms) / MS_PER_MINUTE);
+    }
+
+    sim_nvs_stats_t nvs_stats;
+    sim_nvs_get_stats(&nvs_stats);
+    fprintf(out, "NVS: %lu writes, %llu bytes, ~%llu flash entries (%.1f NVS pages)\n",
+            (unsigned long)nvs_stats.blob_writes, (unsigned long long)nvs_stats.bytes_written,
+            (unsigned long long)nvs_stats.entries_written, (double)nvs_stats.entries_written / 126.0);
+
+    coordinator_loop_timing_t timing;
+    if (coordinator_get_loop_timing(&timing) == ESP_OK)
+    {
+        fprintf(out, "PID loop: %lu ticks, %lu missed, dt min/max %lu/%lu us, %lu status updates, %lu heater "
+                "commands\n", (unsigned long)timing.ticks, (unsigned long)timing.missed_ticks,
+                (unsigned long)timing.dt_min_us, (unsigned long)timing.dt_max_us,
+                (unsigned long)sim.status_updates, (unsigned long)sim.heater_commands);
+    }
+
+    fprintf(out, "Wall clock %.2f s: %.1f ms per simulated hour, %.0fx real time", wall_s,
+            simulated_h > 0.0 ? wall_s * 1000.0 / simulated_h : 0.0,
+            wall_s > 0.0 ? (double)now_us / 1e6 / wall_s : 0.0);
+    if (options->speed > 0.0)
+    {
+        fprintf(out, " (paced at %.0fx)", options->speed);
+    }
+    fprintf(out, "\n");
+}
+
+/* =========================================================================
+ *  Firmware services
+ * ========================================================================= */
+void logger_send(const log_level_t log_level, const char* tag, const char* message, ...)
+{
+    if (!verbose && log_level > LOG_LEVEL_WARN)
+    {
+        return;
+    }
+
+    static const char level_chars[] = {'-', 'E', 'W', 'I', 'D'};
+    fprintf(stderr, "[%9.1f s] %c %s: ", (double)esp_timer_get_time() / 1e6, level_chars[log_level], tag);
+    va_list args;
+    va_start(args, message);
+    vfprintf(stderr, message, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+const char* esp_err_to_name(const esp_err_t code)
+{
+    switch (code)
+    {
+    case ESP_OK: return "ESP_OK";
+    case ESP_FAIL: return "ESP_FAIL";
+    case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+    case ESP_ERR_INVALID_RESPONSE: return "ESP_ERR_INVALID_RESPONSE";
+    default: return "UNKNOWN";
+    }
+}
+
+esp_err_t event_manager_post_health(const health_monitor_event_id_t event_id, const health_monitor_data_t* event_data)
+{
+    (void)event_id;
+    (void)event_data;
+    return ESP_OK;
+}
+
+esp_err_t post_coordinator_event(const coordinator_event_id_t event_type, void* event_data,
+                                 const size_t event_data_size)
+{
+    if (event_type == COORDINATOR_EVENT_PROFILE_COMPLETED)
+    {
+        sim.completed = true;
+    }
+    if (event_type != COORDINATOR_EVENT_STATUS_UPDATE || event_data_size != sizeof(coordinator_status_data_t))
+    {
+        return ESP_OK;
+    }
+
+    const coordinator_status_data_t* status = event_data;
+    const int64_t now_us = esp_timer_get_time();
+    sim.status_updates++;
+    if (sim.eta_count == sim.eta_capacity)
+    {
+        const size_t capacity = sim.eta_capacity > 0 ? sim.eta_capacity * 2 : 4096;
+        uint32_t* totals = realloc(sim.eta_totals_ms, capacity * sizeof(*totals));
+        if (totals == NULL)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+        sim.eta_totals_ms = totals;
+        sim.eta_capacity = capacity;
+    }
+    sim.eta_totals_ms[sim.eta_count++] = status->elapsed_ms + status->remaining_ms;
+    if (sim.csv != NULL && now_us >= sim.next_csv_us)
+    {
+        fprintf(sim.csv, "%.1f,%.1f,%.2f,%.2f,%.2f,%.3f,%d,%s,%.1f\n", (double)now_us / 1e6,
+                (double)status->elapsed_ms / 1000.0, status->target_temperature, status->current_temperature,
+                chamber_c(now_us), status->power_output, sim.last_tick.current_stage_index + 1,
+                phase_name(sim.last_tick.phase), (double)status->remaining_ms / 1000.0);
+        sim.next_csv_us = now_us + (int64_t)sim.csv_interval_ms * 1000;
+    }
+    return ESP_OK;
+}
+
+esp_err_t commands_dispatcher_dispatch_command(command_t* command)
+{
+    if (command == NULL || command->data == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (command->target != COMMAND_TARGET_HEATER || command->data_size != sizeof(heater_command_data_t))
+    {
+        return ESP_OK;
+    }
+
+    const heater_command_data_t* data = command->data;
+    sim.heater_commands++;
+    switch (data->type)
+    {
+    case COMMAND_TYPE_HEATER_SET_POWER:
+        return heater_emulator_set_power(&sim.heater, data->power_level) ? ESP_OK : ESP_ERR_INVALID_ARG;
+    case COMMAND_TYPE_HEATER_CLEAR:
+        heater_emulator_clear(&sim.heater);
+        return ESP_OK;
+    default:
+        return ESP_OK;
+    }
+}
+
+esp_err_t post_heater_controller_command(command_t* command)
+{
+    return commands_dispatcher_dispatch_command(command);
+}
+
+/* Linked with --wrap=profile_tick so the trace can show the stage and phase of each tick */
+profile_controller_error_t __real_profile_tick(uint32_t elapsed_since_last_ms, float current_temp,
+                                               profile_tick_result_t* result);
+
+profile_controller_error_t __wrap_profile_tick(const uint32_t elapsed_since_last_ms, const float current_temp,
+                                               profile_tick_result_t* result)
+{
+    const profile_controller_error_t err = __real_profile_tick(elapsed_since_last_ms, current_temp, result);
+    if (err == PROFILE_CONTROLLER_ERROR_NONE)
+    {
+        sim.last_tick = *result;
+        sim.phase_ticks[result->phase]++;
+    }
+    return err;
+}
+
+/* =========================================================================
+ *  Simulation
+ * ========================================================================= */
+/* The task dies with the heater, the furnace coasts through the outage, then
+ * the coordinator boots with nothing but what the journal kept in NVS */
+static int64_t simulate_power_loss(const sim_options_t* options, int64_t now_us)
+{
+    sim.reset_done = true;
+    sim.reset_elapsed_ms = g_coordinator_ctx->heating_task_state.current_time_elapsed_ms;
+    if (virtual_clock_live_tasks() > 0)
+    {
+        stop_heating_profile(g_coordinator_ctx);
+        virtual_clock_advance_to(now_us);
+    }
+    heater_emulator_clear(&sim.heater);
+
+    const int64_t boot_us = now_us + (int64_t)(options->outage_s * 1e6);
+    while (now_us < boot_us)
+    {
+        now_us += SIM_STEP_MS * 1000;
+        virtual_clock_advance_to(now_us);
+        furnace_model_step(&sim.furnace, false, SIM_STEP_MS / 1000.0);
+    }
+
+    shutdown_profile_controller();
+    pid_controller_reset();
+    free(g_coordinator_ctx);
+    g_coordinator_ctx = calloc(1, sizeof(coordinator_ctx_t));
+    if (g_coordinator_ctx == NULL)
+    {
+        exit(1);
+    }
+    coordinator_ctx_t* ctx = g_coordinator_ctx;
+    ctx->timing_lock = (portMUX_TYPE)portMUX_INITIALIZER_UNLOCKED;
+    checkpoint_load(ctx);
+    eta_load();
+
+    /* The first reading after boot is what decides whether the run resumes; the
+     * firmware dispatches that decision as a coordinator command, run here inline */
+    ctx->current_temperature = read_sensor(now_us);
+    checkpoint_try_resume(ctx);
+    sim.resumed = ctx->running;
+    sim.resumed_elapsed_ms = ctx->heating_task_state.current_time_elapsed_ms;
+    return now_us;
+}
+
+int main(const int argc, char** argv)
+{
+    sim_options_t options;
+    if (!parse_options(argc, argv, &options))
+    {
+        return 2;
+    }
+
+    if (options.curve_path != NULL)
+    {
+        if (!temperature_curve_load(&sim.curve, options.curve_path))
+        {
+            return 1;
+        }
+        sim.use_curve = true;
+        options.furnace.sensor_lag_s = 0.0;
+    }
+    if (options.csv_path != NULL)
+    {
+        sim.csv = strcmp(options.csv_path, "-") == 0 ? stdout : fopen(options.csv_path, "w");
+        if (sim.csv == NULL)
+        {
+            perror(options.csv_path);
+            return 1;
+        }
+        fprintf(sim.csv, "time_s,profile_s,setpoint_c,measured_c,chamber_c,power,stage,phase,remaining_s\n");
+        sim.csv_interval_ms = options.csv_interval_ms;
+    }
+
+    const double initial_c = sim.use_curve ? temperature_curve_at(&sim.curve, 0.0)
+                                           : options.start_set ? options.start_c : options.furnace.ambient_c;
+    furnace_model_init(&sim.furnace, &options.furnace, initial_c, options.seed);
+    heater_emulator_init(&sim.heater, CONFIG_HEATER_WINDOW_SIZE_MS);
+    virtual_clock_init(options.speed);
+
+    g_coordinator_ctx = calloc(1, sizeof(coordinator_ctx_t));
+    if (g_coordinator_ctx == NULL)
+    {
+        return 1;
+    }
+    coordinator_ctx_t* ctx = g_coordinator_ctx;
+    ctx->timing_lock = (portMUX_TYPE)portMUX_INITIALIZER_UNLOCKED;
+    ctx->current_temperature = read_sensor(0);
+
+    /* What coordinator_init() reads from flash on boot */
+    if (options.flash_path != NULL && !sim_nvs_load(options.flash_path))
+    {
+        fprintf(stderr, "%s: no saved NVS, starting blank\n", options.flash_path);
+    }
+    eta_load();
+
+    if (start_heating_profile(ctx, &options.program.draft, options.cooldown_rate_x10) != ESP_OK)
+    {
+        fprintf(stderr, "Failed to start the heating profile\n");
+        return 1;
+    }
+    sim.initial_total_ms = ctx->heating_task_state.estimated_total_duration_ms;
+
+    const int64_t limit_us = (int64_t)(options.max_hours * 3.6e9);
+    const int64_t reset_us = options.reset_at_h >= 0.0 ? (int64_t)(options.reset_at_h * 3.6e9) : -1;
+    int64_t now_us = 0;
+    while (virtual_clock_live_tasks() > 0 && now_us < limit_us)
+    {
+        if (!sim.reset_done && reset_us >= 0 && now_us >= reset_us)
+        {
+            now_us = simulate_power_loss(&options, now_us);
+            ctx = g_coordinator_ctx;
+            if (virtual_clock_live_tasks() == 0)
+            {
+                break;
+            }
+        }
+
+        now_us += SIM_STEP_MS * 1000;
+        virtual_clock_advance_to(now_us);
+
+        const bool heater_on = heater_emulator_advance(&sim.heater, SIM_STEP_MS);
+        furnace_model_step(&sim.furnace, heater_on, SIM_STEP_MS / 1000.0);
+        ctx->current_temperature = read_sensor(now_us);
+    }
+
+    if (virtual_clock_live_tasks() > 0)
+    {
+        /* Time limit: stop the way the HMI would and let the task wind down */
+        stop_heating_profile(ctx);
+        virtual_clock_advance_to(now_us);
+    }
+    const double wall_s = virtual_clock_wall_seconds();
+
+    if (sim.csv != NULL && sim.csv != stdout)
+    {
+        fclose(sim.csv);
+    }
+    print_report(sim.csv == stdout ? stderr : stdout, &options, wall_s);
+    temperature_curve_free(&sim.curve);
+    free(sim.eta_totals_ms);
+
+    if (options.flash_path != NULL && !sim_nvs_save(options.flash_path))
+    {
+        perror(options.flash_path);
+        return 1;
+    }
+
+    return sim.completed ? 0 : 1;
+}
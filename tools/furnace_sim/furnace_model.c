@@ -0,0 +1,118 @@
+/**
+ * @file furnace_model.c
+ * @brief Lumped thermal model of an electric kiln for host-side simulation.
+ */
+
+#include "furnace_model.h"
+
+#include <math.h>
+
+#define STEFAN_BOLTZMANN 5.670374e-8
+#define KELVIN_OFFSET    273.15
+
+/* Keeps explicit Euler stable for any realistic mass/loss combination */
+#define MAX_INTEGRATION_STEP_S 0.5
+
+/* =========================================================================
+ *  Helpers
+ * ========================================================================= */
+static uint64_t next_random(furnace_model_t* model)
+{
+    /* xorshift64* */
+    model->rng_state ^= model->rng_state >> 12;
+    model->rng_state ^= model->rng_state << 25;
+    model->rng_state ^= model->rng_state >> 27;
+    return model->rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+static double uniform_random(furnace_model_t* model)
+{
+    return ((double)(next_random(model) >> 11) + 0.5) / 9007199254740992.0;
+}
+
+static double gaussian_random(furnace_model_t* model)
+{
+    const double u1 = uniform_random(model);
+    const double u2 = uniform_random(model);
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static double heat_loss_w(const furnace_params_t* params, const double chamber_c)
+{
+    const double t_k = chamber_c + KELVIN_OFFSET;
+    const double ambient_k = params->ambient_c + KELVIN_OFFSET;
+    const double wall_w = params->wall_loss_w_per_k * (chamber_c - params->ambient_c);
+    const double radiation_w = params->emissivity * STEFAN_BOLTZMANN * params->radiating_area_m2 *
+                               (t_k * t_k * t_k * t_k - ambient_k * ambient_k * ambient_k * ambient_k);
+    return wall_w + radiation_w;
+}
+
+/* =========================================================================
+ *  Public API
+ * ========================================================================= */
+void furnace_default_params(furnace_params_t* params)
+{
+    *params = (furnace_params_t){
+        .thermal_mass_j_per_k = 45000.0,
+        .heater_power_w = 5000.0,
+        .wall_loss_w_per_k = 2.0,
+        .radiating_area_m2 = 0.006,
+        .emissivity = 0.9,
+        .ambient_c = 20.0,
+        .sensor_lag_s = 20.0,
+        .sensor_noise_c = 0.3,
+        .sensor_resolution_c = 0.1,
+    };
+}
+
+void furnace_model_init(furnace_model_t* model, const furnace_params_t* params, const double initial_c,
+                        const uint64_t seed)
+{
+    model->params = *params;
+    model->chamber_c = initial_c;
+    model->sensor_c = initial_c;
+    model->heater_energy_j = 0.0;
+    model->rng_state = seed != 0 ? seed : 0x9E3779B97F4A7C15ULL;
+}
+
+void furnace_model_step(furnace_model_t* model, const bool heater_on, const double dt_s)
+{
+    const furnace_params_t* params = &model->params;
+    const double heater_w = heater_on ? params->heater_power_w : 0.0;
+
+    double remaining_s = dt_s;
+    while (remaining_s > 0.0)
+    {
+        const double step_s = remaining_s < MAX_INTEGRATION_STEP_S ? remaining_s : MAX_INTEGRATION_STEP_S;
+        remaining_s -= step_s;
+
+        const double net_w = heater_w - heat_loss_w(params, model->chamber_c);
+        model->chamber_c += net_w * step_s / params->thermal_mass_j_per_k;
+
+        if (params->sensor_lag_s > 0.0)
+        {
+            model->sensor_c += (model->chamber_c - model->sensor_c) * (1.0 - exp(-step_s / params->sensor_lag_s));
+        }
+        else
+        {
+            model->sensor_c = model->chamber_c;
+        }
+    }
+    model->heater_energy_j += heater_w * dt_s;
+}
+
+float furnace_model_read_sensor(furnace_model_t* model)
+{
+    const furnace_params_t* params = &model->params;
+    double reading = model->sensor_c;
+
+    if (params->sensor_noise_c > 0.0)
+    {
+        reading += gaussian_random(model) * params->sensor_noise_c;
+    }
+    if (params->sensor_resolution_c > 0.0)
+    {
+        reading = round(reading / params->sensor_resolution_c) * params->sensor_resolution_c;
+    }
+    return (float)reading;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file furnace_model.h
+ * @brief Lumped thermal model of an electric kiln for host-side simulation.
+ *
+ * One thermal mass is heated by an on/off element and loses heat to ambient
+ * by convection/conduction through the walls (linear in the temperature
+ * difference) and by radiation through leaks and spy holes (Stefan-Boltzmann).
+ * The thermocouple sees the chamber through a first-order lag and reports it
+ * with Gaussian noise, quantised to the transmitter resolution.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct
+{
+    double thermal_mass_j_per_k;    // Chamber, ware and inner insulation
+    double heater_power_w;          // Element power when switched on
+    double wall_loss_w_per_k;       // Convection/conduction to ambient
+    double radiating_area_m2;       // Effective area radiating to ambient
+    double emissivity;
+    double ambient_c;
+    double sensor_lag_s;            // Thermocouple time constant, 0 = none
+    double sensor_noise_c;          // Standard deviation of the reading
+    double sensor_resolution_c;     // Reading quantisation, 0 = none
+} furnace_params_t;
+
+typedef struct
+{
+    furnace_params_t params;
+    double chamber_c;               // True chamber temperature
+    double sensor_c;                // Lagged thermocouple temperature
+    double heater_energy_j;         // Energy delivered by the element so far
+    uint64_t rng_state;
+} furnace_model_t;
+
+/* A 5 kW, ~0.1 m3 ceramic kiln that tops out around 1300 C */
+void furnace_default_params(furnace_params_t* params);
+
+void furnace_model_init(furnace_model_t* model, const furnace_params_t* params, double initial_c, uint64_t seed);
+
+/* Advance the model by dt_s seconds with the element on or off */
+void furnace_model_step(furnace_model_t* model, bool heater_on, double dt_s);
+
+/* What the temperature sensor device would report now */
+float furnace_model_read_sensor(furnace_model_t* model);
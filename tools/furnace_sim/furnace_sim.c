@@ -0,0 +1,409 @@
+/**
+ * @file furnace_sim.c
+ * @brief Closed-loop host simulation of a firing program against a furnace model.
+ *
+ * Runs the firmware's temperature_profile_controller and pid_component
+ * sources unchanged, in the order the coordinator's control iteration calls
+ * them, against the lumped furnace model in place of the temperature sensor
+ * device and the heater emulator in place of the heater controller.  Time is
+ * simulated, so a 12 hour program finishes in well under a second.
+ *
+ * Prints a per-stage report (duration, overtime, overshoot, tracking error)
+ * and optionally writes a CSV trace for plotting.
+ *
+ *   furnace_sim [options]
+ *     -p, --program FILE       Stages, lines of "minutes,target_c" ('#' comments)
+ *     -s, --stage MIN:TARGET   Append a stage (repeatable); default is a built-in bisque
+ *     -c, --cooldown X10       Cooldown rate x10 (default CONFIG_NEXTION_COOLDOWN_RATE_X10)
+ *     -o, --csv FILE           Write a trace to FILE ("-" for stdout)
+ *     -i, --csv-interval SEC   Trace sample interval (default 10)
+ *     -H, --max-hours H        Stop after H simulated hours (default 48)
+ *     -t, --start T            Initial furnace temperature (default: ambient)
+ *     -a, --ambient T          Ambient temperature (default 20)
+ *     -m, --mass J_PER_K       Thermal mass (default 45000)
+ *     -P, --power W            Element power (default 5000)
+ *     -k, --wall-loss W_PER_K  Wall loss coefficient (default 2.0)
+ *     -r, --radiating-area M2  Effective radiating area (default 0.006)
+ *     -l, --sensor-lag SEC     Thermocouple time constant (default 20)
+ *     -N, --noise SIGMA        Sensor noise in degrees C (default 0.3)
+ *     -S, --seed N             Random seed (default 1)
+ *     -v, --verbose            Print controller log messages
+ *
+ * PID gains and the other controller options are compile-time Kconfig values,
+ * see host/sdkconfig.h for how to override them.
+ *
+ * Build: cmake -S tools/furnace_sim -B build/furnace_sim && cmake --build build/furnace_sim
+ */
+
+#include <getopt.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "furnace_model.h"
+#include "heater_emulator.h"
+#include "logger_component.h"
+#include "pid_component.h"
+#include "sdkconfig.h"
+#include "sim_program.h"
+#include "temperature_profile_controller.h"
+
+#define SIM_STEP_MS         100U
+#define PID_TICK_MS         ((uint32_t)CONFIG_COORDINATOR_PID_TICK_INTERVAL_MS)
+#define MS_PER_MINUTE       60000.0
+
+typedef struct
+{
+    int stage_index;
+    float start_c;
+    float target_c;
+    uint32_t planned_ms;
+    uint64_t start_ms;
+    uint64_t end_ms;
+    uint64_t overtime_ms;           // Time spent in SETTLE or EXTEND
+    double overshoot_c;             // Past the target in the direction of travel
+    double max_error_c;             // |chamber - setpoint|
+    double squared_error_sum;
+    uint32_t samples;
+    bool extension_warning;
+} stage_report_t;
+
+typedef struct
+{
+    sim_program_t program;
+    int cooldown_rate_x10;
+    const char* csv_path;
+    uint32_t csv_interval_ms;
+    double max_hours;
+    double start_c;
+    bool start_set;
+    furnace_params_t furnace;
+    uint64_t seed;
+} sim_options_t;
+
+static bool verbose;
+static uint64_t sim_now_ms;
+
+/* =========================================================================
+ *  Logger backend for the firmware sources
+ * ========================================================================= */
+void logger_send(const log_level_t log_level, const char* tag, const char* message, ...)
+{
+    if (!verbose && log_level > LOG_LEVEL_WARN)
+    {
+        return;
+    }
+
+    static const char level_chars[] = {'-', 'E', 'W', 'I', 'D'};
+    fprintf(stderr, "[%9.1f s] %c %s: ", (double)sim_now_ms / 1000.0, level_chars[log_level], tag);
+    va_list args;
+    va_start(args, message);
+    vfprintf(stderr, message, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+/* =========================================================================
+ *  Helpers
+ * ========================================================================= */
+static const char* phase_name(const stage_phase_t phase)
+{
+    switch (phase)
+    {
+    case STAGE_PHASE_RAMPING: return "RAMPING";
+    case STAGE_PHASE_HOLDING: return "HOLDING";
+    case STAGE_PHASE_SETTLE: return "SETTLE";
+    case STAGE_PHASE_EXTEND: return "EXTEND";
+    case STAGE_PHASE_COOLDOWN: return "COOLDOWN";
+    case STAGE_PHASE_COMPLETE: return "COMPLETE";
+    default: return "?";
+    }
+}
+
+static void usage(const char* argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-p FILE | -s MIN:TARGET ...] [-c X10] [-o CSV] [-i SEC] [-H HOURS]\n"
+            "          [-t START] [-a AMBIENT] [-m J_PER_K] [-P W] [-k W_PER_K] [-r M2]\n"
+            "          [-l LAG_S] [-N SIGMA] [-S SEED] [-v]\n",
+            argv0);
+}
+
+static bool parse_options(const int argc, char** argv, sim_options_t* options)
+{
+    static const struct option long_options[] = {
+        {"program", required_argument, NULL, 'p'},
+        {"stage", required_argument, NULL, 's'},
+        {"cooldown", required_argument, NULL, 'c'},
+        {"csv", required_argument, NULL, 'o'},
+        {"csv-interval", required_argument, NULL, 'i'},
+        {"max-hours", required_argument, NULL, 'H'},
+        {"start", required_argument, NULL, 't'},
+        {"ambient", required_argument, NULL, 'a'},
+        {"mass", required_argument, NULL, 'm'},
+        {"power", required_argument, NULL, 'P'},
+        {"wall-loss", required_argument, NULL, 'k'},
+        {"radiating-area", required_argument, NULL, 'r'},
+        {"sensor-lag", required_argument, NULL, 'l'},
+        {"noise", required_argument, NULL, 'N'},
+        {"seed", required_argument, NULL, 'S'},
+        {"verbose", no_argument, NULL, 'v'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0},
+    };
+
+    memset(options, 0, sizeof(*options));
+    options->cooldown_rate_x10 = CONFIG_NEXTION_COOLDOWN_RATE_X10;
+    options->csv_interval_ms = 10000;
+    options->max_hours = 48.0;
+    options->seed = 1;
+    furnace_default_params(&options->furnace);
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "p:s:c:o:i:H:t:a:m:P:k:r:l:N:S:vh", long_options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'p':
+            if (!sim_program_load_file(&options->program, optarg))
+            {
+                return false;
+            }
+            break;
+        case 's':
+            if (!sim_program_add_stage_arg(&options->program, optarg))
+            {
+                return false;
+            }
+            break;
+        case 'c': options->cooldown_rate_x10 = atoi(optarg); break;
+        case 'o': options->csv_path = optarg; break;
+        case 'i': options->csv_interval_ms = (uint32_t)(atof(optarg) * 1000.0); break;
+        case 'H': options->max_hours = atof(optarg); break;
+        case 't':
+            options->start_c = atof(optarg);
+            options->start_set = true;
+            break;
+        case 'a': options->furnace.ambient_c = atof(optarg); break;
+        case 'm': options->furnace.thermal_mass_j_per_k = atof(optarg); break;
+        case 'P': options->furnace.heater_power_w = atof(optarg); break;
+        case 'k': options->furnace.wall_loss_w_per_k = atof(optarg); break;
+        case 'r': options->furnace.radiating_area_m2 = atof(optarg); break;
+        case 'l': options->furnace.sensor_lag_s = atof(optarg); break;
+        case 'N': options->furnace.sensor_noise_c = atof(optarg); break;
+        case 'S': options->seed = strtoull(optarg, NULL, 0); break;
+        case 'v': verbose = true; break;
+        default:
+            usage(argv[0]);
+            return false;
+        }
+    }
+
+    if (options->program.stage_count == 0)
+    {
+        sim_program_load_default(&options->program);
+    }
+    if (options->furnace.thermal_mass_j_per_k <= 0.0 || options->csv_interval_ms < PID_TICK_MS)
+    {
+        fprintf(stderr, "Thermal mass must be positive and the CSV interval at least one PID tick\n");
+        return false;
+    }
+    return true;
+}
+
+static void record_stage_sample(stage_report_t* report, const profile_tick_result_t* tick, const double chamber_c)
+{
+    const double error_c = chamber_c - tick->setpoint;
+    const double abs_error_c = fabs(error_c);
+    const bool heating = report->target_c >= report->start_c;
+    const double past_target_c = heating ? chamber_c - report->target_c : report->target_c - chamber_c;
+
+    report->squared_error_sum += error_c * error_c;
+    report->samples++;
+    if (abs_error_c > report->max_error_c)
+    {
+        report->max_error_c = abs_error_c;
+    }
+    if (past_target_c > report->overshoot_c)
+    {
+        report->overshoot_c = past_target_c;
+    }
+    if (tick->phase == STAGE_PHASE_SETTLE || tick->phase == STAGE_PHASE_EXTEND)
+    {
+        report->overtime_ms += PID_TICK_MS;
+    }
+    if (tick->extension_warning)
+    {
+        report->extension_warning = true;
+    }
+}
+
+static void print_report(FILE* out, const sim_options_t* options, const stage_report_t* stages, const int stages_seen,
+                         const uint64_t cooldown_start_ms, const bool completed, const furnace_model_t* furnace,
+                         const uint64_t heater_on_ms, const double peak_c)
+{
+    fprintf(out, "Program \"%s\": %d stages, %.0f min planned before cooldown\n", options->program.draft.name,
+            options->program.stage_count, sim_program_planned_minutes(&options->program));
+    fprintf(out, "PID kp/ki/kd %d/%d/%d %%, tick %lu ms, heater window %d ms, average of %d\n", CONFIG_PID_KP,
+            CONFIG_PID_KI, CONFIG_PID_KD, (unsigned long)PID_TICK_MS, CONFIG_HEATER_WINDOW_SIZE_MS,
+            CONFIG_HEATER_POWER_AVERAGE_SAMPLES);
+    fprintf(out, "%s after %.2f h simulated\n\n", completed ? "Profile complete" : "Stopped at the time limit",
+            (double)sim_now_ms / 3600000.0);
+
+    fprintf(out, "Stage  Start C  Target C  Planned min  Actual min  Overtime min  Overshoot C  RMS err C  Max err C\n");
+    for (int i = 0; i < stages_seen; i++)
+    {
+        const stage_report_t* report = &stages[i];
+        const double rms_c = report->samples > 0 ? sqrt(report->squared_error_sum / report->samples) : 0.0;
+        fprintf(out, "%5d  %7.1f  %8.0f  %11.1f  %10.1f  %12.1f  %11.1f  %9.2f  %9.2f%s\n", report->stage_index + 1,
+                report->start_c, report->target_c, report->planned_ms / MS_PER_MINUTE,
+                (double)(report->end_ms - report->start_ms) / MS_PER_MINUTE, report->overtime_ms / MS_PER_MINUTE,
+                report->overshoot_c, rms_c, report->max_error_c,
+                report->extension_warning ? "  forced advance" : "");
+    }
+
+    if (cooldown_start_ms > 0)
+    {
+        fprintf(out, "\nCooldown %.1f min\n", (double)(sim_now_ms - cooldown_start_ms) / MS_PER_MINUTE);
+    }
+    fprintf(out, "Peak chamber %.1f C, element energy %.2f kWh, mean duty %.1f %%\n", peak_c,
+            furnace->heater_energy_j / 3.6e6, sim_now_ms > 0 ? 100.0 * (double)heater_on_ms / (double)sim_now_ms : 0.0);
+}
+
+/* =========================================================================
+ *  Simulation
+ * ========================================================================= */
+int main(const int argc, char** argv)
+{
+    sim_options_t options;
+    if (!parse_options(argc, argv, &options))
+    {
+        return 2;
+    }
+
+    FILE* csv = NULL;
+    if (options.csv_path != NULL)
+    {
+        csv = strcmp(options.csv_path, "-") == 0 ? stdout : fopen(options.csv_path, "w");
+        if (csv == NULL)
+        {
+            perror(options.csv_path);
+            return 1;
+        }
+        fprintf(csv, "time_s,setpoint_c,chamber_c,measured_c,power,stage,phase\n");
+    }
+
+    furnace_model_t furnace;
+    furnace_model_init(&furnace, &options.furnace, options.start_set ? options.start_c : options.furnace.ambient_c,
+                       options.seed);
+    heater_emulator_t heater;
+    heater_emulator_init(&heater, CONFIG_HEATER_WINDOW_SIZE_MS);
+
+    const temp_profile_config_t config = {
+        .program = &options.program.draft,
+        .initial_temperature = furnace_model_read_sensor(&furnace),
+        .cooldown_rate_x10 = options.cooldown_rate_x10,
+    };
+    if (load_heating_profile(config) != PROFILE_CONTROLLER_ERROR_NONE)
+    {
+        fprintf(stderr, "Failed to load the program\n");
+        return 1;
+    }
+    pid_controller_reset();
+
+    stage_report_t stages[PROGRAMS_TOTAL_STAGE_COUNT] = {0};
+    int stages_seen = 0;
+    uint64_t cooldown_start_ms = 0;
+    uint64_t heater_on_ms = 0;
+    uint64_t next_csv_ms = 0;
+    double peak_c = furnace.chamber_c;
+    bool completed = false;
+    const uint64_t limit_ms = (uint64_t)(options.max_hours * 3600000.0);
+    profile_tick_result_t tick = {0};
+
+    /* The coordinator's first iteration follows the first timer tick */
+    while (!completed && sim_now_ms < limit_ms)
+    {
+        for (uint32_t step_ms = 0; step_ms < PID_TICK_MS; step_ms += SIM_STEP_MS)
+        {
+            const bool heater_on = heater_emulator_advance(&heater, SIM_STEP_MS);
+            furnace_model_step(&furnace, heater_on, SIM_STEP_MS / 1000.0);
+            heater_on_ms += heater_on ? SIM_STEP_MS : 0;
+            sim_now_ms += SIM_STEP_MS;
+        }
+        if (furnace.chamber_c > peak_c)
+        {
+            peak_c = furnace.chamber_c;
+        }
+
+        /* ── Control iteration, as in run_control_iteration() ──────── */
+        const float measured_c = furnace_model_read_sensor(&furnace);
+        if (profile_tick(PID_TICK_MS, measured_c, &tick) != PROFILE_CONTROLLER_ERROR_NONE)
+        {
+            continue;
+        }
+
+        const float power = pid_controller_compute(tick.setpoint, measured_c, (float)PID_TICK_MS);
+        if (tick.stage_changed)
+        {
+            heater_emulator_clear(&heater);
+
+            if (stages_seen > 0)
+            {
+                stages[stages_seen - 1].end_ms = sim_now_ms;
+            }
+            if (tick.current_stage_index >= 0 && stages_seen < PROGRAMS_TOTAL_STAGE_COUNT)
+            {
+                const program_stage_t* stage = &options.program.draft.stages[tick.current_stage_index];
+                stages[stages_seen++] = (stage_report_t){
+                    .stage_index = tick.current_stage_index,
+                    .start_c = measured_c,
+                    .target_c = (float)stage->target_t_c,
+                    .planned_ms = (uint32_t)stage->t_min * 60000U,
+                    .start_ms = sim_now_ms,
+                };
+            }
+            else if (tick.current_stage_index < 0 && cooldown_start_ms == 0)
+            {
+                cooldown_start_ms = sim_now_ms;
+            }
+        }
+        heater_emulator_set_power(&heater, power);
+
+        if (tick.current_stage_index >= 0 && stages_seen > 0)
+        {
+            record_stage_sample(&stages[stages_seen - 1], &tick, furnace.chamber_c);
+        }
+
+        if (csv != NULL && sim_now_ms >= next_csv_ms)
+        {
+            fprintf(csv, "%.1f,%.2f,%.2f,%.2f,%.3f,%d,%s\n", (double)sim_now_ms / 1000.0, tick.setpoint,
+                    furnace.chamber_c, measured_c, power, tick.current_stage_index + 1, phase_name(tick.phase));
+            next_csv_ms = sim_now_ms + options.csv_interval_ms;
+        }
+
+        if (tick.profile_complete)
+        {
+            heater_emulator_clear(&heater);
+            heater_emulator_set_power(&heater, 0.0f);
+            completed = true;
+        }
+    }
+    if (stages_seen > 0 && stages[stages_seen - 1].end_ms == 0)
+    {
+        stages[stages_seen - 1].end_ms = sim_now_ms;
+    }
+
+    if (csv != NULL && csv != stdout)
+    {
+        fclose(csv);
+    }
+    print_report(csv == stdout ? stderr : stdout, &options, stages, stages_seen, cooldown_start_ms, completed, &furnace, heater_on_ms, peak_c);
+    shutdown_profile_controller();
+
+    return completed ? 0 : 1;
+}
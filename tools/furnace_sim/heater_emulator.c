@@ -0,0 +1,69 @@
+/**
+ * @file heater_emulator.c
+ * @brief Host stand-in for the heater controller's time-proportioning output.
+ */
+
+#include "heater_emulator.h"
+
+#include <string.h>
+
+/* =========================================================================
+ *  Public API
+ * ========================================================================= */
+void heater_emulator_init(heater_emulator_t* heater, const uint32_t window_ms)
+{
+    memset(heater, 0, sizeof(*heater));
+    heater->window_ms = window_ms;
+}
+
+bool heater_emulator_set_power(heater_emulator_t* heater, const float power_level)
+{
+    if (power_level < 0.0f || power_level > 1.0f)
+    {
+        return false;
+    }
+    if (power_level == 0.0f)
+    {
+        heater_emulator_clear(heater);
+    }
+    if (heater->count == CONFIG_HEATER_POWER_AVERAGE_SAMPLES)
+    {
+        heater->sum -= heater->samples[heater->next];
+    }
+    else
+    {
+        heater->count++;
+    }
+    heater->samples[heater->next] = power_level;
+    heater->sum += power_level;
+    heater->next = (uint8_t)((heater->next + 1) % CONFIG_HEATER_POWER_AVERAGE_SAMPLES);
+    return true;
+}
+
+void heater_emulator_clear(heater_emulator_t* heater)
+{
+    heater->sum = 0.0f;
+    heater->count = 0;
+    heater->next = 0;
+}
+
+float heater_emulator_average_power(const heater_emulator_t* heater)
+{
+    return heater->count > 0 ? heater->sum / (float)heater->count : 0.0f;
+}
+
+bool heater_emulator_advance(heater_emulator_t* heater, const uint32_t dt_ms)
+{
+    if (heater->window_elapsed_ms == 0)
+    {
+        heater->on_time_ms = (uint32_t)(heater_emulator_average_power(heater) * (float)heater->window_ms);
+    }
+
+    const bool on = heater->window_elapsed_ms < heater->on_time_ms;
+    heater->window_elapsed_ms += dt_ms;
+    if (heater->window_elapsed_ms >= heater->window_ms)
+    {
+        heater->window_elapsed_ms = 0;
+    }
+    return on;
+}
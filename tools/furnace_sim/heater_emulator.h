@@ -0,0 +1,39 @@
+/**
+ * @file heater_emulator.h
+ * @brief Host stand-in for the heater controller's time-proportioning output.
+ *
+ * Mirrors heater_controller_task.c: power commands are averaged over the
+ * last CONFIG_HEATER_POWER_AVERAGE_SAMPLES levels (0 clears the average),
+ * and at the start of every CONFIG_HEATER_WINDOW_SIZE_MS window the element
+ * is switched on for average * window and off for the rest.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+
+typedef struct
+{
+    float samples[CONFIG_HEATER_POWER_AVERAGE_SAMPLES];
+    float sum;
+    uint8_t count;
+    uint8_t next;
+    uint32_t window_ms;
+    uint32_t window_elapsed_ms;
+    uint32_t on_time_ms;
+} heater_emulator_t;
+
+void heater_emulator_init(heater_emulator_t* heater, uint32_t window_ms);
+
+/* COMMAND_TYPE_HEATER_SET_POWER; levels outside 0..1 are rejected like the firmware does */
+bool heater_emulator_set_power(heater_emulator_t* heater, float power_level);
+
+/* COMMAND_TYPE_HEATER_CLEAR */
+void heater_emulator_clear(heater_emulator_t* heater);
+
+float heater_emulator_average_power(const heater_emulator_t* heater);
+
+/* Element state for the next dt_ms; dt_ms must not cross a window boundary */
+bool heater_emulator_advance(heater_emulator_t* heater, uint32_t dt_ms);
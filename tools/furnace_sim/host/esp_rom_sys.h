@@ -0,0 +1,6 @@
+/* Host build: ROM busy-wait on the virtual clock, see sim_uart.c */
+#pragma once
+
+#include <stdint.h>
+
+void esp_rom_delay_us(uint32_t us);
@@ -0,0 +1,39 @@
+/*
+ * Host build: the FreeRTOS types and macros used by the simulated sources.
+ * Tasks, notifications and critical sections are implemented on the
+ * virtual clock, see virtual_clock.c.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef void (*TaskFunction_t)(void*);
+
+typedef struct
+{
+    int unused;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+
+#define configMAX_TASK_NAME_LEN 16
+#define portTICK_PERIOD_MS      1
+#define portMAX_DELAY           ((TickType_t)0xffffffffUL)
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(ms))
+#define pdTICKS_TO_MS(ticks)    ((uint32_t)(ticks))
+#define pdFALSE                 0
+#define pdTRUE                  1
+#define pdFAIL                  0
+#define pdPASS                  1
+
+void virtual_clock_enter_critical(void);
+void virtual_clock_exit_critical(void);
+
+#define taskENTER_CRITICAL(mux) ((void)(mux), virtual_clock_enter_critical())
+#define taskEXIT_CRITICAL(mux)  ((void)(mux), virtual_clock_exit_critical())
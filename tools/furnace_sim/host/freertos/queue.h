@@ -0,0 +1,21 @@
+/* Host build: queue API on the virtual clock, see virtual_clock.c */
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct virtual_queue* QueueHandle_t;
+
+/* Storage for a queue created in place, large enough for struct virtual_queue */
+typedef struct
+{
+    void* opaque[6];
+} StaticQueue_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+void vQueueDelete(QueueHandle_t queue);
+BaseType_t xQueueReset(QueueHandle_t queue);
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks_to_wait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+QueueHandle_t xQueueCreateMutex(void);
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t item_size, uint8_t* storage, StaticQueue_t* buffer);
@@ -0,0 +1,14 @@
+/* Host build: semaphores as zero-size queues, as in FreeRTOS; no priority inheritance */
+#pragma once
+
+#include "freertos/queue.h"
+
+typedef QueueHandle_t SemaphoreHandle_t;
+typedef StaticQueue_t StaticSemaphore_t;
+
+#define xSemaphoreCreateBinary()                 xQueueCreate(1, 0)
+#define xSemaphoreCreateBinaryStatic(buffer)     xQueueCreateStatic(1, 0, NULL, (buffer))
+#define xSemaphoreCreateMutex()                  xQueueCreateMutex()
+#define xSemaphoreTake(semaphore, ticks_to_wait) xQueueReceive((semaphore), NULL, (ticks_to_wait))
+#define xSemaphoreGive(semaphore)                xQueueSend((semaphore), NULL, 0)
+#define vSemaphoreDelete(semaphore)              vQueueDelete(semaphore)
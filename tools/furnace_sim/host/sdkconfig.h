@@ -0,0 +1,285 @@
+/*
+ * Host build configuration for the furnace simulator.
+ *
+ * Only the options read by the firmware sources compiled into the simulator,
+ * at their Kconfig defaults.  Every value can be overridden at configure time,
+ * e.g. -DCMAKE_C_FLAGS="-DCONFIG_PID_KI=5", to evaluate another tuning.
+ */
+#pragma once
+
+/* logger_component */
+#ifndef CONFIG_LOG_ENABLE
+#define CONFIG_LOG_ENABLE 1
+#endif
+#ifndef CONFIG_LOG_LEVEL
+#define CONFIG_LOG_LEVEL 4
+#endif
+#ifndef CONFIG_LOG_MAX_MESSAGE_LENGTH
+#define CONFIG_LOG_MAX_MESSAGE_LENGTH 265
+#endif
+
+/* nextion_hmi program model */
+#ifndef CONFIG_NEXTION_PROGRAMS_PAGE_STAGE_COUNT
+#define CONFIG_NEXTION_PROGRAMS_PAGE_STAGE_COUNT 5
+#endif
+#ifndef CONFIG_NEXTION_PROGRAMS_PAGE_COUNT
+#define CONFIG_NEXTION_PROGRAMS_PAGE_COUNT 3
+#endif
+#ifndef CONFIG_NEXTION_COOLDOWN_RATE_X10
+#define CONFIG_NEXTION_COOLDOWN_RATE_X10 10
+#endif
+#ifndef CONFIG_NEXTION_MAIN_GRAPH_WIDTH
+#define CONFIG_NEXTION_MAIN_GRAPH_WIDTH 764
+#endif
+#ifndef CONFIG_NEXTION_MAX_TEMPERATURE_C
+#define CONFIG_NEXTION_MAX_TEMPERATURE_C 170
+#endif
+#ifndef CONFIG_NEXTION_TEMP_TOLERANCE_C
+#define CONFIG_NEXTION_TEMP_TOLERANCE_C 2
+#endif
+
+/* coordinator_component */
+#ifndef CONFIG_COORDINATOR_TASK_NAME
+#define CONFIG_COORDINATOR_TASK_NAME "COORDINATOR_TASK"
+#endif
+#ifndef CONFIG_COORDINATOR_TASK_STACK_SIZE
+#define CONFIG_COORDINATOR_TASK_STACK_SIZE 4096
+#endif
+#ifndef CONFIG_COORDINATOR_TASK_PRIORITY
+#define CONFIG_COORDINATOR_TASK_PRIORITY 5
+#endif
+#ifndef CONFIG_COORDINATOR_COMPONENT_ID
+#define CONFIG_COORDINATOR_COMPONENT_ID 4
+#endif
+#ifndef CONFIG_COORDINATOR_HEARTBEAT_TIMEOUT_MS
+#define CONFIG_COORDINATOR_HEARTBEAT_TIMEOUT_MS 5000
+#endif
+#ifndef CONFIG_COORDINATOR_PID_TICK_INTERVAL_MS
+#define CONFIG_COORDINATOR_PID_TICK_INTERVAL_MS 1000
+#endif
+#ifndef CONFIG_COORDINATOR_LOOP_TIMING_REPORT_MS
+#define CONFIG_COORDINATOR_LOOP_TIMING_REPORT_MS 60000
+#endif
+#ifndef CONFIG_COORDINATOR_CHECKPOINT_INTERVAL_S
+#define CONFIG_COORDINATOR_CHECKPOINT_INTERVAL_S 60
+#endif
+#ifndef CONFIG_COORDINATOR_CHECKPOINT_JOURNAL_SLOTS
+#define CONFIG_COORDINATOR_CHECKPOINT_JOURNAL_SLOTS 4
+#endif
+#ifndef CONFIG_COORDINATOR_CHECKPOINT_RESUME_TOLERANCE_C
+#define CONFIG_COORDINATOR_CHECKPOINT_RESUME_TOLERANCE_C 30
+#endif
+#ifndef CONFIG_COORDINATOR_ETA_BAND_C
+#define CONFIG_COORDINATOR_ETA_BAND_C 50
+#endif
+#ifndef CONFIG_COORDINATOR_ETA_BAND_COUNT
+#define CONFIG_COORDINATOR_ETA_BAND_COUNT 28
+#endif
+#ifndef CONFIG_COORDINATOR_ETA_LEARNING_RATE_PCT
+#define CONFIG_COORDINATOR_ETA_LEARNING_RATE_PCT 50
+#endif
+#ifndef CONFIG_COORDINATOR_PROFILE_COMPLETE_TEMP_C
+#define CONFIG_COORDINATOR_PROFILE_COMPLETE_TEMP_C 40
+#endif
+#ifndef CONFIG_COORDINATOR_SETTLE_WINDOW_MIN
+#define CONFIG_COORDINATOR_SETTLE_WINDOW_MIN 3
+#endif
+#ifndef CONFIG_COORDINATOR_MAX_STAGE_EXTENSION_MIN
+#define CONFIG_COORDINATOR_MAX_STAGE_EXTENSION_MIN 30
+#endif
+
+/* commands_dispatcher */
+#ifndef CONFIG_COMMANDS_DISPATCHER_QUEUE_SIZE
+#define CONFIG_COMMANDS_DISPATCHER_QUEUE_SIZE 10
+#endif
+#ifndef CONFIG_COMMANDS_DISPATCHER_TASK_STACK_SIZE
+#define CONFIG_COMMANDS_DISPATCHER_TASK_STACK_SIZE 4096
+#endif
+#ifndef CONFIG_COMMANDS_DISPATCHER_TASK_PRIORITY
+#define CONFIG_COMMANDS_DISPATCHER_TASK_PRIORITY 5
+#endif
+#ifndef CONFIG_COMMANDS_DISPATCHER_TASK_NAME
+#define CONFIG_COMMANDS_DISPATCHER_TASK_NAME "COMMANDS_DISPATCHER_NAME"
+#endif
+#ifndef CONFIG_COMMANDS_DISPATCHER_PER_TARGET_WORKERS
+#define CONFIG_COMMANDS_DISPATCHER_PER_TARGET_WORKERS 1
+#endif
+#ifndef CONFIG_COMMANDS_DISPATCHER_CRITICAL_QUEUE_SIZE
+#define CONFIG_COMMANDS_DISPATCHER_CRITICAL_QUEUE_SIZE 4
+#endif
+#ifndef CONFIG_COMMANDS_DISPATCHER_BULK_QUEUE_SIZE
+#define CONFIG_COMMANDS_DISPATCHER_BULK_QUEUE_SIZE 10
+#endif
+#ifndef CONFIG_COMMANDS_DISPATCHER_STATS_REPORT_MS
+#define CONFIG_COMMANDS_DISPATCHER_STATS_REPORT_MS 60000
+#endif
+#ifndef CONFIG_COMMANDS_DISPATCHER_COALESCE_SLOTS
+#define CONFIG_COMMANDS_DISPATCHER_COALESCE_SLOTS 4
+#endif
+#ifndef CONFIG_COMMANDS_DISPATCHER_MAX_FUTURES
+#define CONFIG_COMMANDS_DISPATCHER_MAX_FUTURES 4
+#endif
+#ifndef CONFIG_COMMANDS_DISPATCHER_REPLY_SIZE
+#define CONFIG_COMMANDS_DISPATCHER_REPLY_SIZE 64
+#endif
+#ifndef CONFIG_COMMANDS_DISPATCHER_SMALL_SLOTS
+#define CONFIG_COMMANDS_DISPATCHER_SMALL_SLOTS 10
+#endif
+#ifndef CONFIG_COMMANDS_DISPATCHER_SMALL_SLOT_SIZE
+#define CONFIG_COMMANDS_DISPATCHER_SMALL_SLOT_SIZE 32
+#endif
+#ifndef CONFIG_COMMANDS_DISPATCHER_LARGE_SLOTS
+#define CONFIG_COMMANDS_DISPATCHER_LARGE_SLOTS 2
+#endif
+#ifndef CONFIG_COMMANDS_DISPATCHER_CRITICAL_LARGE_SLOTS
+#define CONFIG_COMMANDS_DISPATCHER_CRITICAL_LARGE_SLOTS 1
+#endif
+#ifndef CONFIG_COMMANDS_DISPATCHER_MAX_HANDLERS
+#define CONFIG_COMMANDS_DISPATCHER_MAX_HANDLERS 5
+#endif
+#ifndef CONFIG_COMMANDS_DISPATCHER_COMPONENT_ID
+#define CONFIG_COMMANDS_DISPATCHER_COMPONENT_ID 7
+#endif
+#ifndef CONFIG_COMMANDS_DISPATCHER_HEARTBEAT_TIMEOUT_MS
+#define CONFIG_COMMANDS_DISPATCHER_HEARTBEAT_TIMEOUT_MS 10000
+#endif
+
+/* pid_component */
+#ifndef CONFIG_PID_KP
+#define CONFIG_PID_KP 100
+#endif
+#ifndef CONFIG_PID_KI
+#define CONFIG_PID_KI 10
+#endif
+#ifndef CONFIG_PID_KD
+#define CONFIG_PID_KD 1
+#endif
+#ifndef CONFIG_PID_OUTPUT_MIN
+#define CONFIG_PID_OUTPUT_MIN 0
+#endif
+#ifndef CONFIG_PID_OUTPUT_MAX
+#define CONFIG_PID_OUTPUT_MAX 100
+#endif
+
+/* heater_controller_component */
+#ifndef CONFIG_HEATER_WINDOW_SIZE_MS
+#define CONFIG_HEATER_WINDOW_SIZE_MS 10000
+#endif
+#ifndef CONFIG_HEATER_POWER_AVERAGE_SAMPLES
+#define CONFIG_HEATER_POWER_AVERAGE_SAMPLES 4
+#endif
+
+/* modbus_master, native backend */
+#ifndef CONFIG_MODBUS_MASTER_BACKEND_NATIVE
+#define CONFIG_MODBUS_MASTER_BACKEND_NATIVE 1
+#endif
+#ifndef CONFIG_MODBUS_BUS_QUEUE_LENGTH
+#define CONFIG_MODBUS_BUS_QUEUE_LENGTH 8
+#endif
+#ifndef CONFIG_MODBUS_BUS_SHUTDOWN_TIMEOUT_MS
+#define CONFIG_MODBUS_BUS_SHUTDOWN_TIMEOUT_MS 2000
+#endif
+#ifndef CONFIG_MODBUS_BUS_TASK_STACK_SIZE
+#define CONFIG_MODBUS_BUS_TASK_STACK_SIZE 4096
+#endif
+#ifndef CONFIG_MODBUS_BUS_TASK_PRIORITY
+#define CONFIG_MODBUS_BUS_TASK_PRIORITY 7
+#endif
+#ifndef CONFIG_MODBUS_BUS_TASK_NAME
+#define CONFIG_MODBUS_BUS_TASK_NAME "modbus_bus_task"
+#endif
+#ifndef CONFIG_MODBUS_RESPONSE_TIMEOUT_MS
+#define CONFIG_MODBUS_RESPONSE_TIMEOUT_MS 1000
+#endif
+#ifndef CONFIG_MODBUS_READ_MERGE_ENABLE
+#define CONFIG_MODBUS_READ_MERGE_ENABLE 1
+#endif
+#ifndef CONFIG_MODBUS_READ_MERGE_LOOKAHEAD
+#define CONFIG_MODBUS_READ_MERGE_LOOKAHEAD 8
+#endif
+#ifndef CONFIG_MODBUS_READ_MERGE_MAX_GAP
+#define CONFIG_MODBUS_READ_MERGE_MAX_GAP 0
+#endif
+#ifndef CONFIG_MODBUS_READ_MERGE_WINDOW_MS
+#define CONFIG_MODBUS_READ_MERGE_WINDOW_MS 5
+#endif
+#ifndef CONFIG_MODBUS_HEALTH_MAX_SLAVES
+#define CONFIG_MODBUS_HEALTH_MAX_SLAVES 16
+#endif
+#ifndef CONFIG_MODBUS_HEALTH_RTT_WINDOW
+#define CONFIG_MODBUS_HEALTH_RTT_WINDOW 16
+#endif
+#ifndef CONFIG_MODBUS_HEALTH_TIMEOUT_PERCENTILE
+#define CONFIG_MODBUS_HEALTH_TIMEOUT_PERCENTILE 95
+#endif
+#ifndef CONFIG_MODBUS_HEALTH_TIMEOUT_MARGIN_MS
+#define CONFIG_MODBUS_HEALTH_TIMEOUT_MARGIN_MS 20
+#endif
+#ifndef CONFIG_MODBUS_HEALTH_MIN_TIMEOUT_MS
+#define CONFIG_MODBUS_HEALTH_MIN_TIMEOUT_MS 50
+#endif
+#ifndef CONFIG_MODBUS_HEALTH_FAILURE_THRESHOLD
+#define CONFIG_MODBUS_HEALTH_FAILURE_THRESHOLD 3
+#endif
+#ifndef CONFIG_MODBUS_HEALTH_PROBE_BASE_MS
+#define CONFIG_MODBUS_HEALTH_PROBE_BASE_MS 1000
+#endif
+#ifndef CONFIG_MODBUS_HEALTH_PROBE_MAX_MS
+#define CONFIG_MODBUS_HEALTH_PROBE_MAX_MS 60000
+#endif
+#ifndef CONFIG_MODBUS_STATS_MAX_SLAVES
+#define CONFIG_MODBUS_STATS_MAX_SLAVES 8
+#endif
+#ifndef CONFIG_MODBUS_STATS_WINDOW_MS
+#define CONFIG_MODBUS_STATS_WINDOW_MS 10000
+#endif
+#ifndef CONFIG_MODBUS_STATS_DUMP_INTERVAL_MS
+#define CONFIG_MODBUS_STATS_DUMP_INTERVAL_MS 60000
+#endif
+#ifndef CONFIG_MODBUS_POLL_MAX_SLOTS
+#define CONFIG_MODBUS_POLL_MAX_SLOTS 16
+#endif
+#ifndef CONFIG_MODBUS_POLL_MAX_REGS
+#define CONFIG_MODBUS_POLL_MAX_REGS 4
+#endif
+#ifndef CONFIG_MODBUS_POLL_SILENT_THRESHOLD
+#define CONFIG_MODBUS_POLL_SILENT_THRESHOLD 3
+#endif
+#ifndef CONFIG_MODBUS_POLL_SILENT_PROBE_PERIODS
+#define CONFIG_MODBUS_POLL_SILENT_PROBE_PERIODS 10
+#endif
+#ifndef CONFIG_MODBUS_POLL_STATS_WINDOW_MS
+#define CONFIG_MODBUS_POLL_STATS_WINDOW_MS 10000
+#endif
+#ifndef CONFIG_MODBUS_POLL_TASK_STACK_SIZE
+#define CONFIG_MODBUS_POLL_TASK_STACK_SIZE 4096
+#endif
+#ifndef CONFIG_MODBUS_POLL_TASK_PRIORITY
+#define CONFIG_MODBUS_POLL_TASK_PRIORITY 6
+#endif
+#ifndef CONFIG_MODBUS_POLL_TASK_NAME
+#define CONFIG_MODBUS_POLL_TASK_NAME "modbus_poll_task"
+#endif
+
+/* temp_sensor_device */
+#ifndef CONFIG_TEMP_SENSOR_DEVICE_MAX_DEVICES
+#define CONFIG_TEMP_SENSOR_DEVICE_MAX_DEVICES 16
+#endif
+#ifndef CONFIG_TEMP_SENSOR_POLL_PERIOD_MS
+#define CONFIG_TEMP_SENSOR_POLL_PERIOD_MS 500
+#endif
+#ifndef CONFIG_TEMP_SENSOR_SAMPLE_MAX_AGE_MS
+#define CONFIG_TEMP_SENSOR_SAMPLE_MAX_AGE_MS 3000
+#endif
+#ifndef CONFIG_TEMP_SENSOR_SHADOW_MAX_REGS
+#define CONFIG_TEMP_SENSOR_SHADOW_MAX_REGS 16
+#endif
+#ifndef CONFIG_TEMP_SENSOR_SHADOW_FILL_GAP
+#define CONFIG_TEMP_SENSOR_SHADOW_FILL_GAP 2
+#endif
+#ifndef CONFIG_TEMP_SENSOR_SHADOW_SETTLE_MS
+#define CONFIG_TEMP_SENSOR_SHADOW_SETTLE_MS 100
+#endif
+#ifndef CONFIG_TEMP_SENSOR_SHADOW_VERIFY_MAX_SPAN
+#define CONFIG_TEMP_SENSOR_SHADOW_VERIFY_MAX_SPAN 16
+#endif
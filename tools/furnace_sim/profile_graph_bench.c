@@ -0,0 +1,384 @@
+/**
+ * @file profile_graph_bench.c
+ * @brief Host benchmark for planned-curve lookups and the graph render.
+ *
+ * Times a full-width render of the projected curve with program_build_graph()
+ * (segment table swept forward, one segment step per boundary) against the
+ * keypoint scan it replaced, and single setpoint lookups with
+ * profile_segment_table_temperature_at() (binary search) against the stage
+ * walk get_target_temperature_at_time() used to do.  Both renders are
+ * compared pixel by pixel.
+ *
+ *   profile_graph_bench [options]
+ *     -p, --program FILE       Stages, lines of "minutes,target_c" ('#' comments)
+ *     -s, --stage MIN:TARGET   Append a stage (repeatable); default is a built-in bisque
+ *     -F, --full               Fill every stage slot (worst case for the scans)
+ *     -c, --cooldown X10       Cooldown rate x10 (default CONFIG_NEXTION_COOLDOWN_RATE_X10)
+ *     -w, --width PX           Graph width (default CONFIG_NEXTION_MAIN_GRAPH_WIDTH)
+ *     -T, --max-temp C         Graph full scale (default: hottest stage)
+ *     -t, --start C            Start temperature (default 20)
+ *     -n, --iterations N       Renders to time (default 20000)
+ *
+ * Build: cmake -S tools/furnace_sim -B build/furnace_sim && cmake --build build/furnace_sim
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "heating_program_graph_internal.h"
+#include "profile_segment_table.h"
+#include "sdkconfig.h"
+#include "sim_program.h"
+
+#define LOOKUP_ROUNDS 2000000U
+
+typedef struct
+{
+    sim_program_t program;
+    int cooldown_rate_x10;
+    int width_px;
+    int max_temp_c;
+    int start_temp_c;
+    unsigned iterations;
+} bench_options_t;
+
+static int s_cooldown_rate_x10 = CONFIG_NEXTION_COOLDOWN_RATE_X10;
+
+/* Keeps the compiler from dropping the benchmarked work */
+static volatile float s_sink;
+
+/* heating_program_graph.c reads the cooldown rate from the HMI models */
+int program_get_cooldown_rate_x10(void)
+{
+    return s_cooldown_rate_x10;
+}
+
+/* =========================================================================
+ *  Baselines: the stage scans the segment table replaced
+ * ========================================================================= */
+static float legacy_target_at(const program_draft_t* prog, const float initial_temp, const int cd_rate,
+                              const uint32_t time_ms)
+{
+    uint32_t elapsed_time = 0;
+    float start_temp = initial_temp;
+
+    for (int i = 0; i < PROGRAMS_TOTAL_STAGE_COUNT; ++i)
+    {
+        const program_stage_t* stage = &prog->stages[i];
+        if (!stage->is_set)
+        {
+            continue;
+        }
+
+        const uint32_t stage_duration_ms = (uint32_t)stage->t_min * 60U * 1000U;
+        if (time_ms <= elapsed_time + stage_duration_ms)
+        {
+            const float t = (float)(time_ms - elapsed_time) / (float)stage_duration_ms;
+            return start_temp + ((float)stage->target_t_c - start_temp) * t;
+        }
+
+        elapsed_time += stage_duration_ms;
+        start_temp = (float)stage->target_t_c;
+    }
+
+    if (start_temp > 0.0f && cd_rate > 0)
+    {
+        float cooldown_min = (start_temp * 10.0f) / (float)cd_rate;
+        if (cooldown_min < 1.0f)
+        {
+            cooldown_min = 1.0f;
+        }
+        const uint32_t cooldown_ms = (uint32_t)(cooldown_min * 60.0f * 1000.0f);
+        if (time_ms <= elapsed_time + cooldown_ms)
+        {
+            const float t = (float)(time_ms - elapsed_time) / (float)cooldown_ms;
+            return start_temp * (1.0f - t);
+        }
+    }
+    return 0.0f;
+}
+
+static size_t legacy_build_graph(const program_draft_t* draft, uint8_t* out, const size_t max_len, const int width_px,
+                                 const int max_temp_c, const int start_temp_c)
+{
+    memset(out, 0, max_len);
+
+    float kp_time[PROGRAMS_TOTAL_STAGE_COUNT + 2];
+    float kp_temp[PROGRAMS_TOTAL_STAGE_COUNT + 2];
+    int n_keys = 1;
+    kp_time[0] = 0.0f;
+    kp_temp[0] = (float)start_temp_c;
+
+    float total_time = 0.0f;
+    for (int i = 0; i < PROGRAMS_TOTAL_STAGE_COUNT; ++i)
+    {
+        const program_stage_t* stage = &draft->stages[i];
+        if (!stage->is_set || !stage->t_set || !stage->target_set)
+        {
+            continue;
+        }
+        total_time += (float)stage->t_min;
+        kp_time[n_keys] = total_time;
+        kp_temp[n_keys] = (float)stage->target_t_c;
+        n_keys++;
+    }
+    if (n_keys <= 1 || total_time <= 0.0f)
+    {
+        return 0;
+    }
+
+    const float last_temp = kp_temp[n_keys - 1];
+    const int cd_rate = program_get_cooldown_rate_x10();
+    if (last_temp > 0.0f && cd_rate > 0)
+    {
+        float cooldown_min = (last_temp * 10.0f) / (float)cd_rate;
+        if (cooldown_min < 1.0f)
+        {
+            cooldown_min = 1.0f;
+        }
+        total_time += cooldown_min;
+        kp_time[n_keys] = total_time;
+        kp_temp[n_keys] = 0.0f;
+        n_keys++;
+    }
+
+    const size_t count = (size_t)width_px < max_len ? (size_t)width_px : max_len;
+    for (size_t x = 0; x < count; ++x)
+    {
+        const float t = count > 1 ? total_time * (float)x / (float)(count - 1) : 0.0f;
+        float temp_val = kp_temp[n_keys - 1];
+        for (int k = 1; k < n_keys; ++k)
+        {
+            if (t <= kp_time[k])
+            {
+                const float seg_len = kp_time[k] - kp_time[k - 1];
+                const float frac = seg_len > 0.0f ? (t - kp_time[k - 1]) / seg_len : 1.0f;
+                temp_val = kp_temp[k - 1] + (kp_temp[k] - kp_temp[k - 1]) * frac;
+                break;
+            }
+        }
+
+        int capped = (int)temp_val;
+        capped = capped < 0 ? 0 : capped > max_temp_c ? max_temp_c : capped;
+        const int mapped = (int)((float)capped * 255.0f / (float)max_temp_c);
+        out[x] = (uint8_t)(mapped > 255 ? 255 : mapped);
+    }
+    return count;
+}
+
+/* =========================================================================
+ *  Helpers
+ * ========================================================================= */
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void fill_program(sim_program_t* program)
+{
+    memset(program, 0, sizeof(*program));
+    snprintf(program->draft.name, sizeof(program->draft.name), "full");
+    for (int i = 0; i < PROGRAMS_TOTAL_STAGE_COUNT; ++i)
+    {
+        /* Alternate ramps and soaks up to 1000 C */
+        const int target_c = 100 + (900 * (i / 2 + 1)) / ((PROGRAMS_TOTAL_STAGE_COUNT + 1) / 2);
+        sim_program_add_stage(program, i % 2 == 0 ? 90 : 30, target_c);
+    }
+}
+
+static bool parse_options(const int argc, char** argv, bench_options_t* options)
+{
+    static const struct option long_options[] = {
+        {"program", required_argument, NULL, 'p'},
+        {"stage", required_argument, NULL, 's'},
+        {"full", no_argument, NULL, 'F'},
+        {"cooldown", required_argument, NULL, 'c'},
+        {"width", required_argument, NULL, 'w'},
+        {"max-temp", required_argument, NULL, 'T'},
+        {"start", required_argument, NULL, 't'},
+        {"iterations", required_argument, NULL, 'n'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0},
+    };
+
+    memset(options, 0, sizeof(*options));
+    options->cooldown_rate_x10 = CONFIG_NEXTION_COOLDOWN_RATE_X10;
+    options->width_px = CONFIG_NEXTION_MAIN_GRAPH_WIDTH;
+    options->start_temp_c = 20;
+    options->iterations = 20000;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "p:s:Fc:w:T:t:n:h", long_options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'p':
+            if (!sim_program_load_file(&options->program, optarg))
+            {
+                return false;
+            }
+            break;
+        case 's':
+            if (!sim_program_add_stage_arg(&options->program, optarg))
+            {
+                return false;
+            }
+            break;
+        case 'F': fill_program(&options->program); break;
+        case 'c': options->cooldown_rate_x10 = atoi(optarg); break;
+        case 'w': options->width_px = atoi(optarg); break;
+        case 'T': options->max_temp_c = atoi(optarg); break;
+        case 't': options->start_temp_c = atoi(optarg); break;
+        case 'n': options->iterations = (unsigned)strtoul(optarg, NULL, 0); break;
+        default:
+            fprintf(stderr, "usage: %s [-p FILE | -s MIN:TARGET ... | -F] [-c X10] [-w PX] [-T C] [-t C] [-n N]\n",
+                    argv[0]);
+            return false;
+        }
+    }
+
+    if (options->program.stage_count == 0)
+    {
+        sim_program_load_default(&options->program);
+    }
+    if (options->max_temp_c <= 0)
+    {
+        for (int i = 0; i < PROGRAMS_TOTAL_STAGE_COUNT; ++i)
+        {
+            const program_stage_t* stage = &options->program.draft.stages[i];
+            if (stage->is_set && stage->target_t_c > options->max_temp_c)
+            {
+                options->max_temp_c = stage->target_t_c;
+            }
+        }
+    }
+    if (options->width_px <= 0 || options->iterations == 0 || options->max_temp_c <= 0)
+    {
+        fprintf(stderr, "Width, iterations and full scale must be positive\n");
+        return false;
+    }
+    return true;
+}
+
+/* =========================================================================
+ *  Benchmarks
+ * ========================================================================= */
+static bool bench_render(const bench_options_t* options)
+{
+    const program_draft_t* draft = &options->program.draft;
+    const size_t len = (size_t)options->width_px;
+    uint8_t* legacy = malloc(len);
+    uint8_t* table = malloc(len);
+    if (legacy == NULL || table == NULL)
+    {
+        free(legacy);
+        free(table);
+        return false;
+    }
+
+    const size_t legacy_count = legacy_build_graph(draft, legacy, len, options->width_px, options->max_temp_c,
+                                                   options->start_temp_c);
+    const size_t table_count = program_build_graph(draft, table, len, options->width_px, options->max_temp_c,
+                                                   options->start_temp_c);
+    size_t mismatched = 0;
+    int max_diff = 0;
+    for (size_t x = 0; x < len; ++x)
+    {
+        const int diff = abs((int)legacy[x] - (int)table[x]);
+        mismatched += diff != 0;
+        max_diff = diff > max_diff ? diff : max_diff;
+    }
+
+    double start = now_s();
+    for (unsigned i = 0; i < options->iterations; ++i)
+    {
+        legacy_build_graph(draft, legacy, len, options->width_px, options->max_temp_c, options->start_temp_c);
+        s_sink = legacy[i % len];
+    }
+    const double legacy_s = now_s() - start;
+
+    start = now_s();
+    for (unsigned i = 0; i < options->iterations; ++i)
+    {
+        program_build_graph(draft, table, len, options->width_px, options->max_temp_c, options->start_temp_c);
+        s_sink = table[i % len];
+    }
+    const double table_s = now_s() - start;
+
+    printf("Full-width render, %d px:\n", options->width_px);
+    printf("  keypoint scan     %8.2f us/render\n", legacy_s * 1e6 / options->iterations);
+    printf("  segment table     %8.2f us/render  (%.2fx)\n", table_s * 1e6 / options->iterations,
+           table_s > 0.0 ? legacy_s / table_s : 0.0);
+    printf("  %zu/%zu points, %zu differ (max %d of 255)\n", table_count, legacy_count, mismatched, max_diff);
+
+    free(legacy);
+    free(table);
+    return table_count == legacy_count;
+}
+
+static void bench_lookup(const bench_options_t* options)
+{
+    const program_draft_t* draft = &options->program.draft;
+    const float start_c = (float)options->start_temp_c;
+
+    profile_segment_table_t segments;
+    const double build_start = now_s();
+    for (unsigned i = 0; i < options->iterations; ++i)
+    {
+        profile_segment_table_build(&segments, draft, start_c, options->cooldown_rate_x10);
+        s_sink = (float)segments.total_ms;
+    }
+    const double build_s = now_s() - build_start;
+
+    /* Spread the lookups over the whole curve, cooldown included */
+    const uint32_t span_ms = segments.total_ms + 1;
+    float max_error = 0.0f;
+    double start = now_s();
+    for (uint32_t i = 0; i < LOOKUP_ROUNDS; ++i)
+    {
+        s_sink = legacy_target_at(draft, start_c, options->cooldown_rate_x10, (uint32_t)((uint64_t)i * 7919U % span_ms));
+    }
+    const double legacy_s = now_s() - start;
+
+    start = now_s();
+    for (uint32_t i = 0; i < LOOKUP_ROUNDS; ++i)
+    {
+        s_sink = profile_segment_table_temperature_at(&segments, (uint32_t)((uint64_t)i * 7919U % span_ms));
+    }
+    const double table_s = now_s() - start;
+
+    for (uint32_t i = 0; i < 10000; ++i)
+    {
+        const uint32_t t_ms = (uint32_t)((uint64_t)i * span_ms / 10000U);
+        const float diff = legacy_target_at(draft, start_c, options->cooldown_rate_x10, t_ms) -
+                           profile_segment_table_temperature_at(&segments, t_ms);
+        max_error = diff > max_error ? diff : -diff > max_error ? -diff : max_error;
+    }
+
+    printf("Setpoint lookup, %u segments over %.1f min:\n", segments.segment_count, segments.total_ms / 60000.0);
+    printf("  table build       %8.1f ns\n", build_s * 1e9 / options->iterations);
+    printf("  stage walk        %8.1f ns/lookup\n", legacy_s * 1e9 / LOOKUP_ROUNDS);
+    printf("  binary search     %8.1f ns/lookup  (%.2fx), max difference %.4f C\n", table_s * 1e9 / LOOKUP_ROUNDS,
+           table_s > 0.0 ? legacy_s / table_s : 0.0, max_error);
+}
+
+int main(const int argc, char** argv)
+{
+    bench_options_t options;
+    if (!parse_options(argc, argv, &options))
+    {
+        return 2;
+    }
+    s_cooldown_rate_x10 = options.cooldown_rate_x10;
+
+    printf("Program \"%s\": %d stages, cooldown %d x10, full scale %d C\n", options.program.draft.name,
+           options.program.stage_count, options.cooldown_rate_x10, options.max_temp_c);
+    const bool render_ok = bench_render(&options);
+    bench_lookup(&options);
+    return render_ok ? 0 : 1;
+}
@@ -0,0 +1,271 @@
+/**
+ * @file sim_nvs.c
+ * @brief In-memory NVS for the host simulators.
+ */
+
+#include "sim_nvs.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_rom_crc.h"
+#include "nvs.h"
+
+#define SIM_NVS_MAX_NAMESPACES 4
+#define SIM_NVS_MAX_ENTRIES    32
+#define SIM_NVS_NAME_LEN       16       // NVS keys and namespaces are at most 15 characters
+#define SIM_NVS_MAX_BLOB       1024
+#define SIM_NVS_ENTRY_SIZE     32
+
+typedef struct
+{
+    bool used;
+    uint8_t namespace_index;
+    char key[SIM_NVS_NAME_LEN];
+    uint8_t data[SIM_NVS_MAX_BLOB];
+    size_t length;
+} sim_nvs_entry_t;
+
+static char namespaces[SIM_NVS_MAX_NAMESPACES][SIM_NVS_NAME_LEN];
+static sim_nvs_entry_t entries[SIM_NVS_MAX_ENTRIES];
+static sim_nvs_stats_t stats;
+
+/* =========================================================================
+ *  Helpers
+ * ========================================================================= */
+static int find_namespace(const char* name)
+{
+    for (int i = 0; i < SIM_NVS_MAX_NAMESPACES; i++)
+    {
+        if (namespaces[i][0] != '\0' && strcmp(namespaces[i], name) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static sim_nvs_entry_t* find_entry(const nvs_handle_t handle, const char* key)
+{
+    for (int i = 0; i < SIM_NVS_MAX_ENTRIES; i++)
+    {
+        if (entries[i].used && entries[i].namespace_index == handle && strcmp(entries[i].key, key) == 0)
+        {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+/* =========================================================================
+ *  NVS API
+ * ========================================================================= */
+esp_err_t nvs_open(const char* name, const nvs_open_mode_t open_mode, nvs_handle_t* out_handle)
+{
+    if (name == NULL || out_handle == NULL || strlen(name) >= SIM_NVS_NAME_LEN)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int index = find_namespace(name);
+    if (index < 0)
+    {
+        if (open_mode == NVS_READONLY)
+        {
+            return ESP_ERR_NVS_NOT_FOUND;
+        }
+        index = 0;
+        while (index < SIM_NVS_MAX_NAMESPACES && namespaces[index][0] != '\0')
+        {
+            index++;
+        }
+        if (index == SIM_NVS_MAX_NAMESPACES)
+        {
+            return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+        }
+        strcpy(namespaces[index], name);
+    }
+    *out_handle = (nvs_handle_t)index;
+    return ESP_OK;
+}
+
+void nvs_close(const nvs_handle_t handle)
+{
+    (void)handle;
+}
+
+esp_err_t nvs_commit(const nvs_handle_t handle)
+{
+    (void)handle;
+    return ESP_OK;
+}
+
+static esp_err_t store_entry(const nvs_handle_t handle, const char* key, const void* value, const size_t length)
+{
+    if (key == NULL || strlen(key) >= SIM_NVS_NAME_LEN || length > SIM_NVS_MAX_BLOB)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    sim_nvs_entry_t* entry = find_entry(handle, key);
+    for (int i = 0; entry == NULL && i < SIM_NVS_MAX_ENTRIES; i++)
+    {
+        if (!entries[i].used)
+        {
+            entry = &entries[i];
+            entry->used = true;
+            entry->namespace_index = (uint8_t)handle;
+            strcpy(entry->key, key);
+        }
+    }
+    if (entry == NULL)
+    {
+        return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+    }
+
+    memcpy(entry->data, value, length);
+    entry->length = length;
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(const nvs_handle_t handle, const char* key, const void* value, const size_t length)
+{
+    const esp_err_t err = store_entry(handle, key, value, length);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    /* A blob is a data header, its data entries and an index entry */
+    stats.blob_writes++;
+    stats.bytes_written += length;
+    stats.entries_written += 2 + (length + SIM_NVS_ENTRY_SIZE - 1) / SIM_NVS_ENTRY_SIZE;
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_blob(const nvs_handle_t handle, const char* key, void* out_value, size_t* length)
+{
+    const sim_nvs_entry_t* entry = find_entry(handle, key);
+    if (entry == NULL)
+    {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (out_value == NULL)
+    {
+        *length = entry->length;
+        return ESP_OK;
+    }
+    if (*length < entry->length)
+    {
+        *length = entry->length;
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    memcpy(out_value, entry->data, entry->length);
+    *length = entry->length;
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_u32(const nvs_handle_t handle, const char* key, const uint32_t value)
+{
+    const esp_err_t err = store_entry(handle, key, &value, sizeof(value));
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    /* An integer fits in a single entry */
+    stats.bytes_written += sizeof(value);
+    stats.entries_written++;
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_u32(const nvs_handle_t handle, const char* key, uint32_t* out_value)
+{
+    const sim_nvs_entry_t* entry = find_entry(handle, key);
+    if (entry == NULL)
+    {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (entry->length != sizeof(*out_value))
+    {
+        return ESP_ERR_NVS_TYPE_MISMATCH;
+    }
+    memcpy(out_value, entry->data, sizeof(*out_value));
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_key(const nvs_handle_t handle, const char* key)
+{
+    sim_nvs_entry_t* entry = find_entry(handle, key);
+    if (entry == NULL)
+    {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    entry->used = false;
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_all(const nvs_handle_t handle)
+{
+    for (int i = 0; i < SIM_NVS_MAX_ENTRIES; i++)
+    {
+        if (entries[i].used && entries[i].namespace_index == handle)
+        {
+            entries[i].used = false;
+        }
+    }
+    stats.erase_all_calls++;
+    return ESP_OK;
+}
+
+/* Same result as the ESP32 ROM routine: reflected CRC-32, inverted in and out */
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buf, const uint32_t len)
+{
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++)
+    {
+        crc ^= buf[i];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320U & (0U - (crc & 1U)));
+        }
+    }
+    return ~crc;
+}
+
+/* =========================================================================
+ *  Public API
+ * ========================================================================= */
+void sim_nvs_get_stats(sim_nvs_stats_t* out)
+{
+    *out = stats;
+}
+
+bool sim_nvs_load(const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    const bool ok = fread(namespaces, sizeof(namespaces), 1, file) == 1 && fread(entries, sizeof(entries), 1, file) == 1;
+    fclose(file);
+    if (!ok)
+    {
+        memset(namespaces, 0, sizeof(namespaces));
+        memset(entries, 0, sizeof(entries));
+    }
+    return ok;
+}
+
+bool sim_nvs_save(const char* path)
+{
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    bool ok = fwrite(namespaces, sizeof(namespaces), 1, file) == 1 && fwrite(entries, sizeof(entries), 1, file) == 1;
+    ok = fclose(file) == 0 && ok;
+    return ok;
+}
@@ -0,0 +1,29 @@
+/**
+ * @file sim_nvs.h
+ * @brief In-memory NVS for the host simulators.
+ *
+ * Implements the blob and u32 subset of the NVS API (host/nvs.h) on a small table
+ * that survives a simulated reset, and counts writes the way the flash
+ * would see them.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct
+{
+    uint32_t blob_writes;
+    uint64_t bytes_written;
+    uint64_t entries_written;   // 32-byte flash entries, NVS blob overhead included
+    uint32_t erase_all_calls;
+} sim_nvs_stats_t;
+
+void sim_nvs_get_stats(sim_nvs_stats_t* stats);
+
+/* Replace the contents with a file written by sim_nvs_save(); false if there is none */
+bool sim_nvs_load(const char* path);
+
+/* Write the contents to a file, as the flash would keep them across power cycles */
+bool sim_nvs_save(const char* path);
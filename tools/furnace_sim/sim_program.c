@@ -0,0 +1,105 @@
+/**
+ * @file sim_program.c
+ * @brief Firing programs for the host simulators.
+ */
+
+#include "sim_program.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* =========================================================================
+ *  Public API
+ * ========================================================================= */
+bool sim_program_add_stage(sim_program_t* program, const int minutes, const int target_c)
+{
+    if (program->stage_count >= PROGRAMS_TOTAL_STAGE_COUNT)
+    {
+        fprintf(stderr, "At most %d stages fit in a program\n", PROGRAMS_TOTAL_STAGE_COUNT);
+        return false;
+    }
+    if (minutes <= 0 || target_c < 0)
+    {
+        fprintf(stderr, "Invalid stage %d min -> %d C\n", minutes, target_c);
+        return false;
+    }
+
+    program_stage_t* stage = &program->draft.stages[program->stage_count++];
+    stage->t_min = minutes;
+    stage->target_t_c = target_c;
+    stage->t_set = true;
+    stage->target_set = true;
+    stage->is_set = true;
+    return true;
+}
+
+bool sim_program_add_stage_arg(sim_program_t* program, const char* arg)
+{
+    int minutes = 0;
+    int target_c = 0;
+    if (sscanf(arg, "%d:%d", &minutes, &target_c) != 2)
+    {
+        fprintf(stderr, "Invalid stage \"%s\", expected MIN:TARGET\n", arg);
+        return false;
+    }
+    snprintf(program->draft.name, sizeof(program->draft.name), "command line");
+    return sim_program_add_stage(program, minutes, target_c);
+}
+
+bool sim_program_load_file(sim_program_t* program, const char* path)
+{
+    FILE* file = fopen(path, "r");
+    if (file == NULL)
+    {
+        perror(path);
+        return false;
+    }
+
+    char line[128];
+    int line_number = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file) != NULL)
+    {
+        line_number++;
+        const char* text = line + strspn(line, " \t");
+        if (*text == '#' || *text == '\n' || *text == '\0')
+        {
+            continue;
+        }
+
+        int minutes = 0;
+        int target_c = 0;
+        if (sscanf(text, "%d , %d", &minutes, &target_c) != 2)
+        {
+            fprintf(stderr, "%s:%d: expected \"minutes,target_c\"\n", path, line_number);
+            ok = false;
+            break;
+        }
+        ok = sim_program_add_stage(program, minutes, target_c);
+    }
+    fclose(file);
+
+    const char* base = strrchr(path, '/');
+    snprintf(program->draft.name, sizeof(program->draft.name), "%s", base != NULL ? base + 1 : path);
+    return ok;
+}
+
+void sim_program_load_default(sim_program_t* program)
+{
+    sim_program_add_stage(program, 120, 200);
+    sim_program_add_stage(program, 240, 600);
+    sim_program_add_stage(program, 30, 600);
+    sim_program_add_stage(program, 180, 1000);
+    sim_program_add_stage(program, 20, 1000);
+    snprintf(program->draft.name, sizeof(program->draft.name), "default bisque");
+}
+
+double sim_program_planned_minutes(const sim_program_t* program)
+{
+    double minutes = 0.0;
+    for (int i = 0; i < program->stage_count; i++)
+    {
+        minutes += program->draft.stages[i].t_min;
+    }
+    return minutes;
+}
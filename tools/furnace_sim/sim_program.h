@@ -0,0 +1,30 @@
+/**
+ * @file sim_program.h
+ * @brief Firing programs for the host simulators.
+ *
+ * Program files hold one stage per line as "minutes,target_c"; blank lines
+ * and lines starting with '#' are ignored.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include "core_types.h"
+
+typedef struct
+{
+    program_draft_t draft;
+    int stage_count;
+} sim_program_t;
+
+bool sim_program_add_stage(sim_program_t* program, int minutes, int target_c);
+
+/* "MIN:TARGET", as given on the command line */
+bool sim_program_add_stage_arg(sim_program_t* program, const char* arg);
+
+bool sim_program_load_file(sim_program_t* program, const char* path);
+
+/* Slow bisque: dry, burn out, quartz inversion, soak */
+void sim_program_load_default(sim_program_t* program);
+
+double sim_program_planned_minutes(const sim_program_t* program);
@@ -0,0 +1,219 @@
+/**
+ * @file sim_uart.c
+ * @brief UART driver for the host simulators on a serial device or PTY.
+ *
+ * The descriptor is non-blocking: a read that finds no data sleeps one tick
+ * on the virtual clock and retries until the requested length arrived or
+ * ticks_to_wait passed, which is what the ESP-IDF driver returns too.
+ * Line settings are ignored, a PTY has no baud rate.
+ */
+
+#define _GNU_SOURCE
+#include "sim_uart.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+
+#define SIM_UART_PORTS 3
+
+typedef struct
+{
+    const char* path;
+    int fd;
+    bool installed;
+} sim_uart_t;
+
+static sim_uart_t uarts[SIM_UART_PORTS];
+
+static sim_uart_t* get_uart(const uart_port_t port)
+{
+    return port >= 0 && port < SIM_UART_PORTS && uarts[port].installed ? &uarts[port] : NULL;
+}
+
+bool sim_uart_attach(const uart_port_t port, const char* path)
+{
+    if (port < 0 || port >= SIM_UART_PORTS || uarts[port].installed)
+    {
+        return false;
+    }
+    uarts[port].path = path;
+    return true;
+}
+
+esp_err_t uart_driver_install(const uart_port_t uart_num, const int rx_buffer_size, const int tx_buffer_size,
+                              const int queue_size, QueueHandle_t* uart_queue, const int intr_alloc_flags)
+{
+    (void)rx_buffer_size;
+    (void)tx_buffer_size;
+    (void)queue_size;
+    (void)uart_queue;
+    (void)intr_alloc_flags;
+
+    if (uart_num < 0 || uart_num >= SIM_UART_PORTS || uarts[uart_num].path == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim_uart_t* uart = &uarts[uart_num];
+    if (uart->installed)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uart->fd = open(uart->path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (uart->fd < 0)
+    {
+        perror(uart->path);
+        return ESP_FAIL;
+    }
+
+    struct termios tio;
+    if (tcgetattr(uart->fd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        tcsetattr(uart->fd, TCSANOW, &tio);
+    }
+    uart->installed = true;
+    return ESP_OK;
+}
+
+esp_err_t uart_driver_delete(const uart_port_t uart_num)
+{
+    sim_uart_t* uart = get_uart(uart_num);
+    if (uart == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    close(uart->fd);
+    uart->installed = false;
+    return ESP_OK;
+}
+
+esp_err_t uart_param_config(const uart_port_t uart_num, const uart_config_t* uart_config)
+{
+    return get_uart(uart_num) != NULL && uart_config != NULL ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t uart_set_pin(const uart_port_t uart_num, const int tx_io_num, const int rx_io_num, const int rts_io_num,
+                       const int cts_io_num)
+{
+    (void)tx_io_num;
+    (void)rx_io_num;
+    (void)rts_io_num;
+    (void)cts_io_num;
+    return get_uart(uart_num) != NULL ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t uart_set_mode(const uart_port_t uart_num, const uart_mode_t mode)
+{
+    (void)mode;
+    return get_uart(uart_num) != NULL ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t uart_set_rx_timeout(const uart_port_t uart_num, const uint8_t tout_thresh)
+{
+    (void)tout_thresh;
+    return get_uart(uart_num) != NULL ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+int uart_write_bytes(const uart_port_t uart_num, const void* src, const size_t size)
+{
+    const sim_uart_t* uart = get_uart(uart_num);
+    if (uart == NULL || src == NULL)
+    {
+        return -1;
+    }
+
+    size_t written = 0;
+    while (written < size)
+    {
+        const ssize_t n = write(uart->fd, (const uint8_t*)src + written, size - written);
+        if (n > 0)
+        {
+            written += (size_t)n;
+        }
+        else if (n < 0 && errno != EAGAIN && errno != EINTR)
+        {
+            return -1;
+        }
+        else
+        {
+            vTaskDelay(1);
+        }
+    }
+    return (int)written;
+}
+
+int uart_read_bytes(const uart_port_t uart_num, void* buf, const uint32_t length, const TickType_t ticks_to_wait)
+{
+    const sim_uart_t* uart = get_uart(uart_num);
+    if (uart == NULL || buf == NULL)
+    {
+        return -1;
+    }
+
+    const int64_t deadline_us = ticks_to_wait == portMAX_DELAY
+                                    ? INT64_MAX
+                                    : esp_timer_get_time() + (int64_t)pdTICKS_TO_MS(ticks_to_wait) * 1000;
+    uint32_t received = 0;
+    while (received < length)
+    {
+        const ssize_t n = read(uart->fd, (uint8_t*)buf + received, length - received);
+        if (n > 0)
+        {
+            received += (uint32_t)n;
+            continue;
+        }
+        if (n < 0 && errno != EAGAIN && errno != EINTR)
+        {
+            return -1;
+        }
+        if (esp_timer_get_time() >= deadline_us)
+        {
+            break;
+        }
+        vTaskDelay(1);
+    }
+    return (int)received;
+}
+
+esp_err_t uart_wait_tx_done(const uart_port_t uart_num, const TickType_t ticks_to_wait)
+{
+    const sim_uart_t* uart = get_uart(uart_num);
+    (void)ticks_to_wait;
+    if (uart == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return tcdrain(uart->fd) == 0 ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t uart_flush_input(const uart_port_t uart_num)
+{
+    const sim_uart_t* uart = get_uart(uart_num);
+    if (uart == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t discard[64];
+    while (read(uart->fd, discard, sizeof(discard)) > 0)
+    {
+    }
+    return ESP_OK;
+}
+
+/* The virtual clock counts whole ticks: a sub-tick busy-wait takes one */
+void esp_rom_delay_us(const uint32_t us)
+{
+    if (us > 0)
+    {
+        vTaskDelay(1);
+    }
+}
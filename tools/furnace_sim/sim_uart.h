@@ -0,0 +1,17 @@
+/**
+ * @file sim_uart.h
+ * @brief UART driver for the host simulators on a serial device or PTY.
+ *
+ * Implements the driver calls in host/driver/uart.h on a file descriptor, so
+ * the native Modbus backend can talk to tools/ms9024_sim.  Reads poll the
+ * descriptor once per virtual tick: run the virtual clock at speed 1 so a
+ * tick lasts as long as the peer needs to answer.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include "driver/uart.h"
+
+/* Device opened by uart_driver_install(port, ...); call before the driver is installed */
+bool sim_uart_attach(uart_port_t port, const char* path);
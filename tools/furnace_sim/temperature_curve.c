@@ -0,0 +1,122 @@
+/**
+ * @file temperature_curve.c
+ * @brief Scripted temperature readings for the host simulators.
+ */
+
+#include "temperature_curve.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* =========================================================================
+ *  Public API
+ * ========================================================================= */
+bool temperature_curve_load(temperature_curve_t* curve, const char* path)
+{
+    memset(curve, 0, sizeof(*curve));
+
+    FILE* file = fopen(path, "r");
+    if (file == NULL)
+    {
+        perror(path);
+        return false;
+    }
+
+    int capacity = 0;
+    char line[128];
+    int line_number = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file) != NULL)
+    {
+        line_number++;
+        const char* text = line + strspn(line, " \t");
+        if (*text == '#' || *text == '\n' || *text == '\0')
+        {
+            continue;
+        }
+
+        double seconds = 0.0;
+        double celsius = 0.0;
+        if (sscanf(text, "%lf , %lf", &seconds, &celsius) != 2 ||
+            (curve->count > 0 && seconds <= curve->seconds[curve->count - 1]))
+        {
+            fprintf(stderr, "%s:%d: expected \"seconds,celsius\" with increasing seconds\n", path, line_number);
+            ok = false;
+            break;
+        }
+
+        if (curve->count == capacity)
+        {
+            capacity = capacity > 0 ? capacity * 2 : 64;
+            double* new_seconds = realloc(curve->seconds, (size_t)capacity * sizeof(double));
+            if (new_seconds != NULL)
+            {
+                curve->seconds = new_seconds;
+            }
+            double* new_celsius = realloc(curve->celsius, (size_t)capacity * sizeof(double));
+            if (new_celsius != NULL)
+            {
+                curve->celsius = new_celsius;
+            }
+            if (new_seconds == NULL || new_celsius == NULL)
+            {
+                fprintf(stderr, "Out of memory loading %s\n", path);
+                ok = false;
+                break;
+            }
+        }
+        curve->seconds[curve->count] = seconds;
+        curve->celsius[curve->count] = celsius;
+        curve->count++;
+    }
+    fclose(file);
+
+    if (ok && curve->count == 0)
+    {
+        fprintf(stderr, "%s: no points\n", path);
+        ok = false;
+    }
+    if (!ok)
+    {
+        temperature_curve_free(curve);
+    }
+    return ok;
+}
+
+double temperature_curve_at(const temperature_curve_t* curve, const double seconds)
+{
+    if (seconds <= curve->seconds[0])
+    {
+        return curve->celsius[0];
+    }
+    if (seconds >= curve->seconds[curve->count - 1])
+    {
+        return curve->celsius[curve->count - 1];
+    }
+
+    int low = 0;
+    int high = curve->count - 1;
+    while (high - low > 1)
+    {
+        const int mid = (low + high) / 2;
+        if (curve->seconds[mid] <= seconds)
+        {
+            low = mid;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    const double fraction = (seconds - curve->seconds[low]) / (curve->seconds[high] - curve->seconds[low]);
+    return curve->celsius[low] + (curve->celsius[high] - curve->celsius[low]) * fraction;
+}
+
+void temperature_curve_free(temperature_curve_t* curve)
+{
+    free(curve->seconds);
+    free(curve->celsius);
+    memset(curve, 0, sizeof(*curve));
+}
@@ -0,0 +1,24 @@
+/**
+ * @file temperature_curve.h
+ * @brief Scripted temperature readings for the host simulators.
+ *
+ * A curve file holds "seconds,celsius" points in ascending time order;
+ * readings are interpolated linearly and hold the end points outside them.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+typedef struct
+{
+    double* seconds;
+    double* celsius;
+    int count;
+} temperature_curve_t;
+
+bool temperature_curve_load(temperature_curve_t* curve, const char* path);
+
+double temperature_curve_at(const temperature_curve_t* curve, double seconds);
+
+void temperature_curve_free(temperature_curve_t* curve);
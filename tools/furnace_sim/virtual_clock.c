@@ -0,0 +1,708 @@
+/**
+ * @file virtual_clock.c
+ * @brief Simulated time source behind the host esp_timer and FreeRTOS task API.
+ *
+ * The simulator thread owns time.  Before it moves the clock it waits until
+ * the system is quiescent: every task is deleted, or blocked with no pending
+ * notification and a timeout still in the future.  Timer callbacks run on the
+ * simulator thread, like esp_timer's ESP_TIMER_TASK dispatch.
+ *
+ * Every blocking call (notification, queue, semaphore, delay) is a wait on a
+ * readiness check evaluated under the clock lock, so a task blocked on a
+ * queue counts as quiescent exactly like one blocked on a notification.
+ */
+
+#define _GNU_SOURCE
+#include "virtual_clock.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+#define MAX_VIRTUAL_TASKS  8
+#define MAX_VIRTUAL_TIMERS 8
+#define WAIT_FOREVER_US    INT64_MAX
+
+typedef bool (*ready_fn_t)(const void* arg);
+
+struct virtual_task
+{
+    bool used;
+    bool blocked;
+    bool deleted;
+    uint32_t notify_value;          // Counter for Give/Take, bits for xTaskNotify(eSetBits)
+    bool notify_pending;
+    int64_t wake_at_us;             // Timeout while blocked
+    ready_fn_t ready;               // What the blocked task waits for
+    const void* ready_arg;
+    pthread_cond_t wake;
+    TaskFunction_t function;
+    void* arg;
+    char name[configMAX_TASK_NAME_LEN];
+};
+
+struct virtual_queue
+{
+    uint8_t* storage;
+    size_t item_size;
+    UBaseType_t length;
+    UBaseType_t count;
+    UBaseType_t head;
+};
+
+struct virtual_timer
+{
+    bool used;
+    bool active;
+    esp_timer_cb_t callback;
+    void* arg;
+    int64_t period_us;              // 0 for one-shot
+    int64_t expires_us;
+};
+
+static struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t quiescent;
+    int64_t now_us;
+    double speed;
+    struct timespec wall_start;
+    struct virtual_task tasks[MAX_VIRTUAL_TASKS];
+    struct virtual_timer timers[MAX_VIRTUAL_TIMERS];
+} vclock = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .quiescent = PTHREAD_COND_INITIALIZER,
+};
+
+static pthread_mutex_t critical_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static __thread struct virtual_task* current_task;
+
+/* =========================================================================
+ *  Helpers
+ * ========================================================================= */
+static double timespec_seconds(const struct timespec* ts)
+{
+    return (double)ts->tv_sec + (double)ts->tv_nsec / 1e9;
+}
+
+/* Caller holds vclock.lock */
+static bool is_quiescent(void)
+{
+    for (int i = 0; i < MAX_VIRTUAL_TASKS; i++)
+    {
+        const struct virtual_task* task = &vclock.tasks[i];
+        if (!task->used || task->deleted)
+        {
+            continue;
+        }
+        if (!task->blocked || task->ready(task->ready_arg) || task->wake_at_us <= vclock.now_us)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Caller holds vclock.lock */
+static void wait_quiescent(void)
+{
+    while (!is_quiescent())
+    {
+        pthread_cond_wait(&vclock.quiescent, &vclock.lock);
+    }
+}
+
+/* Caller holds vclock.lock; a queue, semaphore or notification changed */
+static void wake_blocked(void)
+{
+    for (int i = 0; i < MAX_VIRTUAL_TASKS; i++)
+    {
+        struct virtual_task* task = &vclock.tasks[i];
+        if (task->used && !task->deleted && task->blocked)
+        {
+            pthread_cond_signal(&task->wake);
+        }
+    }
+}
+
+/*
+ * Caller holds vclock.lock.  Block the calling task until ready(arg) holds or
+ * ticks_to_wait pass; returns the final readiness.
+ */
+static bool block_until(const ready_fn_t ready, const void* arg, const TickType_t ticks_to_wait)
+{
+    struct virtual_task* task = current_task;
+    if (ready(arg) || ticks_to_wait == 0)
+    {
+        return ready(arg);
+    }
+    if (task == NULL)
+    {
+        fprintf(stderr, "virtual_clock: only tasks may block\n");
+        abort();
+    }
+
+    task->wake_at_us = ticks_to_wait == portMAX_DELAY
+                           ? WAIT_FOREVER_US
+                           : vclock.now_us + (int64_t)pdTICKS_TO_MS(ticks_to_wait) * 1000;
+    task->ready = ready;
+    task->ready_arg = arg;
+    task->blocked = true;
+    pthread_cond_broadcast(&vclock.quiescent);
+    while (!ready(arg) && vclock.now_us < task->wake_at_us)
+    {
+        pthread_cond_wait(&task->wake, &vclock.lock);
+    }
+    task->blocked = false;
+    task->wake_at_us = WAIT_FOREVER_US;
+    return ready(arg);
+}
+
+static bool never_ready(const void* arg)
+{
+    (void)arg;
+    return false;
+}
+
+static bool notify_counted(const void* arg)
+{
+    return ((const struct virtual_task*)arg)->notify_value > 0;
+}
+
+static bool notify_pending(const void* arg)
+{
+    return ((const struct virtual_task*)arg)->notify_pending;
+}
+
+static bool queue_has_item(const void* arg)
+{
+    return ((const struct virtual_queue*)arg)->count > 0;
+}
+
+static bool queue_has_space(const void* arg)
+{
+    const struct virtual_queue* queue = arg;
+    return queue->count < queue->length;
+}
+
+/* Sleep until the wall clock catches up with virtual time at the requested speed */
+static void pace_to(const int64_t virtual_us)
+{
+    if (vclock.speed <= 0.0)
+    {
+        return;
+    }
+
+    const double wall_s = timespec_seconds(&vclock.wall_start) + (double)virtual_us / 1e6 / vclock.speed;
+    struct timespec target = {
+        .tv_sec = (time_t)wall_s,
+        .tv_nsec = (long)((wall_s - (double)(time_t)wall_s) * 1e9),
+    };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &target, NULL) != 0)
+    {
+    }
+}
+
+static void* task_trampoline(void* arg)
+{
+    current_task = arg;
+    current_task->function(current_task->arg);
+
+    /* A FreeRTOS task must not return; treat it as vTaskDelete(NULL) */
+    vTaskDelete(NULL);
+    return NULL;
+}
+
+/* =========================================================================
+ *  Simulator API
+ * ========================================================================= */
+void virtual_clock_init(const double speed)
+{
+    pthread_mutex_lock(&vclock.lock);
+    vclock.now_us = 0;
+    vclock.speed = speed;
+    clock_gettime(CLOCK_MONOTONIC, &vclock.wall_start);
+    pthread_mutex_unlock(&vclock.lock);
+}
+
+void virtual_clock_advance_to(const int64_t until_us)
+{
+    pthread_mutex_lock(&vclock.lock);
+    wait_quiescent();
+
+    while (vclock.now_us < until_us)
+    {
+        int64_t next_us = until_us;
+        for (int i = 0; i < MAX_VIRTUAL_TIMERS; i++)
+        {
+            const struct virtual_timer* timer = &vclock.timers[i];
+            if (timer->used && timer->active && timer->expires_us < next_us)
+            {
+                next_us = timer->expires_us;
+            }
+        }
+        for (int i = 0; i < MAX_VIRTUAL_TASKS; i++)
+        {
+            const struct virtual_task* task = &vclock.tasks[i];
+            if (task->used && !task->deleted && task->blocked && task->wake_at_us < next_us)
+            {
+                next_us = task->wake_at_us;
+            }
+        }
+
+        pthread_mutex_unlock(&vclock.lock);
+        pace_to(next_us);
+        pthread_mutex_lock(&vclock.lock);
+        vclock.now_us = next_us;
+
+        for (int i = 0; i < MAX_VIRTUAL_TASKS; i++)
+        {
+            struct virtual_task* task = &vclock.tasks[i];
+            if (task->used && !task->deleted && task->blocked && task->wake_at_us <= next_us)
+            {
+                pthread_cond_signal(&task->wake);
+            }
+        }
+
+        struct virtual_timer* due[MAX_VIRTUAL_TIMERS];
+        int due_count = 0;
+        for (int i = 0; i < MAX_VIRTUAL_TIMERS; i++)
+        {
+            struct virtual_timer* timer = &vclock.timers[i];
+            if (timer->used && timer->active && timer->expires_us <= next_us)
+            {
+                due[due_count++] = timer;
+                if (timer->period_us > 0)
+                {
+                    timer->expires_us += timer->period_us;
+                }
+                else
+                {
+                    timer->active = false;
+                }
+            }
+        }
+
+        pthread_mutex_unlock(&vclock.lock);
+        for (int i = 0; i < due_count; i++)
+        {
+            due[i]->callback(due[i]->arg);
+        }
+        pthread_mutex_lock(&vclock.lock);
+
+        wait_quiescent();
+    }
+
+    pthread_mutex_unlock(&vclock.lock);
+}
+
+int64_t virtual_clock_now_us(void)
+{
+    pthread_mutex_lock(&vclock.lock);
+    const int64_t now_us = vclock.now_us;
+    pthread_mutex_unlock(&vclock.lock);
+    return now_us;
+}
+
+int virtual_clock_live_tasks(void)
+{
+    int live = 0;
+
+    pthread_mutex_lock(&vclock.lock);
+    for (int i = 0; i < MAX_VIRTUAL_TASKS; i++)
+    {
+        live += vclock.tasks[i].used && !vclock.tasks[i].deleted;
+    }
+    pthread_mutex_unlock(&vclock.lock);
+    return live;
+}
+
+double virtual_clock_wall_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return timespec_seconds(&now) - timespec_seconds(&vclock.wall_start);
+}
+
+void virtual_clock_enter_critical(void)
+{
+    pthread_mutex_lock(&critical_lock);
+}
+
+void virtual_clock_exit_critical(void)
+{
+    pthread_mutex_unlock(&critical_lock);
+}
+
+/* =========================================================================
+ *  FreeRTOS task API
+ * ========================================================================= */
+BaseType_t xTaskCreate(const TaskFunction_t function, const char* name, const uint32_t stack_size, void* arg,
+                       const UBaseType_t priority, TaskHandle_t* handle)
+{
+    (void)stack_size;
+    (void)priority;
+
+    pthread_mutex_lock(&vclock.lock);
+    struct virtual_task* task = NULL;
+    for (int i = 0; i < MAX_VIRTUAL_TASKS && task == NULL; i++)
+    {
+        if (!vclock.tasks[i].used || vclock.tasks[i].deleted)
+        {
+            task = &vclock.tasks[i];
+        }
+    }
+    if (task == NULL)
+    {
+        pthread_mutex_unlock(&vclock.lock);
+        return pdFAIL;
+    }
+
+    memset(task, 0, sizeof(*task));
+    task->used = true;
+    task->function = function;
+    task->arg = arg;
+    task->wake_at_us = WAIT_FOREVER_US;
+    snprintf(task->name, sizeof(task->name), "%s", name);
+    pthread_cond_init(&task->wake, NULL);
+    if (handle != NULL)
+    {
+        *handle = task;
+    }
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, task_trampoline, task) != 0)
+    {
+        task->used = false;
+        pthread_mutex_unlock(&vclock.lock);
+        return pdFAIL;
+    }
+    pthread_detach(thread);
+
+    /* The new task runs up to its first block before the creator continues */
+    if (current_task == NULL)
+    {
+        wait_quiescent();
+    }
+    pthread_mutex_unlock(&vclock.lock);
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task != NULL && task != current_task)
+    {
+        fprintf(stderr, "virtual_clock: deleting another task is not supported\n");
+        abort();
+    }
+
+    pthread_mutex_lock(&vclock.lock);
+    current_task->deleted = true;
+    pthread_cond_broadcast(&vclock.quiescent);
+    pthread_mutex_unlock(&vclock.lock);
+    pthread_exit(NULL);
+}
+
+uint32_t ulTaskNotifyTake(const BaseType_t clear_on_exit, const TickType_t ticks_to_wait)
+{
+    struct virtual_task* task = current_task;
+
+    pthread_mutex_lock(&vclock.lock);
+    block_until(notify_counted, task, ticks_to_wait);
+    const uint32_t count = task->notify_value;
+    if (count > 0)
+    {
+        task->notify_value = clear_on_exit ? 0 : count - 1;
+    }
+    task->notify_pending = false;
+    pthread_mutex_unlock(&vclock.lock);
+    return count;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    pthread_mutex_lock(&vclock.lock);
+    task->notify_value++;
+    task->notify_pending = true;
+    wake_blocked();
+    pthread_mutex_unlock(&vclock.lock);
+    return pdPASS;
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, const uint32_t value, const eNotifyAction action)
+{
+    pthread_mutex_lock(&vclock.lock);
+    switch (action)
+    {
+    case eSetBits:
+        task->notify_value |= value;
+        break;
+    case eIncrement:
+        task->notify_value++;
+        break;
+    case eSetValueWithOverwrite:
+        task->notify_value = value;
+        break;
+    default:
+        break;
+    }
+    task->notify_pending = true;
+    wake_blocked();
+    pthread_mutex_unlock(&vclock.lock);
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyWait(const uint32_t clear_on_entry, const uint32_t clear_on_exit, uint32_t* value,
+                           const TickType_t ticks_to_wait)
+{
+    struct virtual_task* task = current_task;
+
+    pthread_mutex_lock(&vclock.lock);
+    if (!task->notify_pending)
+    {
+        task->notify_value &= ~clear_on_entry;
+    }
+    const bool notified = block_until(notify_pending, task, ticks_to_wait);
+    if (value != NULL)
+    {
+        *value = task->notify_value;
+    }
+    if (notified)
+    {
+        task->notify_value &= ~clear_on_exit;
+    }
+    task->notify_pending = false;
+    pthread_mutex_unlock(&vclock.lock);
+    return notified ? pdTRUE : pdFALSE;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return current_task;
+}
+
+void vTaskDelay(const TickType_t ticks)
+{
+    pthread_mutex_lock(&vclock.lock);
+    block_until(never_ready, NULL, ticks);
+    pthread_mutex_unlock(&vclock.lock);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(virtual_clock_now_us() / (portTICK_PERIOD_MS * 1000));
+}
+
+/* =========================================================================
+ *  FreeRTOS queue API (semaphores are zero-size queues, see semphr.h)
+ * ========================================================================= */
+QueueHandle_t xQueueCreate(const UBaseType_t length, const UBaseType_t item_size)
+{
+    struct virtual_queue* queue = calloc(1, sizeof(*queue));
+    if (queue == NULL)
+    {
+        return NULL;
+    }
+    queue->storage = calloc(length, item_size > 0 ? item_size : 1);
+    if (queue->storage == NULL)
+    {
+        free(queue);
+        return NULL;
+    }
+    queue->item_size = item_size;
+    queue->length = length;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    if (queue != NULL)
+    {
+        free(queue->storage);
+        free(queue);
+    }
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue)
+{
+    pthread_mutex_lock(&vclock.lock);
+    queue->count = 0;
+    queue->head = 0;
+    wake_blocked();
+    pthread_mutex_unlock(&vclock.lock);
+    return pdPASS;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, const TickType_t ticks_to_wait)
+{
+    pthread_mutex_lock(&vclock.lock);
+    const bool space = block_until(queue_has_space, queue, ticks_to_wait);
+    if (space)
+    {
+        const UBaseType_t tail = (queue->head + queue->count) % queue->length;
+        if (queue->item_size > 0)
+        {
+            memcpy(queue->storage + tail * queue->item_size, item, queue->item_size);
+        }
+        queue->count++;
+        wake_blocked();
+    }
+    pthread_mutex_unlock(&vclock.lock);
+    return space ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, const TickType_t ticks_to_wait)
+{
+    pthread_mutex_lock(&vclock.lock);
+    const bool available = block_until(queue_has_item, queue, ticks_to_wait);
+    if (available)
+    {
+        if (queue->item_size > 0 && item != NULL)
+        {
+            memcpy(item, queue->storage + queue->head * queue->item_size, queue->item_size);
+        }
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+        wake_blocked();
+    }
+    pthread_mutex_unlock(&vclock.lock);
+    return available ? pdTRUE : pdFALSE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    pthread_mutex_lock(&vclock.lock);
+    const UBaseType_t count = queue->count;
+    pthread_mutex_unlock(&vclock.lock);
+    return count;
+}
+
+QueueHandle_t xQueueCreateStatic(const UBaseType_t length, const UBaseType_t item_size, uint8_t* storage,
+                                 StaticQueue_t* buffer)
+{
+    _Static_assert(sizeof(struct virtual_queue) <= sizeof(StaticQueue_t), "StaticQueue_t too small");
+    if (buffer == NULL || (item_size > 0 && storage == NULL))
+    {
+        return NULL;
+    }
+
+    struct virtual_queue* queue = (struct virtual_queue*)buffer;
+    *queue = (struct virtual_queue){
+        .storage = storage,
+        .item_size = item_size,
+        .length = length,
+    };
+    return queue;
+}
+
+QueueHandle_t xQueueCreateMutex(void)
+{
+    QueueHandle_t mutex = xQueueCreate(1, 0);
+    if (mutex != NULL)
+    {
+        mutex->count = 1;
+    }
+    return mutex;
+}
+
+/* =========================================================================
+ *  esp_timer API
+ * ========================================================================= */
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out_handle)
+{
+    if (args == NULL || args->callback == NULL || out_handle == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&vclock.lock);
+    for (int i = 0; i < MAX_VIRTUAL_TIMERS; i++)
+    {
+        struct virtual_timer* timer = &vclock.timers[i];
+        if (!timer->used)
+        {
+            *timer = (struct virtual_timer){
+                .used = true,
+                .callback = args->callback,
+                .arg = args->arg,
+            };
+            *out_handle = timer;
+            pthread_mutex_unlock(&vclock.lock);
+            return ESP_OK;
+        }
+    }
+    pthread_mutex_unlock(&vclock.lock);
+    return ESP_ERR_NO_MEM;
+}
+
+static esp_err_t start_timer(esp_timer_handle_t timer, const uint64_t timeout_us, const bool periodic)
+{
+    if (timer == NULL || timeout_us == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&vclock.lock);
+    const esp_err_t err = timer->active ? ESP_ERR_INVALID_STATE : ESP_OK;
+    if (err == ESP_OK)
+    {
+        timer->active = true;
+        timer->period_us = periodic ? (int64_t)timeout_us : 0;
+        timer->expires_us = vclock.now_us + (int64_t)timeout_us;
+    }
+    pthread_mutex_unlock(&vclock.lock);
+    return err;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, const uint64_t period_us)
+{
+    return start_timer(timer, period_us, true);
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, const uint64_t timeout_us)
+{
+    return start_timer(timer, timeout_us, false);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    if (timer == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&vclock.lock);
+    const esp_err_t err = timer->active ? ESP_OK : ESP_ERR_INVALID_STATE;
+    timer->active = false;
+    pthread_mutex_unlock(&vclock.lock);
+    return err;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    if (timer == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&vclock.lock);
+    const esp_err_t err = timer->active ? ESP_ERR_INVALID_STATE : ESP_OK;
+    if (err == ESP_OK)
+    {
+        timer->used = false;
+    }
+    pthread_mutex_unlock(&vclock.lock);
+    return err;
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return virtual_clock_now_us();
+}
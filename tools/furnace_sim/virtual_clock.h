@@ -0,0 +1,29 @@
+/**
+ * @file virtual_clock.h
+ * @brief Simulated time source behind the host esp_timer and FreeRTOS task API.
+ *
+ * Firmware tasks run on real threads but in lockstep with the simulator:
+ * virtual time only moves while every task is blocked in ulTaskNotifyTake()
+ * or has deleted itself, and it jumps straight to the next timer expiry or
+ * notification timeout.  Task code therefore takes no virtual time, and a
+ * run is deterministic whatever the host load.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* speed: virtual seconds per wall second, 0 runs as fast as possible */
+void virtual_clock_init(double speed);
+
+/* Run timers and tasks until virtual time reaches until_us */
+void virtual_clock_advance_to(int64_t until_us);
+
+int64_t virtual_clock_now_us(void);
+
+/* Tasks created and not yet deleted */
+int virtual_clock_live_tasks(void);
+
+/* Wall time since virtual_clock_init() */
+double virtual_clock_wall_seconds(void);
@@ -0,0 +1,406 @@
+/**
+ * @file modbus_rtu_bench.c
+ * @brief Host benchmark for the native Modbus RTU engine (modbus_rtu.c).
+ *
+ * Drives components/modbus_master/src/modbus_rtu.c over a termios serial
+ * port (a USB/RS485 adapter or the PTY of tools/ms9024_sim) and reports
+ * round-trip latency, throughput and where the time of a transaction goes
+ * (t3.5 wait, request on the wire, slave turnaround, response on the wire).
+ * A CRC micro-benchmark compares the table-driven CRC with the bitwise loop
+ * the engine used to need.
+ *
+ *   modbus_rtu_bench [options] PORT
+ *     -b, --baud B          Baud rate (default 9600)
+ *     -a, --address A       Slave address (default 1)
+ *     -f, --function F      3 or 4 (default 3)
+ *     -r, --register R      First register (default 728, MS9024 PV)
+ *     -c, --count N         Registers per request (default 2)
+ *     -n, --iterations N    Transactions to run (default 200)
+ *     -t, --timeout MS      Response timeout (default 200)
+ *     -C, --crc-only        Run only the CRC micro-benchmark
+ *
+ * Example against the simulator:
+ *   ms9024_sim -l /tmp/ms9024 -L 2 &
+ *   modbus_rtu_bench -n 500 /tmp/ms9024
+ *
+ * Build: cmake -S tools/modbus_rtu_bench -B build/modbus_rtu_bench && cmake --build build/modbus_rtu_bench
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "modbus_rtu.h"
+
+#define CRC_BENCH_FRAME_LEN 256
+#define CRC_BENCH_ROUNDS    200000
+
+/* ── termios transport ────────────────────────────────────────────────── */
+typedef struct
+{
+    int fd;
+} serial_ctx_t;
+
+static int64_t host_now_us(void* ctx)
+{
+    (void)ctx;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void host_delay_us(void* ctx, const uint32_t us)
+{
+    (void)ctx;
+    const struct timespec ts = {.tv_sec = us / 1000000U, .tv_nsec = (long)(us % 1000000U) * 1000};
+    nanosleep(&ts, NULL);
+}
+
+static int serial_write(void* ctx, const uint8_t* data, const size_t len)
+{
+    const serial_ctx_t* serial = ctx;
+    size_t done = 0;
+    while (done < len)
+    {
+        const ssize_t n = write(serial->fd, data + done, len - done);
+        if (n < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+            {
+                continue;
+            }
+            return -1;
+        }
+        done += (size_t)n;
+    }
+    tcdrain(serial->fd);
+    return (int)done;
+}
+
+static int serial_read(void* ctx, uint8_t* data, const size_t len, const uint32_t timeout_us)
+{
+    const serial_ctx_t* serial = ctx;
+    struct pollfd pfd = {.fd = serial->fd, .events = POLLIN};
+    const int timeout_ms = (int)((timeout_us + 999U) / 1000U);
+
+    const int ready = poll(&pfd, 1, timeout_ms > 0 ? timeout_ms : 1);
+    if (ready < 0)
+    {
+        return errno == EINTR ? 0 : -1;
+    }
+    if (ready == 0)
+    {
+        return 0;
+    }
+
+    const ssize_t n = read(serial->fd, data, len);
+    if (n < 0)
+    {
+        return errno == EAGAIN || errno == EINTR ? 0 : -1;
+    }
+    return (int)n;
+}
+
+static void serial_flush_input(void* ctx)
+{
+    const serial_ctx_t* serial = ctx;
+    tcflush(serial->fd, TCIFLUSH);
+}
+
+static speed_t baud_to_speed(const uint32_t baud)
+{
+    switch (baud)
+    {
+    case 1200: return B1200;
+    case 2400: return B2400;
+    case 4800: return B4800;
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    default: return 0;
+    }
+}
+
+static int serial_open(const char* path, const uint32_t baud)
+{
+    const speed_t speed = baud_to_speed(baud);
+    if (speed == 0)
+    {
+        fprintf(stderr, "unsupported baud rate %u\n", baud);
+        return -1;
+    }
+
+    const int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0)
+    {
+        perror(path);
+        return -1;
+    }
+
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0)
+    {
+        perror("tcgetattr");
+        close(fd);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSTOPB | PARENB);
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    if (tcsetattr(fd, TCSANOW, &tio) != 0)
+    {
+        perror("tcsetattr");
+        close(fd);
+        return -1;
+    }
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+/* ── CRC micro-benchmark ──────────────────────────────────────────────── */
+static uint16_t crc16_bitwise(const uint8_t* data, const size_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 1U) ? (uint16_t)((crc >> 1) ^ 0xA001U) : (uint16_t)(crc >> 1);
+        }
+    }
+    return crc;
+}
+
+static int run_crc_bench(void)
+{
+    uint8_t frame[CRC_BENCH_FRAME_LEN];
+    for (size_t i = 0; i < sizeof(frame); i++)
+    {
+        frame[i] = (uint8_t)(i * 37U + 11U);
+    }
+
+    for (size_t len = 0; len <= sizeof(frame); len++)
+    {
+        if (modbus_rtu_crc16(frame, len) != crc16_bitwise(frame, len))
+        {
+            fprintf(stderr, "CRC mismatch at length %zu\n", len);
+            return 1;
+        }
+    }
+
+    volatile uint16_t sink = 0;
+    int64_t start = host_now_us(NULL);
+    for (int i = 0; i < CRC_BENCH_ROUNDS; i++)
+    {
+        sink ^= crc16_bitwise(frame, sizeof(frame));
+    }
+    const double bitwise_ns = (double)(host_now_us(NULL) - start) * 1000.0 / CRC_BENCH_ROUNDS / sizeof(frame);
+
+    start = host_now_us(NULL);
+    for (int i = 0; i < CRC_BENCH_ROUNDS; i++)
+    {
+        sink ^= modbus_rtu_crc16(frame, sizeof(frame));
+    }
+    const double table_ns = (double)(host_now_us(NULL) - start) * 1000.0 / CRC_BENCH_ROUNDS / sizeof(frame);
+    (void)sink;
+
+    printf("CRC-16/MODBUS: bitwise %.2f ns/byte, table %.2f ns/byte (%.1fx)\n",
+           bitwise_ns, table_ns, table_ns > 0 ? bitwise_ns / table_ns : 0.0);
+    return 0;
+}
+
+/* ── Round-trip benchmark ─────────────────────────────────────────────── */
+static int compare_u32(const void* a, const void* b)
+{
+    const uint32_t x = *(const uint32_t*)a;
+    const uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t percentile(const uint32_t* sorted, const size_t count, const unsigned pct)
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    const size_t index = (count - 1) * pct / 100;
+    return sorted[index];
+}
+
+static void usage(const char* argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-b baud] [-a address] [-f 3|4] [-r register] [-c count] [-n iterations]\n"
+            "          [-t timeout_ms] [-C] PORT\n",
+            argv0);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t baud = 9600;
+    uint8_t address = 1;
+    uint8_t function = 0x03;
+    uint16_t reg_start = 728;
+    uint16_t reg_count = 2;
+    unsigned iterations = 200;
+    uint32_t timeout_ms = 200;
+    bool crc_only = false;
+
+    static const struct option options[] = {
+        {"baud", required_argument, NULL, 'b'},
+        {"address", required_argument, NULL, 'a'},
+        {"function", required_argument, NULL, 'f'},
+        {"register", required_argument, NULL, 'r'},
+        {"count", required_argument, NULL, 'c'},
+        {"iterations", required_argument, NULL, 'n'},
+        {"timeout", required_argument, NULL, 't'},
+        {"crc-only", no_argument, NULL, 'C'},
+        {NULL, 0, NULL, 0},
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "b:a:f:r:c:n:t:C", options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'b': baud = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'a': address = (uint8_t)strtoul(optarg, NULL, 0); break;
+        case 'f': function = (uint8_t)strtoul(optarg, NULL, 0); break;
+        case 'r': reg_start = (uint16_t)strtoul(optarg, NULL, 0); break;
+        case 'c': reg_count = (uint16_t)strtoul(optarg, NULL, 0); break;
+        case 'n': iterations = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 't': timeout_ms = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'C': crc_only = true; break;
+        default: usage(argv[0]); return 2;
+        }
+    }
+
+    if (run_crc_bench() != 0)
+    {
+        return 1;
+    }
+    if (crc_only)
+    {
+        return 0;
+    }
+
+    if (optind >= argc || (function != 0x03 && function != 0x04) || reg_count == 0 ||
+        reg_count > MODBUS_RTU_MAX_READ_REGS || iterations == 0)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    serial_ctx_t serial = {.fd = serial_open(argv[optind], baud)};
+    if (serial.fd < 0)
+    {
+        return 1;
+    }
+
+    const modbus_rtu_transport_t transport = {
+        .ctx = &serial,
+        .write = serial_write,
+        .read = serial_read,
+        .flush_input = serial_flush_input,
+        .now_us = host_now_us,
+        .delay_us = host_delay_us,
+    };
+    modbus_rtu_master_t master;
+    modbus_rtu_init(&master, &transport, baud);
+
+    const modbus_rtu_request_t request = {
+        .slave_addr = address,
+        .function = function,
+        .reg_start = reg_start,
+        .reg_count = reg_count,
+    };
+
+    uint32_t* rtt = calloc(iterations, sizeof(uint32_t));
+    if (rtt == NULL)
+    {
+        close(serial.fd);
+        return 1;
+    }
+
+    unsigned errors[MODBUS_RTU_ERR_EXCEPTION + 1] = {0};
+    uint64_t gap_sum = 0, tx_sum = 0, response_sum = 0, rx_sum = 0;
+    size_t ok = 0;
+    uint16_t values[MODBUS_RTU_MAX_READ_REGS];
+
+    const int64_t bench_start = host_now_us(NULL);
+    for (unsigned i = 0; i < iterations; i++)
+    {
+        uint8_t exception = 0;
+        const int64_t start = host_now_us(NULL);
+        const modbus_rtu_err_t err = modbus_rtu_transact(&master, &request, values, timeout_ms * 1000U, &exception);
+        const uint32_t elapsed = (uint32_t)(host_now_us(NULL) - start);
+
+        errors[err]++;
+        if (err != MODBUS_RTU_OK)
+        {
+            continue;
+        }
+        rtt[ok++] = elapsed;
+        gap_sum += master.last_timing.gap_wait_us;
+        tx_sum += master.last_timing.tx_us;
+        response_sum += master.last_timing.response_us;
+        rx_sum += master.last_timing.rx_us;
+    }
+    const double bench_sec = (double)(host_now_us(NULL) - bench_start) / 1e6;
+
+    printf("slave %u fc 0x%02X reg %u x%u @ %u baud (t3.5 %u us): %u transactions in %.2f s\n",
+           address, function, reg_start, reg_count, baud, master.t35_us, iterations, bench_sec);
+    printf("  ok %zu", ok);
+    for (int e = MODBUS_RTU_ERR_ARG; e <= MODBUS_RTU_ERR_EXCEPTION; e++)
+    {
+        if (errors[e] > 0)
+        {
+            printf(", %s %u", modbus_rtu_err_to_name((modbus_rtu_err_t)e), errors[e]);
+        }
+    }
+    printf("\n");
+
+    if (ok > 0)
+    {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < ok; i++)
+        {
+            sum += rtt[i];
+        }
+        qsort(rtt, ok, sizeof(uint32_t), compare_u32);
+
+        printf("  RTT us: min %u avg %llu p50 %u p99 %u max %u\n",
+               rtt[0], (unsigned long long)(sum / ok), percentile(rtt, ok, 50), percentile(rtt, ok, 99), rtt[ok - 1]);
+        printf("  throughput: %.1f transactions/s\n", (double)ok / bench_sec);
+        printf("  avg split us: gap %llu, tx %llu, turnaround %llu, rx %llu\n",
+               (unsigned long long)(gap_sum / ok), (unsigned long long)(tx_sum / ok),
+               (unsigned long long)(response_sum / ok), (unsigned long long)(rx_sum / ok));
+        printf("  last values:");
+        for (uint16_t i = 0; i < reg_count && i < 8; i++)
+        {
+            printf(" %04X", values[i]);
+        }
+        printf("\n");
+    }
+
+    free(rtt);
+    close(serial.fd);
+    return ok == iterations ? 0 : 1;
+}
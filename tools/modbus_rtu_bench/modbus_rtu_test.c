@@ -0,0 +1,697 @@
+/**
+ * @file modbus_rtu_test.c
+ * @brief Deterministic host tests for the native Modbus RTU engine (modbus_rtu.c).
+ *
+ * Covers the CRC table against the bitwise definition and known vectors,
+ * FC 0x03 / 0x06 / 0x10 encoding and response decoding, exception frames,
+ * short frames and bad CRCs, and modbus_rtu_transact() against a scripted
+ * transport on a virtual clock: response timeout, truncated and split
+ * responses, stale input and the t3.5 gap between frames.
+ *
+ *   modbus_rtu_test        Exit status 0 when every check passes
+ *
+ * Build: cmake -S tools/modbus_rtu_bench -B build/modbus_rtu_bench && cmake --build build/modbus_rtu_bench
+ * Run:   ctest --test-dir build/modbus_rtu_bench --output-on-failure
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "modbus_rtu.h"
+
+static int checks;
+static int failures;
+
+#define CHECK(cond)                                                              \
+    do                                                                           \
+    {                                                                            \
+        checks++;                                                                \
+        if (!(cond))                                                             \
+        {                                                                        \
+            failures++;                                                          \
+            fprintf(stderr, "%s:%d: %s: check failed: %s\n", __FILE__, __LINE__, \
+                    __func__, #cond);                                            \
+        }                                                                        \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                       \
+    do                                                                                   \
+    {                                                                                    \
+        checks++;                                                                        \
+        const long long a_ = (long long)(actual), e_ = (long long)(expected);            \
+        if (a_ != e_)                                                                    \
+        {                                                                                \
+            failures++;                                                                  \
+            fprintf(stderr, "%s:%d: %s: %s == %lld, expected %lld\n", __FILE__, __LINE__, \
+                    __func__, #actual, a_, e_);                                          \
+        }                                                                                \
+    } while (0)
+
+#define CHECK_ERR(actual, expected)                                                   \
+    do                                                                                \
+    {                                                                                 \
+        checks++;                                                                     \
+        const modbus_rtu_err_t a_ = (actual), e_ = (expected);                        \
+        if (a_ != e_)                                                                 \
+        {                                                                             \
+            failures++;                                                               \
+            fprintf(stderr, "%s:%d: %s: %s returned %s, expected %s\n", __FILE__,     \
+                    __LINE__, __func__, #actual, modbus_rtu_err_to_name(a_),          \
+                    modbus_rtu_err_to_name(e_));                                      \
+        }                                                                             \
+    } while (0)
+
+#define ARRAY_LEN(a) (sizeof(a) / sizeof((a)[0]))
+
+/* ── Helpers ──────────────────────────────────────────────────────────── */
+static uint16_t crc16_bitwise(const uint8_t* data, const size_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 1U) ? (uint16_t)((crc >> 1) ^ 0xA001) : (uint16_t)(crc >> 1);
+        }
+    }
+    return crc;
+}
+
+/** Copy @p pdu into @p frame and append its CRC, low byte first. */
+static size_t with_crc(uint8_t* frame, const uint8_t* pdu, const size_t len)
+{
+    memcpy(frame, pdu, len);
+    const uint16_t crc = crc16_bitwise(pdu, len);
+    frame[len] = (uint8_t)(crc & 0xFF);
+    frame[len + 1] = (uint8_t)(crc >> 8);
+    return len + 2;
+}
+
+/* ── Scripted transport on a virtual clock ────────────────────────────── */
+#define MOCK_MAX_CHUNKS  8
+#define MOCK_CHAR_US     1146  /* 11 bits at 9600 baud */
+
+typedef struct
+{
+    uint8_t data[MODBUS_RTU_MAX_FRAME];
+    size_t len;
+    size_t pos;
+    int64_t arrival_us;  // Absolute time the first byte of this chunk is readable
+} mock_chunk_t;
+
+typedef struct
+{
+    int64_t now_us;
+
+    /* Response played back after the next write: chunks with a delay from the end of the request */
+    mock_chunk_t reply[MOCK_MAX_CHUNKS];
+    uint32_t reply_delay_us[MOCK_MAX_CHUNKS];
+    size_t reply_count;
+
+    /* Bytes already on the line before the request (a late answer, noise) */
+    mock_chunk_t pending[MOCK_MAX_CHUNKS];
+    size_t pending_count;
+
+    uint8_t written[MODBUS_RTU_MAX_FRAME];
+    size_t written_len;
+    int64_t write_start_us;
+    int writes;
+    int flushes;
+    bool fail_write;
+} mock_ctx_t;
+
+static int64_t mock_now_us(void* ctx)
+{
+    return ((mock_ctx_t*)ctx)->now_us;
+}
+
+static void mock_delay_us(void* ctx, const uint32_t us)
+{
+    ((mock_ctx_t*)ctx)->now_us += us;
+}
+
+static int mock_write(void* ctx, const uint8_t* data, const size_t len)
+{
+    mock_ctx_t* mock = ctx;
+    if (mock->fail_write)
+    {
+        return -1;
+    }
+    memcpy(mock->written, data, len);
+    mock->written_len = len;
+    mock->write_start_us = mock->now_us;
+    mock->writes++;
+    mock->now_us += (int64_t)len * MOCK_CHAR_US;  // Returns once the last bit is on the wire
+
+    for (size_t i = 0; i < mock->reply_count && mock->pending_count < MOCK_MAX_CHUNKS; i++)
+    {
+        mock_chunk_t* chunk = &mock->pending[mock->pending_count++];
+        *chunk = mock->reply[i];
+        chunk->pos = 0;
+        chunk->arrival_us = mock->now_us + mock->reply_delay_us[i];
+    }
+    mock->reply_count = 0;
+    return (int)len;
+}
+
+static int mock_read(void* ctx, uint8_t* data, const size_t len, const uint32_t timeout_us)
+{
+    mock_ctx_t* mock = ctx;
+    while (mock->pending_count > 0 && mock->pending[0].pos == mock->pending[0].len)
+    {
+        memmove(&mock->pending[0], &mock->pending[1], (mock->pending_count - 1) * sizeof(mock->pending[0]));
+        mock->pending_count--;
+    }
+    if (mock->pending_count == 0 || mock->pending[0].arrival_us > mock->now_us + timeout_us)
+    {
+        mock->now_us += timeout_us;
+        return 0;
+    }
+
+    mock_chunk_t* chunk = &mock->pending[0];
+    if (chunk->arrival_us > mock->now_us)
+    {
+        mock->now_us = chunk->arrival_us;
+    }
+    size_t n = chunk->len - chunk->pos;
+    n = n < len ? n : len;
+    memcpy(data, chunk->data + chunk->pos, n);
+    chunk->pos += n;
+    mock->now_us += (int64_t)n * MOCK_CHAR_US;
+    return (int)n;
+}
+
+static void mock_flush_input(void* ctx)
+{
+    mock_ctx_t* mock = ctx;
+    mock->flushes++;
+    /* Only what has already arrived can be discarded */
+    size_t kept = 0;
+    for (size_t i = 0; i < mock->pending_count; i++)
+    {
+        if (mock->pending[i].arrival_us > mock->now_us)
+        {
+            mock->pending[kept++] = mock->pending[i];
+        }
+    }
+    mock->pending_count = kept;
+}
+
+static void mock_reply(mock_ctx_t* mock, const uint8_t* frame, const size_t len, const uint32_t delay_us)
+{
+    mock_chunk_t* chunk = &mock->reply[mock->reply_count];
+    memcpy(chunk->data, frame, len);
+    chunk->len = len;
+    mock->reply_delay_us[mock->reply_count] = delay_us;
+    mock->reply_count++;
+}
+
+static void mock_setup(mock_ctx_t* mock, modbus_rtu_transport_t* transport, modbus_rtu_master_t* master)
+{
+    memset(mock, 0, sizeof(*mock));
+    mock->now_us = 1000000;
+    *transport = (modbus_rtu_transport_t){
+        .ctx = mock,
+        .write = mock_write,
+        .read = mock_read,
+        .flush_input = mock_flush_input,
+        .now_us = mock_now_us,
+        .delay_us = mock_delay_us,
+    };
+    modbus_rtu_init(master, transport, 9600);
+    mock->now_us += 100000;  // Line idle well past t3.5
+}
+
+/* ── CRC ──────────────────────────────────────────────────────────────── */
+static void test_crc_vectors(void)
+{
+    static const uint8_t check[] = "123456789";
+    static const uint8_t read_req[] = {0x01, 0x03, 0x00, 0x00, 0x00, 0x0A};
+    static const uint8_t write_req[] = {0x01, 0x06, 0x00, 0x01, 0x00, 0x03};
+    static const uint8_t write_multi_req[] = {0x11, 0x10, 0x00, 0x01, 0x00, 0x02, 0x04, 0x00, 0x0A, 0x01, 0x02};
+
+    CHECK_EQ(modbus_rtu_crc16(check, 9), 0x4B37);  // CRC-16/MODBUS catalogue check value
+    CHECK_EQ(modbus_rtu_crc16(read_req, sizeof(read_req)), 0xCDC5);
+    CHECK_EQ(modbus_rtu_crc16(write_req, sizeof(write_req)), 0x0B98);
+    CHECK_EQ(modbus_rtu_crc16(write_multi_req, sizeof(write_multi_req)), 0xF0C6);
+    CHECK_EQ(modbus_rtu_crc16(check, 0), 0xFFFF);
+
+    /* A frame followed by its own CRC checks to zero */
+    uint8_t frame[16];
+    const size_t len = with_crc(frame, read_req, sizeof(read_req));
+    CHECK_EQ(modbus_rtu_crc16(frame, len), 0x0000);
+}
+
+static void test_crc_table_matches_bitwise(void)
+{
+    uint8_t buf[MODBUS_RTU_MAX_FRAME];
+    uint32_t seed = 0x12345678;
+    for (size_t i = 0; i < sizeof(buf); i++)
+    {
+        seed = seed * 1664525U + 1013904223U;
+        buf[i] = (uint8_t)(seed >> 24);
+    }
+
+    /* Every single-byte input exercises every table entry once */
+    for (int b = 0; b < 256; b++)
+    {
+        const uint8_t byte = (uint8_t)b;
+        CHECK_EQ(modbus_rtu_crc16(&byte, 1), crc16_bitwise(&byte, 1));
+    }
+    for (size_t len = 0; len <= sizeof(buf); len++)
+    {
+        if (modbus_rtu_crc16(buf, len) != crc16_bitwise(buf, len))
+        {
+            CHECK_EQ(modbus_rtu_crc16(buf, len), crc16_bitwise(buf, len));
+            break;
+        }
+    }
+    checks++;
+}
+
+static void test_frame_gap(void)
+{
+    CHECK_EQ(modbus_rtu_frame_gap_us(9600), 4010);
+    CHECK_EQ(modbus_rtu_frame_gap_us(19200), 2005);
+    CHECK_EQ(modbus_rtu_frame_gap_us(38400), 1750);
+    CHECK_EQ(modbus_rtu_frame_gap_us(115200), 1750);
+    CHECK_EQ(modbus_rtu_frame_gap_us(0), 1750);
+}
+
+/* ── Encoding ─────────────────────────────────────────────────────────── */
+static void test_encode_read(void)
+{
+    static const uint8_t expected[] = {0x01, 0x03, 0x00, 0x00, 0x00, 0x0A, 0xC5, 0xCD};
+    const modbus_rtu_request_t request = {.slave_addr = 1, .function = 0x03, .reg_start = 0, .reg_count = 10};
+    uint8_t frame[MODBUS_RTU_MAX_FRAME];
+
+    CHECK_EQ(modbus_rtu_encode_request(&request, frame, sizeof(frame)), sizeof(expected));
+    CHECK(memcmp(frame, expected, sizeof(expected)) == 0);
+    CHECK_EQ(modbus_rtu_expected_response_len(&request), 25);
+
+    modbus_rtu_request_t input = request;
+    input.function = 0x04;
+    CHECK_EQ(modbus_rtu_encode_request(&input, frame, sizeof(frame)), 8);
+    CHECK_EQ(frame[1], 0x04);
+}
+
+static void test_encode_write_single(void)
+{
+    static const uint8_t expected[] = {0x01, 0x06, 0x00, 0x01, 0x00, 0x03, 0x98, 0x0B};
+    const uint16_t value = 3;
+    const modbus_rtu_request_t request = {.slave_addr = 1, .function = 0x06, .reg_start = 1, .reg_count = 1,
+                                          .values = &value};
+    uint8_t frame[MODBUS_RTU_MAX_FRAME];
+
+    CHECK_EQ(modbus_rtu_encode_request(&request, frame, sizeof(frame)), sizeof(expected));
+    CHECK(memcmp(frame, expected, sizeof(expected)) == 0);
+    CHECK_EQ(modbus_rtu_expected_response_len(&request), 8);
+}
+
+static void test_encode_write_multiple(void)
+{
+    static const uint8_t expected[] = {0x11, 0x10, 0x00, 0x01, 0x00, 0x02, 0x04, 0x00, 0x0A, 0x01, 0x02,
+                                       0xC6, 0xF0};
+    const uint16_t values[] = {0x000A, 0x0102};
+    const modbus_rtu_request_t request = {.slave_addr = 0x11, .function = 0x10, .reg_start = 1, .reg_count = 2,
+                                          .values = values};
+    uint8_t frame[MODBUS_RTU_MAX_FRAME];
+
+    CHECK_EQ(modbus_rtu_encode_request(&request, frame, sizeof(frame)), sizeof(expected));
+    CHECK(memcmp(frame, expected, sizeof(expected)) == 0);
+    CHECK_EQ(modbus_rtu_expected_response_len(&request), 8);
+
+    /* The largest write fits one frame exactly */
+    uint16_t many[MODBUS_RTU_MAX_WRITE_REGS] = {0};
+    const modbus_rtu_request_t largest = {.slave_addr = 1, .function = 0x10, .reg_start = 0,
+                                          .reg_count = MODBUS_RTU_MAX_WRITE_REGS, .values = many};
+    CHECK_EQ(modbus_rtu_encode_request(&largest, frame, sizeof(frame)), 9 + 2 * MODBUS_RTU_MAX_WRITE_REGS);
+}
+
+static void test_encode_rejects_invalid(void)
+{
+    uint8_t frame[MODBUS_RTU_MAX_FRAME];
+    uint16_t values[MODBUS_RTU_MAX_WRITE_REGS + 1] = {0};
+    const modbus_rtu_request_t invalid[] = {
+        {.slave_addr = 248, .function = 0x03, .reg_count = 1},
+        {.slave_addr = 1, .function = 0x03, .reg_count = 0},
+        {.slave_addr = 1, .function = 0x03, .reg_count = MODBUS_RTU_MAX_READ_REGS + 1},
+        {.slave_addr = 1, .function = 0x06, .reg_count = 1, .values = NULL},
+        {.slave_addr = 1, .function = 0x10, .reg_count = 0, .values = values},
+        {.slave_addr = 1, .function = 0x10, .reg_count = MODBUS_RTU_MAX_WRITE_REGS + 1, .values = values},
+        {.slave_addr = 1, .function = 0x05, .reg_count = 1, .values = values},
+    };
+    for (size_t i = 0; i < ARRAY_LEN(invalid); i++)
+    {
+        CHECK_EQ(modbus_rtu_encode_request(&invalid[i], frame, sizeof(frame)), 0);
+    }
+    CHECK_EQ(modbus_rtu_encode_request(NULL, frame, sizeof(frame)), 0);
+
+    /* Destination too small for the frame */
+    const modbus_rtu_request_t read = {.slave_addr = 1, .function = 0x03, .reg_count = 1};
+    CHECK_EQ(modbus_rtu_encode_request(&read, frame, 7), 0);
+    const modbus_rtu_request_t write = {.slave_addr = 1, .function = 0x10, .reg_count = 4, .values = values};
+    CHECK_EQ(modbus_rtu_encode_request(&write, frame, 16), 0);
+    CHECK_EQ(modbus_rtu_encode_request(&write, frame, 17), 17);
+}
+
+/* ── Decoding ─────────────────────────────────────────────────────────── */
+static void test_decode_read(void)
+{
+    static const uint8_t pdu[] = {0x01, 0x03, 0x04, 0x00, 0x0A, 0x01, 0x02};
+    const modbus_rtu_request_t request = {.slave_addr = 1, .function = 0x03, .reg_start = 0, .reg_count = 2};
+    uint8_t frame[MODBUS_RTU_MAX_FRAME];
+    uint16_t dest[2] = {0};
+
+    const size_t len = with_crc(frame, pdu, sizeof(pdu));
+    CHECK_EQ(frame[len - 2], 0x5A);
+    CHECK_EQ(frame[len - 1], 0x60);
+    CHECK_ERR(modbus_rtu_decode_response(&request, frame, len, dest, NULL), MODBUS_RTU_OK);
+    CHECK_EQ(dest[0], 0x000A);
+    CHECK_EQ(dest[1], 0x0102);
+    CHECK_ERR(modbus_rtu_decode_response(&request, frame, len, NULL, NULL), MODBUS_RTU_OK);
+
+    /* Byte count disagrees with the request */
+    static const uint8_t wrong_count[] = {0x01, 0x03, 0x02, 0x00, 0x0A, 0x01, 0x02};
+    const size_t wrong_len = with_crc(frame, wrong_count, sizeof(wrong_count));
+    CHECK_ERR(modbus_rtu_decode_response(&request, frame, wrong_len, dest, NULL), MODBUS_RTU_ERR_FRAME);
+
+    /* Another slave or function answered */
+    static const uint8_t wrong_slave[] = {0x02, 0x03, 0x04, 0x00, 0x0A, 0x01, 0x02};
+    CHECK_ERR(modbus_rtu_decode_response(&request, frame, with_crc(frame, wrong_slave, sizeof(wrong_slave)),
+                                         dest, NULL), MODBUS_RTU_ERR_FRAME);
+    static const uint8_t wrong_function[] = {0x01, 0x04, 0x04, 0x00, 0x0A, 0x01, 0x02};
+    CHECK_ERR(modbus_rtu_decode_response(&request, frame, with_crc(frame, wrong_function, sizeof(wrong_function)),
+                                         dest, NULL), MODBUS_RTU_ERR_FRAME);
+}
+
+static void test_decode_writes(void)
+{
+    const uint16_t value = 3;
+    const modbus_rtu_request_t single = {.slave_addr = 1, .function = 0x06, .reg_start = 1, .reg_count = 1,
+                                         .values = &value};
+    static const uint8_t echo[] = {0x01, 0x06, 0x00, 0x01, 0x00, 0x03};
+    static const uint8_t bad_echo[] = {0x01, 0x06, 0x00, 0x01, 0x00, 0x04};
+    uint8_t frame[MODBUS_RTU_MAX_FRAME];
+
+    CHECK_ERR(modbus_rtu_decode_response(&single, frame, with_crc(frame, echo, sizeof(echo)), NULL, NULL),
+              MODBUS_RTU_OK);
+    CHECK_ERR(modbus_rtu_decode_response(&single, frame, with_crc(frame, bad_echo, sizeof(bad_echo)), NULL, NULL),
+              MODBUS_RTU_ERR_FRAME);
+
+    const uint16_t values[] = {0x000A, 0x0102};
+    const modbus_rtu_request_t multi = {.slave_addr = 0x11, .function = 0x10, .reg_start = 1, .reg_count = 2,
+                                        .values = values};
+    static const uint8_t ack[] = {0x11, 0x10, 0x00, 0x01, 0x00, 0x02};
+    static const uint8_t bad_ack[] = {0x11, 0x10, 0x00, 0x01, 0x00, 0x01};
+    const size_t ack_len = with_crc(frame, ack, sizeof(ack));
+    CHECK_EQ(frame[6], 0x12);
+    CHECK_EQ(frame[7], 0x98);
+    CHECK_ERR(modbus_rtu_decode_response(&multi, frame, ack_len, NULL, NULL), MODBUS_RTU_OK);
+    CHECK_ERR(modbus_rtu_decode_response(&multi, frame, with_crc(frame, bad_ack, sizeof(bad_ack)), NULL, NULL),
+              MODBUS_RTU_ERR_FRAME);
+}
+
+static void test_decode_exception(void)
+{
+    const modbus_rtu_request_t request = {.slave_addr = 1, .function = 0x03, .reg_start = 0, .reg_count = 2};
+    static const uint8_t pdu[] = {0x01, 0x83, 0x02};
+    uint8_t frame[MODBUS_RTU_MAX_FRAME];
+    uint8_t exception = 0;
+
+    const size_t len = with_crc(frame, pdu, sizeof(pdu));
+    CHECK_EQ(frame[3], 0xC0);
+    CHECK_EQ(frame[4], 0xF1);
+    CHECK_ERR(modbus_rtu_decode_response(&request, frame, len, NULL, &exception), MODBUS_RTU_ERR_EXCEPTION);
+    CHECK_EQ(exception, 0x02);
+    CHECK_ERR(modbus_rtu_decode_response(&request, frame, len, NULL, NULL), MODBUS_RTU_ERR_EXCEPTION);
+
+    /* Exception bit set on the wrong function, or an exception frame with trailing bytes */
+    static const uint8_t other[] = {0x01, 0x84, 0x02};
+    CHECK_ERR(modbus_rtu_decode_response(&request, frame, with_crc(frame, other, sizeof(other)), NULL, NULL),
+              MODBUS_RTU_ERR_FRAME);
+    static const uint8_t padded[] = {0x01, 0x83, 0x02, 0x00};
+    CHECK_ERR(modbus_rtu_decode_response(&request, frame, with_crc(frame, padded, sizeof(padded)), NULL, NULL),
+              MODBUS_RTU_ERR_FRAME);
+}
+
+static void test_decode_short_and_corrupt(void)
+{
+    const modbus_rtu_request_t request = {.slave_addr = 1, .function = 0x03, .reg_start = 0, .reg_count = 2};
+    static const uint8_t pdu[] = {0x01, 0x03, 0x04, 0x00, 0x0A, 0x01, 0x02};
+    uint8_t frame[MODBUS_RTU_MAX_FRAME];
+    uint16_t dest[2] = {0xBEEF, 0xBEEF};
+
+    const size_t len = with_crc(frame, pdu, sizeof(pdu));
+    for (size_t cut = 0; cut < 5; cut++)
+    {
+        CHECK_ERR(modbus_rtu_decode_response(&request, frame, cut, dest, NULL), MODBUS_RTU_ERR_FRAME);
+    }
+    /* Truncated frames longer than an exception fail their CRC */
+    for (size_t cut = 5; cut < len; cut++)
+    {
+        CHECK(modbus_rtu_decode_response(&request, frame, cut, dest, NULL) != MODBUS_RTU_OK);
+    }
+
+    /* Any single flipped bit is caught by the CRC */
+    for (size_t byte = 0; byte < len; byte++)
+    {
+        for (int bit = 0; bit < 8; bit++)
+        {
+            frame[byte] ^= (uint8_t)(1U << bit);
+            if (modbus_rtu_decode_response(&request, frame, len, dest, NULL) != MODBUS_RTU_ERR_CRC)
+            {
+                CHECK_ERR(modbus_rtu_decode_response(&request, frame, len, dest, NULL), MODBUS_RTU_ERR_CRC);
+            }
+            frame[byte] ^= (uint8_t)(1U << bit);
+        }
+    }
+    checks++;
+    CHECK_EQ(dest[0], 0xBEEF);  // Nothing is copied out of a rejected frame
+}
+
+/* ── Transactions ─────────────────────────────────────────────────────── */
+static const uint8_t read_reply_pdu[] = {0x01, 0x03, 0x04, 0x00, 0x0A, 0x01, 0x02};
+
+static void test_transact_read(void)
+{
+    mock_ctx_t mock;
+    modbus_rtu_transport_t transport;
+    modbus_rtu_master_t master;
+    mock_setup(&mock, &transport, &master);
+
+    uint8_t reply[16];
+    mock_reply(&mock, reply, with_crc(reply, read_reply_pdu, sizeof(read_reply_pdu)), 5000);
+
+    const modbus_rtu_request_t request = {.slave_addr = 1, .function = 0x03, .reg_start = 0, .reg_count = 2};
+    uint16_t dest[2] = {0};
+    CHECK_ERR(modbus_rtu_transact(&master, &request, dest, 100000, NULL), MODBUS_RTU_OK);
+    CHECK_EQ(dest[0], 0x000A);
+    CHECK_EQ(dest[1], 0x0102);
+
+    static const uint8_t expected_tx[] = {0x01, 0x03, 0x00, 0x00, 0x00, 0x02, 0xC4, 0x0B};
+    CHECK_EQ(mock.written_len, sizeof(expected_tx));
+    CHECK(memcmp(mock.written, expected_tx, sizeof(expected_tx)) == 0);
+    CHECK_EQ(mock.flushes, 1);
+
+    CHECK_EQ(master.last_timing.gap_wait_us, 0);
+    CHECK_EQ(master.last_timing.tx_us, 8 * MOCK_CHAR_US);
+    CHECK_EQ(master.last_timing.response_us, 5000 + MOCK_CHAR_US);
+    CHECK_EQ(master.last_activity_us, mock.now_us);
+}
+
+static void test_transact_timeout(void)
+{
+    mock_ctx_t mock;
+    modbus_rtu_transport_t transport;
+    modbus_rtu_master_t master;
+    mock_setup(&mock, &transport, &master);
+
+    const modbus_rtu_request_t request = {.slave_addr = 1, .function = 0x03, .reg_start = 0, .reg_count = 2};
+    uint16_t dest[2] = {0};
+
+    /* Silent slave: exactly the response timeout is spent, no more */
+    int64_t start = mock.now_us;
+    CHECK_ERR(modbus_rtu_transact(&master, &request, dest, 50000, NULL), MODBUS_RTU_ERR_TIMEOUT);
+    CHECK_EQ(mock.now_us - start, 8 * MOCK_CHAR_US + 50000);
+    CHECK_EQ(master.last_timing.response_us, 50000);
+
+    /* An answer arriving after the timeout is a timeout as well */
+    uint8_t reply[16];
+    mock.now_us += 100000;
+    mock_reply(&mock, reply, with_crc(reply, read_reply_pdu, sizeof(read_reply_pdu)), 60000);
+    CHECK_ERR(modbus_rtu_transact(&master, &request, dest, 50000, NULL), MODBUS_RTU_ERR_TIMEOUT);
+
+    /* ...and its bytes are discarded before the next request instead of being taken as its answer */
+    mock.now_us += 100000;
+    CHECK_EQ(mock.pending_count, 1);
+    CHECK_ERR(modbus_rtu_transact(&master, &request, dest, 50000, NULL), MODBUS_RTU_ERR_TIMEOUT);
+    CHECK_EQ(mock.pending_count, 0);
+}
+
+static void test_transact_truncated(void)
+{
+    mock_ctx_t mock;
+    modbus_rtu_transport_t transport;
+    modbus_rtu_master_t master;
+    mock_setup(&mock, &transport, &master);
+
+    const modbus_rtu_request_t request = {.slave_addr = 1, .function = 0x03, .reg_start = 0, .reg_count = 2};
+    uint16_t dest[2] = {0};
+    uint8_t reply[16];
+    const size_t len = with_crc(reply, read_reply_pdu, sizeof(read_reply_pdu));
+
+    /* Fewer bytes than an exception frame, then silence */
+    mock_reply(&mock, reply, 3, 2000);
+    CHECK_ERR(modbus_rtu_transact(&master, &request, dest, 50000, NULL), MODBUS_RTU_ERR_TIMEOUT);
+
+    /* Longer than an exception frame but short of the expected length */
+    mock.now_us += 100000;
+    mock_reply(&mock, reply, len - 2, 2000);
+    CHECK_ERR(modbus_rtu_transact(&master, &request, dest, 50000, NULL), MODBUS_RTU_ERR_FRAME);
+
+    /* The inter-character wait after the last byte is bounded */
+    CHECK(master.last_timing.rx_us <= (len - 2) * MOCK_CHAR_US + master.inter_char_timeout_us);
+}
+
+static void test_transact_split_response(void)
+{
+    mock_ctx_t mock;
+    modbus_rtu_transport_t transport;
+    modbus_rtu_master_t master;
+    mock_setup(&mock, &transport, &master);
+
+    const modbus_rtu_request_t request = {.slave_addr = 1, .function = 0x03, .reg_start = 0, .reg_count = 2};
+    uint16_t dest[2] = {0};
+    uint8_t reply[16];
+    const size_t len = with_crc(reply, read_reply_pdu, sizeof(read_reply_pdu));
+
+    /* A FIFO/PTY burst boundary inside the frame, within the inter-character allowance */
+    mock_reply(&mock, reply, 4, 3000);
+    mock_reply(&mock, reply + 4, len - 4, 3000 + 4 * MOCK_CHAR_US + master.inter_char_timeout_us - 1);
+    CHECK_ERR(modbus_rtu_transact(&master, &request, dest, 50000, NULL), MODBUS_RTU_OK);
+    CHECK_EQ(dest[1], 0x0102);
+
+    /* The same split with a gap longer than the allowance is two fragments, not one frame */
+    mock.now_us += 100000;
+    mock_reply(&mock, reply, 4, 3000);
+    mock_reply(&mock, reply + 4, len - 4, 3000 + 4 * MOCK_CHAR_US + master.inter_char_timeout_us + 1);
+    CHECK_ERR(modbus_rtu_transact(&master, &request, dest, 50000, NULL), MODBUS_RTU_ERR_TIMEOUT);
+}
+
+static void test_transact_exception_and_crc(void)
+{
+    mock_ctx_t mock;
+    modbus_rtu_transport_t transport;
+    modbus_rtu_master_t master;
+    mock_setup(&mock, &transport, &master);
+
+    const modbus_rtu_request_t request = {.slave_addr = 1, .function = 0x03, .reg_start = 0, .reg_count = 2};
+    uint16_t dest[2] = {0};
+    uint8_t reply[16];
+    uint8_t exception = 0;
+
+    /* The exception frame is recognised from its function byte without waiting for the normal length */
+    static const uint8_t exception_pdu[] = {0x01, 0x83, 0x02};
+    mock_reply(&mock, reply, with_crc(reply, exception_pdu, sizeof(exception_pdu)), 2000);
+    const int64_t start = mock.now_us;
+    CHECK_ERR(modbus_rtu_transact(&master, &request, dest, 50000, &exception), MODBUS_RTU_ERR_EXCEPTION);
+    CHECK_EQ(exception, 0x02);
+    CHECK_EQ(mock.now_us - start, 8 * MOCK_CHAR_US + 2000 + 5 * MOCK_CHAR_US);
+
+    mock.now_us += 100000;
+    const size_t len = with_crc(reply, read_reply_pdu, sizeof(read_reply_pdu));
+    reply[len - 1] ^= 0x01;
+    mock_reply(&mock, reply, len, 2000);
+    CHECK_ERR(modbus_rtu_transact(&master, &request, dest, 50000, NULL), MODBUS_RTU_ERR_CRC);
+}
+
+static void test_transact_frame_gap(void)
+{
+    mock_ctx_t mock;
+    modbus_rtu_transport_t transport;
+    modbus_rtu_master_t master;
+    mock_setup(&mock, &transport, &master);
+
+    const modbus_rtu_request_t request = {.slave_addr = 1, .function = 0x03, .reg_start = 0, .reg_count = 2};
+    uint16_t dest[2] = {0};
+    uint8_t reply[16];
+    const size_t len = with_crc(reply, read_reply_pdu, sizeof(read_reply_pdu));
+
+    mock_reply(&mock, reply, len, 2000);
+    CHECK_ERR(modbus_rtu_transact(&master, &request, dest, 50000, NULL), MODBUS_RTU_OK);
+    const int64_t first_end_us = master.last_activity_us;
+
+    /* Back to back: the next request waits out t3.5 after the last response byte */
+    mock_reply(&mock, reply, len, 2000);
+    CHECK_ERR(modbus_rtu_transact(&master, &request, dest, 50000, NULL), MODBUS_RTU_OK);
+    CHECK_EQ(master.last_timing.gap_wait_us, master.t35_us);
+    CHECK_EQ(mock.write_start_us - first_end_us, master.t35_us);
+
+    /* Part of the gap already elapsed: only the remainder is waited */
+    mock.now_us += 1000;
+    mock_reply(&mock, reply, len, 2000);
+    CHECK_ERR(modbus_rtu_transact(&master, &request, dest, 50000, NULL), MODBUS_RTU_OK);
+    CHECK_EQ(master.last_timing.gap_wait_us, master.t35_us - 1000);
+
+    /* A timeout also restarts the gap from the end of the wait */
+    CHECK_ERR(modbus_rtu_transact(&master, &request, dest, 50000, NULL), MODBUS_RTU_ERR_TIMEOUT);
+    const int64_t timeout_end_us = mock.now_us;
+    mock_reply(&mock, reply, len, 2000);
+    CHECK_ERR(modbus_rtu_transact(&master, &request, dest, 50000, NULL), MODBUS_RTU_OK);
+    CHECK_EQ(mock.write_start_us - timeout_end_us, master.t35_us);
+}
+
+static void test_transact_broadcast_and_errors(void)
+{
+    mock_ctx_t mock;
+    modbus_rtu_transport_t transport;
+    modbus_rtu_master_t master;
+    mock_setup(&mock, &transport, &master);
+
+    /* Broadcast writes are not answered — no read, the gap runs from the end of the request */
+    const uint16_t value = 7;
+    const modbus_rtu_request_t broadcast = {.slave_addr = 0, .function = 0x06, .reg_start = 5, .reg_count = 1,
+                                            .values = &value};
+    CHECK_ERR(modbus_rtu_transact(&master, &broadcast, NULL, 50000, NULL), MODBUS_RTU_OK);
+    CHECK_EQ(master.last_activity_us, mock.now_us);
+    CHECK_EQ(master.last_timing.response_us, 0);
+
+    const modbus_rtu_request_t invalid = {.slave_addr = 1, .function = 0x03, .reg_count = 0};
+    const int writes = mock.writes;
+    CHECK_ERR(modbus_rtu_transact(&master, &invalid, NULL, 50000, NULL), MODBUS_RTU_ERR_ARG);
+    CHECK_EQ(mock.writes, writes);
+
+    mock.fail_write = true;
+    const modbus_rtu_request_t read = {.slave_addr = 1, .function = 0x03, .reg_count = 1};
+    uint16_t dest = 0;
+    CHECK_ERR(modbus_rtu_transact(&master, &read, &dest, 50000, NULL), MODBUS_RTU_ERR_IO);
+}
+
+int main(void)
+{
+    test_crc_vectors();
+    test_crc_table_matches_bitwise();
+    test_frame_gap();
+    test_encode_read();
+    test_encode_write_single();
+    test_encode_write_multiple();
+    test_encode_rejects_invalid();
+    test_decode_read();
+    test_decode_writes();
+    test_decode_exception();
+    test_decode_short_and_corrupt();
+    test_transact_read();
+    test_transact_timeout();
+    test_transact_truncated();
+    test_transact_split_response();
+    test_transact_exception_and_crc();
+    test_transact_frame_gap();
+    test_transact_broadcast_and_errors();
+
+    printf("modbus_rtu_test: %d checks, %d failed\n", checks, failures);
+    return failures == 0 ? 0 : 1;
+}
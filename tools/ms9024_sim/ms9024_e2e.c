@@ -0,0 +1,430 @@
+/**
+ * @file ms9024_e2e.c
+ * @brief Host end-to-end run: the real Modbus master and temp sensor device against ms9024_sim.
+ *
+ * Links components/modbus_master (native backend, bus task, poll scheduler,
+ * slave health, statistics) and components/temp_sensor_device unchanged with
+ * the tools/furnace_sim/host shims.  The UART driver is sim_uart.c on the
+ * simulator's PTY and the tasks run on the virtual clock at wall speed, so
+ * every request crosses a real byte stream with real response latency.
+ *
+ * The device manager is stood in for: this program calls the device's
+ * init/update/read ops itself at the temperature poll period and checks the
+ * temperature read back against the one the simulator was started with.
+ *
+ *   ms9024_e2e [options]
+ *     -s, --sim PATH          Start PATH (an ms9024_sim binary) on a private link
+ *     -p, --port PATH         Use an already running simulator linked at PATH
+ *     -a, --address A         Slave address (default 1)
+ *     -t, --temperature T     Constant PV given to the simulator (default 25.0)
+ *     -T, --tolerance C       Largest accepted read-back error (default 0.01)
+ *     -d, --duration S        Run time after the first reading (default 5)
+ *     -v, --verbose           Firmware log
+ *
+ * Build: cmake -S tools/ms9024_sim -B build/ms9024_sim && cmake --build build/ms9024_sim
+ */
+
+#define _GNU_SOURCE
+#include <getopt.h>
+#include <math.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "device_manager.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "logger_component.h"
+#include "modbus_master.h"
+#include "modbus_master_stats.h"
+#include "sdkconfig.h"
+#include "sim_uart.h"
+#include "temp_sensor_device.h"
+#include "virtual_clock.h"
+
+#define E2E_UART_PORT     1
+#define E2E_BAUD_RATE     9600
+#define SIM_START_MS      5000
+#define FIRST_READING_MS  30000
+
+typedef struct
+{
+    const char* sim_path;
+    const char* port_path;
+    int address;
+    double temperature;
+    double tolerance;
+    uint32_t duration_s;
+    bool verbose;
+} e2e_options_t;
+
+static e2e_options_t options = {
+    .address = 1,
+    .temperature = 25.0,
+    .tolerance = 0.01,
+    .duration_s = 5,
+};
+
+typedef struct
+{
+    uint32_t updates;
+    uint32_t update_errors;
+    uint32_t readings;
+    uint32_t out_of_tolerance;
+    float last;
+    float max_error;
+    uint32_t first_reading_ms;
+} e2e_result_t;
+
+static volatile bool e2e_done;
+static esp_err_t e2e_err = ESP_OK;
+static e2e_result_t result;
+static modbus_slave_stats_t slave_stats;
+
+/* The one device registered through the device manager stand-in */
+static const device_ops_t* device_ops;
+static void* device_ctx;
+
+/* ── Run ──────────────────────────────────────────────────────────────── */
+static void poll_sensor(const temp_sensor_device_t* sensor)
+{
+    if (device_ops->is_available == NULL || device_ops->is_available(device_ctx))
+    {
+        result.updates++;
+        if (device_ops->update(device_ctx) != ESP_OK)
+        {
+            result.update_errors++;
+        }
+    }
+
+    float temperature;
+    if (temp_sensor_read_device(sensor, &temperature) != ESP_OK)
+    {
+        return;
+    }
+    const float error = fabsf(temperature - (float)options.temperature);
+    result.readings++;
+    result.last = temperature;
+    result.max_error = fmaxf(result.max_error, error);
+    if (error > options.tolerance)
+    {
+        result.out_of_tolerance++;
+    }
+}
+
+static void e2e_task(void* arg)
+{
+    (void)arg;
+
+    const modbus_config_t config = {
+        .uart_num = E2E_UART_PORT,
+        .tx_pin = 17,
+        .rx_pin = 16,
+        .de_pin = 4,
+        .baud_rate = E2E_BAUD_RATE,
+    };
+    temp_sensor_device_t* sensor = NULL;
+
+    e2e_err = modbus_master_init(&config);
+    if (e2e_err == ESP_OK)
+    {
+        e2e_err = temp_sensor_create((uint8_t)options.address, &sensor);
+    }
+    if (e2e_err == ESP_OK)
+    {
+        /* Reads the config fingerprint and dumps the registers over the bus, then joins the poll scheduler */
+        e2e_err = device_ops->init(device_ctx);
+    }
+    if (e2e_err == ESP_OK)
+    {
+        const int64_t first_deadline_us = esp_timer_get_time() + FIRST_READING_MS * 1000LL;
+        while (result.readings == 0 && esp_timer_get_time() < first_deadline_us)
+        {
+            vTaskDelay(pdMS_TO_TICKS(CONFIG_TEMP_SENSOR_POLL_PERIOD_MS));
+            poll_sensor(sensor);
+        }
+
+        const int64_t end_us = esp_timer_get_time() + (int64_t)options.duration_s * 1000000;
+        while (result.readings > 0 && esp_timer_get_time() < end_us)
+        {
+            vTaskDelay(pdMS_TO_TICKS(CONFIG_TEMP_SENSOR_POLL_PERIOD_MS));
+            poll_sensor(sensor);
+        }
+
+        temp_sensor_get_time_to_first_reading(sensor, &result.first_reading_ms);
+        modbus_master_get_slave_stats((uint8_t)options.address, &slave_stats);
+    }
+    if (sensor != NULL)
+    {
+        temp_sensor_destroy(sensor);
+    }
+    modbus_master_shutdown();
+
+    e2e_done = true;
+    vTaskDelete(NULL);
+}
+
+/* ── Simulator process ────────────────────────────────────────────────── */
+static pid_t start_simulator(const char* link_path)
+{
+    char temperature[32];
+    snprintf(temperature, sizeof(temperature), "%.3f", options.temperature);
+    char address[8];
+    snprintf(address, sizeof(address), "%d", options.address);
+    char baud[16];
+    snprintf(baud, sizeof(baud), "%d", E2E_BAUD_RATE);
+
+    unlink(link_path);
+    const pid_t pid = fork();
+    if (pid == 0)
+    {
+        if (!options.verbose)
+        {
+            freopen("/dev/null", "w", stdout);
+        }
+        execl(options.sim_path, options.sim_path, "-l", link_path, "-a", address, "-b", baud, "-t", temperature,
+              "-S", "1", (char*)NULL);
+        perror(options.sim_path);
+        _exit(127);
+    }
+    if (pid < 0)
+    {
+        perror("fork");
+        return -1;
+    }
+
+    for (int waited_ms = 0; waited_ms < SIM_START_MS; waited_ms += 10)
+    {
+        if (access(link_path, F_OK) == 0)
+        {
+            return pid;
+        }
+        if (waitpid(pid, NULL, WNOHANG) == pid)
+        {
+            fprintf(stderr, "%s exited before opening its PTY\n", options.sim_path);
+            return -1;
+        }
+        usleep(10000);
+    }
+    fprintf(stderr, "%s did not create %s\n", options.sim_path, link_path);
+    kill(pid, SIGTERM);
+    waitpid(pid, NULL, 0);
+    return -1;
+}
+
+static void stop_simulator(const pid_t pid)
+{
+    if (pid > 0)
+    {
+        kill(pid, SIGTERM);
+        waitpid(pid, NULL, 0);
+    }
+}
+
+/* ── Report ───────────────────────────────────────────────────────────── */
+static void usage(const char* argv0)
+{
+    fprintf(stderr,
+            "usage: %s (-s SIM | -p PORT) [-a A] [-t T] [-T C] [-d S] [-v]\n"
+            "  -s, --sim PATH          Start an ms9024_sim binary on a private link\n"
+            "  -p, --port PATH         Use an already running simulator linked at PATH\n"
+            "  -a, --address A         Slave address (default 1)\n"
+            "  -t, --temperature T     Constant PV given to the simulator (default 25.0)\n"
+            "  -T, --tolerance C       Largest accepted read-back error (default 0.01)\n"
+            "  -d, --duration S        Run time after the first reading (default 5)\n"
+            "  -v, --verbose           Firmware log\n",
+            argv0);
+}
+
+static bool parse_options(const int argc, char** argv)
+{
+    static const struct option long_options[] = {
+        {"sim", required_argument, NULL, 's'},
+        {"port", required_argument, NULL, 'p'},
+        {"address", required_argument, NULL, 'a'},
+        {"temperature", required_argument, NULL, 't'},
+        {"tolerance", required_argument, NULL, 'T'},
+        {"duration", required_argument, NULL, 'd'},
+        {"verbose", no_argument, NULL, 'v'},
+        {NULL, 0, NULL, 0},
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "s:p:a:t:T:d:v", long_options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 's':
+            options.sim_path = optarg;
+            break;
+        case 'p':
+            options.port_path = optarg;
+            break;
+        case 'a':
+            options.address = atoi(optarg);
+            break;
+        case 't':
+            options.temperature = atof(optarg);
+            break;
+        case 'T':
+            options.tolerance = atof(optarg);
+            break;
+        case 'd':
+            options.duration_s = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 'v':
+            options.verbose = true;
+            break;
+        default:
+            return false;
+        }
+    }
+    return (options.sim_path == NULL) != (options.port_path == NULL) && options.address >= 1 &&
+           options.address <= 247;
+}
+
+int main(const int argc, char** argv)
+{
+    if (!parse_options(argc, argv))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    char link_path[64];
+    pid_t sim_pid = -1;
+    if (options.sim_path != NULL)
+    {
+        snprintf(link_path, sizeof(link_path), "/tmp/ms9024_e2e.%d", (int)getpid());
+        sim_pid = start_simulator(link_path);
+        if (sim_pid < 0)
+        {
+            return 1;
+        }
+        options.port_path = link_path;
+    }
+    sim_uart_attach(E2E_UART_PORT, options.port_path);
+
+    /* Wall speed: the simulator answers in real time */
+    virtual_clock_init(1.0);
+    if (xTaskCreate(e2e_task, "ms9024_e2e", 4096, NULL, 5, NULL) != pdPASS)
+    {
+        fprintf(stderr, "Failed to start the end-to-end task\n");
+        stop_simulator(sim_pid);
+        return 1;
+    }
+
+    const int64_t limit_us = (FIRST_READING_MS + (int64_t)options.duration_s * 1000 + 30000) * 1000;
+    for (int64_t until_us = 100000; !e2e_done && until_us <= limit_us; until_us += 100000)
+    {
+        virtual_clock_advance_to(until_us);
+    }
+    stop_simulator(sim_pid);
+
+    if (!e2e_done)
+    {
+        fprintf(stderr, "End-to-end run did not complete\n");
+        return 1;
+    }
+
+    const modbus_fc_stats_t* reads = &slave_stats.fc[MODBUS_STATS_FC_READ_HOLDING];
+    printf("MS9024 end-to-end, slave %d at %.2f C over %s (native RTU backend)\n", options.address,
+           options.temperature, options.port_path);
+    printf("  first reading %lu ms after boot; %lu readings, last %.3f C, max error %.4f C (%lu out of tolerance)\n",
+           (unsigned long)result.first_reading_ms, (unsigned long)result.readings, (double)result.last,
+           (double)result.max_error, (unsigned long)result.out_of_tolerance);
+    printf("  %lu updates (%lu failed); holding reads %lu sent, %lu ok, %lu timeouts, %lu CRC errors, RTT max %.1f ms\n",
+           (unsigned long)result.updates, (unsigned long)result.update_errors, (unsigned long)reads->requests,
+           (unsigned long)reads->ok, (unsigned long)reads->timeouts, (unsigned long)reads->crc_errors,
+           reads->rtt_max_us / 1000.0);
+
+    if (e2e_err != ESP_OK)
+    {
+        fprintf(stderr, "FAIL: start-up error %d\n", e2e_err);
+        return 1;
+    }
+    if (result.readings == 0 || result.out_of_tolerance > 0 || result.update_errors > 0)
+    {
+        fprintf(stderr, "FAIL: temperature not read back through the master\n");
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
+
+/* ── Host stand-ins ───────────────────────────────────────────────────── */
+void logger_send(const log_level_t log_level, const char* tag, const char* message, ...)
+{
+    if (!options.verbose && log_level > LOG_LEVEL_WARN)
+    {
+        return;
+    }
+
+    static const char level_chars[] = {'-', 'E', 'W', 'I', 'D'};
+    fprintf(stderr, "[%9.3f s] %c %s: ", (double)esp_timer_get_time() / 1e6, level_chars[log_level], tag);
+    va_list args;
+    va_start(args, message);
+    vfprintf(stderr, message, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+const char* esp_err_to_name(const esp_err_t code)
+{
+    (void)code;
+    return "ESP_ERR";
+}
+
+/* Device manager: keep the ops so the run drives them, as the device task would */
+esp_err_t device_manager_create_device(const void* ctx, const device_ops_t* ops, const char* name,
+                                       const device_type_t type, device_t** out_device)
+{
+    (void)name;
+    (void)type;
+    if (device_ops != NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    device_ops = ops;
+    device_ctx = (void*)ctx;
+    *out_device = (device_t*)ctx;
+    return ESP_OK;
+}
+
+esp_err_t device_manager_set_device_schedule(device_t* device, const device_schedule_t* schedule)
+{
+    (void)device;
+    (void)schedule;
+    return ESP_OK;
+}
+
+esp_err_t device_manager_set_device_state(device_t* device, const device_state_t new_state)
+{
+    (void)device;
+    (void)new_state;
+    return ESP_OK;
+}
+
+esp_err_t device_manager_read_device(const device_t* device, void* data_out)
+{
+    (void)device;
+    return device_ops->read(device_ctx, data_out);
+}
+
+esp_err_t device_manager_write_device(const device_t* device, const device_write_cmd_t* cmd)
+{
+    (void)device;
+    return device_ops->write(device_ctx, cmd);
+}
+
+esp_err_t device_manager_destroy(device_t* device)
+{
+    (void)device;
+    device_ops = NULL;
+    device_ctx = NULL;
+    return ESP_OK;
+}
@@ -0,0 +1,675 @@
+/**
+ * @file ms9024_sim.c
+ * @brief Host-side Modbus RTU slave simulator emulating MS9024 transmitters.
+ *
+ * Opens a pseudo-terminal pair and answers Modbus RTU requests on the slave
+ * side for one or more MS9024 units.  The register map mirrors the addresses
+ * in components/temp_sensor_device/src/ms9024.h (FIN, SENS, WIRE, the repair
+ * registers 27/30/129, firmware, C/F, input offset and the PV/T2/AOUT floats
+ * in CDAB word order).
+ *
+ * The process value follows a scripted curve (constant, ramp or a CSV of
+ * time/temperature points) with optional noise.  Response latency, dropped
+ * frames, CRC corruption and silent slaves can be injected to exercise the
+ * master's timeout, circuit breaker and statistics paths.
+ *
+ *   ms9024_sim [options]
+ *     -n, --slaves N          Number of emulated units (default 1)
+ *     -a, --base-address A    Address of the first unit (default 1)
+ *     -b, --baud B            Baud rate used for the t3.5 gap (default 9600)
+ *     -l, --link PATH         Symlink the PTY slave to PATH
+ *     -r, --ramp T0:T1:SEC    Ramp PV from T0 to T1 over SEC seconds
+ *     -c, --curve FILE        Piecewise-linear PV curve, lines of "seconds,celsius"
+ *     -t, --temperature T     Constant PV (default 25.0)
+ *     -N, --noise SIGMA       Gaussian PV noise in degrees C
+ *     -L, --latency MS        Response latency (default 5)
+ *     -j, --jitter MS         Uniform extra latency 0..MS
+ *     -d, --drop PCT          Percentage of requests left unanswered
+ *     -C, --corrupt PCT       Percentage of responses sent with a bad CRC
+ *     -s, --silent ADDR       Never answer ADDR (repeatable)
+ *     -S, --seed N            Random seed (default: time)
+ *     -v, --verbose           Log every frame
+ *
+ * Build: cmake -S tools/ms9024_sim -B build/ms9024_sim && cmake --build build/ms9024_sim
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <math.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+/* ── MS9024 register map (see ms9024.h) ───────────────────────────────── */
+#define REG_FIN        26
+#define REG_27         27
+#define REG_SENS       28
+#define REG_30         30
+#define REG_WIRE       32
+#define REG_FIRMWARE   126
+#define REG_129        129
+#define REG_CF         447
+#define REG_IN_OFFSET  524
+#define REG_AOUT       726
+#define REG_PV         728
+#define REG_T2         730
+
+#define REG_SPACE      1024
+#define MAX_SLAVES     32
+#define MAX_SILENT     32
+#define MAX_CURVE      1024
+#define MAX_FRAME      256
+#define MAX_REGS       125
+
+#define EX_ILLEGAL_FUNCTION  0x01
+#define EX_ILLEGAL_ADDRESS   0x02
+#define EX_ILLEGAL_VALUE     0x03
+
+typedef struct
+{
+    uint8_t address;
+    uint16_t regs[REG_SPACE];
+} sim_slave_t;
+
+typedef struct
+{
+    double t;
+    double temp;
+} curve_point_t;
+
+typedef struct
+{
+    uint32_t frames_rx;
+    uint32_t bad_crc_rx;
+    uint32_t foreign;        /* Addressed to a unit we do not emulate */
+    uint32_t responses;
+    uint32_t exceptions;
+    uint32_t dropped;
+    uint32_t corrupted;
+} sim_stats_t;
+
+static struct
+{
+    sim_slave_t slaves[MAX_SLAVES];
+    int slave_count;
+    uint8_t silent[MAX_SILENT];
+    int silent_count;
+
+    uint32_t baud;
+    double constant_temp;
+    double ramp_t0, ramp_t1, ramp_sec;
+    bool ramp;
+    curve_point_t curve[MAX_CURVE];
+    int curve_len;
+    double noise;
+
+    int latency_ms;
+    int jitter_ms;
+    double drop_pct;
+    double corrupt_pct;
+    bool verbose;
+
+    struct timespec start;
+    sim_stats_t stats;
+} sim;
+
+static volatile sig_atomic_t stop_requested;
+
+/* =========================================================================
+ *  Helpers
+ * ========================================================================= */
+static uint16_t crc16(const uint8_t* data, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++)
+        {
+            crc = (crc & 1) ? (uint16_t)((crc >> 1) ^ 0xA001) : (uint16_t)(crc >> 1);
+        }
+    }
+    return crc;
+}
+
+static double elapsed_sec(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - sim.start.tv_sec) + (double)(now.tv_nsec - sim.start.tv_nsec) / 1e9;
+}
+
+static double uniform(void)
+{
+    return (double)rand() / ((double)RAND_MAX + 1.0);
+}
+
+static double gaussian(void)
+{
+    /* Box-Muller */
+    const double u1 = uniform() + 1e-12;
+    const double u2 = uniform();
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static void put_float_cdab(uint16_t* regs, const uint16_t reg, const float value)
+{
+    uint32_t raw;
+    memcpy(&raw, &value, sizeof(raw));
+    regs[reg] = (uint16_t)(raw & 0xFFFF);     /* CD — low word first */
+    regs[reg + 1] = (uint16_t)(raw >> 16);    /* AB */
+}
+
+static double curve_temperature(const double t)
+{
+    if (sim.curve_len > 0)
+    {
+        if (t <= sim.curve[0].t)
+        {
+            return sim.curve[0].temp;
+        }
+        for (int i = 1; i < sim.curve_len; i++)
+        {
+            if (t <= sim.curve[i].t)
+            {
+                const curve_point_t* a = &sim.curve[i - 1];
+                const curve_point_t* b = &sim.curve[i];
+                const double span = b->t - a->t;
+                return span > 0 ? a->temp + (b->temp - a->temp) * (t - a->t) / span : b->temp;
+            }
+        }
+        return sim.curve[sim.curve_len - 1].temp;
+    }
+    if (sim.ramp)
+    {
+        const double f = sim.ramp_sec > 0 ? fmin(t / sim.ramp_sec, 1.0) : 1.0;
+        return sim.ramp_t0 + (sim.ramp_t1 - sim.ramp_t0) * f;
+    }
+    return sim.constant_temp;
+}
+
+static void refresh_measurements(sim_slave_t* slave)
+{
+    const double pv = curve_temperature(elapsed_sec()) + (sim.noise > 0 ? gaussian() * sim.noise : 0.0);
+    put_float_cdab(slave->regs, REG_PV, (float)pv);
+    put_float_cdab(slave->regs, REG_T2, (float)(24.0 + 0.2 * gaussian()));
+    /* 4–20 mA output scaled over 0 … 1200 °C */
+    put_float_cdab(slave->regs, REG_AOUT, (float)(4.0 + 16.0 * fmin(fmax(pv / 1200.0, 0.0), 1.0)));
+}
+
+static void init_slave(sim_slave_t* slave, const uint8_t address)
+{
+    memset(slave, 0, sizeof(*slave));
+    slave->address = address;
+    slave->regs[REG_FIN] = 50;
+    slave->regs[REG_27] = 0;
+    slave->regs[REG_SENS] = 16;  /* Pt100 385 */
+    slave->regs[REG_30] = 2;
+    slave->regs[REG_WIRE] = 3;
+    slave->regs[REG_FIRMWARE] = 112;
+    slave->regs[REG_129] = 282;
+    slave->regs[REG_CF] = 0;
+    put_float_cdab(slave->regs, REG_IN_OFFSET, 0.0f);
+    refresh_measurements(slave);
+}
+
+static sim_slave_t* find_slave(const uint8_t address)
+{
+    for (int i = 0; i < sim.silent_count; i++)
+    {
+        if (sim.silent[i] == address)
+        {
+            return NULL;
+        }
+    }
+    for (int i = 0; i < sim.slave_count; i++)
+    {
+        if (sim.slaves[i].address == address)
+        {
+            return &sim.slaves[i];
+        }
+    }
+    return NULL;
+}
+
+static bool is_emulated(const uint8_t address)
+{
+    for (int i = 0; i < sim.slave_count; i++)
+    {
+        if (sim.slaves[i].address == address)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void log_frame(const char* dir, const uint8_t* frame, const size_t len)
+{
+    if (!sim.verbose)
+    {
+        return;
+    }
+    fprintf(stderr, "[%9.3f] %s", elapsed_sec(), dir);
+    for (size_t i = 0; i < len; i++)
+    {
+        fprintf(stderr, " %02X", frame[i]);
+    }
+    fputc('\n', stderr);
+}
+
+/* =========================================================================
+ *  Request handling
+ * ========================================================================= */
+static size_t exception_response(uint8_t* out, const uint8_t address, const uint8_t fc, const uint8_t code)
+{
+    out[0] = address;
+    out[1] = (uint8_t)(fc | 0x80);
+    out[2] = code;
+    sim.stats.exceptions++;
+    return 3;
+}
+
+static size_t handle_pdu(sim_slave_t* slave, const uint8_t* req, const size_t len, uint8_t* out)
+{
+    const uint8_t fc = req[1];
+    if (len < 6)
+    {
+        return exception_response(out, slave->address, fc, EX_ILLEGAL_VALUE);
+    }
+    const uint16_t start = (uint16_t)(req[2] << 8 | req[3]);
+    const uint16_t value = (uint16_t)(req[4] << 8 | req[5]);
+
+    out[0] = slave->address;
+    out[1] = fc;
+
+    switch (fc)
+    {
+    case 0x03:
+    case 0x04:
+        {
+            const uint16_t count = value;
+            if (count == 0 || count > MAX_REGS)
+            {
+                return exception_response(out, slave->address, fc, EX_ILLEGAL_VALUE);
+            }
+            if ((uint32_t)start + count > REG_SPACE)
+            {
+                return exception_response(out, slave->address, fc, EX_ILLEGAL_ADDRESS);
+            }
+            refresh_measurements(slave);
+            out[2] = (uint8_t)(count * 2);
+            for (uint16_t i = 0; i < count; i++)
+            {
+                out[3 + 2 * i] = (uint8_t)(slave->regs[start + i] >> 8);
+                out[4 + 2 * i] = (uint8_t)(slave->regs[start + i] & 0xFF);
+            }
+            return 3 + (size_t)count * 2;
+        }
+    case 0x06:
+        if (start >= REG_SPACE)
+        {
+            return exception_response(out, slave->address, fc, EX_ILLEGAL_ADDRESS);
+        }
+        slave->regs[start] = value;
+        memcpy(&out[2], &req[2], 4);
+        return 6;
+    case 0x10:
+        {
+            const uint16_t count = value;
+            if (len < 7 || count == 0 || count > 123 || req[6] != count * 2 || len < 7 + (size_t)count * 2)
+            {
+                return exception_response(out, slave->address, fc, EX_ILLEGAL_VALUE);
+            }
+            if ((uint32_t)start + count > REG_SPACE)
+            {
+                return exception_response(out, slave->address, fc, EX_ILLEGAL_ADDRESS);
+            }
+            for (uint16_t i = 0; i < count; i++)
+            {
+                slave->regs[start + i] = (uint16_t)(req[7 + 2 * i] << 8 | req[8 + 2 * i]);
+            }
+            memcpy(&out[2], &req[2], 4);
+            return 6;
+        }
+    default:
+        return exception_response(out, slave->address, fc, EX_ILLEGAL_FUNCTION);
+    }
+}
+
+static void handle_frame(const int fd, const uint8_t* frame, const size_t len)
+{
+    sim.stats.frames_rx++;
+    log_frame("RX", frame, len);
+
+    if (len < 4)
+    {
+        sim.stats.bad_crc_rx++;
+        return;
+    }
+    const uint16_t crc = (uint16_t)(frame[len - 2] | frame[len - 1] << 8);
+    if (crc16(frame, len - 2) != crc)
+    {
+        sim.stats.bad_crc_rx++;
+        if (sim.verbose)
+        {
+            fprintf(stderr, "            bad CRC, ignored\n");
+        }
+        return;
+    }
+
+    sim_slave_t* slave = find_slave(frame[0]);
+    if (slave == NULL)
+    {
+        if (!is_emulated(frame[0]))
+        {
+            sim.stats.foreign++;
+        }
+        return;
+    }
+
+    if (uniform() * 100.0 < sim.drop_pct)
+    {
+        sim.stats.dropped++;
+        return;
+    }
+
+    uint8_t out[MAX_FRAME];
+    size_t out_len = handle_pdu(slave, frame, len - 2, out);
+    const uint16_t out_crc = crc16(out, out_len);
+    out[out_len++] = (uint8_t)(out_crc & 0xFF);
+    out[out_len++] = (uint8_t)(out_crc >> 8);
+
+    if (uniform() * 100.0 < sim.corrupt_pct)
+    {
+        out[out_len - 1] ^= 0x5A;
+        sim.stats.corrupted++;
+    }
+
+    const int delay_ms = sim.latency_ms + (sim.jitter_ms > 0 ? rand() % (sim.jitter_ms + 1) : 0);
+    if (delay_ms > 0)
+    {
+        usleep((useconds_t)delay_ms * 1000);
+    }
+
+    log_frame("TX", out, out_len);
+    size_t written = 0;
+    while (written < out_len)
+    {
+        const ssize_t n = write(fd, out + written, out_len - written);
+        if (n < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+            {
+                continue;
+            }
+            perror("write");
+            return;
+        }
+        written += (size_t)n;
+    }
+    sim.stats.responses++;
+}
+
+/* =========================================================================
+ *  Setup
+ * ========================================================================= */
+static int load_curve(const char* path)
+{
+    FILE* f = fopen(path, "r");
+    if (f == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+    char line[128];
+    while (fgets(line, sizeof(line), f) != NULL && sim.curve_len < MAX_CURVE)
+    {
+        double t, temp;
+        if (line[0] == '#' || sscanf(line, "%lf,%lf", &t, &temp) != 2)
+        {
+            continue;
+        }
+        sim.curve[sim.curve_len++] = (curve_point_t){t, temp};
+    }
+    fclose(f);
+    if (sim.curve_len == 0)
+    {
+        fprintf(stderr, "%s: no \"seconds,celsius\" points\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+static int open_pty(int* slave_fd, char* name, const size_t name_len)
+{
+    const int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+    {
+        perror("posix_openpt");
+        return -1;
+    }
+    const char* path = ptsname(master);
+    if (path == NULL)
+    {
+        perror("ptsname");
+        return -1;
+    }
+    snprintf(name, name_len, "%s", path);
+
+    /* Keep our own handle on the slave side in raw mode: the line discipline
+     * must not translate bytes, and the master must not see EIO when the
+     * client closes and reopens the port. */
+    *slave_fd = open(name, O_RDWR | O_NOCTTY);
+    if (*slave_fd < 0)
+    {
+        perror(name);
+        return -1;
+    }
+    struct termios tio;
+    tcgetattr(*slave_fd, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(*slave_fd, TCSANOW, &tio);
+
+    return master;
+}
+
+static void on_signal(const int sig)
+{
+    (void)sig;
+    stop_requested = 1;
+}
+
+static void usage(const char* prog)
+{
+    fprintf(stderr,
+            "usage: %s [-n slaves] [-a base_addr] [-b baud] [-l link] [-t temp | -r T0:T1:SEC | -c curve.csv]\n"
+            "          [-N noise] [-L latency_ms] [-j jitter_ms] [-d drop_pct] [-C corrupt_pct] [-s silent_addr]\n"
+            "          [-S seed] [-v]\n",
+            prog);
+}
+
+int main(int argc, char** argv)
+{
+    int slave_count = 1;
+    int base_address = 1;
+    const char* link_path = NULL;
+    unsigned seed = (unsigned)time(NULL);
+
+    sim.baud = 9600;
+    sim.constant_temp = 25.0;
+    sim.latency_ms = 5;
+
+    static const struct option options[] = {
+        {"slaves", required_argument, NULL, 'n'},
+        {"base-address", required_argument, NULL, 'a'},
+        {"baud", required_argument, NULL, 'b'},
+        {"link", required_argument, NULL, 'l'},
+        {"temperature", required_argument, NULL, 't'},
+        {"ramp", required_argument, NULL, 'r'},
+        {"curve", required_argument, NULL, 'c'},
+        {"noise", required_argument, NULL, 'N'},
+        {"latency", required_argument, NULL, 'L'},
+        {"jitter", required_argument, NULL, 'j'},
+        {"drop", required_argument, NULL, 'd'},
+        {"corrupt", required_argument, NULL, 'C'},
+        {"silent", required_argument, NULL, 's'},
+        {"seed", required_argument, NULL, 'S'},
+        {"verbose", no_argument, NULL, 'v'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0},
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "n:a:b:l:t:r:c:N:L:j:d:C:s:S:vh", options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'n': slave_count = atoi(optarg); break;
+        case 'a': base_address = atoi(optarg); break;
+        case 'b': sim.baud = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'l': link_path = optarg; break;
+        case 't': sim.constant_temp = atof(optarg); break;
+        case 'r':
+            if (sscanf(optarg, "%lf:%lf:%lf", &sim.ramp_t0, &sim.ramp_t1, &sim.ramp_sec) != 3)
+            {
+                usage(argv[0]);
+                return 2;
+            }
+            sim.ramp = true;
+            break;
+        case 'c':
+            if (load_curve(optarg) != 0)
+            {
+                return 2;
+            }
+            break;
+        case 'N': sim.noise = atof(optarg); break;
+        case 'L': sim.latency_ms = atoi(optarg); break;
+        case 'j': sim.jitter_ms = atoi(optarg); break;
+        case 'd': sim.drop_pct = atof(optarg); break;
+        case 'C': sim.corrupt_pct = atof(optarg); break;
+        case 's':
+            if (sim.silent_count < MAX_SILENT)
+            {
+                sim.silent[sim.silent_count++] = (uint8_t)atoi(optarg);
+            }
+            break;
+        case 'S': seed = (unsigned)strtoul(optarg, NULL, 10); break;
+        case 'v': sim.verbose = true; break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 2;
+        }
+    }
+
+    if (slave_count < 1 || slave_count > MAX_SLAVES || base_address < 1 || base_address + slave_count - 1 > 247)
+    {
+        fprintf(stderr, "invalid slave range %d..%d\n", base_address, base_address + slave_count - 1);
+        return 2;
+    }
+
+    srand(seed);
+    clock_gettime(CLOCK_MONOTONIC, &sim.start);
+    for (int i = 0; i < slave_count; i++)
+    {
+        init_slave(&sim.slaves[i], (uint8_t)(base_address + i));
+    }
+    sim.slave_count = slave_count;
+
+    int slave_fd = -1;
+    char pty_name[128];
+    const int fd = open_pty(&slave_fd, pty_name, sizeof(pty_name));
+    if (fd < 0)
+    {
+        return 1;
+    }
+    if (link_path != NULL)
+    {
+        unlink(link_path);
+        if (symlink(pty_name, link_path) != 0)
+        {
+            perror(link_path);
+            return 1;
+        }
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    /* t3.5: 3.5 characters of 11 bits, fixed at 1.75 ms above 19200 baud.
+     * A PTY delivers bytes in bursts, so never wait less than 2 ms. */
+    const double gap_ms = sim.baud > 19200 ? 1.75 : 3.5 * 11.0 * 1000.0 / sim.baud;
+    const int gap_poll_ms = gap_ms < 2.0 ? 2 : (int)ceil(gap_ms);
+
+    printf("MS9024 simulator: %d unit(s) at address %d..%d on %s%s%s (t3.5 %d ms, seed %u)\n",
+           slave_count, base_address, base_address + slave_count - 1, pty_name,
+           link_path ? " -> " : "", link_path ? link_path : "", gap_poll_ms, seed);
+    fflush(stdout);
+
+    uint8_t frame[MAX_FRAME];
+    size_t frame_len = 0;
+
+    while (!stop_requested)
+    {
+        struct pollfd pfd = {.fd = fd, .events = POLLIN};
+        const int ready = poll(&pfd, 1, frame_len > 0 ? gap_poll_ms : 200);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            perror("poll");
+            break;
+        }
+        if (ready == 0)
+        {
+            /* Silence for t3.5 closes the frame */
+            if (frame_len > 0)
+            {
+                handle_frame(fd, frame, frame_len);
+                frame_len = 0;
+            }
+            continue;
+        }
+
+        const ssize_t n = read(fd, frame + frame_len, sizeof(frame) - frame_len);
+        if (n <= 0)
+        {
+            if (n < 0 && (errno == EINTR || errno == EAGAIN || errno == EIO))
+            {
+                continue;
+            }
+            break;
+        }
+        frame_len += (size_t)n;
+        if (frame_len == sizeof(frame))
+        {
+            /* Longer than any RTU frame — garbage, resynchronise */
+            sim.stats.bad_crc_rx++;
+            frame_len = 0;
+        }
+    }
+
+    printf("\nframes rx %u (bad crc %u, foreign %u), responses %u (exceptions %u), dropped %u, corrupted %u\n",
+           sim.stats.frames_rx, sim.stats.bad_crc_rx, sim.stats.foreign, sim.stats.responses,
+           sim.stats.exceptions, sim.stats.dropped, sim.stats.corrupted);
+
+    if (link_path != NULL)
+    {
+        unlink(link_path);
+    }
+    close(slave_fd);
+    close(fd);
+    return 0;
+}